@@ -0,0 +1,367 @@
+/*
+ * pipebench.c : Benchmark of the core event pipeline
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+/* A synthetic driver (like the foo driver, but at a high rate) and
+ * 32 dummy joysticks are registered through the internal device
+ * interface, and the stages of the event pipeline are timed one by
+ * one: the raw queue, oi_events_poll, action dispatch with a large
+ * action map, the joystick pump, and finally the latency from the
+ * (synthetic) hardware timestamp to the application. Results are
+ * written to stdout as JSON, progress goes to stderr.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "openinput.h"
+#include "internal.h"
+#include "testlib.h"
+
+// Parameters
+#define ROUNDS 2001
+#define BATCH 64
+#define NUM_JOYS 32
+#define NUM_AXES 6
+#define NUM_BUTTONS 12
+#define NUM_ACTIONS 1024
+#define NUM_KEYS 64
+#define SYNTH_RATE 50000
+#define SYNTH_MS 500
+#define MAX_SAMPLES (SYNTH_RATE * SYNTH_MS / 1000 + OI_MAX_EVENTS)
+
+// Globals
+static unsigned char joys[NUM_JOYS];
+static double samples[MAX_SAMPLES];
+static char first = TRUE;
+static volatile unsigned int sink;
+
+// Synthetic driver state
+static char synth_on = FALSE;
+static oi_time synth_next = 0;
+static unsigned int synth_count = 0;
+static unsigned int synth_dropped = 0;
+static unsigned char synth_index = 0;
+
+// Bootstraps
+oi_bootstrap synth_bootstrap = {
+    "synth",
+    "Synthetic high rate keyboard",
+    OI_PRO_UNKNOWN,
+    NULL,
+    dummy_device
+};
+oi_bootstrap joy_bootstrap = {
+    "benchjoy",
+    "Pipeline benchmark joystick",
+    OI_PRO_JOYSTICK,
+    NULL,
+    dummy_joystick
+};
+
+/* ******************************************************************** */
+
+// Post key events which are due, stamped with the time they were due.
+// Like hardware, events the queue has no room for are lost and
+// counted. The joysticks get their input from the benchmark
+void synth_process(oi_device *dev) {
+    oi_event ev;
+    oi_time now;
+
+    if(!synth_on || dev->joyconfig) {
+        return;
+    }
+
+    synth_index = dev->index;
+    now = oi_gettime();
+    while(synth_next <= now) {
+        ev.type = (synth_count & 1) ? OI_KEYUP : OI_KEYDOWN;
+        ev.key.device = dev->index;
+        ev.key.keysym.scancode = 0;
+        ev.key.keysym.sym = OIK_F15;
+        ev.key.keysym.mod = OIM_NONE;
+        queue_stamp(synth_next);
+        if(!queue_add(&ev)) {
+            synth_dropped++;
+        }
+        synth_count++;
+        synth_next += 1000000000ULL / SYNTH_RATE;
+    }
+}
+
+/* ******************************************************************** */
+
+// Monotonic time in nanoseconds
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* ******************************************************************** */
+
+// Compare doubles for qsort
+int cmp(const void *a, const void *b) {
+    double d;
+    d = *(const double*)a - *(const double*)b;
+    return (d > 0) - (d < 0);
+}
+
+/* ******************************************************************** */
+
+// Remove all pending events
+void drain() {
+    oi_event evs[BATCH];
+
+    while(queue_peep(evs, BATCH, OI_MASK_ALL, TRUE) > 0);
+}
+
+/* ******************************************************************** */
+
+// Print one result
+void result(char *name, char *unit, double value, double *sorted, int n) {
+    fprintf(stderr, "%-32s %12.1f %s\n", name, value, unit);
+    printf("%s\n    {\"name\": \"%s\", \"unit\": \"%s\", \"value\": %.1f",
+           first ? "" : ",", name, unit, value);
+    if(sorted && n) {
+        printf(", \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f",
+               sorted[n/2], sorted[n*9/10], sorted[n*99/100], sorted[n-1]);
+    }
+    printf("}");
+    first = FALSE;
+}
+
+/* ******************************************************************** */
+
+// Raw queue throughput, batches of adds and removals
+void bench_queue() {
+    oi_event ev[BATCH];
+    double t[ROUNDS];
+    double s;
+    int r;
+    int i;
+
+    memset(ev, 0, sizeof(ev));
+    for(i=0; i<BATCH; i++) {
+        ev[i].type = OI_JOYAXIS;
+        ev[i].joyaxis.abs = i;
+    }
+
+    for(r=0; r<ROUNDS; r++) {
+        s = now_ns();
+        for(i=0; i<BATCH; i++) {
+            queue_add(&ev[i]);
+        }
+        sink += queue_peep(ev, BATCH, OI_MASK_ALL, TRUE);
+        t[r] = (now_ns() - s) / BATCH;
+    }
+    qsort(t, ROUNDS, sizeof(double), cmp);
+    result("queue_add_peep", "ns/event", t[ROUNDS/2], t, ROUNDS);
+    result("queue_throughput", "Mevents/s", 1e3 / t[ROUNDS/2], NULL, 0);
+}
+
+/* ******************************************************************** */
+
+// Cost of oi_events_poll per returned event
+void bench_poll() {
+    oi_event ev;
+    double t[ROUNDS];
+    double s;
+    int r;
+    int i;
+    int n;
+
+    memset(&ev, 0, sizeof(ev));
+    for(r=0; r<ROUNDS; r++) {
+        for(i=0; i<BATCH; i++) {
+            ev.type = OI_JOYAXIS;
+            queue_add(&ev);
+        }
+        n = 0;
+        s = now_ns();
+        while(oi_events_poll(&ev)) {
+            n++;
+        }
+        t[r] = (now_ns() - s) / (n ? n : 1);
+    }
+    qsort(t, ROUNDS, sizeof(double), cmp);
+    result("oi_events_poll", "ns/event", t[ROUNDS/2], t, ROUNDS);
+}
+
+/* ******************************************************************** */
+
+// Action dispatch with a large map, keys have many actions each
+void bench_action() {
+    oi_actionmap map[NUM_ACTIONS + 1];
+    oi_event ev;
+    double t[ROUNDS];
+    double s;
+    int r;
+    int i;
+
+    // Spread the actions over the keys a to z
+    for(i=0; i<NUM_ACTIONS; i++) {
+        map[i].actionid = i + 1;
+        map[i].device = 0;
+        map[i].name = oi_key_getname((oi_key)(OIK_A + i % 26));
+    }
+
+    // Highest id on a key that is never pressed
+    map[NUM_ACTIONS].actionid = NUM_ACTIONS + 1;
+    map[NUM_ACTIONS].device = 0;
+    map[NUM_ACTIONS].name = oi_key_getname(OIK_F14);
+    if(oi_action_install(map, NUM_ACTIONS + 1) != OI_ERR_OK) {
+        fprintf(stderr, "cannot install action map\n");
+        return;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    for(r=0; r<ROUNDS; r++) {
+        ev.type = (r & 1) ? OI_KEYUP : OI_KEYDOWN;
+        ev.key.keysym.sym = (oi_key)(OIK_A + (r / 2) % 26);
+        s = now_ns();
+        action_process(&ev);
+        t[r] = now_ns() - s;
+        drain();
+    }
+    qsort(t, ROUNDS, sizeof(double), cmp);
+    result("action_process", "ns/dispatch", t[ROUNDS/2], t, ROUNDS);
+    result("action_process_per_action", "ns/action",
+           t[ROUNDS/2] / (NUM_ACTIONS / 26), NULL, 0);
+}
+
+/* ******************************************************************** */
+
+// Joystick pump, without and with changes to post
+void bench_joystick() {
+    double t[ROUNDS];
+    double s;
+    int busy;
+    int r;
+    int i;
+
+    for(busy=0; busy<2; busy++) {
+        for(r=0; r<ROUNDS; r++) {
+            if(busy) {
+                for(i=0; i<NUM_JOYS; i++) {
+                    joystick_axis(joys[i], 0, (r * 7 + i) & 0x7fff, FALSE, TRUE);
+                    joystick_axis(joys[i], 1, (r * 3 + i) & 0x7fff, FALSE, TRUE);
+                }
+            }
+            s = now_ns();
+            joystick_pump();
+            t[r] = now_ns() - s;
+            drain();
+        }
+        qsort(t, ROUNDS, sizeof(double), cmp);
+        result(busy ? "joystick_pump_busy" : "joystick_pump_idle",
+               "ns/pump", t[ROUNDS/2], t, ROUNDS);
+    }
+}
+
+/* ******************************************************************** */
+
+// Latency from synthetic hardware time to the application
+void bench_latency() {
+    oi_event ev;
+    oi_time end;
+    unsigned int got;
+    int n;
+
+    drain();
+    n = 0;
+    got = 0;
+    synth_count = 0;
+    synth_dropped = 0;
+    synth_next = oi_gettime();
+    end = synth_next + (oi_time)SYNTH_MS * 1000000;
+    synth_on = TRUE;
+    while(oi_gettime() < end) {
+        while(oi_events_poll(&ev)) {
+            if(((ev.type == OI_KEYDOWN) || (ev.type == OI_KEYUP)) &&
+               (ev.key.device == synth_index)) {
+                if(n < MAX_SAMPLES) {
+                    samples[n++] = (double)(oi_gettime() - oi_events_timestamp()) / 1e3;
+                }
+                got++;
+            }
+        }
+    }
+    synth_on = FALSE;
+
+    // Events still queued were delivered too, just late
+    while(oi_events_poll(&ev)) {
+        if(((ev.type == OI_KEYDOWN) || (ev.type == OI_KEYUP)) &&
+           (ev.key.device == synth_index)) {
+            got++;
+        }
+    }
+    if(got + synth_dropped != synth_count) {
+        fprintf(stderr, "pipebench: %u synthetic events unaccounted for\n",
+                synth_count - synth_dropped - got);
+    }
+
+    qsort(samples, n, sizeof(double), cmp);
+    result("end_to_end_latency", "us", n ? samples[n/2] : 0, samples, n);
+    result("end_to_end_delivered", "events/s", (double)got * 1000 / SYNTH_MS, NULL, 0);
+    result("end_to_end_dropped", "events", (double)synth_dropped, NULL, 0);
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    int i;
+    int x;
+
+    oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+
+    // Synthetic keyboard and joysticks
+    dummy_joyconfig(&dummy_joy, "benchjoy", NUM_BUTTONS, NUM_AXES);
+    dummy_pump = synth_process;
+    device_register(&synth_bootstrap, NULL, 0);
+    for(i=0; i<NUM_JOYS; i++) {
+        if(device_register(&joy_bootstrap, NULL, 0) != OI_ERR_OK) {
+            fprintf(stderr, "cannot register joystick %i\n", i);
+            return 1;
+        }
+        for(x=0; device_live(x+1); x++);
+        joys[i] = device_live(x);
+    }
+    drain();
+
+    printf("{\n  \"benchmark\": \"pipebench\",\n  \"results\": [");
+    bench_queue();
+    bench_poll();
+    bench_action();
+    bench_joystick();
+    bench_latency();
+    printf("\n  ]\n}\n");
+
+    oi_close();
+    return 0;
+}
+
+/* ******************************************************************** */
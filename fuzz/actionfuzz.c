@@ -0,0 +1,213 @@
+/*
+ * actionfuzz.c : Fuzz harness for action map installation
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+/* The input is an action map followed by events. Each map entry
+ * takes four bytes: flags, two bytes of action id and a name
+ * index. With the raw flag set, the name is the following bytes
+ * up to a control character. The map is installed, and the events are built to
+ * hit the installed names and run through the queue. Every action
+ * posted must fit the state table.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "openinput.h"
+#include "fuzz.h"
+
+// Parameters
+#define MAX_MAP 32
+#define MAX_NAME 32
+#define FLAG_RAW 0x80
+#define FLAG_BIG 0x40
+#define FLAG_DEVICE 0x20
+#define FLAG_LAST 0x10
+
+// Starting inputs
+char *fuzz_seeds[] = {
+    "\x10\x01\x01\x01",
+    "\x01\x05\x01\x02\x01\x09\x01\x08\x10\x07\x01\x0b" "abcdefgh",
+    "\x01\xff\xff\x03\x10\x01\x01\x0f" "\x02\x03\x05\x07",
+    "\x80\x01\x01" "key_f16\x01" "\x90\x02\x01" "joy_button16\x01" "\x03\x05",
+    "\x40\xff\xff\x01\x10\x01\x01\x04" "z",
+    "\x20\x03\x01\x05\x10\x04\x01\x0c" "\x01\x01\x01\x01",
+    NULL
+};
+
+// Names to pick from
+static char *names[] = {
+    "key_a",
+    "key_escape",
+    "key_f12",
+    "key_num_5",
+    "key_int95",
+    "key_up",
+    "mouse_button_left",
+    "mouse_button_middle",
+    "mouse_wheel_up",
+    "mouse_motion",
+    "joy_axis0",
+    "joy_axis15",
+    "joy_button0",
+    "joy_button15",
+    "joy_button7",
+    "joy_axis3"
+};
+
+/* ******************************************************************** */
+
+// Initialize library
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    setenv("OI_DRIVERS", "none", 1);
+    oi_init(NULL, OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    return 0;
+}
+
+/* ******************************************************************** */
+
+// Build event from name, returns false if it has none
+int make_event(char *name, unsigned char val, oi_event *ev) {
+    unsigned int code;
+
+    memset(ev, 0, sizeof(oi_event));
+    if((code = oi_key_getcode(name)) != OIK_UNKNOWN) {
+        ev->type = (val & 1) ? OI_KEYDOWN : OI_KEYUP;
+        ev->key.device = val >> 4;
+        ev->key.keysym.sym = code;
+    }
+    else if((code = oi_mouse_getcode(name)) == OIP_MOTION) {
+        ev->type = OI_MOUSEMOVE;
+        ev->move.device = val >> 4;
+        ev->move.relx = val;
+    }
+    else if(code != OIP_UNKNOWN) {
+        ev->type = (val & 1) ? OI_MOUSEBUTTONDOWN : OI_MOUSEBUTTONUP;
+        ev->button.device = val >> 4;
+        ev->button.button = code;
+    }
+    else if((code = oi_joy_getcode(name)) != OI_JOY_NONE_CODE) {
+        if(OI_JOY_DECODE_TYPE(code) == OIJ_GEN_BUTTON) {
+            ev->type = (val & 1) ? OI_JOYBUTTONDOWN : OI_JOYBUTTONUP;
+            ev->joybutton.device = val >> 4;
+            ev->joybutton.code = code;
+        }
+        else {
+            ev->type = OI_JOYAXIS;
+            ev->joyaxis.device = val >> 4;
+            ev->joyaxis.code = code;
+            ev->joyaxis.abs = val;
+        }
+    }
+    else {
+        return 0;
+    }
+
+    return 1;
+}
+
+/* ******************************************************************** */
+
+// Run one input
+int LLVMFuzzerTestOneInput(const unsigned char *data, unsigned long size) {
+    static char raw[MAX_MAP][MAX_NAME];
+    oi_actionmap map[MAX_MAP];
+    unsigned int big;
+    unsigned long pos;
+    unsigned long n;
+    unsigned char flags;
+    oi_event ev;
+    char *state;
+    int num;
+    int e;
+    int i;
+
+    // Map
+    pos = 0;
+    num = 0;
+    big = 0;
+    while((num < MAX_MAP) && (pos + 4 <= size)) {
+        flags = data[pos];
+        map[num].actionid = data[pos+1] | (data[pos+2] << 8) | ((flags & FLAG_BIG) ? 0x10000 : 0);
+        map[num].device = (flags & FLAG_DEVICE) ? data[pos+3] : 0;
+
+        if(flags & FLAG_RAW) {
+            for(n=0; (n < MAX_NAME-1) && (pos+3+n < size) && (data[pos+3+n] >= ' '); n++) {
+                raw[num][n] = data[pos+3+n];
+            }
+            raw[num][n] = '\0';
+            map[num].name = raw[num];
+            pos += 4 + n;
+        }
+        else {
+            map[num].name = names[data[pos+3] % (sizeof(names)/sizeof(names[0]))];
+            pos += 4;
+        }
+
+        if(map[num].actionid > big) {
+            big = map[num].actionid;
+        }
+        num++;
+        if(flags & FLAG_LAST) {
+            break;
+        }
+    }
+
+    // Install, a map is all valid or refused
+    e = oi_action_install(map, num);
+    for(i=0; i<num; i++) {
+        if((e == OI_ERR_OK) && (oi_action_validate(&map[i]) != OI_ERR_OK)) {
+            fprintf(stderr, "installed invalid map '%s'\n", map[i].name);
+            abort();
+        }
+    }
+    if(e != OI_ERR_OK) {
+        return 0;
+    }
+
+    state = oi_action_actionstate(&i);
+    if(!state || (i != (int)big + 1)) {
+        fprintf(stderr, "state table has %i entries for id %u\n", i, big);
+        abort();
+    }
+
+    // Events for the installed names
+    for(; pos < size; pos++) {
+        if(make_event(map[data[pos] % num].name, data[pos], &ev)) {
+            oi_events_add(&ev, 1);
+        }
+    }
+
+    // Actions must be within the table
+    while(oi_events_poll(&ev)) {
+        if((ev.type == OI_ACTION) && ((ev.action.actionid == 0) || (ev.action.actionid > big))) {
+            fprintf(stderr, "action %u beyond %u\n", ev.action.actionid, big);
+            abort();
+        }
+    }
+
+    return 0;
+}
+
+/* ******************************************************************** */
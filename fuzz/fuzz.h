@@ -0,0 +1,43 @@
+/*
+ * fuzz.h : Common declarations of the fuzz harnesses
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+#ifndef _OPENINPUT_FUZZ_H_
+#define _OPENINPUT_FUZZ_H_
+
+/* ******************************************************************** */
+
+// Harness entry points, as in libFuzzer
+int LLVMFuzzerInitialize(int *argc, char ***argv);
+int LLVMFuzzerTestOneInput(const unsigned char *data, unsigned long size);
+
+// Starting inputs of each harness, NULL terminated
+extern char *fuzz_seeds[];
+
+// Parameters
+#define FUZZ_MAX_INPUT 4096
+#define FUZZ_RUNS 20000
+
+/* ******************************************************************** */
+
+#endif
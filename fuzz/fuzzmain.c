@@ -0,0 +1,228 @@
+/*
+ * fuzzmain.c : Standalone driver for the fuzz harnesses
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+/* Runs a harness without libFuzzer. Files given on the command line
+ * are run once each, which is how AFL and crash reproduction use it.
+ * Without files, the seeds of the harness are run, and then mutated
+ * at random for -runs=N rounds from -seed=N. With -seeds=DIR the
+ * seeds are written to files in DIR, as a starting corpus.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz.h"
+
+// Globals
+static unsigned int state = 1;
+
+/* ******************************************************************** */
+
+// Random number (xorshift)
+unsigned int fuzz_random() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/* ******************************************************************** */
+
+// Run harness on exact copy, so reads past the end are caught
+void fuzz_run(unsigned char *data, unsigned long size) {
+    unsigned char *copy;
+
+    copy = (unsigned char*)malloc(size ? size : 1);
+    memcpy(copy, data, size);
+    LLVMFuzzerTestOneInput(copy, size);
+    free(copy);
+}
+
+/* ******************************************************************** */
+
+// Run input file, returns zero on success
+int fuzz_file(char *filename) {
+    static unsigned char buf[FUZZ_MAX_INPUT];
+    unsigned long size;
+    FILE *f;
+
+    f = fopen(filename, "rb");
+    if(!f) {
+        fprintf(stderr, "cannot open '%s'\n", filename);
+        return 1;
+    }
+    size = fread(buf, 1, FUZZ_MAX_INPUT, f);
+    fclose(f);
+
+    fuzz_run(buf, size);
+    return 0;
+}
+
+/* ******************************************************************** */
+
+// Write seeds to directory, returns zero on success
+int fuzz_dump(char *dir) {
+    char name[1024];
+    FILE *f;
+    int i;
+
+    for(i=0; fuzz_seeds[i]; i++) {
+        snprintf(name, sizeof(name), "%s/seed%03i", dir, i);
+        f = fopen(name, "wb");
+        if(!f) {
+            fprintf(stderr, "cannot write '%s'\n", name);
+            return 1;
+        }
+        fwrite(fuzz_seeds[i], 1, strlen(fuzz_seeds[i]), f);
+        fclose(f);
+    }
+    return 0;
+}
+
+/* ******************************************************************** */
+
+// Mutate input in place, returns new size
+unsigned long fuzz_mutate(unsigned char *buf, unsigned long size) {
+    static const unsigned char magic[] = { 0, 1, '0', '9', ':', '_', 0x7f, 0x80, 0xff };
+    unsigned long pos;
+    unsigned long len;
+    unsigned int n;
+    unsigned int i;
+    unsigned int k;
+
+    n = 1 + fuzz_random() % 4;
+    for(i=0; i<n; i++) {
+        pos = size ? fuzz_random() % size : 0;
+
+        switch(fuzz_random() % 6) {
+        case 0:
+            // Flip a bit
+            if(size) {
+                buf[pos] ^= 1 << (fuzz_random() % 8);
+            }
+            break;
+
+        case 1:
+            // Random byte
+            if(size) {
+                buf[pos] = (unsigned char)fuzz_random();
+            }
+            break;
+
+        case 2:
+            // Interesting byte
+            if(size) {
+                buf[pos] = magic[fuzz_random() % sizeof(magic)];
+            }
+            break;
+
+        case 3:
+            // Insert byte
+            if(size < FUZZ_MAX_INPUT) {
+                memmove(buf + pos + 1, buf + pos, size - pos);
+                buf[pos] = (unsigned char)fuzz_random();
+                size++;
+            }
+            break;
+
+        case 4:
+            // Cut
+            size = pos;
+            break;
+
+        case 5:
+            // Splice another seed
+            for(k=0; fuzz_seeds[k]; k++);
+            k = fuzz_random() % k;
+            len = strlen(fuzz_seeds[k]);
+            if(size + len <= FUZZ_MAX_INPUT) {
+                memmove(buf + pos + len, buf + pos, size - pos);
+                memcpy(buf + pos, fuzz_seeds[k], len);
+                size += len;
+            }
+            break;
+        }
+    }
+
+    return size;
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    static unsigned char buf[FUZZ_MAX_INPUT];
+    unsigned long size;
+    unsigned int runs;
+    unsigned int seeds;
+    unsigned int r;
+    unsigned int k;
+    int files;
+    int i;
+
+    LLVMFuzzerInitialize(&argc, &argv);
+
+    // Options and files
+    runs = FUZZ_RUNS;
+    files = 0;
+    for(i=1; i<argc; i++) {
+        if(strncmp(argv[i], "-runs=", 6) == 0) {
+            runs = atoi(argv[i] + 6);
+        }
+        else if(strncmp(argv[i], "-seed=", 6) == 0) {
+            state = atoi(argv[i] + 6) | 1;
+        }
+        else if(strncmp(argv[i], "-seeds=", 7) == 0) {
+            return fuzz_dump(argv[i] + 7);
+        }
+        else if(argv[i][0] != '-') {
+            if(fuzz_file(argv[i]) != 0) {
+                return 1;
+            }
+            files++;
+        }
+    }
+    if(files) {
+        printf("%s: %i files\n", argv[0], files);
+        return 0;
+    }
+
+    // Seeds as they are, then mutated
+    for(seeds=0; fuzz_seeds[seeds]; seeds++) {
+        fuzz_run((unsigned char*)fuzz_seeds[seeds], strlen(fuzz_seeds[seeds]));
+    }
+    for(r=0; r<runs; r++) {
+        k = fuzz_random() % seeds;
+        size = strlen(fuzz_seeds[k]);
+        memcpy(buf, fuzz_seeds[k], size);
+        size = fuzz_mutate(buf, size);
+        fuzz_run(buf, size);
+    }
+
+    printf("%s: %u seeds, %u runs\n", argv[0], seeds, runs);
+    return 0;
+}
+
+/* ******************************************************************** */
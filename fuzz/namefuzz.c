@@ -0,0 +1,112 @@
+/*
+ * namefuzz.c : Fuzz harness for the key, mouse and joystick names
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+/* The input is a symbolic name. Whatever key, mouse or joystick
+ * code it parses to must have exactly that name, so no two names
+ * map to the same code. The first bytes are also used as a code
+ * to look up a name for.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "openinput.h"
+#include "fuzz.h"
+
+// Starting inputs
+char *fuzz_seeds[] = {
+    "key_a",
+    "key_9",
+    "key_f1",
+    "key_f15",
+    "key_int0",
+    "key_int95",
+    "key_num_0",
+    "key_num_period",
+    "key_escape",
+    "key_backspace",
+    "mouse_button_left",
+    "mouse_wheel_down",
+    "mouse_motion",
+    "joy_axis0",
+    "joy_axis15",
+    "joy_button9",
+    NULL
+};
+
+/* ******************************************************************** */
+
+// Initialize library
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    setenv("OI_DRIVERS", "none", 1);
+    oi_init(NULL, OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    return 0;
+}
+
+/* ******************************************************************** */
+
+// Run one input
+int LLVMFuzzerTestOneInput(const unsigned char *data, unsigned long size) {
+    unsigned int code;
+    unsigned int k;
+    char *name;
+
+    name = (char*)malloc(size + 1);
+    memcpy(name, data, size);
+    name[size] = '\0';
+
+    // Name to code and back
+    k = oi_key_getcode(name);
+    if((k != OIK_UNKNOWN) && (strcmp(oi_key_getname(k), name) != 0)) {
+        fprintf(stderr, "key '%s' parsed as '%s'\n", name, oi_key_getname(k));
+        abort();
+    }
+    k = oi_mouse_getcode(name);
+    if((k != OIP_UNKNOWN) && (strcmp(oi_mouse_getname(k), name) != 0)) {
+        fprintf(stderr, "mouse '%s' parsed as '%s'\n", name, oi_mouse_getname(k));
+        abort();
+    }
+    k = oi_joy_getcode(name);
+    if((k != OI_JOY_NONE_CODE) && (strcmp(oi_joy_getname(k), name) != 0)) {
+        fprintf(stderr, "joystick '%s' parsed as '%s'\n", name, oi_joy_getname(k));
+        abort();
+    }
+
+    // Code to name
+    if(size >= sizeof(code)) {
+        memcpy(&code, data, sizeof(code));
+        if(!oi_key_getname((oi_key)code) ||
+           !oi_mouse_getname((oi_mouse)code) ||
+           !oi_joy_getname(code)) {
+            fprintf(stderr, "no name for code 0x%08x\n", code);
+            abort();
+        }
+    }
+
+    free(name);
+    return 0;
+}
+
+/* ******************************************************************** */
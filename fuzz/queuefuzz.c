@@ -0,0 +1,160 @@
+/*
+ * queuefuzz.c : Fuzz harness for the event queue
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+/* The input is a sequence of queue operations: adds of events made
+ * from the input bytes, peeps with and without removal, polls and
+ * mask changes. A small action map is installed, so the events also
+ * go through the action mapper. The queue must never return more
+ * than asked for, or hold more than it has room for.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "openinput.h"
+#include "internal.h"
+#include "fuzz.h"
+
+// Starting inputs
+char *fuzz_seeds[] = {
+    "\x01\x02\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x03",
+    "\x01\x0c\x02\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x02\x05\x7f",
+    "\x01\x05\x03\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x04\xff\xff\xff\xff",
+    "\x07\x40\x7f\xff\xff\xff\x06\x09\x07\x40\x7f\xff\xff\xff\x03",
+    "\x01\x0e\x01\x01\x01\x0f\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x02\x20\x7f\x7f\x7f\x7f",
+    NULL
+};
+
+// Actions to map
+static oi_actionmap map[] = {
+    { 1, 0, "key_a" },
+    { 2, 0, "mouse_button_left" },
+    { 3, 0, "mouse_motion" },
+    { 4, 0, "joy_axis15" },
+    { 5, 0, "joy_button15" },
+    { 6, 0, "key_num_9" }
+};
+
+/* ******************************************************************** */
+
+// Initialize library with every measurement on
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    setenv("OI_DRIVERS", "none", 1);
+    oi_init(NULL, OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG | OI_FLAG_LATENCY);
+    oi_action_install(map, sizeof(map)/sizeof(map[0]));
+    return 0;
+}
+
+/* ******************************************************************** */
+
+// Events in queue
+int pending() {
+    static oi_event evts[OI_MAX_EVENTS + 1];
+    return queue_peep(evts, OI_MAX_EVENTS + 1, 0xffffffff, FALSE);
+}
+
+/* ******************************************************************** */
+
+// Run one input
+int LLVMFuzzerTestOneInput(const unsigned char *data, unsigned long size) {
+    static oi_event evts[OI_MAX_EVENTS + 8];
+    unsigned long pos;
+    unsigned int mask;
+    unsigned int num;
+    unsigned int got;
+    oi_event ev;
+
+    for(pos=0; pos<size; ) {
+        switch(data[pos++] % 8) {
+        case 0:
+        case 1:
+            // Add event, the rest of it is raw bytes
+            memset(&ev, 0, sizeof(ev));
+            num = (size - pos < sizeof(ev)) ? size - pos : sizeof(ev);
+            memcpy(&ev, data + pos, num);
+            pos += num;
+            ev.type %= OI_SIGNAL + 1;
+
+            // These carry pointers
+            if((ev.type == OI_DISCOVERY) || (ev.type == OI_DEVICELOST)) {
+                ev.type = OI_EXPOSE;
+            }
+            oi_events_add(&ev, 1);
+            break;
+
+        case 2:
+        case 3:
+            // Peep, with removal for odd ops
+            num = (pos < size) ? data[pos++] % (OI_MAX_EVENTS + 8) : 1;
+            mask = 0;
+            if(pos + sizeof(mask) <= size) {
+                memcpy(&mask, data + pos, sizeof(mask));
+                pos += sizeof(mask);
+            }
+            // Zero asks if anything is pending
+            got = queue_peep(evts, num, mask, data[pos-1] & 1);
+            if(got > (num ? num : 1)) {
+                fprintf(stderr, "peeped %u of %u\n", got, num);
+                abort();
+            }
+            break;
+
+        case 4:
+            // Just ask
+            queue_peep(NULL, 0, 0xffffffff, TRUE);
+            break;
+
+        case 5:
+            // Poll
+            oi_events_poll(&ev);
+            break;
+
+        case 6:
+            // Mask, drops the queue
+            mask = (pos < size) ? data[pos++] : 0;
+            oi_events_setmask(mask << 1);
+            oi_events_setmask(0);
+            break;
+
+        case 7:
+            // Stamp the next events
+            queue_stamp(oi_gettime() - ((pos < size) ? data[pos++] : 0) * 1000000);
+            break;
+        }
+
+        if(pending() >= OI_MAX_EVENTS) {
+            fprintf(stderr, "queue holds %i events\n", pending());
+            abort();
+        }
+    }
+
+    // Empty queue for the next input
+    queue_stamp(0);
+    while(oi_events_poll(&ev));
+
+    return 0;
+}
+
+/* ******************************************************************** */
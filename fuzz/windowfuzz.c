@@ -0,0 +1,94 @@
+/*
+ * windowfuzz.c : Fuzz harness for the window_id parser
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+/* The input is a window_id string, as given to oi_init. Every
+ * parameter is looked up, and the first byte is also tried as
+ * a parameter name.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "openinput.h"
+#include "internal.h"
+#include "fuzz.h"
+
+// Starting inputs
+char *fuzz_seeds[] = {
+    "c:0 s:0 w:0",
+    "c:1 s:2 w:3",
+    "x:94558311261216 w:71303175",
+    "w:18446744073709551615",
+    "c:-1 s: 4 w:",
+    "cs:5 c:6",
+    NULL
+};
+
+// Parameters to look up
+static char toks[] = {
+    OI_I_CONN,
+    OI_I_SCRN,
+    OI_I_WINID,
+    OI_I_XCB
+};
+
+/* ******************************************************************** */
+
+// Nothing to initialize
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    return 0;
+}
+
+/* ******************************************************************** */
+
+// Run one input
+int LLVMFuzzerTestOneInput(const unsigned char *data, unsigned long size) {
+    unsigned long val;
+    unsigned int i;
+    char *str;
+    char match[3];
+
+    str = (char*)malloc(size + 1);
+    memcpy(str, data, size);
+    str[size] = '\0';
+
+    for(i=0; i<=sizeof(toks); i++) {
+        match[0] = (i < sizeof(toks)) ? toks[i] : str[0];
+        match[1] = ':';
+        match[2] = '\0';
+
+        // A value means the parameter was there
+        val = device_windowid(str, match[0]);
+        if(val && !strstr(str, match)) {
+            fprintf(stderr, "'%c' is %lu in '%s'\n", match[0], val, str);
+            abort();
+        }
+    }
+
+    free(str);
+    return 0;
+}
+
+/* ******************************************************************** */
@@ -74,6 +74,20 @@ extern DECLSPEC void OICALL oi_events_setmask(unsigned int mask);
 // Get event type filter mask (event_mask)
 extern DECLSPEC unsigned int OICALL oi_events_getmask();
 
+// Get timestamp of last polled event (nanoseconds)
+extern DECLSPEC oi_time OICALL oi_events_timestamp();
+
+// Record queued events to file, NULL to stop (errorcode)
+extern DECLSPEC int OICALL oi_events_record(char *filename);
+
+// Add event filter called before events are queued (errorcode)
+extern DECLSPEC int OICALL oi_events_addfilter(oi_filter fn,
+                                               void *data);
+
+// Remove event filter (errorcode)
+extern DECLSPEC int OICALL oi_events_delfilter(oi_filter fn,
+                                               void *data);
+
 /* ******************************************************************** */
 
 // Send events for down-state keys (errorcode)
@@ -105,6 +119,11 @@ extern DECLSPEC int OICALL oi_mouse_relative(unsigned char index,
                                              int *x,
                                              int *y);
 
+// Get high-resolution wheel motion of mouse (button_mask)
+extern DECLSPEC int OICALL oi_mouse_wheel(unsigned char index,
+                                          int *vert,
+                                          int *horiz);
+
 // Warp mouse cursor position (errorcode)
 extern DECLSPEC int OICALL oi_mouse_warp(unsigned char index,
                                          int x,
@@ -148,6 +167,22 @@ extern DECLSPEC int OICALL op_joy_axessetup(unsigned char index,
                                             unsigned char *pair[],
                                             int *num);
 
+// Set or clear calibration of a joystick device (errorcode)
+extern DECLSPEC int OICALL oi_joy_setcalib(unsigned char index,
+                                           oi_joycalib *calib);
+
+// Get calibration of a joystick device (errorcode)
+extern DECLSPEC int OICALL oi_joy_getcalib(unsigned char index,
+                                           oi_joycalib *calib);
+
+// Load calibration profile from file (errorcode)
+extern DECLSPEC int OICALL oi_joy_loadprofile(unsigned char index,
+                                              char *filename);
+
+// Save calibration profile to file (errorcode)
+extern DECLSPEC int OICALL oi_joy_saveprofile(unsigned char index,
+                                              char *filename);
+
 /* ******************************************************************** */
 
 // Get focus state of application (focus_mask)
@@ -173,4 +208,32 @@ extern DECLSPEC char * OICALL oi_action_actionstate(int *num);
 
 /* ******************************************************************** */
 
+// Get library statistics (errorcode)
+extern DECLSPEC int OICALL oi_stats_get(oi_stats *stats);
+
+// Get statistics of a device (errorcode)
+extern DECLSPEC int OICALL oi_stats_device(unsigned char index,
+                                           oi_devstats *stats);
+
+// Clear all counters (n/a)
+extern DECLSPEC void OICALL oi_stats_reset();
+
+// Get event latency percentiles, type 0 for all (errorcode)
+extern DECLSPEC int OICALL oi_latency_get(unsigned char type,
+                                          oi_latency *lat);
+
+// Clear latency histograms (n/a)
+extern DECLSPEC void OICALL oi_latency_reset();
+
+// Dump trace ring as JSON (errorcode)
+extern DECLSPEC int OICALL oi_trace_dump(char *filename);
+
+// Set log level, returns previous level (log_level)
+extern DECLSPEC int OICALL oi_log_level(int level);
+
+// Write buffered log messages to standard error (number)
+extern DECLSPEC int OICALL oi_log_flush();
+
+/* ******************************************************************** */
+
 #endif
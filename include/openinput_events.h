@@ -53,7 +53,9 @@ typedef enum {
     OI_JOYAXIS                    = 12, /**< Joystick axis */
     OI_JOYBUTTONUP                = 13, /**< Joystick button released */
     OI_JOYBUTTONDOWN              = 14, /**< Joystick button pressed */
-    OI_JOYBALL                    = 15  /**< Joystick trackball */
+    OI_JOYBALL                    = 15, /**< Joystick trackball */
+    OI_DEVICELOST                 = 16, /**< Device driver removed */
+    OI_SIGNAL                     = 17  /**< UNIX signal received */
 } oi_type;
 
 
@@ -74,8 +76,10 @@ typedef enum {
 #define OI_MASK_RESIZE          OI_EVENT_MASK(OI_RESIZE)          /**< Window resize */
 #define OI_MASK_EXPOSE          OI_EVENT_MASK(OI_EXPOSE)          /**< Window show/update */
 #define OI_MASK_DISCOVERY       OI_EVENT_MASK(OI_DISCOVERY)       /**< Device discovery */
+#define OI_MASK_DEVICELOST      OI_EVENT_MASK(OI_DEVICELOST)      /**< Device removal */
 #define OI_MASK_ACTION          OI_EVENT_MASK(OI_ACTION)          /**< Action map */
 #define OI_MASK_QUIT            OI_EVENT_MASK(OI_QUIT)            /**< Application quit */
+#define OI_MASK_SIGNAL          OI_EVENT_MASK(OI_SIGNAL)          /**< UNIX signal */
 #define OI_MASK_WINDOW          (OI_EVENT_MASK(OI_ACTIVE) | OI_EVENT_MASK(OI_RESIZE) | OI_EVENT_MASK(OI_EXPOSE)) /**< Focus, resize, expose */
 #define OI_MASK_MOUSE           (OI_EVENT_MASK(OI_MOUSEMOVE) | OI_EVENT_MASK(OI_MOUSEBUTTONUP) | OI_EVENT_MASK(OI_MOUSEBUTTONDOWN)) /**< Mouse button and motion */
 #define OI_MASK_JOYSTICK        (OI_EVENT_MASK(OI_JOYAXIS) | OI_EVENT_MASK(OI_JOYBUTTONUP) | OI_EVENT_MASK(OI_JOYBUTTONDOWN) | OI_EVENT_MASK(OI_JOYBALL)) /**< Joystick axes, buttons and trackballs */
@@ -86,10 +90,12 @@ typedef enum {
  * @ingroup PEventStructs
  * @brief Device discovery event
  *
- * Sent when device drivers are registered and ready for use
+ * Sent when device drivers are registered and ready for use, and
+ * when a device is removed (unplugged) again. After removal the
+ * device index is no longer valid.
  */
 typedef struct oi_discovery_event {
-    unsigned char type;              /**< OI_DISCOVERY  */
+    unsigned char type;              /**< OI_DISCOVERY or OI_DEVICELOST */
     unsigned char device;            /**< Device index  */
     char *name;                      /**< Short name  */
     char *description;               /**< Long description  */
@@ -196,6 +202,20 @@ typedef struct oi_quit_event {
 } oi_quit_event;
 
 
+/**
+ * @ingroup PEventStructs
+ * @brief Signal event
+ *
+ * Sent when the process receives a UNIX signal which the
+ * application asked for (see the unixsignal driver), and
+ * which is not a request to quit, eg. SIGHUP or SIGUSR1.
+ */
+typedef struct oi_signal_event {
+    unsigned char type;              /**< OI_SIGNAL */
+    int signum;                      /**< Signal number */
+} oi_signal_event;
+
+
 /**
  * @ingroup PEventStructs
  * @brief Action event
@@ -275,13 +295,25 @@ typedef union {
     oi_resize_event resize;           /**< OI_RESIZE */
     oi_expose_event expose;           /**< OI_EXPOSE */
     oi_quit_event quit;               /**< OI_QUIT */
-    oi_discovery_event discover;      /**< OI_DISCOVERY */
+    oi_signal_event signal;           /**< OI_SIGNAL */
+    oi_discovery_event discover;      /**< OI_DISCOVERY or OI_DEVICELOST */
     oi_action_event action;           /**< OI_ACTION */
     oi_joyaxis_event joyaxis;         /**< OI_JOYAXIS */
     oi_joybutton_event joybutton;     /**< OI_JOYBUTTONUP or OI_JOYBUTTONDOWN */
     oi_joyball_event joyball;         /**< OI_JOYBALL */
 } oi_event;
 
+/**
+ * @ingroup PEvents
+ * @brief Event filter callback
+ *
+ * Called with each event before it is queued, and with the
+ * data pointer given to oi_events_addfilter. The filter may
+ * change the event. Return true (non-zero) to queue it, or
+ * false (0) to drop it.
+ */
+typedef int (OICALL *oi_filter)(oi_event *evt, void *data);
+
 
 /* ******************************************************************** */
 
@@ -80,15 +80,40 @@ typedef enum {
 #define OI_JOY_NUM_DEVS      32       /**< Maximum number of joysticks */
 #define OI_JOY_NUM_AXES      16       /**< Maximum buttons/axes */
 #define OI_JOY_AXIS_MIN     -32768    /**< Minimum axis value */
-#define OI_JOY_AXIS_MAX      326767   /**< Maximum axis value */
+#define OI_JOY_AXIS_MAX      32767    /**< Maximum axis value */
 #define OI_JOY_ENCODE_TYPE(t)  (0x0000ffff & (t))        /**< Make the type-part of a joystick code */
 #define OI_JOY_DECODE_TYPE(t)  (0x0000ffff & (t))        /**< Get the type-part of a joystick code */
 #define OI_JOY_ENCODE_INDEX(i) (0xffff0000 & ((i) <<16)) /**< Make the index-part of a joystick code */
 #define OI_JOY_DECODE_INDEX(i) ((0xffff0000 & (i)) >>16) /**< Get the index-part of a joystick code */
 #define OI_JOY_MAKE_CODE(t,i)  (OI_JOY_ENCODE_TYPE((t)) + OI_JOY_ENCODE_INDEX((i))) /**< Make joystick code given type and index (in that order) */
 #define OI_JOY_NONE_CODE OI_JOY_MAKE_CODE(OIJ_NONE, 0)   /**< The 'none' code that never matches */
+#define OI_JOY_SMOOTH_MAX    255      /**< Maximum axis smoothing factor */
 /** @} */
 
+
+/**
+ * @ingroup PJoystick
+ * @brief Joystick calibration profile
+ *
+ * Per-axis calibration of a joystick. Raw driver values are clipped
+ * to [min;max] and mapped so that "center" becomes zero and the two
+ * ends become OI_JOY_AXIS_MIN and OI_JOY_AXIS_MAX.
+ *
+ * The axial deadzone is given in output units and zeroes small
+ * values on a single axis. The radial deadzone does the same for
+ * the magnitude of a paired stick (see "pair" in op_joy_axessetup).
+ * Smoothing is an exponential filter, where 0 is off and
+ * OI_JOY_SMOOTH_MAX is the heaviest.
+ */
+typedef struct oi_joycalib {
+    int min[OI_JOY_NUM_AXES];         /**< Raw minimum value */
+    int center[OI_JOY_NUM_AXES];      /**< Raw center value */
+    int max[OI_JOY_NUM_AXES];         /**< Raw maximum value */
+    int deadzone[OI_JOY_NUM_AXES];    /**< Axial deadzone */
+    int radial[OI_JOY_NUM_AXES];      /**< Radial deadzone (paired sticks) */
+    int smooth[OI_JOY_NUM_AXES];      /**< Smoothing factor (0-255) */
+} oi_joycalib;
+
 /* ******************************************************************** */
 
 #endif
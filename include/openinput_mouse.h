@@ -69,6 +69,16 @@ typedef enum {
 #define OI_BUTTON_RIGHTMASK     OI_BUTTON_MASK(OIP_BUTTON_RIGHT)  /**< Bitmask for right button */
 /** @} */
 
+/**
+ * @ingroup PMouse
+ * @brief Wheel resolution
+ *
+ * Wheel motion from oi_mouse_wheel is in fractions of a wheel
+ * "click", such that one click (ie. one OIP_WHEEL_UP or
+ * OIP_WHEEL_DOWN event) is OI_WHEEL_DETENT units.
+ */
+#define OI_WHEEL_DETENT 120
+
 /* ******************************************************************** */
 
 #endif
@@ -0,0 +1,118 @@
+/*
+ * openinput_stats.h : Definitions for runtime statistics
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+#ifndef _OPENINPUT_STATS_H_
+#define _OPENINPUT_STATS_H_
+
+#ifndef _OPENINPUT_H_
+#error Do not include this file directly - use openinput.h
+#endif
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PStats
+ * @defgroup PStatsConsts Statistics constants
+ * @brief Sizes of the statistics tables
+ * @{
+ */
+#define OI_STATS_TYPES 32   /**< Event types counted (all that fit an event mask) */
+#define OI_STATS_BUCKETS 16 /**< Buckets of the pump duration histogram */
+/** @} */
+
+/**
+ * @ingroup PStats
+ * @brief Statistics counter
+ *
+ * Counters are 64 bit, so they do not wrap in practice.
+ */
+#ifdef _MSC_VER
+typedef unsigned __int64 oi_count;
+#else
+typedef unsigned long long oi_count;
+#endif
+
+/**
+ * @ingroup PStats
+ * @brief Library statistics
+ *
+ * Counters since library initialization or oi_stats_reset.
+ * The per type tables are indexed by event type, see oi_type.
+ * Merged events are updates which were folded into an event
+ * already pending, ie. joystick axis updates between two pumps.
+ * Filtered events were dropped by an event filter, see
+ * oi_events_addfilter, and never reached the queue.
+ *
+ * Bucket 0 of the pump histogram counts pumps which took less
+ * than a microsecond, bucket n those below 2^n microseconds, and
+ * the last bucket everything slower.
+ */
+typedef struct oi_stats {
+    oi_count enqueued[OI_STATS_TYPES];          /**< Events added to the queue */
+    oi_count dropped[OI_STATS_TYPES];           /**< Events lost to a full queue */
+    oi_count merged[OI_STATS_TYPES];            /**< Updates merged into pending events */
+    oi_count filtered[OI_STATS_TYPES];          /**< Events dropped by filters */
+    unsigned int highwater;                     /**< Most events ever in the queue */
+    oi_count pumps;                             /**< Device pumps */
+    oi_count pumptime[OI_STATS_BUCKETS];        /**< Pump duration histogram */
+    oi_count actions;                           /**< Events looked up in the action map */
+    oi_count dispatched;                        /**< Action events posted */
+    oi_time elapsed;                            /**< Nanoseconds counted */
+} oi_stats;
+
+/**
+ * @ingroup PStats
+ * @brief Device statistics
+ *
+ * Counters since the device was registered, or oi_stats_reset.
+ * Read calls are only counted by drivers which read from
+ * device nodes or pipes.
+ */
+typedef struct oi_devstats {
+    oi_count events;                            /**< Events from the device */
+    oi_count reads;                             /**< Read system calls */
+    unsigned int rate;                          /**< Average events per second */
+    oi_time elapsed;                            /**< Nanoseconds counted */
+} oi_devstats;
+
+/**
+ * @ingroup PStats
+ * @brief Event latency
+ *
+ * Time from the event timestamp (taken by the kernel or the
+ * driver, or else when the event was queued) to the moment the
+ * event was polled, in nanoseconds. Percentiles are accurate to
+ * about 6%, and never below the true value.
+ */
+typedef struct oi_latency {
+    oi_count count;                             /**< Events measured */
+    oi_time p50;                                /**< Median */
+    oi_time p99;                                /**< 99th percentile */
+    oi_time p999;                               /**< 99.9th percentile */
+    oi_time max;                                /**< Highest latency */
+} oi_latency;
+
+/* ******************************************************************** */
+
+#endif
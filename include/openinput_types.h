@@ -41,6 +41,21 @@ typedef enum {
     OI_ENABLE                      = 1,    /**< True/enable */
     OI_QUERY                       = 2     /**< Don't change, return current */
 } oi_bool;                                 /**< Tri-state (bool + query) */
+
+
+/**
+ * @ingroup PTypes
+ * @brief Timestamp in nanoseconds
+ *
+ * High resolution timestamp, see oi_events_timestamp. The epoch is
+ * unspecified (on POSIX it is the monotonic clock), so only use
+ * differences between timestamps.
+ */
+#ifdef _MSC_VER
+typedef unsigned __int64 oi_time;
+#else
+typedef unsigned long long oi_time;
+#endif
 /** @} */
 
 
@@ -48,11 +63,18 @@ typedef enum {
  * @ingroup PTypes
  * @defgroup PWindow Window hook parameters
  * @brief Init string parameters for window_id
+ *
+ * The window hook shares the application's server connection.
+ * With X11 and XCB, XKB detectable autorepeat is switched on for
+ * that connection while OpenInput runs, so the application also gets
+ * repeated key presses without the fake releases in between. The
+ * previous setting is restored by oi_close.
  * @{
  */
 #define OI_I_CONN                  'c' /**< Server connection handle */
 #define OI_I_SCRN                  's' /**< Screen handle */
 #define OI_I_WINID                 'w' /**< Window handle */
+#define OI_I_XCB                   'x' /**< XCB connection handle */
 /** @} */
 
 
@@ -90,6 +112,10 @@ typedef enum {
  * @{
  */
 #define OI_FLAG_NOWINDOW        1 /**< Do not hook into window */
+#define OI_FLAG_NOHOTPLUG       2 /**< Do not watch for new/removed devices */
+#define OI_FLAG_LAZY            4 /**< Defer joystick drivers until first use */
+#define OI_FLAG_COMPRESS        8 /**< Collapse queued mouse motion (X11) */
+#define OI_FLAG_LATENCY        16 /**< Measure event latency, see oi_latency_get */
 /** @} */
 
 
@@ -110,6 +136,20 @@ typedef enum {
 #define OI_ERR_DEV_BEHAVE       9 /**< Device programming error */
 /** @} */
 
+
+/**
+ * @ingroup PTypes
+ * @defgroup PLog Log levels
+ * @brief Levels of library log messages
+ * @{
+ */
+#define OI_LOG_NONE             0 /**< Nothing is logged */
+#define OI_LOG_ERROR            1 /**< Errors */
+#define OI_LOG_WARN             2 /**< Warnings, the default */
+#define OI_LOG_INFO             3 /**< Information */
+#define OI_LOG_DEBUG            4 /**< Debugging, only in debug builds */
+/** @} */
+
 /* ******************************************************************** */
 
 #endif
@@ -118,7 +118,7 @@ SOURCE=..\src\appstate.c
 # End Source File
 # Begin Source File
 
-SOURCE=..\src\debug.c
+SOURCE=..\src\device.c
 
 !IF  "$(CFG)" == "OpenInput - Win32 Release"
 
@@ -131,7 +131,7 @@ SOURCE=..\src\debug.c
 # End Source File
 # Begin Source File
 
-SOURCE=..\src\device.c
+SOURCE=..\src\events.c
 
 !IF  "$(CFG)" == "OpenInput - Win32 Release"
 
@@ -144,7 +144,7 @@ SOURCE=..\src\device.c
 # End Source File
 # Begin Source File
 
-SOURCE=..\src\events.c
+SOURCE=..\src\hotplug.c
 
 !IF  "$(CFG)" == "OpenInput - Win32 Release"
 
@@ -196,6 +196,32 @@ SOURCE=..\src\keynames.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\latency.c
+
+!IF  "$(CFG)" == "OpenInput - Win32 Release"
+
+!ELSEIF  "$(CFG)" == "OpenInput - Win32 Debug"
+
+# ADD CPP /Zd
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\log.c
+
+!IF  "$(CFG)" == "OpenInput - Win32 Release"
+
+!ELSEIF  "$(CFG)" == "OpenInput - Win32 Debug"
+
+# ADD CPP /Zd
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\main.c
 
 !IF  "$(CFG)" == "OpenInput - Win32 Release"
@@ -222,6 +248,19 @@ SOURCE=..\src\mouse.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\plugin.c
+
+!IF  "$(CFG)" == "OpenInput - Win32 Release"
+
+!ELSEIF  "$(CFG)" == "OpenInput - Win32 Debug"
+
+# ADD CPP /Zd
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\queue.c
 
 !IF  "$(CFG)" == "OpenInput - Win32 Release"
@@ -235,6 +274,45 @@ SOURCE=..\src\queue.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\record.c
+
+!IF  "$(CFG)" == "OpenInput - Win32 Release"
+
+!ELSEIF  "$(CFG)" == "OpenInput - Win32 Debug"
+
+# ADD CPP /Zd
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\stats.c
+
+!IF  "$(CFG)" == "OpenInput - Win32 Release"
+
+!ELSEIF  "$(CFG)" == "OpenInput - Win32 Debug"
+
+# ADD CPP /Zd
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\trace.c
+
+!IF  "$(CFG)" == "OpenInput - Win32 Release"
+
+!ELSEIF  "$(CFG)" == "OpenInput - Win32 Debug"
+
+# ADD CPP /Zd
+
+!ENDIF 
+
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\unixsignal\unixsignal.c
 # End Source File
 # Begin Source File
@@ -322,6 +400,10 @@ SOURCE=..\include\openinput_mouse.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\include\openinput_stats.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\include\openinput_types.h
 # End Source File
 # Begin Source File
@@ -5,3 +5,10 @@
 # Print the directory-part of a path by using shell-expansion
 AC_DEFUN([DIRNAME_EXPR],
          [[expr ".$1" : '\(\.\)[^/]*$' \| "x$1" : 'x\(.*\)/[^/]*$']])
+
+# Build driver $1 as a loadable module instead of linking it into the library
+AC_DEFUN([OI_PLUGIN_DRIVER],
+         [if test x$have_plugins != xyes; then
+              AC_MSG_ERROR([--enable-$1=plugin requires dlopen, see --enable-plugins])
+          fi
+          PLUGIN_DIRS="$PLUGIN_DIRS $1"])
@@ -40,7 +40,7 @@ static oi_aclink *action_keyboard[OIK_LAST];
 static oi_aclink *action_mouse[OIP_LAST];
 
 // Lookup table for joystick (2-dim: buttons and axes)
-static oi_aclink *action_joy[2][OIJ_LAST];
+static oi_aclink *action_joy[2][OI_JOY_NUM_AXES];
 
 /* ******************************************************************** */
 
@@ -71,6 +71,8 @@ int action_init() {
  * @returns errorcode, see @ref PErrors
  *
  * Free current action map (if any) and install new one.
+ * Actions bound to a device stop firing when it is removed,
+ * even if a new device gets the same index.
  */
 int oi_action_install(oi_actionmap *map, int num) {
     int i;
@@ -107,18 +109,22 @@ int oi_action_install(oi_actionmap *map, int num) {
     // Clean lookup tables
     action_cleartable(action_keyboard, OIK_LAST);
     action_cleartable(action_mouse, OIP_LAST);
-    action_cleartable(action_joy[OI_JOY_TAB_AXES], OIJ_LAST);
-    action_cleartable(action_joy[OI_JOY_TAB_BTNS], OIJ_LAST);
+    action_cleartable(action_joy[OI_JOY_TAB_AXES], OI_JOY_NUM_AXES);
+    action_cleartable(action_joy[OI_JOY_TAB_BTNS], OI_JOY_NUM_AXES);
 
     // Free old state table
     if(action_count > 0) {
         free(action_state);
     }
 
-    // Alloc state table and clear it
-    action_count = big;
-    action_state = (char*)malloc(big);
-    memset(action_state, 0, big);
+    // Alloc state table and clear it, the table is indexed by id
+    action_count = big + 1;
+    action_state = (char*)malloc(action_count);
+    if(action_state == NULL) {
+        action_count = 0;
+        return OI_ERR_INTERNAL;
+    }
+    memset(action_state, 0, action_count);
 
     /* Parse map and fill the lookup tables
      * The tables are arrays of linked lists. Actions can be triggered
@@ -133,7 +139,7 @@ int oi_action_install(oi_actionmap *map, int num) {
             // Alloc new tail and fill it
             last = action_tail(&action_keyboard[j], TRUE);
             last->action = map[i].actionid;
-            last->device = map[i].device;
+            last->device = map[i].device ? device_handle(map[i].device) : 0;
 
             debug("oi_action_install: keyboard action:\t id:%u name:'%s'",
                   map[i].actionid, map[i].name);
@@ -145,7 +151,7 @@ int oi_action_install(oi_actionmap *map, int num) {
             // Alloc new tail and fill it
             last = action_tail(&action_mouse[j], TRUE);
             last->action = map[i].actionid;
-            last->device = map[i].device;
+            last->device = map[i].device ? device_handle(map[i].device) : 0;
 
             debug("oi_action_install: mouse action:\t id:%u name:'%s'",
                   map[i].actionid, map[i].name);
@@ -158,7 +164,7 @@ int oi_action_install(oi_actionmap *map, int num) {
             if(OI_JOY_DECODE_TYPE((unsigned int)j) != OIJ_GEN_BUTTON) {
                 last = action_tail(&action_joy[OI_JOY_TAB_AXES][OI_JOY_DECODE_INDEX((unsigned int)j)], TRUE);
                 last->action = map[i].actionid;
-                last->device = map[i].device;
+                last->device = map[i].device ? device_handle(map[i].device) : 0;
 
                 debug("oi_action_install: joystick axis action:\t id:%u name:'%s'",
                       map[i].actionid, map[i].name);
@@ -167,7 +173,7 @@ int oi_action_install(oi_actionmap *map, int num) {
             else {
                 last = action_tail(&action_joy[OI_JOY_TAB_BTNS][OI_JOY_DECODE_INDEX((unsigned int)j)], TRUE);
                 last->action = map[i].actionid;
-                last->device = map[i].device;
+                last->device = map[i].device ? device_handle(map[i].device) : 0;
 
                 debug("oi_action_install: joystick button action:\t id:%u name:'%s'",
                       map[i].actionid, map[i].name);
@@ -181,7 +187,7 @@ int oi_action_install(oi_actionmap *map, int num) {
         for(i=0; i<OIK_LAST; i++) {
             last = action_keyboard[i];
             while(last != NULL) {
-                debug("keyboard \t id:%i \t dev:%i \t action:%i",
+                debug("keyboard \t id:%i \t dev:%#x \t action:%i",
                       i, last->device, last->action);
                 last = last->next;
             }
@@ -189,21 +195,21 @@ int oi_action_install(oi_actionmap *map, int num) {
         for(i=0; i<OIP_LAST; i++) {
             last = action_mouse[i];
             while(last != NULL) {
-                debug("mouse \t id:%i \t dev:%i \t action:%i",
+                debug("mouse \t id:%i \t dev:%#x \t action:%i",
                       i, last->device, last->action);
                 last = last->next;
             }
         }
-        for(i=0; i<OIJ_LAST; i++) {
+        for(i=0; i<OI_JOY_NUM_AXES; i++) {
             last = action_joy[OI_JOY_TAB_AXES][i];
             while(last != NULL) {
-                debug("joyaxis \t id::%i \t dev:%i \t action:%i",
+                debug("joyaxis \t id::%i \t dev:%#x \t action:%i",
                       i, last->device, last->action);
                 last = last->next;
             }
             last = action_joy[OI_JOY_TAB_BTNS][i];
             while(last != NULL) {
-                debug("joybutton \t id::%i \t dev:%i \t action:%i",
+                debug("joybutton \t id::%i \t dev:%#x \t action:%i",
                       i, last->device, last->action);
                 last = last->next;
             }
@@ -225,7 +231,9 @@ int oi_action_install(oi_actionmap *map, int num) {
  * @returns errorcode, see @ref PErrors
  *
  * Check if action map is valid. For example,
- * check that the event name exists
+ * check that the event name exists. Action ids
+ * must be between 1 and 65535, as the action state
+ * table is indexed by id.
  */
 int oi_action_validate(oi_actionmap *map) {
     unsigned char u;
@@ -235,7 +243,7 @@ int oi_action_validate(oi_actionmap *map) {
     if(map == NULL) {
         return OI_ERR_PARAM;
     }
-    if(map->actionid == 0) {
+    if((map->actionid == 0) || (map->actionid > OI_MAX_ACTIONID)) {
         return OI_ERR_PARAM;
     }
     if(map->name == NULL) {
@@ -326,6 +334,7 @@ void action_process(oi_event *evt) {
     if((action_state == NULL) || (action_count <= 0)) {
         return;
     }
+    stats_action(FALSE);
 
     // Set defaults
     act.type = OI_ACTION;
@@ -341,7 +350,7 @@ void action_process(oi_event *evt) {
      * @li Calculate table offset (keysym/button index)
      * @li Get table entry, which is a linked list (action_manager[index])
      * @li Parse linked list (while(item != NULL))
-     * @li Check each list item for device index (zero or match the event poster)
+     * @li Check each list item for device handle (zero or match the event poster)
      * @li Setup the action event structure and post it
      *
      * The above list assumes that all steps are successfull, ie. that
@@ -354,11 +363,11 @@ void action_process(oi_event *evt) {
 
         // Check trigger
         i = evt->key.keysym.sym;
-        link = action_keyboard[i];
+        link = ((i > OIK_FIRST) && (i < OIK_LAST)) ? action_keyboard[i] : NULL;
         while(link != NULL) {
 
             // Match device
-            if((link->device == 0) || (link->device == evt->key.device)) {
+            if((link->device == 0) || (link->device == device_handle(evt->key.device))) {
                 act.action.device = evt->key.device;
                 act.action.actionid = link->action;
                 act.action.state = (evt->type == OI_KEYDOWN);
@@ -377,7 +386,7 @@ void action_process(oi_event *evt) {
 
         // Check trigger
         i = evt->button.button;
-        link = action_mouse[i];
+        link = (i < OIP_LAST) ? action_mouse[i] : NULL;
         while(link != NULL) {
 
             /* Special handling for mouse scroll wheels!
@@ -386,7 +395,7 @@ void action_process(oi_event *evt) {
              */
             if(((i == OIP_WHEEL_UP) || (i == OIP_WHEEL_DOWN)) &&
                (evt->type == OI_MOUSEBUTTONDOWN) &&
-               ((link->device == 0) || (link->device == evt->button.device))) {
+               ((link->device == 0) || (link->device == device_handle(evt->button.device)))) {
                 act.action.device = evt->button.device;
                 act.action.actionid = link->action;
                 act.action.state = TRUE;
@@ -394,7 +403,7 @@ void action_process(oi_event *evt) {
                 debug("action_process: %u (mouse wheel)", act.action.actionid);
             }
             // Normal event, match device
-            else if((link->device == 0) || (link->device == evt->button.device)) {
+            else if((link->device == 0) || (link->device == device_handle(evt->button.device))) {
                 act.action.device = evt->button.device;
                 act.action.actionid = link->action;
                 act.action.state = (evt->type == OI_MOUSEBUTTONDOWN);
@@ -415,7 +424,7 @@ void action_process(oi_event *evt) {
         while(link != NULL) {
 
             // Match device
-            if((link->device == 0) || (link->device == evt->move.device)) {
+            if((link->device == 0) || (link->device == device_handle(evt->move.device))) {
                 act.action.device = evt->move.device;
                 act.action.actionid = link->action;
                 act.action.state = TRUE;
@@ -436,11 +445,11 @@ void action_process(oi_event *evt) {
 
         // Check trigger
         i = OI_JOY_DECODE_INDEX(evt->joybutton.code);
-        link = action_joy[OI_JOY_TAB_BTNS][i];
+        link = (i < OI_JOY_NUM_AXES) ? action_joy[OI_JOY_TAB_BTNS][i] : NULL;
         while(link != NULL) {
 
             // Match device
-            if((link->device == 0) || (link->device == evt->joybutton.device)) {
+            if((link->device == 0) || (link->device == device_handle(evt->joybutton.device))) {
                 act.action.device = evt->joybutton.device;
                 act.action.actionid = link->action;
                 act.action.state = (evt->type == OI_JOYBUTTONDOWN);
@@ -459,11 +468,11 @@ void action_process(oi_event *evt) {
 
         // Check trigger
         i = OI_JOY_DECODE_INDEX(evt->joyaxis.code);
-        link = action_joy[OI_JOY_TAB_AXES][i];
+        link = (i < OI_JOY_NUM_AXES) ? action_joy[OI_JOY_TAB_AXES][i] : NULL;
         while(link != NULL) {
 
             // Match device
-            if((link->device == 0) || (link->device == evt->joyaxis.device)) {
+            if((link->device == 0) || (link->device == device_handle(evt->joyaxis.device))) {
                 act.action.device = evt->joyaxis.device;
                 act.action.actionid = link->action;
                 act.action.state = TRUE;
@@ -482,11 +491,11 @@ void action_process(oi_event *evt) {
 
         // Check trigger
         i = OI_JOY_DECODE_INDEX(evt->joyaxis.code);
-        link = action_joy[OI_JOY_TAB_AXES][i];
+        link = (i < OI_JOY_NUM_AXES) ? action_joy[OI_JOY_TAB_AXES][i] : NULL;
         while(link != NULL) {
 
             // Match device
-            if((link->device == 0) || (link->device == evt->joyaxis.device)) {
+            if((link->device == 0) || (link->device == device_handle(evt->joyaxis.device))) {
                 act.action.device = evt->joyaxis.device;
                 act.action.actionid = link->action;
                 act.action.state = TRUE;
@@ -505,11 +514,11 @@ void action_process(oi_event *evt) {
 
         // Check trigger
         i = OI_JOY_DECODE_INDEX(evt->joyball.code);
-        link = action_joy[OI_JOY_TAB_AXES][i];
+        link = (i < OI_JOY_NUM_AXES) ? action_joy[OI_JOY_TAB_AXES][i] : NULL;
         while(link != NULL) {
 
             // Match device
-            if((link->device == 0) || (link->device == evt->joyball.device)) {
+            if((link->device == 0) || (link->device == device_handle(evt->joyball.device))) {
                 act.action.device = evt->joyball.device;
                 act.action.actionid = link->action;
                 act.action.state = TRUE;
@@ -581,6 +590,7 @@ void action_cleartable(oi_aclink *tab[], int num) {
             free(prev);
             prev = next;
         }
+        tab[i] = NULL;
     }
 }
 
@@ -655,6 +665,8 @@ void action_statepost(oi_event *evt) {
     action_state[evt->action.actionid] = evt->action.state;
 
     // Post the action event
+    OI_PROBE3(action__post, evt->action.device, evt->action.actionid, evt->action.state);
+    stats_action(TRUE);
     queue_add(evt);
 }
 
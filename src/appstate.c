@@ -45,7 +45,7 @@ static int win_height;
  * Must be called on library initialization.
  */
 int appstate_init() {
-    unsigned char i;
+    unsigned int i;
 
     // Ok, our focus is complete
     focus = OI_FOCUS_MOUSE | OI_FOCUS_INPUT | OI_FOCUS_VISIBLE;
@@ -55,12 +55,13 @@ int appstate_init() {
     cursor = TRUE;
 
     // Find default/first window device which we assume is "the root"
-    i = 1;
-    while((windowdev = device_get(i)) != NULL) {
+    windowdev = NULL;
+    for(i=0; device_live(i); i++) {
+        windowdev = device_get(device_live(i));
         if((windowdev->provides & OI_PRO_WINDOW) == OI_PRO_WINDOW) {
             break;
         }
-        i++;
+        windowdev = NULL;
     }
 
     // We really want a window
@@ -211,7 +212,7 @@ unsigned int oi_app_focus() {
  */
 oi_bool oi_app_cursor(oi_bool q) {
     char hide;
-    unsigned char i;
+    unsigned int i;
     oi_device *dev;
 
     switch(q) {
@@ -233,8 +234,9 @@ oi_bool oi_app_cursor(oi_bool q) {
     }
 
     // Set cursor mode on all devices
-    i = 1;
-    while((dev = device_get(i)) != NULL) {
+    for(i=0; device_live(i); i++) {
+        dev = device_get(device_live(i));
+
         // Hide is an optional function
         if(dev->hide) {
             dev->hide(dev, hide);
@@ -247,7 +249,6 @@ oi_bool oi_app_cursor(oi_bool q) {
             oi_mouse_absolute(0, &x, &y);
             dev->warp(dev, x, y);
         }
-        i++;
     }
 
     // Remember mode
@@ -269,7 +270,7 @@ oi_bool oi_app_cursor(oi_bool q) {
  */
 oi_bool oi_app_grab(oi_bool q) {
     char eat;
-    unsigned char i;
+    unsigned int i;
     oi_device *dev;
 
     switch(q) {
@@ -291,13 +292,13 @@ oi_bool oi_app_grab(oi_bool q) {
     }
 
     // Set cursor mode on all devices
-    i = 1;
-    while((dev = device_get(i)) != NULL) {
+    for(i=0; device_live(i); i++) {
+        dev = device_get(device_live(i));
+
         // Grab is an optional function
         if(dev->grab) {
             dev->grab(dev, eat);
         }
-        i++;
     }
 
     // Remember mode
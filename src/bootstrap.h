@@ -33,12 +33,24 @@ extern oi_bootstrap foo_bootstrap;
 #ifdef ENABLE_X11
 extern oi_bootstrap x11_bootstrap;
 #endif
+#ifdef ENABLE_XCB
+extern oi_bootstrap xcb_bootstrap;
+#endif
 #ifdef ENABLE_UNIXSIGNAL
 extern oi_bootstrap unixsignal_bootstrap;
 #endif
+#ifdef ENABLE_REPLAY
+extern oi_bootstrap replay_bootstrap;
+#endif
+#ifdef ENABLE_SYNTH
+extern oi_bootstrap synth_bootstrap;
+#endif
 #ifdef ENABLE_LINUXJOY
 extern oi_bootstrap linuxjoy_bootstrap;
 #endif
+#ifdef ENABLE_EVDEV
+extern oi_bootstrap evdev_bootstrap;
+#endif
 #ifdef ENABLE_WIN32
 extern oi_bootstrap win32_bootstrap;
 #endif
@@ -70,14 +82,30 @@ static oi_bootstrap *bootstrap[] = {
     &x11_bootstrap,
 #endif
 
+#ifdef ENABLE_XCB
+    &xcb_bootstrap,
+#endif
+
 #ifdef ENABLE_UNIXSIGNAL
     &unixsignal_bootstrap,
 #endif
 
+#ifdef ENABLE_REPLAY
+    &replay_bootstrap,
+#endif
+
+#ifdef ENABLE_SYNTH
+    &synth_bootstrap,
+#endif
+
 #ifdef ENABLE_LINUXJOY
     &linuxjoy_bootstrap,
 #endif
 
+#ifdef ENABLE_EVDEV
+    &evdev_bootstrap,
+#endif
+
 #ifdef ENABLE_WIN32
     &win32_bootstrap,
 #endif
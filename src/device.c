@@ -30,11 +30,15 @@
 #include "internal.h"
 #include "private.h"
 
-// Globals
-static oi_device *devices[OI_MAX_DEVICES];
-static oi_private *private[OI_MAX_DEVICES];
-static char devices_run[OI_MAX_DEVICES];
-static unsigned int num_devices;
+// Device table: slots by index, and the live devices in registration order
+static oi_devslot *slots = NULL;
+static unsigned char *live = NULL;
+static unsigned int num_slots = 0;
+static unsigned int used_slots = 0;
+static unsigned int num_live = 0;
+static unsigned char free_head = 0;
+static unsigned char free_tail = 0;
+static oi_private arena = { NULL, NULL, NULL, NULL };
 static char more_avail;
 
 // Include the bootstrap table
@@ -42,6 +46,16 @@ static char more_avail;
 #include "bootstrap.h"
 #undef _DEVICE_FILLER_
 
+// Parameters for devices registered after oi_init, and deferred drivers
+static char *boot_windowid = NULL;
+static unsigned int boot_flags = 0;
+
+// Drivers in use, the compiled-in ones first and then plugins
+static oi_bootstrap *drivers[TABLESIZE(bootstrap) + OI_MAX_PLUGINS];
+static char boot_lazy[TABLESIZE(bootstrap) + OI_MAX_PLUGINS];
+static unsigned int num_drivers = 0;
+static char lazy_pending = FALSE;
+
 /* ******************************************************************** */
 
 /**
@@ -56,14 +70,20 @@ static char more_avail;
 int device_init() {
     unsigned char i;
 
-    for(i=0; i<OI_MAX_DEVICES; i++) {
-        devices[i] = NULL;
-        private[i] = NULL;
-        devices_run[i] = FALSE;
-    }
-    num_devices = 0;
+    // Leftovers from a previous oi_init without oi_close
+    device_close();
     more_avail = FALSE;
 
+    for(i=0; i<TABLESIZE(boot_lazy); i++) {
+        boot_lazy[i] = FALSE;
+    }
+    num_drivers = 0;
+    lazy_pending = FALSE;
+    if(boot_windowid) {
+        free(boot_windowid);
+        boot_windowid = NULL;
+    }
+
     return OI_ERR_OK;
 }
 
@@ -76,58 +96,150 @@ int device_init() {
  * @param window_id window hook parameters, see @ref PWindow
  * @param flags library initization flags
  *
- * This function parses the bootstrap table and
- * registers (bootstraps and initializes) all devices.
+ * This function parses the bootstrap table and the driver
+ * plugins, and registers (bootstraps and initializes) all devices.
+ * Drivers can be selected with the OI_DRIVERS environment
+ * variable, see device_wanted.
+ *
+ * With the OI_FLAG_LAZY flag, drivers which only provide joysticks
+ * are skipped here, and bootstrapped by device_wakeup when the
+ * joystick interface is first used.
  */
 void device_bootstrap(char *window_id, unsigned int flags) {
     unsigned int i;
     unsigned int j;
-    int ok;
 
     debug("device_bootstrap");
 
-    // Critical error - bootstrap is empty
-    if(!bootstrap[0]) {
+    if(num_live != 0) {
+        debug("device_bootstrap: devices already initialized");
         return;
     }
-    if(num_devices != 0) {
-        debug("device_bootstrap: devices already initialized");
+
+    // Pick compiled-in drivers, then load plugins for the rest
+    num_drivers = 0;
+    for(i=0; bootstrap[i]; i++) {
+        if(device_wanted(bootstrap[i]->name)) {
+            drivers[num_drivers++] = bootstrap[i];
+        }
+    }
+    plugin_load();
+    for(i=0; plugin_get(i); i++) {
+        if(device_wanted(plugin_get(i)->name)) {
+            drivers[num_drivers++] = plugin_get(i);
+        }
+    }
+
+    // Critical error - no drivers
+    if(num_drivers == 0) {
         return;
     }
 
+    // Keep parameters for devices registered later on
+    if(window_id) {
+        boot_windowid = strdup(window_id);
+    }
+    boot_flags = flags;
+
     // Fill structure array with available devices
     j = 0;
-    for(i=0; bootstrap[i]; i++) {
-        debug("device_bootstrap: checking bootstrap entry %u", i, bootstrap[i]->name);
+    for(i=0; i<num_drivers; i++) {
+        debug("device_bootstrap: checking bootstrap entry %u '%s'", i, drivers[i]->name);
+
+        // Joystick-only drivers may wait until they are needed
+        if((flags & OI_FLAG_LAZY) && (drivers[i]->provides == OI_PRO_JOYSTICK)) {
+            debug("device_bootstrap: deferring %s", drivers[i]->name);
+            boot_lazy[i] = TRUE;
+            lazy_pending = TRUE;
+            continue;
+        }
 
-        // Some drivers may control more devices, allow them using the more_avail callback
-        more_avail = FALSE;
-        do {
-            // Be pessimistic
-            ok = FALSE;
-
-            // Check bootstrap entry
-            if(bootstrap[i] &&
-               bootstrap[i]->avail && bootstrap[i]->create &&
-               bootstrap[i]->name && bootstrap[i]->desc) {
-
-                // Check that the device is available
-                if(bootstrap[i]->avail(flags)) {
-
-                    // Register device, but continue even if that fails
-                    ok = TRUE;
-                    if(device_register(bootstrap[i], window_id, flags) == OI_ERR_OK) {
-                        j++;
-                    }
-                }
+        j += device_probe(drivers[i]);
+    }
+
+    debug("device_bootstrap: %u drivers in use, %u devices analyzed" \
+          " and %u available", num_drivers, j, num_live);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Bootstrap the devices of a single driver
+ *
+ * @param boot pointer to bootstrap structure
+ * @returns number of devices registered
+ *
+ * Ask the driver if a device is available and register it.
+ * Drivers may control more devices, in which case this is
+ * repeated as long as they call device_moreavail.
+ */
+int device_probe(oi_bootstrap *boot) {
+    int ok;
+    int j;
+
+    // Check bootstrap entry
+    if(!boot->avail || !boot->create || !boot->name || !boot->desc) {
+        return 0;
+    }
+
+    // Some drivers may control more devices, allow them using the more_avail callback
+    j = 0;
+    more_avail = FALSE;
+    do {
+        // Be pessimistic
+        ok = FALSE;
+
+        // Check that the device is available
+        if(boot->avail(boot_flags)) {
+
+            // Register device, but continue even if that fails
+            ok = TRUE;
+            if(device_register(boot, boot_windowid, boot_flags) == OI_ERR_OK) {
+                j++;
             }
+        }
+
+        // Continue till register fails or driver exhausted
+    } while(ok && more_avail);
+
+    return j;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Bootstrap deferred drivers
+ *
+ * @param provides provide mask of interface being used, see @ref PProvide
+ *
+ * Called by the state managers when their public interface is
+ * used. Drivers deferred by OI_FLAG_LAZY that provide the
+ * interface are bootstrapped now. This is cheap when nothing is
+ * deferred.
+ */
+void device_wakeup(unsigned int provides) {
+    unsigned int i;
 
-            // Continue till register fails or driver exhausted
-        } while(ok && more_avail);
+    if(!lazy_pending || !oi_runstate()) {
+        return;
     }
 
-    debug("device_bootstrap: %u drivers compiled in, %u devices analyzed" \
-          " and %u available", i, j, num_devices);
+    lazy_pending = FALSE;
+    for(i=0; i<num_drivers; i++) {
+        if(!boot_lazy[i]) {
+            continue;
+        }
+        if(drivers[i]->provides & provides) {
+            debug("device_wakeup: bootstrapping %s", drivers[i]->name);
+            boot_lazy[i] = FALSE;
+            device_probe(drivers[i]);
+        }
+        else {
+            lazy_pending = TRUE;
+        }
+    }
 }
 
 /* ******************************************************************** */
@@ -148,68 +260,79 @@ void device_bootstrap(char *window_id, unsigned int flags) {
  * library initilization
  */
 int device_register(oi_bootstrap *boot, char *window_id, unsigned int flags) {
+    oi_device *dev;
     oi_event ev;
+    unsigned char index;
 
     // Create the device
-    devices[num_devices] = boot->create();
-    if(devices[num_devices] == NULL) {
+    dev = boot->create();
+    if(dev == NULL) {
         return OI_ERR_NO_DEVICE;
     }
 
     // Check required functions
-    if(!devices[num_devices]->init ||
-       !devices[num_devices]->destroy ||
-       !devices[num_devices]->process) {
+    if(!dev->init || !dev->destroy || !dev->process) {
 
         // Device creation failed, abort
+        if(dev->destroy) {
+            dev->destroy(dev);
+        }
         return OI_ERR_NOT_IMPLEM;
     }
 
-    devices[num_devices]->index = num_devices+1;
-
     // Some drivers are lazy, others are advanced
-    if(!devices[num_devices]->name) {
-        devices[num_devices]->name = boot->name;
+    if(!dev->name) {
+        dev->name = boot->name;
     }
-    if(!devices[num_devices]->desc) {
-        devices[num_devices]->desc = boot->desc;
+    if(!dev->desc) {
+        dev->desc = boot->desc;
     }
-    if(!devices[num_devices]->provides) {
-        devices[num_devices]->provides = boot->provides;
+    if(!dev->provides) {
+        dev->provides = boot->provides;
     }
 
-    // Allocate managment data placeholder
-    private[num_devices] = (oi_private*)malloc(sizeof(oi_private));
-    memset(private[num_devices], 0, sizeof(oi_private));
+    // Get a slot, this also sets up the managment data arena
+    index = device_alloc();
+    if(!index) {
+        dev->destroy(dev);
+        return OI_ERR_INDEX;
+    }
 
     // Initialize managment data
-    keyboard_manage(&(private[num_devices]->key), devices[num_devices]->provides);
-    mouse_manage(&(private[num_devices]->mouse), devices[num_devices]->provides);
-    joystick_manage(&(private[num_devices]->joy), devices[num_devices]->provides);
+    keyboard_manage(&arena.key[index-1], dev->provides);
+    mouse_manage(&arena.mouse[index-1], dev->provides);
+    joystick_manage(&arena.joy[index-1], dev->provides);
+
+    // Drivers may use the managers during init, but are not pumped yet
+    stats_device(index);
+    dev->index = index;
+    slots[index-1].dev = dev;
+    slots[index-1].managers = dev->provides & (OI_PRO_KEYBOARD | OI_PRO_MOUSE | OI_PRO_JOYSTICK);
 
     // Ok, initialize the device
-    if(devices[num_devices]->init(devices[num_devices], window_id, flags) != OI_ERR_OK) {
+    if(dev->init(dev, window_id, flags) != OI_ERR_OK) {
 
         // Init failed, free the device structure and abort
-        devices[num_devices]->destroy(devices[num_devices]);
+        device_destroy(index);
         return OI_ERR_NO_DEVICE;
     }
 
     // Send the discovery event
     ev.type = OI_DISCOVERY;
-    ev.discover.device = num_devices+1;
-    ev.discover.name = devices[num_devices]->name;
-    ev.discover.description = devices[num_devices]->desc;
-    ev.discover.provides = devices[num_devices]->provides;
+    ev.discover.device = index;
+    ev.discover.name = dev->name;
+    ev.discover.description = dev->desc;
+    ev.discover.provides = dev->provides;
     queue_add(&ev);
 
     // Enable device for event pumping
-    devices_run[num_devices] = TRUE;
+    slots[index-1].run = TRUE;
+    slots[index-1].live = num_live;
+    live[num_live++] = index;
     debug("device_bootstrap: device '%s' (%s) added as index %i",
-          devices[num_devices]->name, devices[num_devices]->desc, num_devices+1);
+          dev->name, dev->desc, index);
 
     // Ok, we're done
-    num_devices++;
     return OI_ERR_OK;
 }
 
@@ -222,10 +345,11 @@ int device_register(oi_bootstrap *boot, char *window_id, unsigned int flags) {
  * @param index device index
  * @returns errorcode, see @ref PErrors
  *
- * Shutdown a device.
+ * Shutdown a device, and release its slot in the device table.
  */
 int device_destroy(unsigned char index) {
     oi_device *dev;
+    unsigned int n;
 
     debug("device_destroy");
 
@@ -234,23 +358,382 @@ int device_destroy(unsigned char index) {
     if(!dev) {
         return OI_ERR_INDEX;
     }
+    // Unlink from live devices, keeping the order of the rest
+    if((slots[index-1].live < num_live) && (live[slots[index-1].live] == index)) {
+        for(n=slots[index-1].live+1; n<num_live; n++) {
+            live[n-1] = live[n];
+            slots[live[n-1]-1].live = n-1;
+        }
+        num_live--;
+    }
+    device_release(index);
+
+    // Kill device
+    return dev->destroy(dev);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Remove a device at runtime
+ *
+ * @param index device index
+ * @returns errorcode, see @ref PErrors
+ *
+ * Shutdown a device which has been unplugged, and send an
+ * OI_DEVICELOST event. The index may be given to a device
+ * registered later on. The driver's strings die with the device,
+ * so the event points to copies kept in the slot until the next
+ * device in the slot is removed, or the library is closed.
+ */
+int device_remove(unsigned char index) {
+    oi_device *dev;
+    oi_event ev;
+
+    debug("device_remove");
+
+    // Dummy check
+    dev = device_get(index);
+    if(!dev) {
+        return OI_ERR_INDEX;
+    }
+
+    // Tell the world, with strings which outlive the device
+    device_forget(index);
+    slots[index-1].lostname = dev->name ? strdup(dev->name) : NULL;
+    slots[index-1].lostdesc = dev->desc ? strdup(dev->desc) : NULL;
+    ev.type = OI_DEVICELOST;
+    ev.discover.device = index;
+    ev.discover.name = slots[index-1].lostname;
+    ev.discover.description = slots[index-1].lostdesc;
+    ev.discover.provides = dev->provides;
+    queue_add(&ev);
+
+    debug("device_remove: removing device index %i", index);
+    return device_destroy(index);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Shutdown all devices
+ *
+ * @returns number of devices which failed to shut down
+ *
+ * Destroy all devices and free the device table. Called on
+ * library shutdown.
+ */
+int device_close() {
+    unsigned int n;
+    int e;
+
+    // Last registered first
+    e = 0;
+    while(num_live > 0) {
+        if(device_destroy(live[num_live-1]) != OI_ERR_OK) {
+            e++;
+        }
+    }
+
+    if(slots) {
+        for(n=0; n<num_slots; n++) {
+            device_forget(n+1);
+        }
+        free(slots);
+    }
+    if(live) {
+        free(live);
+    }
+    device_arena(FALSE);
+    slots = NULL;
+    live = NULL;
+    num_slots = 0;
+    used_slots = 0;
+    free_head = 0;
+    free_tail = 0;
+
+    return e;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Allocate a slot in the device table
+ *
+ * @returns device index of slot, 0 if table is full
+ *
+ * Released slots are reused in the order they were released, so
+ * an index stays unused for as long as possible. When there are
+ * no released slots, the table grows (up to OI_MAX_DEVICES).
+ */
+unsigned char device_alloc() {
+    oi_devslot *ns;
+    unsigned char *nl;
+    unsigned char index;
+    unsigned int size;
+
+    // Reuse oldest released slot
+    if(free_head) {
+        index = free_head;
+        free_head = slots[index-1].next;
+        if(!free_head) {
+            free_tail = 0;
+        }
+        slots[index-1].next = 0;
+        return index;
+    }
 
-    // Free private manager data
-    if(private[index-1]) {
-        if(private[index-1]->joy) {
-            free(private[index-1]->joy);
+    // Grow table
+    if(used_slots == num_slots) {
+        if(num_slots >= OI_MAX_DEVICES) {
+            return 0;
         }
-        if(private[index-1]->key) {
-            free(private[index-1]->key);
+        size = num_slots ? num_slots*2 : OI_MIN_DEVSLOTS;
+        if(size > OI_MAX_DEVICES) {
+            size = OI_MAX_DEVICES;
         }
-        if(private[index-1]->mouse) {
-            free(private[index-1]->mouse);
+        if(device_arena(TRUE) != OI_ERR_OK) {
+            return 0;
         }
-        free(private[index-1]);
+        ns = (oi_devslot*)realloc(slots, size * sizeof(oi_devslot));
+        if(!ns) {
+            return 0;
+        }
+        slots = ns;
+        nl = (unsigned char*)realloc(live, size);
+        if(!nl) {
+            return 0;
+        }
+        live = nl;
+        memset(slots + num_slots, 0, (size - num_slots) * sizeof(oi_devslot));
+        num_slots = size;
     }
 
-    // Kill device
-    return dev->destroy(dev);
+    return ++used_slots;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Allocate the managment data arena
+ *
+ * @param on true (1) to allocate, false (0) to free the arena
+ * @returns errorcode, see @ref PErrors
+ *
+ * Allocate the manager arrays for all OI_MAX_DEVICES slots as one
+ * block, each array starting on a cache line. The arena never
+ * moves, so pointers from device_priv (and the tables returned by
+ * oi_key_keystate and friends) stay valid while the device lives.
+ * Pages of slots which are never used are not touched.
+ */
+int device_arena(char on) {
+    unsigned int joylen;
+    unsigned int mouselen;
+    unsigned int keylen;
+    char *base;
+
+    if(!on) {
+        if(arena.block) {
+            free(arena.block);
+        }
+        memset(&arena, 0, sizeof(oi_private));
+        return OI_ERR_OK;
+    }
+    if(arena.block) {
+        return OI_ERR_OK;
+    }
+
+    joylen = OI_ALIGN(OI_MAX_DEVICES * sizeof(oi_privjoy), OI_ARENA_ALIGN);
+    mouselen = OI_ALIGN(OI_MAX_DEVICES * sizeof(oi_privmouse), OI_ARENA_ALIGN);
+    keylen = OI_ALIGN(OI_MAX_DEVICES * sizeof(oi_privkey), OI_ARENA_ALIGN);
+
+    // Room to move the start up to the next cache line
+    arena.block = (char*)malloc(joylen + mouselen + keylen + OI_ARENA_ALIGN - 1);
+    if(!arena.block) {
+        return OI_ERR_NO_DEVICE;
+    }
+    base = arena.block + (OI_ALIGN((size_t)arena.block, OI_ARENA_ALIGN) - (size_t)arena.block);
+
+    arena.joy = (oi_privjoy*)base;
+    arena.mouse = (oi_privmouse*)(base + joylen);
+    arena.key = (oi_privkey*)(base + joylen + mouselen);
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Release a slot in the device table
+ *
+ * @param index device index
+ *
+ * Clear the slot, bump its generation and put it at the end of
+ * the list of free slots.
+ */
+void device_release(unsigned char index) {
+    oi_devslot *slot;
+
+    slot = &slots[index-1];
+    slot->dev = NULL;
+    slot->managers = 0;
+    slot->run = FALSE;
+    slot->gen++;
+    slot->next = 0;
+
+    if(free_tail) {
+        slots[free_tail-1].next = index;
+    }
+    else {
+        free_head = index;
+    }
+    free_tail = index;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Free the strings of a removed device
+ *
+ * @param index device index
+ *
+ * Called when the next device in the slot is removed, or the
+ * table is freed, as the OI_DEVICELOST event of the old device
+ * has been polled by then.
+ */
+void device_forget(unsigned char index) {
+    oi_devslot *slot;
+
+    slot = &slots[index-1];
+    if(slot->lostname) {
+        free(slot->lostname);
+    }
+    if(slot->lostdesc) {
+        free(slot->lostdesc);
+    }
+    slot->lostname = NULL;
+    slot->lostdesc = NULL;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Device node added or removed
+ *
+ * @param node name of device node (without directory)
+ * @param added true (1) if node appeared, false (0) if it vanished
+ * @returns index of device registered or removed, 0 if none
+ *
+ * Called by the hotplug watcher when the contents of the device
+ * node directory change. The drivers with a hotplug function in
+ * the bootstrap table are asked in turn: For new nodes the first
+ * driver to claim the node gets a device registered, while for
+ * removed nodes the driver returns the index of the device which
+ * is then removed. Deferred drivers are left alone, they will
+ * see the node when they are bootstrapped.
+ */
+int device_hotplug(char *node, char added) {
+    unsigned int i;
+    int index;
+
+    for(i=0; i<num_drivers; i++) {
+        if(!drivers[i]->hotplug || boot_lazy[i]) {
+            continue;
+        }
+
+        // Node removed, driver returns index of device to kill
+        if(!added) {
+            index = drivers[i]->hotplug(node, FALSE);
+            if((index > 0) && (device_remove(index) == OI_ERR_OK)) {
+                return index;
+            }
+        }
+
+        // Node added, driver prepares create/init if it wants the node
+        else if(drivers[i]->hotplug(node, TRUE)) {
+            debug("device_hotplug: '%s' claimed by %s", node, drivers[i]->name);
+            if(device_register(drivers[i], boot_windowid, boot_flags) == OI_ERR_OK) {
+                return live[num_live-1];
+            }
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Directory of device nodes
+ *
+ * @returns path of device node directory
+ *
+ * Drivers that open device nodes (like /dev/input/js0) should
+ * build the path from this directory, which is also the one
+ * watched for hotplugged devices. The environment variable
+ * OI_INPUTDIR overrides the default.
+ */
+char *device_nodedir() {
+    char *dir;
+
+    dir = getenv(OI_NODE_ENVIRONMENT);
+    if(!dir || !*dir) {
+        dir = OI_NODE_DIR;
+    }
+    return dir;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Check if driver should be used
+ *
+ * @param name short name of driver
+ * @returns true (1) if the driver is selected and not already in use
+ *
+ * The OI_DRIVERS environment variable may hold a list of driver
+ * names separated by commas or spaces, eg. "linuxjoy,evdev" for a
+ * headless server. Only the listed drivers are used, and only the
+ * listed plugins are loaded. When unset, all drivers are used.
+ */
+char device_wanted(char *name) {
+    unsigned int i;
+    unsigned int len;
+    unsigned int n;
+    char *list;
+
+    // First one wins, compiled-in drivers before plugins
+    for(i=0; i<num_drivers; i++) {
+        if(strcmp(drivers[i]->name, name) == 0) {
+            return FALSE;
+        }
+    }
+
+    // No selection, anything goes
+    list = getenv(OI_DRIVER_ENVIRONMENT);
+    if(!list || !*list) {
+        return TRUE;
+    }
+
+    len = strlen(name);
+    while(*list) {
+        list += strspn(list, ", ");
+        n = strcspn(list, ", ");
+        if((n == len) && (strncmp(list, name, len) == 0)) {
+            return TRUE;
+        }
+        list += n;
+    }
+    return FALSE;
 }
 
 /* ******************************************************************** */
@@ -291,16 +774,109 @@ void device_moreavail(char more) {
  * @param index device index
  * @returns pointer to device structure
  *
- * Fetch a device structure given device index.
+ * Fetch a device structure given device index. Only the range
+ * is checked: indices are reused, so an index kept after a
+ * pump may name a later device. Internal state which outlives
+ * a pump (like device bound actions) stores a handle from
+ * device_handle instead. The public API takes plain indices,
+ * which the application learns from OI_DISCOVERY and must drop
+ * on OI_DEVICELOST.
  */
 oi_device *device_get(unsigned char index) {
     // Dummy check
-    if((index < 1) || (index > num_devices)) {
+    if((index < 1) || (index > used_slots)) {
         // debug("device_get: no device, index %i", index);
         return NULL;
     }
 
-    return devices[index-1];
+    return slots[index-1].dev;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Iterate live devices
+ *
+ * @param n number of live device, starting from zero
+ * @returns device index, or 0 when there are no more devices
+ *
+ * Devices are returned in the order they were registered. Holes
+ * left by removed devices are skipped, so a loop over the live
+ * devices costs the number of devices present, not the number
+ * of devices ever seen:
+ *
+ * for(i=0; (index = device_live(i)); i++) { ... }
+ */
+unsigned char device_live(unsigned int n) {
+    if(n >= num_live) {
+        return 0;
+    }
+    return live[n];
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Find first device with managment data
+ *
+ * @param manager provide-code (see @ref PProvide) of manager
+ * @returns device index, or 0 if no device has the manager
+ *
+ * Used by the managers to find the default device when the
+ * application passes index 0.
+ */
+unsigned char device_first(unsigned int manager) {
+    unsigned int n;
+
+    for(n=0; n<num_live; n++) {
+        if(device_priv(live[n], manager)) {
+            return live[n];
+        }
+    }
+    return 0;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Get handle of device
+ *
+ * @param index device index
+ * @returns handle, or 0 if no device
+ *
+ * Device indices are reused when devices are removed and others
+ * are added. A handle combines the index with the generation of
+ * the slot, so it can be stored and validated later using
+ * device_lookup.
+ */
+unsigned int device_handle(unsigned char index) {
+    if(!device_get(index)) {
+        return 0;
+    }
+    return (slots[index-1].gen << 8) | index;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Get device structure from handle
+ *
+ * @param handle device handle, see device_handle
+ * @returns pointer to device structure, or NULL if the
+ * device has been removed
+ */
+oi_device *device_lookup(unsigned int handle) {
+    unsigned char index;
+
+    index = handle & 0xff;
+    if(!device_get(index) || (slots[index-1].gen != (handle >> 8))) {
+        return NULL;
+    }
+    return slots[index-1].dev;
 }
 
 /* ******************************************************************** */
@@ -321,7 +897,7 @@ oi_device *device_get(unsigned char index) {
 void *device_priv(unsigned char index, unsigned int manager) {
 
     // Dummy check
-    if(!private[index-1]) {
+    if((index < 1) || (index > used_slots) || !(slots[index-1].managers & manager)) {
         // debug("device_priv: no private struct, index %i", index);
         return NULL;
     }
@@ -329,13 +905,13 @@ void *device_priv(unsigned char index, unsigned int manager) {
     // Return the manager data
     switch(manager) {
     case OI_PRO_KEYBOARD:
-        return private[index-1]->key;
+        return &arena.key[index-1];
 
     case OI_PRO_MOUSE:
-        return private[index-1]->mouse;
+        return &arena.mouse[index-1];
 
     case OI_PRO_JOYSTICK:
-        return private[index-1]->joy;
+        return &arena.joy[index-1];
 
     default:
         return NULL;
@@ -352,13 +928,20 @@ void *device_priv(unsigned char index, unsigned int manager) {
  * make them pump events into the queue.
  */
 void device_pumpall() {
-    unsigned int i;
-
-    for(i=0; i<num_devices; i++) {
-        // Only pump devices if it's there and enabled!
-        if(devices[i] && (devices_run[i] == TRUE)) {
-            // debug("device_pumpall: now pumping device index %i", i);
-            devices[i]->process(devices[i]);
+    oi_devslot *slot;
+    unsigned int n;
+
+    // Devices may come and go between pumps
+    hotplug_pump();
+
+    // Only live devices, and only if enabled!
+    for(n=0; n<num_live; n++) {
+        slot = &slots[live[n]-1];
+        if(slot->run == TRUE) {
+            OI_PROBE1(device__process, live[n]);
+            slot->dev->process(slot->dev);
+            queue_stamp(0);
+            OI_PROBE1(device__processed, live[n]);
         }
     }
 }
@@ -374,41 +957,31 @@ void device_pumpall() {
  * @returns converted parameter (as an unsigned int)
  *
  * Parse and convert string parameter to an unsigned long. Basically
- * this is just an advanced atoi-function.
+ * this is just an advanced atoi-function. The parameter is the
+ * first "tok:" in the string, followed by a decimal number.
  */
 
 unsigned long device_windowid(char *str, char tok) {
-    char match[5];
     char *sub;
-    int e;
-    unsigned long val;
 
-    if(!str) {
+    if(!str || !tok) {
         return 0;
     }
 
-    memset(match, 0, 5);
-
-    // Set token to find, and scan
-    match[0] = tok;
-    strcat(match, ":%lu");
-
-    // Find sub-string index (index of tok in str)
-    sub = str;
-    while(sub < str+strlen(str)) {
-        if(*sub == tok) {
+    // Find "tok:" in str
+    for(sub=str; *sub; sub++) {
+        if((sub[0] == tok) && (sub[1] == ':')) {
             break;
         }
-        sub++;
     }
 
-    e = sscanf(sub, match, &val);
-    if(e != 1) {
+    // Plain digits only, no sign or blanks
+    if((sub[0] == '\0') || (sub[2] < '0') || (sub[2] > '9')) {
         debug("device_windowid: parameter not found");
         return 0;
     }
 
-    return val;
+    return strtoul(sub+2, NULL, 10);
 }
 
 /* ******************************************************************** */
@@ -445,7 +1018,7 @@ oi_bool oi_device_enable(unsigned char index, oi_bool q) {
         break;
 
     case OI_QUERY:
-        if(devices_run[index-1]) {
+        if(slots[index-1].run) {
             return OI_ENABLE;
         }
         else {
@@ -454,12 +1027,12 @@ oi_bool oi_device_enable(unsigned char index, oi_bool q) {
     }
 
     // Reset driver
-    if(devices[index-1] && devices[index-1]->reset) {
-        devices[index-1]->reset(devices[index-1]);
+    if(slots[index-1].dev->reset) {
+        slots[index-1].dev->reset(slots[index-1].dev);
     }
 
     // Set new device state
-    devices_run[index-1] = enable;
+    slots[index-1].run = enable;
     return q;
 }
 
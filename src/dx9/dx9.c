@@ -145,7 +145,7 @@ oi_device *dx9_device() {
                                  NULL);
 
         if((res != DI_OK) || (object == NULL)) {
-            debug("dx9_device: object creation failed, code 0x%08X", res);
+            log_error("dx9_device: object creation failed, code 0x%08X", res);
             return NULL;
         }
         res = object->lpVtbl->EnumDevices(object,
@@ -155,7 +155,7 @@ oi_device *dx9_device() {
                                           DIEDFL_ALLDEVICES);
 
         if(res != DI_OK) {
-            debug("dx9_device: device enumeration failed, code 0x%08X", res);
+            log_error("dx9_device: device enumeration failed, code 0x%08X", res);
         }
         else {
             debug("dx9_device: enumeration succeeded");
@@ -0,0 +1,1090 @@
+/*
+ * evdev.c: GNU/Linux event device driver
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include "openinput.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <linux/input.h>
+#include "internal.h"
+#include "bootstrap.h"
+#include "evdev.h"
+#include "evdev_keys.h"
+
+// Codes missing in older kernel headers
+#ifndef SYN_DROPPED
+#define SYN_DROPPED 3
+#endif
+#ifndef REL_WHEEL_HI_RES
+#define REL_WHEEL_HI_RES 0x0b
+#endif
+#ifndef REL_HWHEEL_HI_RES
+#define REL_HWHEEL_HI_RES 0x0c
+#endif
+
+// Capability bitmask helpers
+#define DEVD_LONGBITS (8*sizeof(unsigned long))
+#define DEVD_NLONGS(x) (((x)+DEVD_LONGBITS-1)/DEVD_LONGBITS)
+#define DEVD_TEST(b, x) (((b)[(x)/DEVD_LONGBITS] >> ((x)%DEVD_LONGBITS)) & 1)
+
+/**
+ * @ingroup Drivers
+ * @defgroup DEvdev Linux event device driver
+ * @brief GNU/Linux event device driver
+ *
+ * Keyboard, mouse and joystick driver for GNU/Linux using the
+ * kernel event interface (/dev/input/eventX). Unlike the window
+ * system drivers, this driver sees every event at the full rate
+ * of the device, with the kernel timestamp of the event.
+ *
+ * Events are collected until the kernel marks the end of a frame
+ * (SYN_REPORT), and are then injected together with the timestamp
+ * of the frame, see oi_events_timestamp. High resolution wheels
+ * are reported through oi_mouse_wheel, and oi_app_grab gives
+ * exclusive access to the devices (EVIOCGRAB).
+ *
+ * Instead of scanning /dev/input, the driver can be pointed at a
+ * list of files using the OI_EVDEV environment variable, eg.
+ * "OI_EVDEV=/tmp/keyboard.rec:fd=5". Entries can be paths or
+ * "fd=N" for an already open file descriptor (like a pipe or a
+ * socketpair). Anything which is not a real event device is read
+ * as a stream of struct input_event records, ie. a replay.
+ * Without OI_EVDEV, devices plugged in while the library is
+ * running are picked up through the hotplug watcher.
+ */
+
+// Bootstrap global
+oi_bootstrap evdev_bootstrap = {
+    "evdev",
+    "GNU/Linux event device driver",
+    OI_PRO_KEYBOARD | OI_PRO_MOUSE | OI_PRO_JOYSTICK,
+    evdev_avail,
+    evdev_device,
+    evdev_hotplug
+};
+
+// Device to be probed next, hotplugged device plus one and number of open devices
+static unsigned char init_next = 0;
+static unsigned char init_hot = 0;
+static unsigned char num_open = 0;
+
+// Device opened by avail, handed over to create
+static int avail_fd = -1;
+static unsigned char avail_num = 0;
+
+// Keycode to OpenInput key lookup
+static oi_key evdev_map[256];
+static char evdev_mapready = FALSE;
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Check if event devices exist
+ *
+ * @param flags library initialization flags, see @ref PFlags
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a bootstrap function.
+ *
+ * Check whether another event device can be opened. The device
+ * is kept open for evdev_device.
+ */
+int evdev_avail(unsigned int flags) {
+    int i;
+    int fd;
+
+    debug("evdev_avail");
+
+    // Forget a device that was never created
+    if(avail_fd != -1) {
+        close(avail_fd);
+        avail_fd = -1;
+    }
+
+    fd = -1;
+    for(i=init_next; i<DEVD_MAX_DEVS; i++) {
+        fd = evdev_open(i);
+        if(fd != -1) {
+            avail_fd = fd;
+            avail_num = i;
+            break;
+        }
+    }
+
+    return (fd != -1);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Create event device driver interface
+ *
+ * @returns pointer to device interface, see @ref IDevstructs
+ *
+ * This is a bootstrap function.
+ *
+ * Open the next event device which looks like a keyboard, mouse or
+ * joystick. The device is probed already here, since the provide
+ * mask must be known before the device is registered with the
+ * state managers.
+ */
+oi_device *evdev_device() {
+    oi_device *dev;
+    evdev_private *priv;
+    oi_joyconfig *conf;
+    int first;
+    int last;
+    int i;
+
+    debug("evdev_device");
+
+    // Alloc device data
+    dev = (oi_device*)malloc(sizeof(oi_device));
+    priv = (evdev_private*)malloc(sizeof(evdev_private));
+    conf = (oi_joyconfig*)malloc(sizeof(oi_joyconfig));
+    if(!dev || !priv || !conf) {
+        debug("evdev_device: device creation failed");
+        if(dev) {
+            free(dev);
+        }
+        if(priv) {
+            free(priv);
+        }
+        if(conf) {
+            free(conf);
+        }
+        return NULL;
+    }
+
+    // Clear structures
+    memset(dev, 0, sizeof(oi_device));
+    memset(priv, 0, sizeof(evdev_private));
+    memset(conf, 0, sizeof(oi_joyconfig));
+    dev->private = priv;
+    dev->joyconfig = conf;
+
+    // Find next device we can use, or just the hotplugged one
+    first = init_next;
+    last = DEVD_MAX_DEVS;
+    if(init_hot) {
+        first = init_hot - 1;
+        last = init_hot;
+    }
+    priv->fd = -1;
+    for(i=first; i<last; i++) {
+        if((avail_fd != -1) && (avail_num == i)) {
+            priv->fd = avail_fd;
+            avail_fd = -1;
+        }
+        else {
+            priv->fd = evdev_open(i);
+        }
+        if(priv->fd == -1) {
+            continue;
+        }
+
+        priv->id = i;
+        dev->provides = evdev_probe(dev);
+        if(dev->provides) {
+            break;
+        }
+
+        // Not interesting (power button, lid switch, etc.)
+        close(priv->fd);
+        priv->fd = -1;
+    }
+
+    // No matter what, don't try these devices again
+    if(init_hot) {
+        init_hot = 0;
+    }
+    else {
+        init_next = i+1;
+    }
+
+    if(priv->fd == -1) {
+        free(dev);
+        free(priv);
+        free(conf);
+        return NULL;
+    }
+    num_open++;
+
+    // Set members
+    dev->desc = priv->name;
+    dev->init = evdev_init;
+    dev->destroy = evdev_destroy;
+    dev->process = evdev_process;
+    dev->grab = evdev_grab;
+    dev->hide = NULL;
+    dev->warp = NULL;
+    dev->winsize = NULL;
+    dev->reset = evdev_reset;
+
+    // Done
+    return dev;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Initialize the event device driver
+ *
+ * @param dev pointer to created device interface
+ * @param window_id window hook parameters, see @ref PWindow
+ * @param flags initialization flags, see @ref PFlags
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * The device was opened and probed by evdev_device, so only
+ * the initial joystick axis positions are fetched here.
+ */
+int evdev_init(oi_device *dev, char *window_id, unsigned int flags) {
+    debug("evdev_init");
+
+    // We can handle more than one device!
+    device_moreavail(TRUE);
+
+    evdev_keymap();
+    evdev_sync(dev, FALSE);
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Destroy the event device driver
+ *
+ * @param dev pointer to device interface
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Release grab, close the device and free the structures.
+ */
+int evdev_destroy(oi_device *dev) {
+    evdev_private *priv;
+
+    debug("evdev_destroy");
+
+    if(dev) {
+        priv = (evdev_private*)dev->private;
+        if(priv) {
+            if(priv->grabbed) {
+                evdev_grab(dev, FALSE);
+            }
+            if(priv->fd != -1) {
+                close(priv->fd);
+            }
+            free(priv);
+        }
+
+        if(dev->joyconfig) {
+            free(dev->joyconfig);
+        }
+        free(dev);
+
+        // Start over on next library initialization
+        if(num_open > 0) {
+            num_open--;
+        }
+        if(num_open == 0) {
+            init_next = 0;
+        }
+    }
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Process events
+ *
+ * @param dev pointer to device interface
+ *
+ * This is a device interface function.
+ *
+ * Read events in blocks of up to DEVD_READ_EVENTS and feed
+ * them to evdev_event. Incomplete records (which can only
+ * happen on replay streams) are kept for the next read.
+ */
+void evdev_process(oi_device *dev) {
+    struct input_event buf[DEVD_READ_EVENTS];
+    evdev_private *priv;
+    int num;
+    int len;
+    int i;
+
+    if(!oi_runstate()) {
+        debug("evdev_process: oi_running false");
+        return;
+    }
+
+    priv = (evdev_private*)dev->private;
+
+    // We're in non-blocking mode, so empty the kernel queue
+    do {
+        memcpy(buf, priv->rest, priv->restlen);
+        num = read(priv->fd, (char*)buf + priv->restlen, sizeof(buf) - priv->restlen);
+        stats_read(dev->index);
+        if(num <= 0) {
+            break;
+        }
+        len = num + priv->restlen;
+
+        // Handle complete records, keep the remains
+        num = len / sizeof(struct input_event);
+        priv->restlen = len % sizeof(struct input_event);
+        memcpy(priv->rest, (char*)buf + num*sizeof(struct input_event), priv->restlen);
+
+        for(i=0; i<num; i++) {
+            trace_add(OI_TRACE_DRIVER, dev->index, buf[i].type);
+            evdev_event(dev, &buf[i]);
+        }
+    }
+    // A short read means the queue is empty
+    while(len == sizeof(buf));
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Grab device
+ *
+ * @param dev pointer to device interface
+ * @param on true (1) to grab, false (0) to release
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Get exclusive access to the device, such that no other
+ * application (including the X server) receive its events.
+ */
+int evdev_grab(oi_device *dev, int on) {
+    evdev_private *priv;
+
+    debug("evdev_grab: %i", on);
+    priv = (evdev_private*)dev->private;
+
+    if(priv->replay) {
+        return OI_ERR_NOT_IMPLEM;
+    }
+
+    if(ioctl(priv->fd, EVIOCGRAB, on ? 1 : 0) < 0) {
+        log_warn("evdev_grab: ioctl failed");
+        return OI_ERR_DEV_BEHAVE;
+    }
+
+    priv->grabbed = on ? TRUE : FALSE;
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Reset internal state
+ *
+ * @param dev pointer to device interface
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Drop the frame being collected and resync the driver-device states.
+ */
+int evdev_reset(oi_device *dev) {
+    evdev_private *priv;
+
+    debug("evdev_reset");
+    priv = (evdev_private*)dev->private;
+
+    // Forget everything about current frame
+    priv->dropped = FALSE;
+    priv->relx = 0;
+    priv->rely = 0;
+    priv->wheel = 0;
+    priv->hwheel = 0;
+    priv->wheelhi = 0;
+    priv->hwheelhi = 0;
+    priv->numkeys = 0;
+    priv->axpend = 0;
+
+    evdev_sync(dev, TRUE);
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Device node added or removed
+ *
+ * @param node name of device node
+ * @param added true (1) if node was added, false (0) if removed
+ * @returns see below
+ *
+ * This is a bootstrap function.
+ *
+ * When a new eventX node appears, remember it for the following
+ * create and return true, unless it is already open. When a node
+ * is removed, return the index of the device to shut down. Nodes
+ * are ignored when OI_EVDEV selects the devices.
+ */
+int evdev_hotplug(char *node, char added) {
+    unsigned int num;
+    unsigned char index;
+    char c;
+
+    // Only eventX nodes, and only when scanning the node directory
+    if(getenv(DEVD_ENVIRONMENT) ||
+       (sscanf(node, "event%u%c", &num, &c) != 1) || (num >= DEVD_MAX_DEVS)) {
+        return 0;
+    }
+
+    index = evdev_find(num);
+    if(!added) {
+        return index;
+    }
+    if(index) {
+        return FALSE;
+    }
+
+    init_hot = num + 1;
+    return TRUE;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Find device of numbered event device
+ *
+ * @param num device number (0-31)
+ * @returns device index, or 0 if device is not open
+ */
+unsigned char evdev_find(unsigned char num) {
+    oi_device *dev;
+    unsigned int i;
+
+    for(i=0; device_live(i); i++) {
+        dev = device_get(device_live(i));
+        if((dev->process == evdev_process) &&
+           (((evdev_private*)dev->private)->id == num)) {
+            return dev->index;
+        }
+    }
+    return 0;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Open numbered event device
+ *
+ * @param num device number (0-31)
+ * @returns file descriptor or -1 if device not found
+ *
+ * Open /dev/input/eventX with X=num, or if the OI_EVDEV
+ * environment variable is set, the num'th entry in that list.
+ */
+int evdev_open(unsigned char num) {
+    char path[DEVD_NAME_SIZE];
+    char *env;
+    char *end;
+    int len;
+    int fd;
+
+    // Dummy
+    if(num >= DEVD_MAX_DEVS) {
+        return -1;
+    }
+
+    // Default path
+    env = getenv(DEVD_ENVIRONMENT);
+    if(!env) {
+        snprintf(path, sizeof(path), "%s/event%u", device_nodedir(), num);
+        return open(path, O_RDONLY | O_NONBLOCK, 0);
+    }
+
+    // Find entry in colon-separated list
+    while(num > 0) {
+        env = strchr(env, ':');
+        if(!env) {
+            return -1;
+        }
+        env++;
+        num--;
+    }
+    end = strchr(env, ':');
+    len = end ? (int)(end - env) : (int)strlen(env);
+    if((len == 0) || (len >= DEVD_NAME_SIZE)) {
+        return -1;
+    }
+    memcpy(path, env, len);
+    path[len] = '\0';
+
+    // Already open descriptor
+    if(strncmp(path, "fd=", 3) == 0) {
+        fd = dup(atoi(path+3));
+        if(fd != -1) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        }
+        return fd;
+    }
+
+    return open(path, O_RDONLY | O_NONBLOCK, 0);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Probe device capabilities
+ *
+ * @param dev pointer to device interface
+ * @returns provide mask, see @ref PProvide
+ *
+ * Ask the kernel what the device can do, and decide whether it
+ * is a keyboard, mouse and/or joystick. Absolute axes and
+ * buttons of joysticks are mapped to OpenInput axes and buttons.
+ *
+ * Files which are not event devices (replays) are assumed to be
+ * everything, with the first 16 absolute axes in the range of a
+ * signed short. Their wheels are taken as low resolution until a
+ * high resolution event shows up.
+ */
+unsigned int evdev_probe(oi_device *dev) {
+    unsigned long evbits[DEVD_NLONGS(EV_CNT)];
+    unsigned long keybits[DEVD_NLONGS(KEY_CNT)];
+    unsigned long relbits[DEVD_NLONGS(REL_CNT)];
+    unsigned long absbits[DEVD_NLONGS(ABS_CNT)];
+    struct input_absinfo info;
+    evdev_private *priv;
+    oi_joyconfig *conf;
+    unsigned int provides;
+    int code;
+    int j;
+
+    priv = (evdev_private*)dev->private;
+    conf = dev->joyconfig;
+    memset(evbits, 0, sizeof(evbits));
+    memset(keybits, 0, sizeof(keybits));
+    memset(relbits, 0, sizeof(relbits));
+    memset(absbits, 0, sizeof(absbits));
+
+    // Real device or replay
+    if(ioctl(priv->fd, EVIOCGBIT(0, sizeof(evbits)), evbits) >= 0) {
+        ioctl(priv->fd, EVIOCGBIT(EV_KEY, sizeof(keybits)), keybits);
+        ioctl(priv->fd, EVIOCGBIT(EV_REL, sizeof(relbits)), relbits);
+        ioctl(priv->fd, EVIOCGBIT(EV_ABS, sizeof(absbits)), absbits);
+        if(ioctl(priv->fd, EVIOCGNAME(DEVD_NAME_SIZE), priv->name) < 0) {
+            sprintf(priv->name, "Unknown event device #%u", priv->id);
+        }
+        priv->name[DEVD_NAME_SIZE-1] = '\0';
+
+#ifdef EVIOCSCLOCKID
+        {
+            // Timestamps on the same clock as oi_gettime
+            int clk = CLOCK_MONOTONIC;
+            ioctl(priv->fd, EVIOCSCLOCKID, &clk);
+        }
+#endif
+    }
+    else {
+        priv->replay = TRUE;
+        sprintf(priv->name, "Event replay #%u", priv->id);
+        memset(evbits, 0xff, sizeof(evbits));
+        memset(keybits, 0xff, sizeof(keybits));
+        memset(relbits, 0xff, sizeof(relbits));
+        for(code=0; code<OI_JOY_NUM_AXES; code++) {
+            absbits[code/DEVD_LONGBITS] |= 1UL << (code%DEVD_LONGBITS);
+        }
+    }
+    debug("evdev_probe: device '%s'", priv->name);
+
+    // Keyboards have letters
+    provides = 0;
+    if(DEVD_TEST(evbits, EV_KEY) && DEVD_TEST(keybits, KEY_A) &&
+       DEVD_TEST(keybits, KEY_Z) && DEVD_TEST(keybits, KEY_SPACE)) {
+        provides |= OI_PRO_KEYBOARD;
+    }
+
+    // Mice move in two directions
+    if(DEVD_TEST(evbits, EV_REL) && DEVD_TEST(relbits, REL_X) &&
+       DEVD_TEST(relbits, REL_Y)) {
+        provides |= OI_PRO_MOUSE;
+    }
+    priv->hires = !priv->replay && DEVD_TEST(relbits, REL_WHEEL_HI_RES);
+
+    // Joysticks have absolute axes and joystick/gamepad buttons
+    memset(priv->axismap, DEVD_NO_AXIS, sizeof(priv->axismap));
+    priv->numbtn = 0;
+    for(code=BTN_JOYSTICK; code<KEY_CNT; code++) {
+        if((code == BTN_DIGI) && !priv->replay) {
+            code = BTN_TRIGGER_HAPPY;
+        }
+        if(DEVD_TEST(keybits, code) && (priv->numbtn < DEVD_MAX_BUTTONS)) {
+            priv->btnmap[priv->numbtn++] = code;
+        }
+    }
+    if(!DEVD_TEST(evbits, EV_ABS) || !DEVD_TEST(absbits, ABS_X) ||
+       (priv->numbtn == 0)) {
+        priv->numbtn = 0;
+        return provides;
+    }
+    provides |= OI_PRO_JOYSTICK;
+
+    // Map axes in kernel order, multitouch and beyond are ignored
+    conf->name = priv->name;
+    conf->buttons = priv->numbtn;
+    for(code=0, j=0; (code<ABS_MISC) && (j<OI_JOY_NUM_AXES); code++) {
+        if(!DEVD_TEST(absbits, code)) {
+            continue;
+        }
+        priv->axismap[code] = j;
+
+        // Axis range
+        priv->absmin[code] = -32768;
+        priv->absmax[code] = 32767;
+        if(!priv->replay && (ioctl(priv->fd, EVIOCGABS(code), &info) >= 0) &&
+           (info.maximum > info.minimum)) {
+            priv->absmin[code] = info.minimum;
+            priv->absmax[code] = info.maximum;
+        }
+
+        // Axis type
+        switch(code) {
+        case ABS_X:
+        case ABS_Y:
+        case ABS_RX:
+        case ABS_RY:
+            conf->kind[j] = OIJ_STICK;
+            break;
+
+        case ABS_Z:
+        case ABS_RZ:
+        case ABS_THROTTLE:
+        case ABS_GAS:
+        case ABS_BRAKE:
+            conf->kind[j] = OIJ_THROTTLE;
+            break;
+
+        case ABS_RUDDER:
+        case ABS_WHEEL:
+            conf->kind[j] = OIJ_RUDDER;
+            break;
+
+        case ABS_HAT0X:
+        case ABS_HAT1X:
+        case ABS_HAT2X:
+        case ABS_HAT3X:
+            // Hats are two-axis (ie. paired), see linuxjoy
+            conf->kind[j] = OIJ_HAT;
+            if(DEVD_TEST(absbits, code+1) && (j+1 < OI_JOY_NUM_AXES)) {
+                conf->pair[j] = j+1;
+            }
+            break;
+
+        case ABS_HAT0Y:
+        case ABS_HAT1Y:
+        case ABS_HAT2Y:
+        case ABS_HAT3Y:
+            if((j > 0) && (conf->pair[j-1] == j)) {
+                conf->kind[j] = OIJ_NONE;
+            }
+            else {
+                conf->kind[j] = OIJ_HAT;
+            }
+            break;
+
+        default:
+            conf->kind[j] = OIJ_GEN_AXIS;
+            break;
+        }
+        j++;
+    }
+
+    return provides;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Handle single kernel event
+ *
+ * @param dev pointer to device interface
+ * @param ev kernel event
+ *
+ * Add the event to the frame being collected. When the frame
+ * is complete (SYN_REPORT), it is injected by evdev_frame. If
+ * the kernel dropped events (SYN_DROPPED), everything up to
+ * the next SYN_REPORT is ignored and the state is resynced.
+ */
+void evdev_event(oi_device *dev, struct input_event *ev) {
+    evdev_private *priv;
+    oi_joyconfig *conf;
+    unsigned char axis;
+    double v;
+
+    priv = (evdev_private*)dev->private;
+
+    // Wait for end of broken frame
+    if(priv->dropped) {
+        if((ev->type == EV_SYN) && (ev->code == SYN_REPORT)) {
+            evdev_reset(dev);
+        }
+        return;
+    }
+
+    switch(ev->type) {
+    case EV_SYN:
+        if(ev->code == SYN_REPORT) {
+#ifdef input_event_sec
+            priv->stamp = (oi_time)ev->input_event_sec*1000000000 +
+                (oi_time)ev->input_event_usec*1000;
+#else
+            priv->stamp = (oi_time)ev->time.tv_sec*1000000000 +
+                (oi_time)ev->time.tv_usec*1000;
+#endif
+            evdev_frame(dev);
+        }
+        else if(ev->code == SYN_DROPPED) {
+            debug("evdev_event: kernel dropped events");
+            priv->dropped = TRUE;
+        }
+        break;
+
+    case EV_KEY:
+        // Key repeat is done by the keyboard manager
+        if(ev->value == 2) {
+            break;
+        }
+
+        // Inject what we have if frame is too large
+        if(priv->numkeys == DEVD_FRAME_KEYS) {
+            evdev_frame(dev);
+        }
+        priv->keys[priv->numkeys] = ev->code;
+        priv->keydown[priv->numkeys] = (ev->value != 0);
+        priv->numkeys++;
+        break;
+
+    case EV_REL:
+        switch(ev->code) {
+        case REL_X:
+            priv->relx += ev->value;
+            break;
+
+        case REL_Y:
+            priv->rely += ev->value;
+            break;
+
+        case REL_WHEEL:
+            priv->wheel += ev->value;
+            break;
+
+        case REL_HWHEEL:
+            priv->hwheel += ev->value;
+            break;
+
+        case REL_WHEEL_HI_RES:
+            priv->wheelhi += ev->value;
+            priv->hires = TRUE;
+            break;
+
+        case REL_HWHEEL_HI_RES:
+            priv->hwheelhi += ev->value;
+            priv->hires = TRUE;
+            break;
+        }
+        break;
+
+    case EV_ABS:
+        if((ev->code >= ABS_CNT) || (priv->axismap[ev->code] == DEVD_NO_AXIS)) {
+            break;
+        }
+        axis = priv->axismap[ev->code];
+
+        // Scale to OpenInput range, keeping center at zero
+        v = ((double)ev->value * 2 - priv->absmin[ev->code] - priv->absmax[ev->code]) *
+            OI_JOY_AXIS_MAX / (priv->absmax[ev->code] - priv->absmin[ev->code]);
+        if(v > OI_JOY_AXIS_MAX) {
+            v = OI_JOY_AXIS_MAX;
+        }
+        if(v < OI_JOY_AXIS_MIN) {
+            v = OI_JOY_AXIS_MIN;
+        }
+        priv->axes[axis] = (int)v;
+        priv->axpend |= 1u << axis;
+
+        // Second hat axis, post the hat through the first one
+        conf = dev->joyconfig;
+        if((conf->kind[axis] == OIJ_NONE) && (axis > 0) &&
+           (conf->pair[axis-1] == axis)) {
+            priv->axpend |= 1u << (axis-1);
+        }
+        break;
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Inject collected frame
+ *
+ * @param dev pointer to device interface
+ *
+ * Inject the events of a frame into the state managers, all
+ * stamped with the time of the frame. Motion is done before
+ * buttons, such that button events carry the new position.
+ */
+void evdev_frame(oi_device *dev) {
+    evdev_private *priv;
+    struct oi_privjoy *joy;
+    oi_keysym keysym;
+    unsigned short code;
+    unsigned char down;
+    unsigned char axis;
+    int vert;
+    int horiz;
+    int i;
+    int j;
+
+    priv = (evdev_private*)dev->private;
+    queue_stamp(priv->stamp);
+
+    // Pointer motion
+    if(priv->relx || priv->rely) {
+        mouse_move(dev->index, priv->relx, priv->rely, TRUE, TRUE);
+    }
+
+    // Wheels, prefer high resolution data
+    if(priv->hires) {
+        vert = priv->wheelhi;
+        horiz = priv->hwheelhi;
+    }
+    else {
+        vert = priv->wheel * OI_WHEEL_DETENT;
+        horiz = priv->hwheel * OI_WHEEL_DETENT;
+    }
+    if(vert || horiz) {
+        mouse_wheel(dev->index, vert, horiz, TRUE);
+    }
+
+    // Keys and buttons in the order they happened
+    joy = (struct oi_privjoy*)device_priv(dev->index, OI_PRO_JOYSTICK);
+    for(i=0; i<priv->numkeys; i++) {
+        code = priv->keys[i];
+        down = priv->keydown[i];
+
+        // Keyboard
+        if(code < BTN_MISC) {
+            keysym.scancode = code;
+            keysym.sym = (code < 256) ? evdev_map[code] : OIK_UNKNOWN;
+            keysym.mod = OIM_NONE;
+            keyboard_update(dev->index, &keysym, down, TRUE);
+            continue;
+        }
+
+        // Mouse
+        switch(code) {
+        case BTN_LEFT:
+            mouse_button(dev->index, OIP_BUTTON_LEFT, down, TRUE);
+            continue;
+
+        case BTN_MIDDLE:
+            mouse_button(dev->index, OIP_BUTTON_MIDDLE, down, TRUE);
+            continue;
+
+        case BTN_RIGHT:
+            mouse_button(dev->index, OIP_BUTTON_RIGHT, down, TRUE);
+            continue;
+        }
+
+        // Joystick
+        if(joy) {
+            for(j=0; j<priv->numbtn; j++) {
+                if(priv->btnmap[j] == code) {
+                    joystick_setbutton(joy, dev->index, j, down, TRUE);
+                    break;
+                }
+            }
+        }
+    }
+
+    // Joystick axes
+    if(joy) {
+        while(priv->axpend) {
+            axis = OI_CTZ(priv->axpend);
+            priv->axpend &= priv->axpend - 1;
+            joystick_setaxis(joy, dev->joyconfig, dev->index, axis,
+                             priv->axes[axis], OI_DISABLE, TRUE);
+        }
+    }
+
+    // Frame done
+    priv->relx = 0;
+    priv->rely = 0;
+    priv->wheel = 0;
+    priv->hwheel = 0;
+    priv->wheelhi = 0;
+    priv->hwheelhi = 0;
+    priv->numkeys = 0;
+    priv->axpend = 0;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Sync state with kernel
+ *
+ * @param dev pointer to device interface
+ * @param post true (1) to post events for changes, false (0) otherwise
+ *
+ * Fetch the current key state and absolute axis positions from
+ * the kernel, and update the state managers. This is needed on
+ * startup and when the kernel has dropped events. Joystick
+ * buttons are updated silently.
+ */
+void evdev_sync(oi_device *dev, char post) {
+    unsigned long keybits[DEVD_NLONGS(KEY_CNT)];
+    struct input_absinfo info;
+    evdev_private *priv;
+    struct oi_privjoy *joy;
+    oi_keysym keysym;
+    char *keystate;
+    char down;
+    int code;
+    int axis;
+
+    priv = (evdev_private*)dev->private;
+    if(priv->replay) {
+        return;
+    }
+
+    // Keys and buttons
+    memset(keybits, 0, sizeof(keybits));
+    if(ioctl(priv->fd, EVIOCGKEY(sizeof(keybits)), keybits) >= 0) {
+        // Keyboard keys that changed
+        keystate = oi_key_keystate(dev->index, NULL);
+        if(keystate) {
+            for(code=1; code<256; code++) {
+                keysym.sym = evdev_map[code];
+                down = DEVD_TEST(keybits, code);
+                if((keysym.sym != OIK_UNKNOWN) && (keystate[keysym.sym] != down)) {
+                    keysym.scancode = code;
+                    keysym.mod = OIM_NONE;
+                    keyboard_update(dev->index, &keysym, down, post);
+                }
+            }
+        }
+
+        // Mouse buttons only post changes anyway
+        mouse_button(dev->index, OIP_BUTTON_LEFT, DEVD_TEST(keybits, BTN_LEFT), post);
+        mouse_button(dev->index, OIP_BUTTON_MIDDLE, DEVD_TEST(keybits, BTN_MIDDLE), post);
+        mouse_button(dev->index, OIP_BUTTON_RIGHT, DEVD_TEST(keybits, BTN_RIGHT), post);
+
+        // Joystick buttons
+        joy = (struct oi_privjoy*)device_priv(dev->index, OI_PRO_JOYSTICK);
+        if(joy) {
+            for(axis=0; axis<priv->numbtn; axis++) {
+                joystick_setbutton(joy, dev->index, axis,
+                                   DEVD_TEST(keybits, priv->btnmap[axis]), FALSE);
+            }
+        }
+    }
+
+    // Absolute axes through the normal path
+    for(code=0; code<ABS_MISC; code++) {
+        if(priv->axismap[code] == DEVD_NO_AXIS) {
+            continue;
+        }
+        if(ioctl(priv->fd, EVIOCGABS(code), &info) >= 0) {
+            struct input_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.type = EV_ABS;
+            ev.code = code;
+            ev.value = info.value;
+            evdev_event(dev, &ev);
+        }
+    }
+    if(priv->axpend && !post) {
+        joy = (struct oi_privjoy*)device_priv(dev->index, OI_PRO_JOYSTICK);
+        while(joy && priv->axpend) {
+            axis = OI_CTZ(priv->axpend);
+            priv->axpend &= priv->axpend - 1;
+            joystick_setaxis(joy, dev->joyconfig, dev->index, axis,
+                             priv->axes[axis], OI_DISABLE, FALSE);
+        }
+    }
+    priv->stamp = 0;
+    evdev_frame(dev);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Prepare keycode lookup table
+ *
+ * Expand the evdev_keys pairs into the direct lookup table.
+ */
+void evdev_keymap() {
+    unsigned int i;
+
+    if(evdev_mapready) {
+        return;
+    }
+
+    memset(evdev_map, 0, sizeof(evdev_map));
+    for(i=0; i<TABLESIZE(evdev_keys); i++) {
+        if(evdev_keys[i][0] < 256) {
+            evdev_map[evdev_keys[i][0]] = evdev_keys[i][1];
+        }
+    }
+    evdev_mapready = TRUE;
+}
+
+/* ******************************************************************** */
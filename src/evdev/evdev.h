@@ -0,0 +1,115 @@
+/*
+ * evdev.h: GNU/Linux event device driver
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+#ifndef _OPENINPUT_EVDEV_H_
+#define _OPENINPUT_EVDEV_H_
+
+/* ******************************************************************** */
+
+// Bootstrap entries
+int evdev_avail(unsigned int flags);
+oi_device *evdev_device();
+int evdev_hotplug(char *node, char added);
+
+/* ******************************************************************** */
+
+// Device entries
+int evdev_init(oi_device *dev, char *window_id, unsigned int flags);
+int evdev_destroy(oi_device *dev);
+void evdev_process(oi_device *dev);
+int evdev_grab(oi_device *dev, int on);
+int evdev_reset(oi_device *dev);
+
+/* ******************************************************************** */
+
+// Misc local functions
+int evdev_open(unsigned char num);
+unsigned char evdev_find(unsigned char num);
+unsigned int evdev_probe(oi_device *dev);
+void evdev_event(oi_device *dev, struct input_event *ev);
+void evdev_frame(oi_device *dev);
+void evdev_sync(oi_device *dev, char post);
+void evdev_keymap();
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @{
+ */
+#define DEVD_MAX_DEVS 32         /**< Max event devices */
+#define DEVD_NAME_SIZE 128       /**< Length of a device name (kernel) */
+#define DEVD_READ_EVENTS 64      /**< Max events fetched per read() */
+#define DEVD_FRAME_KEYS 32       /**< Max key changes buffered per frame */
+#define DEVD_MAX_BUTTONS 32      /**< Max joystick buttons */
+#define DEVD_NO_AXIS 0xff        /**< Unmapped absolute axis */
+#define DEVD_ENVIRONMENT "OI_EVDEV" /**< Environment variable with device list */
+/** @} */
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Event device driver private instance data
+ *
+ * Private data for a single event device: The file handle,
+ * the mapping of kernel codes to OpenInput buttons and axes,
+ * and the state of the frame (events up to the next SYN_REPORT)
+ * currently being read.
+ *
+ * Note that this driver can handle several devices!
+ */
+typedef struct evdev_private {
+    int fd;                                  /**< File descriptor */
+    unsigned char id;                        /**< Device number, ie. X in /dev/input/eventX */
+    char name[DEVD_NAME_SIZE];               /**< Kernel device name */
+    char replay;                             /**< Not a real device (no ioctls) */
+    char grabbed;                            /**< Exclusive access (EVIOCGRAB) */
+    char dropped;                            /**< Skipping to next SYN_REPORT */
+    char rest[sizeof(struct input_event)];   /**< Incomplete record from last read */
+    int restlen;                             /**< Bytes in incomplete record */
+
+    unsigned char axismap[ABS_CNT];          /**< Absolute code to joystick axis */
+    int absmin[ABS_CNT];                     /**< Absolute axis minimum */
+    int absmax[ABS_CNT];                     /**< Absolute axis maximum */
+    unsigned short btnmap[DEVD_MAX_BUTTONS]; /**< Joystick button to key code */
+    unsigned char numbtn;                    /**< Number of joystick buttons */
+
+    oi_time stamp;                           /**< Frame timestamp */
+    int relx;                                /**< Frame horizontal motion */
+    int rely;                                /**< Frame vertical motion */
+    int wheel;                               /**< Frame wheel clicks */
+    int hwheel;                              /**< Frame horizontal wheel clicks */
+    int wheelhi;                             /**< Frame high-res wheel motion */
+    int hwheelhi;                            /**< Frame high-res horizontal wheel */
+    char hires;                              /**< Device has high-res wheel */
+    unsigned short keys[DEVD_FRAME_KEYS];    /**< Frame key codes, in order */
+    char keydown[DEVD_FRAME_KEYS];           /**< Frame key states */
+    unsigned char numkeys;                   /**< Frame key changes */
+    int axes[OI_JOY_NUM_AXES];               /**< Frame joystick axis values */
+    unsigned int axpend;                     /**< Frame joystick axes changed */
+} evdev_private;
+
+/* ******************************************************************** */
+
+#endif
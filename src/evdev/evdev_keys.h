@@ -0,0 +1,156 @@
+/*
+ * evdev_keys.h: Linux input keycode to OpenInput key table
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+#ifndef _OPENINPUT_EVDEV_KEYS_H_
+#define _OPENINPUT_EVDEV_KEYS_H_
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DEvdev
+ * @brief Keycode translation pairs
+ *
+ * Pairs of Linux input keycode (KEY_*) and OpenInput key. The
+ * kernel keycodes are positional (like PC scancodes), so this
+ * table assumes a US layout. The table is expanded into a direct
+ * lookup table by evdev_keymap.
+ */
+const unsigned short evdev_keys[][2] = {
+    { KEY_ESC,          OIK_ESC },
+    { KEY_1,            OIK_1 },
+    { KEY_2,            OIK_2 },
+    { KEY_3,            OIK_3 },
+    { KEY_4,            OIK_4 },
+    { KEY_5,            OIK_5 },
+    { KEY_6,            OIK_6 },
+    { KEY_7,            OIK_7 },
+    { KEY_8,            OIK_8 },
+    { KEY_9,            OIK_9 },
+    { KEY_0,            OIK_0 },
+    { KEY_MINUS,        OIK_MINUS },
+    { KEY_EQUAL,        OIK_EQUALS },
+    { KEY_BACKSPACE,    OIK_BACKSPACE },
+    { KEY_TAB,          OIK_TAB },
+    { KEY_Q,            OIK_Q },
+    { KEY_W,            OIK_W },
+    { KEY_E,            OIK_E },
+    { KEY_R,            OIK_R },
+    { KEY_T,            OIK_T },
+    { KEY_Y,            OIK_Y },
+    { KEY_U,            OIK_U },
+    { KEY_I,            OIK_I },
+    { KEY_O,            OIK_O },
+    { KEY_P,            OIK_P },
+    { KEY_LEFTBRACE,    OIK_LEFTBRACKET },
+    { KEY_RIGHTBRACE,   OIK_RIGHTBRACKET },
+    { KEY_ENTER,        OIK_RETURN },
+    { KEY_LEFTCTRL,     OIK_LCTRL },
+    { KEY_A,            OIK_A },
+    { KEY_S,            OIK_S },
+    { KEY_D,            OIK_D },
+    { KEY_F,            OIK_F },
+    { KEY_G,            OIK_G },
+    { KEY_H,            OIK_H },
+    { KEY_J,            OIK_J },
+    { KEY_K,            OIK_K },
+    { KEY_L,            OIK_L },
+    { KEY_SEMICOLON,    OIK_SEMICOLON },
+    { KEY_APOSTROPHE,   OIK_QUOTE },
+    { KEY_GRAVE,        OIK_BACKQUOTE },
+    { KEY_LEFTSHIFT,    OIK_LSHIFT },
+    { KEY_BACKSLASH,    OIK_BACKSLASH },
+    { KEY_Z,            OIK_Z },
+    { KEY_X,            OIK_X },
+    { KEY_C,            OIK_C },
+    { KEY_V,            OIK_V },
+    { KEY_B,            OIK_B },
+    { KEY_N,            OIK_N },
+    { KEY_M,            OIK_M },
+    { KEY_COMMA,        OIK_COMMA },
+    { KEY_DOT,          OIK_PERIOD },
+    { KEY_SLASH,        OIK_SLASH },
+    { KEY_RIGHTSHIFT,   OIK_RSHIFT },
+    { KEY_KPASTERISK,   OIK_N_MULTIPLY },
+    { KEY_LEFTALT,      OIK_LALT },
+    { KEY_SPACE,        OIK_SPACE },
+    { KEY_CAPSLOCK,     OIK_CAPSLOCK },
+    { KEY_F1,           OIK_F1 },
+    { KEY_F2,           OIK_F2 },
+    { KEY_F3,           OIK_F3 },
+    { KEY_F4,           OIK_F4 },
+    { KEY_F5,           OIK_F5 },
+    { KEY_F6,           OIK_F6 },
+    { KEY_F7,           OIK_F7 },
+    { KEY_F8,           OIK_F8 },
+    { KEY_F9,           OIK_F9 },
+    { KEY_F10,          OIK_F10 },
+    { KEY_NUMLOCK,      OIK_NUMLOCK },
+    { KEY_SCROLLLOCK,   OIK_SCROLLOCK },
+    { KEY_KP7,          OIK_N_7 },
+    { KEY_KP8,          OIK_N_8 },
+    { KEY_KP9,          OIK_N_9 },
+    { KEY_KPMINUS,      OIK_N_MINUS },
+    { KEY_KP4,          OIK_N_4 },
+    { KEY_KP5,          OIK_N_5 },
+    { KEY_KP6,          OIK_N_6 },
+    { KEY_KPPLUS,       OIK_N_PLUS },
+    { KEY_KP1,          OIK_N_1 },
+    { KEY_KP2,          OIK_N_2 },
+    { KEY_KP3,          OIK_N_3 },
+    { KEY_KP0,          OIK_N_0 },
+    { KEY_KPDOT,        OIK_N_PERIOD },
+    { KEY_102ND,        OIK_LESS },
+    { KEY_F11,          OIK_F11 },
+    { KEY_F12,          OIK_F12 },
+    { KEY_KPENTER,      OIK_N_ENTER },
+    { KEY_RIGHTCTRL,    OIK_RCTRL },
+    { KEY_KPSLASH,      OIK_N_DIVIDE },
+    { KEY_SYSRQ,        OIK_PRINT },
+    { KEY_RIGHTALT,     OIK_RALT },
+    { KEY_HOME,         OIK_HOME },
+    { KEY_UP,           OIK_UP },
+    { KEY_PAGEUP,       OIK_PAGEUP },
+    { KEY_LEFT,         OIK_LEFT },
+    { KEY_RIGHT,        OIK_RIGHT },
+    { KEY_END,          OIK_END },
+    { KEY_DOWN,         OIK_DOWN },
+    { KEY_PAGEDOWN,     OIK_PAGEDOWN },
+    { KEY_INSERT,       OIK_INSERT },
+    { KEY_DELETE,       OIK_DELETE },
+    { KEY_POWER,        OIK_POWER },
+    { KEY_KPEQUAL,      OIK_N_EQUALS },
+    { KEY_PAUSE,        OIK_PAUSE },
+    { KEY_LEFTMETA,     OIK_LWINDOWS },
+    { KEY_RIGHTMETA,    OIK_RWINDOWS },
+    { KEY_COMPOSE,      OIK_MENU },
+    { KEY_UNDO,         OIK_UNDO },
+    { KEY_HELP,         OIK_HELP },
+    { KEY_MENU,         OIK_MENU },
+    { KEY_F13,          OIK_F13 },
+    { KEY_F14,          OIK_F14 },
+    { KEY_F15,          OIK_F15 }
+};
+
+/* ******************************************************************** */
+
+#endif
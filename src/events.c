@@ -30,6 +30,10 @@
 #include <unistd.h>
 #endif
 
+#ifdef HAVE_POLL_H
+#include <poll.h>
+#endif
+
 #if defined(ENABLE_WIN32) || defined(ENABLE_DX9)
 #include <windows.h>
 #endif
@@ -39,6 +43,8 @@
 
 // Globals
 static unsigned int event_mask = 0;
+static int watch_fds[OI_MAX_WATCH];
+static unsigned int num_watch = 0;
 
 /* ******************************************************************** */
 
@@ -133,6 +139,7 @@ int oi_events_add(oi_event *evts, int num) {
 void oi_events_pump() {
     static unsigned int last = 0;
     unsigned int now;
+    oi_time start;
 
     // Bail out if 'no time' has passed
     now = oi_getticks();
@@ -142,6 +149,8 @@ void oi_events_pump() {
     last = now;
 
     // The very essence of OpenInput is the following lines
+    start = oi_gettime();
+    trace_add(OI_TRACE_PUMP, 0, TRUE);
     queue_lock();
 
     action_clearreal();
@@ -150,6 +159,13 @@ void oi_events_pump() {
     joystick_pump();
 
     queue_unlock();
+    trace_add(OI_TRACE_PUMP, 0, FALSE);
+    stats_pump(oi_gettime() - start);
+
+    // Debug builds get their messages right away
+#ifdef DEBUG
+    oi_log_flush();
+#endif
 }
 
 /* ******************************************************************** */
@@ -219,6 +235,19 @@ void oi_events_wait(oi_event *evt) {
             Sleep(OI_SLEEP);
             
         }
+#elif HAVE_POLL
+        {
+            // Sleep, but wake up as soon as a watched descriptor has data
+            struct pollfd fds[OI_MAX_WATCH];
+            unsigned int i;
+
+            for(i=0; i<num_watch; i++) {
+                fds[i].fd = watch_fds[i];
+                fds[i].events = POLLIN;
+                fds[i].revents = 0;
+            }
+            poll(fds, num_watch, OI_SLEEP);
+        }
 #elif HAVE_NANOSLEEP
         {
             // Use nanosleep under POSIX
@@ -270,3 +299,62 @@ unsigned int oi_events_getmask() {
 }
 
 /* ******************************************************************** */
+
+/**
+ * @ingroup PEvents
+ * @brief Get timestamp of last event
+ *
+ * @returns timestamp in nanoseconds
+ *
+ * Return the time at which the event most recently returned by
+ * oi_events_poll or oi_events_wait occured. Drivers which know
+ * the exact hardware time (like evdev) report that, otherwise the
+ * time the event was queued is used. Only differences between
+ * timestamps are meaningful, see oi_time.
+ */
+oi_time oi_events_timestamp() {
+    return queue_timestamp();
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IQueue
+ * @brief Watch a descriptor in the wait loop
+ *
+ * @param fd file descriptor
+ * @param on true (1) to add, false (0) to remove
+ * @returns errorcode, see @ref PErrors
+ *
+ * Drivers which get their input on a file descriptor can
+ * have oi_events_wait wake up as soon as it becomes readable,
+ * instead of at the next tick. Only used where poll is available.
+ */
+int events_watch(int fd, char on) {
+    unsigned int i;
+
+    for(i=0; i<num_watch; i++) {
+        if(watch_fds[i] == fd) {
+            break;
+        }
+    }
+
+    // Remove, move the last one into the gap
+    if(!on) {
+        if(i < num_watch) {
+            watch_fds[i] = watch_fds[--num_watch];
+        }
+        return OI_ERR_OK;
+    }
+
+    // Add if not already there
+    if(i == num_watch) {
+        if(num_watch >= OI_MAX_WATCH) {
+            return OI_ERR_INDEX;
+        }
+        watch_fds[num_watch++] = fd;
+    }
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
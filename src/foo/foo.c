@@ -162,6 +162,11 @@ int foo_init(oi_device *dev, char *window_id, unsigned int flags) {
     priv->x = 0;
     priv->y = 0;
 
+    // Pretend to be a slow device, for latency tests
+    if(getenv(DFOO_DELAY_ENVIRONMENT)) {
+        priv->delay = (oi_time)atoi(getenv(DFOO_DELAY_ENVIRONMENT)) * 1000;
+    }
+
     return OI_ERR_OK;
 }
 
@@ -209,9 +214,13 @@ int foo_destroy(oi_device *dev) {
  * are inserted - all state managers should have an
  * event injected, and a direct queue insertion should
  * also be performed.
+ *
+ * With OI_FOO_DELAY set, events are stamped that many
+ * microseconds in the past, as if read from a slow device.
  */
 void foo_process(oi_device *dev) {
     static oi_event ev;
+    foo_private *priv;
 
     debug("foo_process");
 
@@ -223,12 +232,15 @@ void foo_process(oi_device *dev) {
     // Since this is a test device, generate an event
     ev.type = OI_KEYDOWN;
     ev.key.device = dev->index;
-    ev.key.state = 1;
     ev.key.keysym.scancode = 65;
     ev.key.keysym.sym = OIK_A;
     ev.key.keysym.mod = OIM_NONE;
 
     // Post event
+    priv = (foo_private*)dev->private;
+    if(priv->delay) {
+        queue_stamp(oi_gettime() - priv->delay);
+    }
     queue_add(&ev);
 }
 
@@ -27,8 +27,8 @@
 /* ******************************************************************** */
 
 // Bootstrap
-int foo_avail();
-oi_device *foo_device(unsigned int flags);
+int foo_avail(unsigned int flags);
+oi_device *foo_device();
 
 // Device
 int foo_init(oi_device *dev, char *window_id, unsigned int flags);
@@ -54,8 +54,18 @@ typedef struct foo_private {
     int cursorstatus; /**< Cursor shown of hidden */
     int x;            /**< Cursor horizontal position */
     int y;            /**< Cursor vertical position */
+    oi_time delay;    /**< Age of events when queued, in nanoseconds */
 } foo_private;
 
 /* ******************************************************************** */
 
+/**
+ * @ingroup DFoo
+ * @{
+ */
+#define DFOO_DELAY_ENVIRONMENT "OI_FOO_DELAY" /**< Environment variable with event age in microseconds */
+/** @} */
+
+/* ******************************************************************** */
+
 #endif
@@ -0,0 +1,166 @@
+/*
+ * hotplug.c : Watch for devices being added and removed
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_SYS_INOTIFY_H
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/inotify.h>
+#endif
+
+#include "openinput.h"
+#include "internal.h"
+
+// Globals
+static int hot_fd = -1;
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Start watching the device node directory
+ *
+ * @param flags library initialization flags, see @ref PFlags
+ * @returns errorcode, see @ref PErrors
+ *
+ * Called on library initialization after the devices have been
+ * bootstrapped. On systems with inotify, the device node directory
+ * (see device_nodedir) is watched for nodes being created,
+ * changing permissions or being removed.
+ */
+int hotplug_init(unsigned int flags) {
+    debug("hotplug_init");
+
+    hotplug_close();
+    if(flags & OI_FLAG_NOHOTPLUG) {
+        return OI_ERR_OK;
+    }
+
+#ifdef HAVE_SYS_INOTIFY_H
+    // Non-blocking, we're read from the pump
+    hot_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(hot_fd == -1) {
+        return OI_ERR_NOT_IMPLEM;
+    }
+
+    // Permission changes matter too, udev chmods nodes after creation
+    if(inotify_add_watch(hot_fd, device_nodedir(),
+                         IN_CREATE | IN_ATTRIB | IN_DELETE |
+                         IN_MOVED_FROM | IN_MOVED_TO) == -1) {
+        log_info("hotplug_init: cannot watch '%s'", device_nodedir());
+        close(hot_fd);
+        hot_fd = -1;
+        return OI_ERR_NO_DEVICE;
+    }
+
+    return OI_ERR_OK;
+#else
+    return OI_ERR_NOT_IMPLEM;
+#endif
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Stop watching the device node directory
+ *
+ * @returns errorcode, see @ref PErrors
+ *
+ * Called on library shutdown.
+ */
+int hotplug_close() {
+#ifdef HAVE_SYS_INOTIFY_H
+    if(hot_fd != -1) {
+        close(hot_fd);
+    }
+#endif
+    hot_fd = -1;
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Handle pending hotplug notifications
+ *
+ * Called at the start of every device pump. The notifications
+ * are read without blocking and passed on to device_hotplug,
+ * which lets the drivers claim new nodes and remove devices whose
+ * nodes are gone. If the kernel notification queue overflowed,
+ * all nodes in the directory are offered again, as drivers ignore
+ * nodes they already have open.
+ */
+void hotplug_pump() {
+#ifdef HAVE_SYS_INOTIFY_H
+    char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    struct inotify_event *ev;
+    struct dirent *ent;
+    DIR *dir;
+    int num;
+    int i;
+
+    if(hot_fd == -1) {
+        return;
+    }
+
+    // Nothing pending is the common case, and costs a single syscall
+    while((num = read(hot_fd, buf, sizeof(buf))) > 0) {
+        for(i=0; i<num; i += sizeof(struct inotify_event) + ev->len) {
+            ev = (struct inotify_event*)(buf+i);
+
+            // Lost notifications, rescan everything
+            if(ev->mask & IN_Q_OVERFLOW) {
+                debug("hotplug_pump: queue overflow, rescanning");
+                dir = opendir(device_nodedir());
+                while(dir && ((ent = readdir(dir)) != NULL)) {
+                    if(ent->d_name[0] != '.') {
+                        device_hotplug(ent->d_name, TRUE);
+                    }
+                }
+                if(dir) {
+                    closedir(dir);
+                }
+                continue;
+            }
+
+            // Only nodes in the directory are interesting
+            if((ev->len == 0) || (ev->mask & IN_ISDIR)) {
+                continue;
+            }
+
+            debug("hotplug_pump: '%s' mask 0x%x", ev->name, ev->mask);
+            device_hotplug(ev->name, (ev->mask & (IN_DELETE | IN_MOVED_FROM)) ? FALSE : TRUE);
+        }
+    }
+#endif
+}
+
+/* ******************************************************************** */
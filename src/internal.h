@@ -83,8 +83,42 @@ typedef struct oi_bootstrap {
     unsigned int provides;                                             /**< Device provide-flag */
     int (*avail)(unsigned int flags);                                  /**< Is device available (fcnptr) */
     struct oi_device *(*create)();                                     /**< Return device structure (fcnptr) */
+    int (*hotplug)(char *node, char added);                            /**< Claim hotplugged device node (fcnptr, optional) */
 } oi_bootstrap;
 
+/**
+ * @ingroup IDevstructs
+ * @brief Recording file header
+ *
+ * Start of an event recording, see oi_events_record. The byte
+ * order mark and event size make sure a recording is only read
+ * back by a library with the same binary event layout.
+ */
+typedef struct oi_rechead {
+    char magic[4];                                                     /**< OI_REC_MAGIC */
+    unsigned short version;                                            /**< OI_REC_VERSION */
+    unsigned short order;                                              /**< OI_REC_ORDER in native byte order */
+    unsigned int evsize;                                               /**< Size of an oi_event */
+    unsigned int entsize;                                              /**< Size of an oi_recentry */
+    oi_time start;                                                     /**< Time recording started */
+} oi_rechead;
+
+/**
+ * @ingroup IDevstructs
+ * @brief Recording entry
+ *
+ * An event as it was added to the queue, with its timestamp.
+ * Discovery and removal entries are followed by the device name
+ * and description (zero terminated), and the size is padded to
+ * keep the next entry aligned, so entries can be used in place.
+ */
+typedef struct oi_recentry {
+    oi_time stamp;                                                     /**< Event timestamp */
+    unsigned int size;                                                 /**< Size of entry including strings */
+    unsigned int pad;                                                  /**< Unused, zero */
+    oi_event event;                                                    /**< The event, pointers cleared */
+} oi_recentry;
+
 /* ******************************************************************** */
 // Special functions
 
@@ -92,6 +126,15 @@ char oi_runstate();
 
 unsigned int oi_getticks();
 
+oi_time oi_gettime();
+
+unsigned int oi_ctz(unsigned int x);
+
+int oi_number(char *str,
+              int max);
+
+int log_init();
+
 /* ******************************************************************** */
 // Internal queue functions
 
@@ -110,6 +153,83 @@ int queue_peep(oi_event *evts,
                unsigned int mask,
                char remove);
 
+void queue_stamp(oi_time stamp);
+
+oi_time queue_nextstamp();
+
+oi_time queue_timestamp();
+
+int events_watch(int fd, char on);
+
+/* ******************************************************************** */
+// Event recorder
+
+int record_add(oi_event *evt, oi_time stamp);
+
+int record_close();
+
+/* ******************************************************************** */
+// Statistics
+
+void stats_queue(oi_event *evt,
+                 char added,
+                 unsigned int depth);
+
+void stats_merge(unsigned char type,
+                 unsigned int num);
+
+void stats_filter(unsigned char type);
+
+void stats_pump(oi_time duration);
+
+void stats_action(char posted);
+
+void stats_read(unsigned char index);
+
+void stats_device(unsigned char index);
+
+int latency_init(unsigned int flags);
+
+void latency_add(unsigned char type,
+                 oi_time stamp);
+
+/* ******************************************************************** */
+// Trace ring
+
+int trace_init();
+
+void trace_add(unsigned char stage,
+               unsigned char device,
+               unsigned int type);
+
+void trace_deliver(oi_event *evt);
+
+/**
+ * @ingroup ITrace
+ * @brief Trace ring entry
+ */
+typedef struct oi_trace {
+    oi_time stamp;                                                     /**< Time of the hop */
+    unsigned char stage;                                               /**< Pipeline stage */
+    unsigned char device;                                              /**< Device index */
+    unsigned short pad;                                                /**< Unused */
+    unsigned int type;                                                 /**< Event type or native code */
+} oi_trace;
+
+/**
+ * @ingroup ITrace
+ * @defgroup ITraceStages Pipeline stages
+ * @brief Stages recorded in the trace ring
+ * @{
+ */
+#define OI_TRACE_DRIVER 0                                              /**< Native event read by driver */
+#define OI_TRACE_MANAGER 1                                             /**< State manager update */
+#define OI_TRACE_QUEUE 2                                               /**< Event queued */
+#define OI_TRACE_DROP 3                                                /**< Event dropped, queue full */
+#define OI_TRACE_DELIVER 4                                             /**< Event removed by application */
+#define OI_TRACE_PUMP 5                                                /**< Pump begins (type 1) or ends (type 0) */
+/** @} */
+
 /* ******************************************************************** */
 // Device handling
 
@@ -133,9 +253,60 @@ int device_destroy(unsigned char index);
 
 void device_moreavail(char more);
 
+int device_remove(unsigned char index);
+
+int device_hotplug(char *node,
+                   char added);
+
+int device_probe(oi_bootstrap *boot);
+
+void device_wakeup(unsigned int provides);
+
+char *device_nodedir();
+
+char device_wanted(char *name);
+
 void *device_priv(unsigned char index,
                   unsigned int manager);
 
+int device_close();
+
+unsigned char device_alloc();
+
+int device_arena(char on);
+
+void device_release(unsigned char index);
+
+void device_forget(unsigned char index);
+
+unsigned char device_live(unsigned int n);
+
+unsigned char device_first(unsigned int manager);
+
+unsigned int device_handle(unsigned char index);
+
+oi_device *device_lookup(unsigned int handle);
+
+/* ******************************************************************** */
+// Driver plugins
+
+char *plugin_dir();
+
+int plugin_load();
+
+oi_bootstrap *plugin_get(unsigned int n);
+
+int plugin_close();
+
+/* ******************************************************************** */
+// Hotplug watcher
+
+int hotplug_init(unsigned int flags);
+
+int hotplug_close();
+
+void hotplug_pump();
+
 /* ******************************************************************** */
 // Application state
 
@@ -160,7 +331,7 @@ int appstate_height();
 
 int mouse_init();
 
-void mouse_manage(struct oi_privmouse **mouse,
+void mouse_manage(struct oi_privmouse *mouse,
                   unsigned int provide);
 
 void mouse_move(unsigned char index,
@@ -174,12 +345,17 @@ void mouse_button(unsigned char index,
                   char down,
                   char post);
 
+void mouse_wheel(unsigned char index,
+                 int vert,
+                 int horiz,
+                 char post);
+
 /* ******************************************************************** */
 // Keyboard state
 
 int keyboard_init();
 
-void keyboard_manage(struct oi_privkey **key,
+void keyboard_manage(struct oi_privkey *key,
                      unsigned int provide);
 
 int keyboard_fillnames(char **kn);
@@ -205,7 +381,7 @@ int joystick_init();
 
 int joystick_close();
 
-void joystick_manage(struct oi_privjoy **joy,
+void joystick_manage(struct oi_privjoy *joy,
                      unsigned int provide);
 
 void joystick_axis(unsigned char index,
@@ -214,16 +390,42 @@ void joystick_axis(unsigned char index,
                    oi_bool relative,
                    char post);
 
+void joystick_setaxis(struct oi_privjoy *priv,
+                      struct oi_joyconfig *conf,
+                      unsigned char index,
+                      unsigned char axis,
+                      int value,
+                      oi_bool relative,
+                      char post);
+
 void joystick_button(unsigned char index,
                      unsigned char btn,
                      char down,
                      char post);
 
+void joystick_setbutton(struct oi_privjoy *priv,
+                        unsigned char index,
+                        unsigned char btn,
+                        char down,
+                        char post);
+
 int joystick_hatpos(int x,
                     int y);
 
 void joystick_pump();
 
+void joystick_tag(unsigned char index);
+
+unsigned char joystick_find(unsigned char index);
+
+unsigned int joystick_calibrate(struct oi_privjoy *priv,
+                                struct oi_joyconfig *conf);
+
+void joystick_kernel(struct oi_privjoy *priv,
+                     struct oi_joyconfig *conf);
+
+char joystick_simd(char on);
+
 /**
  * @ingroup IJoystick
  * @brief Joystick device configuration
@@ -242,12 +444,18 @@ void joystick_pump();
  * number can be used to find the twin-brother. A pair-number of
  * zero denotes a no-pair. Not all platforms may need pairing.
  * So far, Linux does as balls and hats are two-axis
+ *
+ * If "calibrated" is set, absolute axes are passed through the
+ * calibration profile in "calib" by the joystick pump. Drivers
+ * may leave this zeroed (uncalibrated).
  */
 typedef struct oi_joyconfig {
     char *name;                                                       /**< Name of joystick */
     unsigned char buttons;                                            /**< Number of buttons */
     oi_joytype kind[OI_JOY_NUM_AXES];                                 /**< Axis "type" mapping */
     unsigned char pair[OI_JOY_NUM_AXES];                              /**< Ball/stick/hat pairing */
+    char calibrated;                                                  /**< Calibration profile is active */
+    oi_joycalib calib;                                                /**< Calibration profile */
 } oi_joyconfig;
 
 /* ******************************************************************** */
@@ -277,24 +485,99 @@ void action_statepost(oi_event *evt);
  */
 typedef struct oi_aclink {
     unsigned int action;                                               /**< Action id */
-    unsigned char device;                                              /**< Device index */
+    unsigned int device;                                               /**< Device handle (see device_handle), 0 for any */
     struct oi_aclink *next;                                            /**< Next pointer */
 } oi_aclink;
 
 /* ******************************************************************** */
 
-// Debug macro
+// Highest log level compiled in, see @ref PLog
+#ifndef OI_LOG_MAX
 #ifdef DEBUG
-void debug(char *format, ...);
-#elif __GNUC__
-#define debug(format, args...) ((void)0)
+#define OI_LOG_MAX OI_LOG_DEBUG
 #else
+#define OI_LOG_MAX OI_LOG_INFO
+#endif
+#endif
+
+// Log macros, disabled levels cost nothing or a compare
+extern int log_level;
+#ifdef __GNUC__
+void log_add(int level, char *format, ...) __attribute__((format(printf, 2, 3)));
+#else
+void log_add(int level, char *format, ...);
+#endif
+#if defined(__GNUC__) || (defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)) || \
+    (defined(_MSC_VER) && (_MSC_VER >= 1400))
+#define OI_LOG(level, ...) ((((level) <= OI_LOG_MAX) && ((level) <= log_level)) ? \
+                            log_add((level), __VA_ARGS__) : (void)0)
+#define log_error(...) OI_LOG(OI_LOG_ERROR, __VA_ARGS__)
+#define log_warn(...) OI_LOG(OI_LOG_WARN, __VA_ARGS__)
+#define log_info(...) OI_LOG(OI_LOG_INFO, __VA_ARGS__)
+#define debug(...) OI_LOG(OI_LOG_DEBUG, __VA_ARGS__)
+#else
+// Without variadic macros, levels not compiled in are never evaluated
+void log_error(char *format, ...);
+void log_warn(char *format, ...);
+#if OI_LOG_MAX >= OI_LOG_INFO
+void log_info(char *format, ...);
+#else
+#define log_info (void)sizeof
+#endif
+#if OI_LOG_MAX >= OI_LOG_DEBUG
 void debug(char *format, ...);
+#else
+#define debug (void)sizeof
+#endif
 #endif
 
 // Table size helper
 #define TABLESIZE(table) (sizeof(table)/sizeof(table[0]))
 
+// Round up to multiple of a power of two
+#define OI_ALIGN(x, a) (((x) + (a) - 1) & ~((a) - 1))
+
+// Index of lowest set bit, argument must be non-zero
+#ifdef __GNUC__
+#define OI_CTZ(x) ((unsigned int)__builtin_ctz(x))
+#else
+#define OI_CTZ(x) oi_ctz(x)
+#endif
+
+// Keep data on its own cache line
+#ifdef __GNUC__
+#define OI_CACHEALIGN __attribute__((aligned(OI_ARENA_ALIGN)))
+#else
+#define OI_CACHEALIGN
+#endif
+
+// Device index of event, zero for events without one
+#define OI_EVDEVICE(e) ((((e)->type == OI_QUIT) || ((e)->type == OI_EXPOSE) || \
+                         ((e)->type == OI_SIGNAL)) ? 0 : (e)->key.device)
+
+// Static tracepoints, see @ref IProbe
+#ifdef ENABLE_PROBES
+#include <sys/sdt.h>
+#define OI_PROBE1(name, a) DTRACE_PROBE1(openinput, name, a)
+#define OI_PROBE2(name, a, b) DTRACE_PROBE2(openinput, name, a, b)
+#define OI_PROBE3(name, a, b, c) DTRACE_PROBE3(openinput, name, a, b, c)
+#define OI_PROBE4(name, a, b, c, d) DTRACE_PROBE4(openinput, name, a, b, c, d)
+#else
+#define OI_PROBE1(name, a)
+#define OI_PROBE2(name, a, b)
+#define OI_PROBE3(name, a, b, c)
+#define OI_PROBE4(name, a, b, c, d)
+#endif
+
+// Per-thread data
+#if defined(__GNUC__)
+#define OI_THREADLOCAL __thread
+#elif defined(_MSC_VER)
+#define OI_THREADLOCAL __declspec(thread)
+#else
+#define OI_THREADLOCAL
+#endif
+
 // True and false
 #ifndef TRUE
 #define TRUE 1
@@ -309,11 +592,38 @@ void debug(char *format, ...);
  * @brief Various constants for internal library use
  * @{
  */
-#define OI_MAX_DEVICES 64                                              /**< Max number of attached devices */
+#define OI_MAX_DEVICES 255                                             /**< Max number of attached devices (index is a byte) */
+#define OI_MIN_DEVSLOTS 8                                              /**< Initial size of device table */
+#define OI_ARENA_ALIGN 64                                              /**< Alignment of manager arrays (cache line) */
 #define OI_MAX_EVENTS 128                                              /**< Size of event queue */
 #define OI_SLEEP 1                                                     /**< Ms to sleep in busy wait-loop */
+#define OI_MAX_WATCH 8                                                 /**< Max descriptors watched by the wait-loop */
+#define OI_MAX_FILTERS 8                                               /**< Max event filters */
+#define OI_REC_MAGIC "OIRC"                                            /**< Recording file magic */
+#define OI_REC_VERSION 1                                               /**< Recording file format version */
+#define OI_REC_ORDER 0x0102                                            /**< Recording byte order mark */
+#define OI_REC_ALIGN 8                                                 /**< Alignment of recording entries */
+#define OI_TRACE_SIZE 2048                                             /**< Entries in trace ring (power of two) */
+#define OI_TRACE_ENVIRONMENT "OI_TRACE"                                /**< Environment variable naming trace dump on quit */
+#define OI_LAT_SUBBITS 4                                               /**< Latency histogram sub-buckets per power of two (log2) */
+#define OI_LAT_MAXBITS 40                                              /**< Latencies from 2^40 ns up share the last bucket */
+#define OI_LAT_BUCKETS ((OI_LAT_MAXBITS - OI_LAT_SUBBITS + 1) << OI_LAT_SUBBITS) /**< Buckets per latency histogram */
+#define OI_LOG_SIZE 256                                                /**< Messages in log buffer (power of two) */
+#define OI_LOG_LINE 120                                                /**< Max length of log message */
+#define OI_LOG_ENVIRONMENT "OI_LOG"                                    /**< Environment variable setting the log level */
+#define OI_MAX_ACTIONID 65535                                          /**< Highest action id, the state table is indexed by id */
 #define OI_MIN_KEYLENGTH 5                                             /**< Min symbolic event name */
 #define OI_MAX_KEYLENGTH 20                                            /**< Max symbolic event name */
+#define OI_NODE_DIR "/dev/input"                                       /**< Default directory of device nodes */
+#define OI_NODE_ENVIRONMENT "OI_INPUTDIR"                              /**< Environment variable overriding node directory */
+#define OI_PLUGIN_ENVIRONMENT "OI_PLUGINDIR"                           /**< Environment variable overriding plugin directory */
+#define OI_DRIVER_ENVIRONMENT "OI_DRIVERS"                             /**< Environment variable selecting drivers */
+#define OI_MAX_PLUGINS 32                                              /**< Max number of loaded driver plugins */
+#define OI_MAX_PLUGNAME 32                                             /**< Max length of plugin driver name */
+#define OI_MAX_PATH 256                                                /**< Max length of file names */
+#ifndef OI_PLUGIN_DIR
+#define OI_PLUGIN_DIR "/usr/local/lib/openinput"                       /**< Default directory of driver plugins */
+#endif
 
 #define OI_JOY_TAB_AXES 0                                              /**< Lookup table offset for joystick axes */
 #define OI_JOY_TAB_BTNS 1                                              /**< Lookup table offset for joystick buttons */
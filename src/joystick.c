@@ -26,12 +26,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include "openinput.h"
 #include "internal.h"
 #include "private.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 // Globals
-static char *joynames[2][OIJ_LAST];
+static char *joynames[2][OI_JOY_NUM_AXES];
+
+// Dirty-device bitmasks, one bit per device index and one summary
+// bit per non-empty mask word, so an idle pump is a single test
+#define OI_JOY_DIRTY_WORDS ((OI_MAX_DEVICES+31)/32)
+static unsigned int joy_dirty[OI_JOY_DIRTY_WORDS];
+static unsigned int joy_dirtysum;
+
+// Run the SSE2 calibration kernel, tests clear it to compare with scalar
+static char joy_simd = TRUE;
 
 // Joystick string names
 static char *joybases[] = {
@@ -56,15 +70,20 @@ int joystick_init() {
 
     debug("joystick_init");
 
-    // Fill symbolic joystick type class names
-    for(i=0; i<OIJ_LAST; i++) {
+    // Fill symbolic joystick axis and button names
+    joystick_close();
+    for(i=0; i<OI_JOY_NUM_AXES; i++) {
         // Axes
         sprintf(target, joybases[OI_JOY_TAB_AXES], i);
-        strcpy(joynames[OI_JOY_TAB_AXES][i], target);
+        joynames[OI_JOY_TAB_AXES][i] = strdup(target);
 
         // Buttons
-        sprintf(target ,joybases[OI_JOY_TAB_BTNS], i);
-        strcpy(joynames[OI_JOY_TAB_BTNS][i], target);
+        sprintf(target, joybases[OI_JOY_TAB_BTNS], i);
+        joynames[OI_JOY_TAB_BTNS][i] = strdup(target);
+
+        if(!joynames[OI_JOY_TAB_AXES][i] || !joynames[OI_JOY_TAB_BTNS][i]) {
+            return OI_ERR_INTERNAL;
+        }
     }
 
     // Done
@@ -85,10 +104,12 @@ int joystick_init() {
 int joystick_close() {
     int i;
 
-    // Free symbolic joystick type class names
-    for(i=0; i<OIJ_LAST; i++) {
+    // Free symbolic joystick axis and button names
+    for(i=0; i<OI_JOY_NUM_AXES; i++) {
         free(joynames[OI_JOY_TAB_AXES][i]);
         free(joynames[OI_JOY_TAB_BTNS][i]);
+        joynames[OI_JOY_TAB_AXES][i] = NULL;
+        joynames[OI_JOY_TAB_BTNS][i] = NULL;
     }
 
     // Done
@@ -99,37 +120,38 @@ int joystick_close() {
 
 /**
  * @ingroup IJoystick
- * @brief Allocate and prepare private managment data
+ * @brief Prepare private managment data
  *
- * @param joy pointer to the address of the joystick data
+ * @param joy pointer to joystick data in the managment data arena
  * @param provide provide mask, see @ref PProvide
  *
  * @pre This function is called during "device_register" where
- * the base device->managment structure has been allocated and
- * initialized
+ * a slot (and thus room in the managment data arena) has been
+ * allocated for the device
  *
- * This function (possible) allocates and initializes the joystick
- * per-device private managment data, ie. axes positions and button
- * states
+ * This function initializes the joystick per-device private
+ * managment data, ie. axes positions and button states
  *
- * The structure might also not be created, depending on whether
- * the device provides joystick as determined by the provide-mask
+ * Nothing is done if the device does not provide joystick, as
+ * determined by the provide-mask
  */
-void joystick_manage(oi_privjoy **joy, unsigned int provide) {
+void joystick_manage(oi_privjoy *joy, unsigned int provide) {
     // Only care about keyboard
     if(!(provide & OI_PRO_JOYSTICK)) {
         return;
     }
 
-    // Allocate
-    *joy = (oi_privjoy*)malloc(sizeof(oi_privjoy));
-
     // Clear states
-    (*joy)->button = 0;
-    memset((*joy)->relaxes, 0, TABLESIZE((*joy)->relaxes));
-    memset((*joy)->absaxes, 0, TABLESIZE((*joy)->absaxes));
-    memset((*joy)->insaxes, 0, TABLESIZE((*joy)->insaxes));
-    memset((*joy)->update, 0, TABLESIZE((*joy)->update));
+    joy->button = 0;
+    memset(joy->relaxes, 0, sizeof(joy->relaxes));
+    memset(joy->absaxes, 0, sizeof(joy->absaxes));
+    memset(joy->insaxes, 0, sizeof(joy->insaxes));
+    memset(joy->rawaxes, 0, sizeof(joy->rawaxes));
+    joy->update = 0;
+    joy->calpend = 0;
+    joy->calpost = 0;
+    joy->calready = FALSE;
+    joy->stamp = 0;
 
     debug("joystick_manage: manager data installed");
 }
@@ -155,12 +177,23 @@ void joystick_manage(oi_privjoy **joy, unsigned int provide) {
  * tags exes for "update needed". This allows for the post-event generation
  * "joystick_pump" to combine multi-axes things (balls, sticks, etc.) into
  * a single event.
+ *
+ * The tagging is done in two bitmasks: The per-device axis mask and the
+ * global dirty-device mask, such that the pump only visits changed axes.
+ *
+ * If the device is calibrated, absolute values are only stored as raw
+ * values here. The pump runs the calibration kernel on them before
+ * the events are generated.
  */
 void joystick_axis(unsigned char index, unsigned char axis, int value, oi_bool relative, char post) {
     oi_privjoy *priv;
     oi_joyconfig *conf;
-    int corval;
-    char rel;
+
+    // Dummy check
+    if((axis >= OI_JOY_NUM_AXES) || (index < 1) || (index > OI_MAX_DEVICES)) {
+        debug("joystick_axis: axis %u out of range", axis);
+        return;
+    }
 
     // Get private data or bail
     priv = device_priv(index, OI_PRO_JOYSTICK);
@@ -176,6 +209,38 @@ void joystick_axis(unsigned char index, unsigned char axis, int value, oi_bool r
         return;
     }
 
+    joystick_setaxis(priv, conf, index, axis, value, relative, post);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IJoystick
+ * @brief Joystick axis update on resolved device
+ *
+ * @param priv joystick manager data
+ * @param conf joystick configuration
+ * @param index device index
+ * @param axis axis index
+ * @param value axis value
+ * @param relative true or false, if set to OI_QUERY, set depending on axis type
+ * @param post true (1) to post event, false (0) otherwise
+ *
+ * Same as joystick_axis, but for drivers which have already
+ * looked up the manager data and configuration, for example
+ * when injecting a whole batch of updates. The axis index
+ * must be valid.
+ */
+void joystick_setaxis(oi_privjoy *priv, oi_joyconfig *conf, unsigned char index,
+                      unsigned char axis, int value, oi_bool relative, char post) {
+    int corval;
+    char rel;
+
+    trace_add(OI_TRACE_MANAGER, index, OI_JOYAXIS);
+
+    // Events are posted by the pump, keep the driver's frame time
+    priv->stamp = queue_nextstamp();
+
     // Clip value
     if(value > OI_JOY_AXIS_MAX) {
         corval = OI_JOY_AXIS_MAX;
@@ -206,6 +271,19 @@ void joystick_axis(unsigned char index, unsigned char axis, int value, oi_bool r
         priv->relaxes[axis] += corval;
         priv->absaxes[axis] += corval;
     }
+    // Calibrated absolute update, the pump posts it if the output changes
+    else if(conf->calibrated) {
+        priv->rawaxes[axis] = corval;
+        priv->calpend |= 1u << axis;
+        if(post) {
+            if(priv->calpost & (1u << axis)) {
+                stats_merge(OI_JOYAXIS, 1);
+            }
+            priv->calpost |= 1u << axis;
+        }
+        joystick_tag(index);
+        return;
+    }
     // State for absolute update
     else {
         priv->insaxes[axis] = corval - priv->absaxes[axis];
@@ -213,8 +291,34 @@ void joystick_axis(unsigned char index, unsigned char axis, int value, oi_bool r
         priv->absaxes[axis] = corval;
     }
 
-    // Update flag
-    priv->update[axis] |= post;
+    // Tag axis and device for the pump
+    if(post) {
+        if(priv->update & (1u << axis)) {
+            stats_merge(OI_JOYAXIS, 1);
+        }
+        priv->update |= 1u << axis;
+        joystick_tag(index);
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IJoystick
+ * @brief Tag device for the joystick pump
+ *
+ * @param index device index
+ *
+ * Set the device bit in the dirty-device mask, so the next
+ * joystick_pump will look at the axes of the device.
+ */
+void joystick_tag(unsigned char index) {
+    if((index < 1) || (index > OI_MAX_DEVICES)) {
+        return;
+    }
+
+    joy_dirty[(index-1) / 32] |= 1u << ((index-1) % 32);
+    joy_dirtysum |= 1u << ((index-1) / 32);
 }
 
 /* ******************************************************************** */
@@ -231,8 +335,6 @@ void joystick_axis(unsigned char index, unsigned char axis, int value, oi_bool r
  * Feed joystick button press/release into joystick state manager.
  */
 void joystick_button(unsigned char index, unsigned char btn, char down, char post) {
-    unsigned int newbut;
-    unsigned char type;
     oi_privjoy *priv;
 
     // Get private data or bail
@@ -241,6 +343,31 @@ void joystick_button(unsigned char index, unsigned char btn, char down, char pos
         return;
     }
 
+    joystick_setbutton(priv, index, btn, down, post);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IJoystick
+ * @brief Joystick button update on resolved device
+ *
+ * @param priv joystick manager data
+ * @param index device index
+ * @param btn button index
+ * @param down true (1) on button press, false (0) otherwise
+ * @param post true (1) to post event, false (0) otherwise
+ *
+ * Same as joystick_button, but for drivers which have already
+ * looked up the manager data.
+ */
+void joystick_setbutton(oi_privjoy *priv, unsigned char index, unsigned char btn,
+                        char down, char post) {
+    unsigned int newbut;
+    unsigned char type;
+
+    trace_add(OI_TRACE_MANAGER, index, down ? OI_JOYBUTTONDOWN : OI_JOYBUTTONUP);
+
     // Calculate button mask
     newbut = priv->button;
     if(down) {
@@ -274,8 +401,18 @@ void joystick_button(unsigned char index, unsigned char btn, char down, char pos
  * possibly paired, and sent to the event queue. We need to do this as
  * the last step in the joystick frame in order to collect x- and
  * y-axes for trackballs, hats etc.
+ *
+ * Only devices in the dirty-device mask are visited, and for those
+ * only the axes in the per-device update mask. The masks are walked
+ * lowest bit first, so events are posted in device and axis order.
+ * Events are stamped with the driver time of the device's latest
+ * axis update, when the driver has set one with queue_stamp.
  */
 void joystick_pump() {
+    unsigned int sum;
+    unsigned int bits;
+    unsigned int axes;
+    unsigned int word;
     unsigned char index;
     oi_device *dev;
     oi_privjoy *priv;
@@ -285,81 +422,454 @@ void joystick_pump() {
     int abs;
     int rel;
 
-    // Parse all devices
-    for(index=1; index<OI_MAX_DEVICES; index++) {
-        // Devices are always ordered, so bail if we hit the end
-        dev = device_get(index);
-        if(!dev) {
-            break;
-        }
+    // Nothing tagged since last pump
+    if(!joy_dirtysum) {
+        return;
+    }
 
-        // Get structures
-        conf = dev->joyconfig;
-        priv = device_priv(index, OI_PRO_JOYSTICK);
+    // Grab and clear the summary, we own the tagged words now
+    sum = joy_dirtysum;
+    joy_dirtysum = 0;
 
-        // Only handle joysticks with valid thingies
-        if(!(dev->provides & OI_PRO_JOYSTICK) || !conf || !priv) {
-            continue;
-        }
+    while(sum) {
+        word = OI_CTZ(sum);
+        sum &= sum - 1;
+
+        bits = joy_dirty[word];
+        joy_dirty[word] = 0;
+
+        // Parse tagged devices
+        while(bits) {
+            index = (unsigned char)(word*32 + OI_CTZ(bits) + 1);
+            bits &= bits - 1;
+
+            // Device may have vanished since it was tagged
+            dev = device_get(index);
+            if(!dev) {
+                continue;
+            }
+
+            // Get structures
+            conf = dev->joyconfig;
+            priv = device_priv(index, OI_PRO_JOYSTICK);
 
-        // Ok, we have a valid joystick, parse each axis
-        for(axis=0; axis<OI_JOY_NUM_AXES; axis++) {
-            // Bail if no-axis or no update needed
-            if((conf->kind[axis] == OIJ_NONE) || !(priv->update[axis])) {
+            // Only handle joysticks with valid thingies
+            if(!(dev->provides & OI_PRO_JOYSTICK) || !conf || !priv) {
                 continue;
             }
 
-            // Flag axis as handled as we may bail out anytime now
-            priv->update[axis] = FALSE;
+            // Flag axes as handled as we may bail out anytime now
+            axes = priv->update;
+            priv->update = 0;
 
-            // Trackballs
-            if(conf->kind[axis] == OIJ_BALL) {
+            // Stamp events with the time of the device's last frame
+            queue_stamp(priv->stamp);
+            priv->stamp = 0;
 
-                // Get vertical movement (second axis)
-                if(conf->pair[axis] != 0) {
-                    rel = priv->relaxes[conf->pair[axis]];
+            // Calibrate pending axes, and post those that moved and
+            // were asked to be posted
+            if(priv->calpend) {
+                axes |= joystick_calibrate(priv, conf) & priv->calpost;
+                priv->calpost &= priv->calpend;
+
+                // Smoothing filter has not settled, come back next pump
+                if(priv->calpend) {
+                    joystick_tag(index);
                 }
-                else {
-                    rel = 0;
+            }
+
+            // Ok, we have a valid joystick, parse each tagged axis
+            while(axes) {
+                axis = (unsigned char)OI_CTZ(axes);
+                axes &= axes - 1;
+
+                // Bail if no-axis
+                if(conf->kind[axis] == OIJ_NONE) {
+                    continue;
+                }
+
+                // Trackballs
+                if(conf->kind[axis] == OIJ_BALL) {
+
+                    // Get vertical movement (second axis)
+                    if(conf->pair[axis] != 0) {
+                        rel = priv->relaxes[conf->pair[axis]];
+                    }
+                    else {
+                        rel = 0;
+                    }
+
+                    // Send trackball event
+                    ev.type = OI_JOYBALL;
+                    ev.joyball.device = index;
+                    ev.joyball.code = OI_JOY_MAKE_CODE(OIJ_BALL, axis);
+                    ev.joyball.relx = priv->relaxes[axis];
+                    ev.joyball.rely = rel;
+                    queue_add(&ev);
+
+                    // We're done with this axis
+                    continue;
                 }
 
-                // Send trackball event
-                ev.type = OI_JOYBALL;
-                ev.joyball.device = index;
-                ev.joyball.code = OI_JOY_MAKE_CODE(OIJ_BALL, axis);
-                ev.joyball.relx = priv->relaxes[axis];
-                ev.joyball.rely = rel;
+                // Set absolute and instantaneous relative value
+                abs = priv->absaxes[axis];
+                rel = priv->insaxes[axis];
+
+                // Hats
+                if(conf->kind[axis] == OIJ_HAT) {
+                    // Two-axis hats
+                    if(conf->pair[axis] != 0) {
+                        abs = joystick_hatpos(priv->absaxes[axis],
+                                              priv->absaxes[conf->pair[axis]]);
+                    }
+
+                    // Hats have no relative movement
+                    rel = abs;
+                }
+
+                // Send absolute axis event
+                ev.type = OI_JOYAXIS;
+                ev.joyaxis.device = index;
+                ev.joyaxis.code = OI_JOY_MAKE_CODE(conf->kind[axis], axis);
+                ev.joyaxis.abs = abs;
+                ev.joyaxis.rel = rel;
                 queue_add(&ev);
+            }
+        }
+    }
+    queue_stamp(0);
+}
+
+/* ******************************************************************** */
 
-                // We're done with this axis
+/**
+ * @ingroup IJoystick
+ * @brief Run calibration kernel on pending axes
+ *
+ * @param priv joystick manager data
+ * @param conf joystick configuration with calibration profile
+ * @returns bitmask of axes where the absolute value changed
+ *
+ * Convert the raw values of all axes in the "calpend" mask to
+ * calibrated absolute values, and update the absolute and relative
+ * values accordingly. The kernel processes all axes of the device
+ * at once, four at a time using SSE2 when available, and then
+ * blends the result into the axes selected by the mask. The scalar
+ * kernel gives the same results, see joystick_simd.
+ *
+ * The stages are: clip to [min;max], subtract center, scale each
+ * half to the OpenInput range, axial deadzone, radial deadzone
+ * (paired sticks only) and smoothing. Axes where the smoothing
+ * filter has not yet reached its target are left in "calpend".
+ */
+unsigned int joystick_calibrate(oi_privjoy *priv, oi_joyconfig *conf) {
+    oi_joykernel *k;
+    float val[OI_JOY_NUM_AXES];
+    unsigned int mask;
+    unsigned int changed;
+    unsigned int moving;
+    unsigned int done;
+    int i;
+
+    // Rebuild coefficients if the profile has been changed
+    k = &(priv->kernel);
+    if(!priv->calready) {
+        joystick_kernel(priv, conf);
+    }
+    mask = priv->calpend;
+
+#ifdef __SSE2__
+    if(joy_simd) {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        __m128 x;
+        __m128 m;
+        __m128 a;
+        __m128 s;
+
+        // Stage 1: clip, center, scale and axial deadzone
+        for(i=0; i<OI_JOY_NUM_AXES; i+=4) {
+            x = _mm_cvtepi32_ps(_mm_loadu_si128((__m128i*)&(priv->rawaxes[i])));
+            x = _mm_min_ps(_mm_max_ps(x, _mm_loadu_ps(&(k->min[i]))),
+                           _mm_loadu_ps(&(k->max[i])));
+            x = _mm_sub_ps(x, _mm_loadu_ps(&(k->center[i])));
+
+            // Pick scale for the upper or lower half
+            m = _mm_cmpge_ps(x, zero);
+            x = _mm_mul_ps(x, _mm_or_ps(_mm_and_ps(m, _mm_loadu_ps(&(k->pos[i]))),
+                                        _mm_andnot_ps(m, _mm_loadu_ps(&(k->neg[i])))));
+
+            // Shrink magnitude by deadzone and stretch back to full range
+            s = _mm_and_ps(x, sign);
+            a = _mm_andnot_ps(sign, x);
+            a = _mm_max_ps(_mm_sub_ps(a, _mm_loadu_ps(&(k->dead[i]))), zero);
+            a = _mm_mul_ps(a, _mm_loadu_ps(&(k->deadscale[i])));
+            _mm_storeu_ps(&(val[i]), _mm_or_ps(a, s));
+        }
+    }
+    else
+#endif
+    {
+        float x;
+
+        // Stage 1: clip, center, scale and axial deadzone
+        for(i=0; i<OI_JOY_NUM_AXES; i++) {
+            x = (float)priv->rawaxes[i];
+            if(x < k->min[i]) {
+                x = k->min[i];
+            }
+            if(x > k->max[i]) {
+                x = k->max[i];
+            }
+            x -= k->center[i];
+            x *= (x >= 0.0f) ? k->pos[i] : k->neg[i];
+
+            if(x > k->dead[i]) {
+                x = (x - k->dead[i]) * k->deadscale[i];
+            }
+            else if(x < -k->dead[i]) {
+                x = (x + k->dead[i]) * k->deadscale[i];
+            }
+            else {
+                x = 0.0f;
+            }
+            val[i] = x;
+        }
+    }
+
+    // Stage 2: radial deadzone for paired sticks, which is rare
+    if(k->hasradial) {
+        done = 0;
+        for(i=0; i<OI_JOY_NUM_AXES; i++) {
+            int p;
+            float mag;
+            float fac;
+
+            p = conf->pair[i];
+            if((k->radial[i] <= 0.0f) || (conf->kind[i] != OIJ_STICK) ||
+               (p == 0) || (p >= OI_JOY_NUM_AXES) || (done & (1u << i))) {
                 continue;
             }
+            done |= (1u << i) | (1u << p);
 
-            // Set absolute and instantaneous relative value
-            abs = priv->absaxes[axis];
-            rel = priv->insaxes[axis];
+            // Zero inside circle, stretch outside to keep full range
+            mag = (float)sqrt(val[i]*val[i] + val[p]*val[p]);
+            if(mag <= k->radial[i]) {
+                fac = 0.0f;
+            }
+            else {
+                fac = ((mag - k->radial[i]) / (OI_JOY_AXIS_MAX - k->radial[i])) *
+                    OI_JOY_AXIS_MAX / mag;
+            }
+            val[i] *= fac;
+            val[p] *= fac;
+
+            // Corners of a square stick may overshoot the range
+            val[i] = (val[i] > OI_JOY_AXIS_MAX) ? OI_JOY_AXIS_MAX : val[i];
+            val[i] = (val[i] < OI_JOY_AXIS_MIN) ? OI_JOY_AXIS_MIN : val[i];
+            val[p] = (val[p] > OI_JOY_AXIS_MAX) ? OI_JOY_AXIS_MAX : val[p];
+            val[p] = (val[p] < OI_JOY_AXIS_MIN) ? OI_JOY_AXIS_MIN : val[p];
+        }
+    }
 
-            // Hats
-            if(conf->kind[axis] == OIJ_HAT) {
-                // Two-axis hats
-                if(conf->pair[axis] != 0) {
-                    abs = joystick_hatpos(priv->absaxes[axis],
-                                          priv->absaxes[conf->pair[axis]]);
-                }
+#ifdef __SSE2__
+    if(joy_simd) {
+        const __m128i bitsel = _mm_set_epi32(8, 4, 2, 1);
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        __m128 x;
+        __m128 f;
+        __m128 n;
+        __m128i m;
+        __m128i out;
+        __m128i old;
+        __m128i rel;
+
+        // Stage 3: smoothing and write-back of the masked axes
+        changed = 0;
+        moving = 0;
+        for(i=0; i<OI_JOY_NUM_AXES; i+=4) {
+            // Expand four mask bits into four lane masks
+            m = _mm_and_si128(_mm_set1_epi32((int)(mask >> i)), bitsel);
+            m = _mm_cmpeq_epi32(m, bitsel);
+
+            // Exponential filter, snap to target when close enough
+            x = _mm_loadu_ps(&(val[i]));
+            f = _mm_loadu_ps(&(k->filter[i]));
+            n = _mm_add_ps(f, _mm_mul_ps(_mm_sub_ps(x, f), _mm_loadu_ps(&(k->alpha[i]))));
+            f = _mm_cmplt_ps(_mm_andnot_ps(sign, _mm_sub_ps(x, n)), half);
+            n = _mm_or_ps(_mm_and_ps(f, x), _mm_andnot_ps(f, n));
+            moving |= (~_mm_movemask_ps(f) & 0xf) << i;
+
+            f = _mm_loadu_ps(&(k->filter[i]));
+            n = _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(m), n),
+                          _mm_andnot_ps(_mm_castsi128_ps(m), f));
+            _mm_storeu_ps(&(k->filter[i]), n);
+
+            // New absolute value and relative motion
+            old = _mm_loadu_si128((__m128i*)&(priv->absaxes[i]));
+            // Round half away from zero, like the scalar kernel
+            out = _mm_cvttps_epi32(_mm_add_ps(n, _mm_or_ps(half, _mm_and_ps(n, sign))));
+            out = _mm_or_si128(_mm_and_si128(m, out), _mm_andnot_si128(m, old));
+            rel = _mm_sub_epi32(out, old);
+            changed |= (~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(out, old))) & 0xf) << i;
+
+            _mm_storeu_si128((__m128i*)&(priv->absaxes[i]), out);
+            _mm_storeu_si128((__m128i*)&(priv->insaxes[i]),
+                             _mm_or_si128(_mm_and_si128(m, rel),
+                                          _mm_andnot_si128(m, _mm_loadu_si128((__m128i*)&(priv->insaxes[i])))));
+            _mm_storeu_si128((__m128i*)&(priv->relaxes[i]),
+                             _mm_or_si128(_mm_and_si128(m, rel),
+                                          _mm_andnot_si128(m, _mm_loadu_si128((__m128i*)&(priv->relaxes[i])))));
+        }
+    }
+    else
+#endif
+    {
+        float n;
+        int out;
+
+        // Stage 3: smoothing and write-back of the masked axes
+        changed = 0;
+        moving = 0;
+        for(i=0; i<OI_JOY_NUM_AXES; i++) {
+            if(!(mask & (1u << i))) {
+                continue;
+            }
+
+            // Exponential filter, snap to target when close enough
+            n = k->filter[i] + (val[i] - k->filter[i]) * k->alpha[i];
+            if(fabs(val[i] - n) < 0.5f) {
+                n = val[i];
+            }
+            else {
+                moving |= 1u << i;
+            }
+            k->filter[i] = n;
 
-                // Hats have no relative movement
-                rel = abs;
+            // New absolute value and relative motion
+            out = (int)((n < 0.0f) ? (n - 0.5f) : (n + 0.5f));
+            if(out != priv->absaxes[i]) {
+                changed |= 1u << i;
             }
+            priv->insaxes[i] = out - priv->absaxes[i];
+            priv->relaxes[i] = out - priv->absaxes[i];
+            priv->absaxes[i] = out;
+        }
+    }
+
+    // Only masked axes can still be moving
+    priv->calpend = moving & mask;
+    return changed & mask;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IJoystick
+ * @brief Select vectorized calibration kernel
+ *
+ * @param on true (1) to use SSE2, false (0) for the scalar kernel
+ * @returns true (1) if the SSE2 kernel is built in, false (0) otherwise
+ *
+ * Both kernels give identical results, this lets tests
+ * check that they do.
+ */
+char joystick_simd(char on) {
+    joy_simd = on;
+#ifdef __SSE2__
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IJoystick
+ * @brief Prepare calibration kernel coefficients
+ *
+ * @param priv joystick manager data
+ * @param conf joystick configuration with calibration profile
+ *
+ * Convert the integer calibration profile into the floating
+ * point factors used by joystick_calibrate. Nonsense values
+ * (like min larger than max) are replaced by the identity
+ * mapping for that axis.
+ */
+void joystick_kernel(oi_privjoy *priv, oi_joyconfig *conf) {
+    oi_joykernel *k;
+    oi_joycalib *c;
+    int i;
+    int lo;
+    int hi;
+    int mid;
+    int dz;
+    int sm;
+
+    k = &(priv->kernel);
+    c = &(conf->calib);
+    k->hasradial = FALSE;
+
+    for(i=0; i<OI_JOY_NUM_AXES; i++) {
+        // Range, fall back to full range
+        lo = c->min[i];
+        hi = c->max[i];
+        if(lo >= hi) {
+            lo = OI_JOY_AXIS_MIN;
+            hi = OI_JOY_AXIS_MAX;
+        }
+        mid = c->center[i];
+        if(mid < lo) {
+            mid = lo;
+        }
+        if(mid > hi) {
+            mid = hi;
+        }
+
+        k->min[i] = (float)lo;
+        k->max[i] = (float)hi;
+        k->center[i] = (float)mid;
+        k->pos[i] = (hi > mid) ? ((float)OI_JOY_AXIS_MAX / (float)(hi - mid)) : 0.0f;
+        k->neg[i] = (mid > lo) ? (-(float)OI_JOY_AXIS_MIN / (float)(mid - lo)) : 0.0f;
+
+        // Axial deadzone
+        dz = c->deadzone[i];
+        if(dz < 0) {
+            dz = 0;
+        }
+        if(dz >= OI_JOY_AXIS_MAX) {
+            dz = OI_JOY_AXIS_MAX - 1;
+        }
+        k->dead[i] = (float)dz;
+        k->deadscale[i] = (float)OI_JOY_AXIS_MAX / (float)(OI_JOY_AXIS_MAX - dz);
+
+        // Radial deadzone
+        dz = c->radial[i];
+        if(dz < 0) {
+            dz = 0;
+        }
+        if(dz >= OI_JOY_AXIS_MAX) {
+            dz = OI_JOY_AXIS_MAX - 1;
+        }
+        k->radial[i] = (float)dz;
+        if(dz > 0) {
+            k->hasradial = TRUE;
+        }
 
-            // Send absolute axis event
-            ev.type = OI_JOYAXIS;
-            ev.joyaxis.device = index;
-            ev.joyaxis.code = OI_JOY_MAKE_CODE(conf->kind[axis], axis);
-            ev.joyaxis.abs = abs;
-            ev.joyaxis.rel = rel;
-            queue_add(&ev);
+        // Smoothing filter weight of the new sample
+        sm = c->smooth[i];
+        if(sm < 0) {
+            sm = 0;
         }
+        if(sm > OI_JOY_SMOOTH_MAX) {
+            sm = OI_JOY_SMOOTH_MAX;
+        }
+        k->alpha[i] = 1.0f - ((float)sm / (OI_JOY_SMOOTH_MAX + 1));
     }
+
+    priv->calready = TRUE;
 }
 
 /* ******************************************************************** */
@@ -430,6 +940,9 @@ unsigned int oi_joy_relative(unsigned char index, unsigned char axis, int *value
     oi_joyconfig *conf;
     unsigned char i;
 
+    // Bootstrap deferred joystick drivers
+    device_wakeup(OI_PRO_JOYSTICK);
+
     // Default value
     if(value) {
         *value = 0;
@@ -446,21 +959,12 @@ unsigned int oi_joy_relative(unsigned char index, unsigned char axis, int *value
     // Get device index
     i = index;
     if(i == 0) {
-        for(i=1; i<OI_MAX_DEVICES; i++) {
-            if(device_priv(i, OI_PRO_JOYSTICK)) {
-                break;
-            }
-        }
-
-        // End reached
-        if(i==OI_MAX_DEVICES) {
-            return OI_BUTTON_MASK(0);
-        }
+        i = device_first(OI_PRO_JOYSTICK);
     }
 
     // Get device data
     priv = (oi_privjoy*)device_priv(i, OI_PRO_JOYSTICK);
-    conf = device_get(i)->joyconfig;
+    conf = priv ? device_get(i)->joyconfig : NULL;
     if(!priv || !conf) {
         return OI_BUTTON_MASK(0);
     }
@@ -508,6 +1012,9 @@ unsigned int oi_joy_absolute(unsigned char index, unsigned char axis, int *value
     oi_joyconfig *conf;
     unsigned char i;
 
+    // Bootstrap deferred joystick drivers
+    device_wakeup(OI_PRO_JOYSTICK);
+
     // Default value
     if(value) {
         *value = 0;
@@ -524,21 +1031,12 @@ unsigned int oi_joy_absolute(unsigned char index, unsigned char axis, int *value
     // Get device index
     i = index;
     if(i == 0) {
-        for(i=1; i<OI_MAX_DEVICES; i++) {
-            if(device_priv(i, OI_PRO_JOYSTICK)) {
-                break;
-            }
-        }
-
-        // End reached
-        if(i==OI_MAX_DEVICES) {
-            return OI_BUTTON_MASK(0);
-        }
+        i = device_first(OI_PRO_JOYSTICK);
     }
 
     // Get device data
     priv = (oi_privjoy*)device_priv(i, OI_PRO_JOYSTICK);
-    conf = device_get(i)->joyconfig;
+    conf = priv ? device_get(i)->joyconfig : NULL;
     if(!priv || !conf) {
         return OI_BUTTON_MASK(0);
     }
@@ -583,7 +1081,8 @@ char *oi_joy_getname(unsigned int code) {
     debug("oi_joystick_getname: decoded type:%u index:%u", t, i);
 
     // Dummy checks (return joy_unknown on error)
-    if((i >= OIJ_LAST) || (t == 0) || (t >= OI_JOY_NUM_AXES)) {
+    if((OI_JOY_DECODE_INDEX(code) >= OI_JOY_NUM_AXES) || (t == OIJ_NONE) || (t >= OIJ_LAST) ||
+       !joynames[OI_JOY_TAB_AXES][i]) {
         return "joy_unknown";
     }
 
@@ -610,13 +1109,15 @@ char *oi_joy_getname(unsigned int code) {
  */
 unsigned int oi_joy_getcode(char *name) {
     int i;
+    unsigned int len;
 
     // Dummy checks
     if(!name) {
         return OI_JOY_NONE_CODE;
     }
-    if((strlen(name) < OI_MIN_KEYLENGTH) ||
-       (strlen(name) > OI_MAX_KEYLENGTH)) {
+    len = strlen(name);
+    if((len < OI_MIN_KEYLENGTH) ||
+       (len > OI_MAX_KEYLENGTH)) {
         return OI_JOY_NONE_CODE;
     }
 
@@ -627,16 +1128,16 @@ unsigned int oi_joy_getcode(char *name) {
 
     // Axes
     if(strncmp(name, "joy_axis", 8) == 0) {
-        i = atoi(name+8);
-        if((i >= 0) && (i<OI_JOY_NUM_AXES)) {
+        i = oi_number(name+8, OI_JOY_NUM_AXES-1);
+        if(i >= 0) {
             return OI_JOY_MAKE_CODE(OIJ_GEN_AXIS, i);
         }
     }
 
     // Buttons
     if(strncmp(name, "joy_button", 10) == 0) {
-        i = atoi(name+10);
-        if((i >= 0) && (i<OI_JOY_NUM_AXES)) {
+        i = oi_number(name+10, OI_JOY_NUM_AXES-1);
+        if(i >= 0) {
             return OI_JOY_MAKE_CODE(OIJ_GEN_BUTTON, i);
         }
     }
@@ -666,17 +1167,13 @@ int oi_joy_info(unsigned char index, char **name, int *buttons, int *axes) {
     unsigned char i;
     unsigned char j;
 
-    // Find first keyboard if index is zero
+    // Bootstrap deferred joystick drivers
+    device_wakeup(OI_PRO_JOYSTICK);
+
+    // Find first joystick if index is zero
     i = index;
     if(i == 0) {
-        for(i=1; i<OI_MAX_DEVICES; i++) {
-            if(device_priv(i, OI_PRO_JOYSTICK)) {
-                break;
-            }
-        }
-
-        // No keyboard found
-        return OI_ERR_NO_DEVICE;
+        i = device_first(OI_PRO_JOYSTICK);
     }
 
     // Get device pointers and dummy checking
@@ -745,17 +1242,10 @@ int op_joy_axessetup(unsigned char index, oi_joytype *type[], unsigned char *pai
     oi_joyconfig *conf;
     unsigned char i;
 
-    // Find first keyboard if index is zero
+    // Find first joystick if index is zero
     i = index;
     if(i == 0) {
-        for(i=1; i<OI_MAX_DEVICES; i++) {
-            if(device_priv(i, OI_PRO_JOYSTICK)) {
-                break;
-            }
-        }
-
-        // No keyboard found
-        return OI_ERR_NO_DEVICE;
+        i = device_first(OI_PRO_JOYSTICK);
     }
 
     // Get private data
@@ -784,3 +1274,276 @@ int op_joy_axessetup(unsigned char index, oi_joytype *type[], unsigned char *pai
 }
 
 /* ******************************************************************** */
+
+/**
+ * @ingroup IJoystick
+ * @brief Resolve joystick device index
+ *
+ * @param index device index, 0 for default joystick
+ * @returns device index of joystick, or 0 if not found
+ *
+ * Translate the "0 is the default joystick" convention of the
+ * public API into a real device index.
+ */
+unsigned char joystick_find(unsigned char index) {
+    // Bootstrap deferred joystick drivers
+    device_wakeup(OI_PRO_JOYSTICK);
+
+    if(index != 0) {
+        return device_priv(index, OI_PRO_JOYSTICK) ? index : 0;
+    }
+
+    return device_first(OI_PRO_JOYSTICK);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PJoystick
+ * @brief Set joystick calibration
+ *
+ * @param index device index, 0 for default joystick
+ * @param calib pointer to calibration profile, NULL to remove calibration
+ * @returns errorcode, see @ref PErrors
+ *
+ * Install a calibration profile on a joystick. From the next event
+ * pump, the absolute axes are clipped, centered, scaled, passed
+ * through the deadzones and smoothed as given by the profile.
+ * Axes whose value changes with the new profile are posted on
+ * that pump. The profile is copied, so you may free it afterwards.
+ */
+int oi_joy_setcalib(unsigned char index, oi_joycalib *calib) {
+    oi_privjoy *priv;
+    oi_joyconfig *conf;
+    unsigned char i;
+    int j;
+
+    // Get device data
+    i = joystick_find(index);
+    if(i == 0) {
+        return OI_ERR_NO_DEVICE;
+    }
+    priv = (oi_privjoy*)device_priv(i, OI_PRO_JOYSTICK);
+    conf = device_get(i)->joyconfig;
+    if(!priv || !conf) {
+        return OI_ERR_NO_DEVICE;
+    }
+
+    // Remove calibration, raw values become the real ones
+    if(calib == NULL) {
+        if(conf->calibrated) {
+            memcpy(priv->absaxes, priv->rawaxes, sizeof(priv->absaxes));
+        }
+        conf->calibrated = FALSE;
+        priv->calpend = 0;
+        priv->calpost = 0;
+        return OI_ERR_OK;
+    }
+
+    // Start out from the current positions
+    if(!conf->calibrated) {
+        memcpy(priv->rawaxes, priv->absaxes, sizeof(priv->rawaxes));
+        for(j=0; j<OI_JOY_NUM_AXES; j++) {
+            priv->kernel.filter[j] = (float)priv->absaxes[j];
+        }
+    }
+
+    // Install and recalibrate all absolute axes on next pump
+    conf->calib = *calib;
+    conf->calibrated = TRUE;
+    priv->calready = FALSE;
+    priv->calpend = 0;
+    for(j=0; j<OI_JOY_NUM_AXES; j++) {
+        if((conf->kind[j] != OIJ_NONE) && (conf->kind[j] != OIJ_BALL)) {
+            priv->calpend |= 1u << j;
+        }
+    }
+    priv->calpost = priv->calpend;
+    joystick_tag(i);
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PJoystick
+ * @brief Get joystick calibration
+ *
+ * @param index device index, 0 for default joystick
+ * @param calib pointer to calibration profile to be filled
+ * @returns errorcode, see @ref PErrors
+ *
+ * Get the calibration profile of a joystick. If the joystick
+ * is not calibrated, the identity profile (full range, zero center,
+ * no deadzones and no smoothing) is returned.
+ */
+int oi_joy_getcalib(unsigned char index, oi_joycalib *calib) {
+    oi_joyconfig *conf;
+    unsigned char i;
+    int j;
+
+    // Dummy check
+    if(calib == NULL) {
+        return OI_ERR_PARAM;
+    }
+
+    // Get device data
+    i = joystick_find(index);
+    if(i == 0) {
+        return OI_ERR_NO_DEVICE;
+    }
+    conf = device_get(i)->joyconfig;
+    if(!conf) {
+        return OI_ERR_NO_DEVICE;
+    }
+
+    // Current profile
+    if(conf->calibrated) {
+        *calib = conf->calib;
+        return OI_ERR_OK;
+    }
+
+    // Identity profile
+    memset(calib, 0, sizeof(oi_joycalib));
+    for(j=0; j<OI_JOY_NUM_AXES; j++) {
+        calib->min[j] = OI_JOY_AXIS_MIN;
+        calib->max[j] = OI_JOY_AXIS_MAX;
+    }
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PJoystick
+ * @brief Load joystick calibration profile
+ *
+ * @param index device index, 0 for default joystick
+ * @param filename path to profile
+ * @returns errorcode, see @ref PErrors
+ *
+ * Read a calibration profile from a text file and install it
+ * on the joystick. The file contains one line per axis on the form
+ *
+ * "axis N min A center B max C deadzone D radial E smooth F"
+ *
+ * Empty lines and lines starting with '#' are ignored. Axes
+ * which are not in the file use the identity profile. Files
+ * written by oi_joy_saveprofile can be read back by this function.
+ * If the file cannot be read or has a bad line, the joystick
+ * keeps its current calibration.
+ */
+int oi_joy_loadprofile(unsigned char index, char *filename) {
+    FILE *file;
+    char line[256];
+    oi_joycalib calib;
+    int v[7];
+    int e;
+    int j;
+
+    if(filename == NULL) {
+        return OI_ERR_PARAM;
+    }
+    if(joystick_find(index) == 0) {
+        return OI_ERR_NO_DEVICE;
+    }
+
+    // Start from identity, the current profile is kept until all is read
+    memset(&calib, 0, sizeof(oi_joycalib));
+    for(j=0; j<OI_JOY_NUM_AXES; j++) {
+        calib.min[j] = OI_JOY_AXIS_MIN;
+        calib.max[j] = OI_JOY_AXIS_MAX;
+    }
+
+    file = fopen(filename, "r");
+    if(file == NULL) {
+        debug("oi_joy_loadprofile: could not open '%s'", filename);
+        return OI_ERR_PARAM;
+    }
+
+    // Parse line by line
+    e = OI_ERR_OK;
+    while(fgets(line, sizeof(line), file)) {
+        if((line[0] == '#') || (line[0] == '\n') || (line[0] == '\r') ||
+           (line[0] == '\0')) {
+            continue;
+        }
+
+        if((sscanf(line, "axis %d min %d center %d max %d deadzone %d radial %d smooth %d",
+                   &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6]) != 7) ||
+           (v[0] < 0) || (v[0] >= OI_JOY_NUM_AXES)) {
+            debug("oi_joy_loadprofile: bad line '%s'", line);
+            e = OI_ERR_PARAM;
+            break;
+        }
+
+        calib.min[v[0]] = v[1];
+        calib.center[v[0]] = v[2];
+        calib.max[v[0]] = v[3];
+        calib.deadzone[v[0]] = v[4];
+        calib.radial[v[0]] = v[5];
+        calib.smooth[v[0]] = v[6];
+    }
+    fclose(file);
+
+    // Install it
+    if(e == OI_ERR_OK) {
+        e = oi_joy_setcalib(index, &calib);
+    }
+    return e;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PJoystick
+ * @brief Save joystick calibration profile
+ *
+ * @param index device index, 0 for default joystick
+ * @param filename path to profile
+ * @returns errorcode, see @ref PErrors
+ *
+ * Write the current calibration profile of the joystick to a text
+ * file, in the format read by oi_joy_loadprofile. Only axes which
+ * exist on the joystick are written.
+ */
+int oi_joy_saveprofile(unsigned char index, char *filename) {
+    FILE *file;
+    oi_joycalib calib;
+    oi_joyconfig *conf;
+    int e;
+    int j;
+
+    if(filename == NULL) {
+        return OI_ERR_PARAM;
+    }
+
+    e = oi_joy_getcalib(index, &calib);
+    if(e != OI_ERR_OK) {
+        return e;
+    }
+    conf = device_get(joystick_find(index))->joyconfig;
+
+    file = fopen(filename, "w");
+    if(file == NULL) {
+        debug("oi_joy_saveprofile: could not open '%s'", filename);
+        return OI_ERR_PARAM;
+    }
+
+    fprintf(file, "# OpenInput joystick profile: %s\n",
+            conf->name ? conf->name : "unknown");
+    for(j=0; j<OI_JOY_NUM_AXES; j++) {
+        if(conf->kind[j] == OIJ_NONE) {
+            continue;
+        }
+        fprintf(file, "axis %d min %d center %d max %d deadzone %d radial %d smooth %d\n",
+                j, calib.min[j], calib.center[j], calib.max[j],
+                calib.deadzone[j], calib.radial[j], calib.smooth[j]);
+    }
+    fclose(file);
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
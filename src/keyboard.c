@@ -59,36 +59,32 @@ int keyboard_init() {
 
 /**
  * @ingroup IKeyboard
- * @brief Allocate and prepare private managment data
+ * @brief Prepare private managment data
  *
- * @param key pointer to the address of the keyboard data
+ * @param key pointer to keyboard data in the managment data arena
  * @param provide provide mask, see @ref PProvide
  *
  * @pre This function is called during "device_register" where
- * the base device->managment structure has been allocated and
- * initialized
+ * a slot (and thus room in the managment data arena) has been
+ * allocated for the device
  *
- * This function (possible) allocates and initializes the keyboard
- * per-device private managment data, ie. the modifier and button-down
- * state tables.
+ * This function initializes the keyboard per-device private
+ * managment data, ie. the modifier and button-down state tables.
  *
- * The structure might also not be created, depending on whether
- * the device provides keyboard as determined by the provide-mask
+ * Nothing is done if the device does not provide keyboard, as
+ * determined by the provide-mask
  */
-void keyboard_manage(oi_privkey **key, unsigned int provide) {
+void keyboard_manage(oi_privkey *key, unsigned int provide) {
     // Only care about keyboard
     if(!(provide & OI_PRO_KEYBOARD)) {
         return;
     }
 
-    // Allocate
-    *key = (oi_privkey*)malloc(sizeof(oi_privkey));
-
     // Clear state
-    memset((*key)->keystate, FALSE, TABLESIZE((*key)->keystate));
-    (*key)->modstate = OIM_NONE;
-    (*key)->rep_first = FALSE;
-    (*key)->rep_time = 0;
+    memset(key->keystate, FALSE, TABLESIZE(key->keystate));
+    key->modstate = OIM_NONE;
+    key->rep_first = FALSE;
+    key->rep_time = 0;
 
     debug("keyboard_manage: manager data installed");
 }
@@ -125,6 +121,7 @@ void keyboard_update(unsigned char index, oi_keysym *keysym, char down, char pos
     if(!priv) {
         return;
     }
+    trace_add(OI_TRACE_MANAGER, index, down ? OI_KEYDOWN : OI_KEYUP);
 
     // Temporary new modifier state
     newmod = priv->modstate;
@@ -317,16 +314,16 @@ void keyboard_update(unsigned char index, oi_keysym *keysym, char down, char pos
  * should not be invoked from elsewhere
  */
 void keyboard_dorepeat() {
-    unsigned char i;
+    unsigned int i;
     oi_privkey *priv;
     unsigned int now;
     int interval;
 
     // Perform repeating for all keyboards
-    for(i=0; i<OI_MAX_DEVICES; i++) {
+    for(i=0; device_live(i); i++) {
 
         // Speed-checking of keyboard
-        priv = (oi_privkey*)device_priv(i, OI_PRO_KEYBOARD);
+        priv = (oi_privkey*)device_priv(device_live(i), OI_PRO_KEYBOARD);
         if(priv) {
 
             // Available?
@@ -400,14 +397,7 @@ unsigned int oi_key_modstate(unsigned char index) {
     // Find first keyboard if index is zero
     i = index;
     if(i == 0) {
-        for(i=1; i<OI_MAX_DEVICES; i++) {
-            if(device_priv(index, OI_PRO_KEYBOARD)) {
-                break;
-            }
-        }
-
-        // No keyboard found
-        return OIM_NONE;
+        i = device_first(OI_PRO_KEYBOARD);
     }
 
     // Get private data, gracefull value return
@@ -446,14 +436,7 @@ char *oi_key_keystate(unsigned char index, int *num) {
     // Find first keyboard if index is zero
     i = index;
     if(i == 0) {
-        for(i=1; i<OI_MAX_DEVICES; i++) {
-            if(device_priv(index, OI_PRO_KEYBOARD)) {
-                break;
-            }
-        }
-
-        // No keyboard found
-        return NULL;
+        i = device_first(OI_PRO_KEYBOARD);
     }
 
     // Set number of keys
@@ -547,14 +530,16 @@ oi_key keyboard_scangetkey(char *name, oi_key first, oi_key last) {
  */
 oi_key oi_key_getcode(char *name) {
     int i;
+    unsigned int len;
     oi_key k;
 
     // Dummies
     if(!name) {
         return OIK_UNKNOWN;
     }
-    if((strlen(name) < OI_MIN_KEYLENGTH) ||
-       (strlen(name) > OI_MAX_KEYLENGTH)) {
+    len = strlen(name);
+    if((len < OI_MIN_KEYLENGTH) ||
+       (len > OI_MAX_KEYLENGTH)) {
         return OIK_UNKNOWN;
     }
 
@@ -572,7 +557,7 @@ oi_key oi_key_getcode(char *name) {
     k = OIK_UNKNOWN;
 
     // Letter or digit
-    if(strlen(name) == 5) {
+    if(len == 5) {
         if((name[4] >= 'a') && (name[4] <= 'z')) {
             return OIK_A + (name[4]-'a');
         }
@@ -585,8 +570,8 @@ oi_key oi_key_getcode(char *name) {
 
     // Function keys (only these and 'f' starts with 'f')
     if(name[4] == 'f') {
-        i = atoi(name+5);
-        if((i>=1) && (i<=15)) {
+        i = oi_number(name+5, 15);
+        if(i >= 1) {
             return OIK_F1 + i - 1;
         }
 
@@ -595,8 +580,8 @@ oi_key oi_key_getcode(char *name) {
 
     // International
     if(strncmp(name, "key_int", 7) == 0) {
-        i = atoi(name+7);
-        if((i>=0) && (i<=95)) {
+        i = oi_number(name+7, 95);
+        if(i >= 0) {
             return OIK_INT_0 + i;
         }
 
@@ -610,8 +595,8 @@ oi_key oi_key_getcode(char *name) {
 
     // Numeric keypad numbers
     if(strncmp(name, "key_num_", 8) == 0) {
-        i = atoi(name+8);
-        if((i>=0) && (i<=9)) {
+        i = oi_number(name+8, 9);
+        if(i >= 0) {
             return OIK_N_0 + i;
         }
     }
@@ -671,7 +656,7 @@ oi_key oi_key_getcode(char *name) {
  */
 int oi_key_repeat(int delay, int interval) {
     oi_privkey *priv;
-    unsigned char i;
+    unsigned int i;
 
     // Dummy check
     if((delay < 0) || (interval < 0)) {
@@ -683,8 +668,8 @@ int oi_key_repeat(int delay, int interval) {
     rep_interval = interval;
 
     // Reset all keyboard repeat states
-    for(i=1; i<OI_MAX_DEVICES; i++) {
-        priv = (oi_privkey*)device_priv(i, OI_PRO_KEYBOARD);
+    for(i=0; device_live(i); i++) {
+        priv = (oi_privkey*)device_priv(device_live(i), OI_PRO_KEYBOARD);
         if(priv) {
             priv->rep_first = FALSE;
             priv->rep_time = 0;
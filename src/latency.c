@@ -0,0 +1,222 @@
+/*
+ * latency.c : Event latency histograms
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include "openinput.h"
+#include "internal.h"
+
+// Histograms, one per event type
+static unsigned int lat_hist[OI_STATS_TYPES][OI_LAT_BUCKETS];
+static oi_time lat_max[OI_STATS_TYPES];
+static char lat_on = FALSE;
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IStats
+ * @brief Histogram bucket of latency
+ *
+ * @param ns latency in nanoseconds
+ * @returns bucket index
+ *
+ * Latencies below 2^OI_LAT_SUBBITS have a bucket each. Above
+ * that, each power of two is split in 2^OI_LAT_SUBBITS buckets,
+ * as in HDR histograms, so a bucket is at most 1/16 wide.
+ */
+static unsigned int latency_bucket(oi_time ns) {
+    unsigned int msb;
+
+    if(ns < (1 << OI_LAT_SUBBITS)) {
+        return (unsigned int)ns;
+    }
+    if(ns >= ((oi_time)1 << OI_LAT_MAXBITS)) {
+        return OI_LAT_BUCKETS - 1;
+    }
+
+#ifdef __GNUC__
+    msb = 63 - __builtin_clzll(ns);
+#else
+    for(msb=OI_LAT_SUBBITS; (ns >> (msb+1)) != 0; msb++);
+#endif
+
+    return ((msb - OI_LAT_SUBBITS) << OI_LAT_SUBBITS) +
+        (unsigned int)(ns >> (msb - OI_LAT_SUBBITS));
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IStats
+ * @brief Highest latency of bucket
+ *
+ * @param b bucket index
+ * @returns latency in nanoseconds
+ */
+static oi_time latency_top(unsigned int b) {
+    unsigned int shift;
+
+    if(b < (2 << OI_LAT_SUBBITS)) {
+        return b;
+    }
+
+    shift = (b >> OI_LAT_SUBBITS) - 1;
+    return ((oi_time)(b - (shift << OI_LAT_SUBBITS) + 1) << shift) - 1;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IStats
+ * @brief Initialize latency histograms
+ *
+ * @param flags library initialization flags, see @ref PFlags
+ * @returns errorcode, see @ref PErrors
+ *
+ * Latency is only measured with OI_FLAG_LATENCY, since it
+ * costs a clock read for each polled event.
+ */
+int latency_init(unsigned int flags) {
+    lat_on = (flags & OI_FLAG_LATENCY) ? TRUE : FALSE;
+    oi_latency_reset();
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IStats
+ * @brief Measure latency of polled event
+ *
+ * @param type event type, see oi_type
+ * @param stamp event timestamp
+ *
+ * Called by the queue when an event is removed.
+ */
+void latency_add(unsigned char type, oi_time stamp) {
+    oi_time now;
+    oi_time ns;
+
+    if(!lat_on) {
+        return;
+    }
+
+    // Replays and synthetic events may be stamped ahead
+    now = oi_gettime();
+    ns = (now > stamp) ? now - stamp : 0;
+
+    type %= OI_STATS_TYPES;
+    lat_hist[type][latency_bucket(ns)]++;
+    if(ns > lat_max[type]) {
+        lat_max[type] = ns;
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PStats
+ * @brief Get event latency
+ *
+ * @param type event type, see oi_type, or 0 for all events
+ * @param lat pointer to latency structure to fill
+ * @returns errorcode, see @ref PErrors
+ *
+ * Get percentiles of the latency of polled events since library
+ * initialization or oi_latency_reset. Latency is only measured
+ * when the library was initialized with OI_FLAG_LATENCY.
+ */
+int oi_latency_get(unsigned char type, oi_latency *lat) {
+    oi_count rank[3];
+    oi_count seen;
+    oi_time *pct[3];
+    unsigned int b;
+    unsigned int t;
+    unsigned int i;
+    unsigned int n;
+
+    if(!lat || (type >= OI_STATS_TYPES)) {
+        return OI_ERR_PARAM;
+    }
+    memset(lat, 0, sizeof(oi_latency));
+
+    // Count and highest
+    for(t=0; t<OI_STATS_TYPES; t++) {
+        if(type && (t != type)) {
+            continue;
+        }
+        for(b=0; b<OI_LAT_BUCKETS; b++) {
+            lat->count += lat_hist[t][b];
+        }
+        if(lat_max[t] > lat->max) {
+            lat->max = lat_max[t];
+        }
+    }
+    if(lat->count == 0) {
+        return OI_ERR_OK;
+    }
+
+    // Rank of each percentile, rounded up
+    rank[0] = (lat->count * 500 + 999) / 1000;
+    rank[1] = (lat->count * 990 + 999) / 1000;
+    rank[2] = (lat->count * 999 + 999) / 1000;
+    pct[0] = &lat->p50;
+    pct[1] = &lat->p99;
+    pct[2] = &lat->p999;
+
+    // Walk buckets until each rank is reached
+    seen = 0;
+    i = 0;
+    for(b=0; (b<OI_LAT_BUCKETS) && (i<3); b++) {
+        n = 0;
+        for(t=0; t<OI_STATS_TYPES; t++) {
+            if(!type || (t == type)) {
+                n += lat_hist[t][b];
+            }
+        }
+        seen += n;
+        while((i < 3) && (seen >= rank[i])) {
+            *pct[i] = (latency_top(b) < lat->max) ? latency_top(b) : lat->max;
+            i++;
+        }
+    }
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PStats
+ * @brief Clear latency histograms
+ */
+void oi_latency_reset() {
+    memset(lat_hist, 0, sizeof(lat_hist));
+    memset(lat_max, 0, sizeof(lat_max));
+}
+
+/* ******************************************************************** */
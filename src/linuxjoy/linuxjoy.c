@@ -31,16 +31,13 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <errno.h>
 #include <linux/joystick.h>
 #include "internal.h"
 #include "bootstrap.h"
 #include "linuxjoy.h"
 #include "linuxjoy_devs.h"
 
-#ifdef DEBUG
-#include <errno.h>
-#endif
-
 /**
  * @ingroup Drivers
  * @defgroup DLinuxjoy Linux joystick driver
@@ -49,7 +46,8 @@
  * Joystick driver for GNU/Linux systems using the v1.0+ joystick API
  * supported by kernels 2.4+. This driver talks directly to the
  * joystick /dev/input/jsX character device(s) and supports up to 32
- * joysticks (X=0..31).
+ * joysticks (X=0..31). Joysticks plugged in while the library is
+ * running are picked up through the hotplug watcher.
  */
 
 // Bootstrap global
@@ -58,11 +56,18 @@ oi_bootstrap linuxjoy_bootstrap = {
     "GNU/Linux joystick driver",
     OI_PRO_JOYSTICK,
     linuxjoy_avail,
-    linuxjoy_device
+    linuxjoy_device,
+    linuxjoy_hotplug
 };
 
-// Joystick to be initialized next
+// Joystick to be initialized next, hotplugged joystick plus one and number of open joysticks
 static unsigned char init_next = 0;
+static unsigned char init_hot = 0;
+static unsigned char num_open = 0;
+
+// Joystick found by avail, handed over to init
+static int avail_fd = -1;
+static unsigned char avail_num = 0;
 
 /* ******************************************************************** */
 
@@ -77,6 +82,7 @@ static unsigned char init_next = 0;
  *
  * The easiest test is to check whether the character devices
  * exist. If a single device is found, we assume it's available.
+ * The device is kept open for linuxjoy_init.
  */
 int linuxjoy_avail(unsigned int flags) {
     int i;
@@ -84,16 +90,26 @@ int linuxjoy_avail(unsigned int flags) {
 
     debug("linuxjoy_avail");
 
-    // Simply try to open a joystick
+    // Forget a joystick that was never initialized
+    if(avail_fd != -1) {
+        close(avail_fd);
+        avail_fd = -1;
+    }
+
+    // Simply try to open a joystick, skipping those already in use
     fd = -1;
     for(i=init_next; i<DLJS_MAX_DEVS; i++) {
+        if(linuxjoy_find(i)) {
+            continue;
+        }
         fd = linuxjoy_getfd(i);
 
         debug("linuxjoy_avail: testing /dev/input/js%u, fd:%i", i, fd);
 
-        // Ok, got on, close it and bail
+        // Ok, got one, keep it for init
         if(fd != -1) {
-            close(fd);
+            avail_fd = fd;
+            avail_num = i;
             break;
         }
     }
@@ -147,6 +163,7 @@ oi_device *linuxjoy_device() {
     memset(conf, 0, sizeof(oi_joyconfig));
 
     // Set members
+    priv->fd = -1;
     dev->private = priv;
     dev->joyconfig = conf;
     dev->init = linuxjoy_init;
@@ -175,7 +192,8 @@ oi_device *linuxjoy_device() {
  *
  * This is a device interface function.
  *
- * Try to open next joystick.
+ * Try to open next joystick, or the one claimed by
+ * linuxjoy_hotplug.
  */
 int linuxjoy_init(oi_device *dev, char *window_id, unsigned int flags) {
     int i;
@@ -186,20 +204,37 @@ int linuxjoy_init(oi_device *dev, char *window_id, unsigned int flags) {
 
     debug("linuxjoy_init");
 
-    // We can handle more than one device!
-    device_moreavail(TRUE);
-
-    // Find next
-    fd = -1;
-    for(i=init_next; i<DLJS_MAX_DEVS; i++) {
+    // Hotplugged joystick, only try that one
+    if(init_hot) {
+        i = init_hot - 1;
+        init_hot = 0;
         fd = linuxjoy_getfd(i);
-        if(fd != -1) {
-            break;
-        }
     }
 
-    // No matter what, don't try this device again
-    init_next++;
+    // Already opened by avail
+    else if(avail_fd != -1) {
+        device_moreavail(TRUE);
+        fd = avail_fd;
+        i = avail_num;
+        avail_fd = -1;
+        init_next = i+1;
+    }
+    else {
+        // We can handle more than one device!
+        device_moreavail(TRUE);
+
+        // Find next
+        fd = -1;
+        for(i=init_next; i<DLJS_MAX_DEVS; i++) {
+            fd = linuxjoy_getfd(i);
+            if(fd != -1) {
+                break;
+            }
+        }
+
+        // No matter what, don't try this device again
+        init_next = i+1;
+    }
 
     // Bail now if no fd was found
     if(fd == -1) {
@@ -211,10 +246,12 @@ int linuxjoy_init(oi_device *dev, char *window_id, unsigned int flags) {
     priv = (linuxjoy_private*)dev->private;
     priv->fd = fd;
     priv->id = i;
+    num_open++;
 
     // Get description using IOCTL (see linux/Documentation/input/joystick-api.h)
     name = (char*)malloc(DLJS_NAME_SIZE);
     memset(name, 0, DLJS_NAME_SIZE);
+    priv->name = name;
     if(ioctl(fd, JSIOCGNAME(DLJS_NAME_SIZE), name) < 0) {
         sprintf(name, "Unknown joystick #%u", i);
     }
@@ -348,15 +385,22 @@ int linuxjoy_destroy(oi_device *dev) {
         // Firstly, free the private data
         priv = (linuxjoy_private*)dev->private;
         if(priv) {
-            // Close file
+            // Close file, start over when the last one is gone
             if(priv->fd != -1) {
                 close(priv->fd);
+                if(num_open > 0) {
+                    num_open--;
+                }
+                if(num_open == 0) {
+                    init_next = 0;
+                }
             }
 
             // Free custom name and description
             if(priv->name) {
                 free(priv->name);
             }
+            free(priv);
         }
 
         // Secondly, free the joystick configuration
@@ -384,11 +428,23 @@ int linuxjoy_destroy(oi_device *dev) {
  * Read events from the joystick, and inject these
  * directly into the OI joystick interface. Translation
  * of buttons, axes etc. is done by OI.
+ *
+ * Events are read in blocks of up to DLJS_READ_EVENTS. Buttons
+ * are injected right away, while multiple updates of the same
+ * axis within a block are folded into one (the last absolute
+ * value, or the sum of relative values), as the joystick pump
+ * only posts the final state anyway.
  */
 void linuxjoy_process(oi_device *dev) {
-    static struct js_event jse;
-    int i;
+    struct js_event jse[DLJS_READ_EVENTS];
+    int value[OI_JOY_NUM_AXES];
+    unsigned int fold;
+    struct oi_privjoy *joy;
+    oi_joyconfig *conf;
     linuxjoy_private *priv;
+    unsigned char n;
+    int num;
+    int i;
 
     if(!oi_runstate()) {
         debug("linuxjoy_process: oi_running false");
@@ -397,24 +453,57 @@ void linuxjoy_process(oi_device *dev) {
 
     // Prepare
     priv = (linuxjoy_private*)dev->private;
+    conf = dev->joyconfig;
+    joy = (struct oi_privjoy*)device_priv(dev->index, OI_PRO_JOYSTICK);
+    if(!joy || !conf) {
+        return;
+    }
 
     // We're in non-blocking mode, so empty the event queue
-    while((i = read(priv->fd, &jse, sizeof(struct js_event))) > 0) {
-        // Button
-        if(jse.type & JS_EVENT_BUTTON) {
-            // Inject event into joystick state manager
-            joystick_button(dev->index, jse.number, jse.value, TRUE);
+    do {
+        num = read(priv->fd, jse, sizeof(jse));
+        stats_read(dev->index);
+        if(num <= 0) {
+            break;
+        }
+        num /= sizeof(struct js_event);
+
+        fold = 0;
+        for(i=0; i<num; i++) {
+            n = jse[i].number;
+            trace_add(OI_TRACE_DRIVER, dev->index, jse[i].type);
+
+            // Button, inject event into joystick state manager
+            if(jse[i].type & JS_EVENT_BUTTON) {
+                joystick_setbutton(joy, dev->index, n, jse[i].value, TRUE);
+            }
+
+            // Axis, fold with previous update in this block
+            else if((jse[i].type & JS_EVENT_AXIS) && (n < OI_JOY_NUM_AXES)) {
+                if((fold & (1u << n)) && (conf->kind[n] == OIJ_BALL)) {
+                    value[n] += jse[i].value;
+                }
+                else {
+                    value[n] = jse[i].value;
+                }
+                fold |= 1u << n;
+            }
         }
 
-        // Axis
-        else if(jse.type & JS_EVENT_AXIS) {
-            // Inject event into joystick state manager
-            joystick_axis(dev->index, jse.number, jse.value, OI_QUERY, TRUE);
+        // Inject folded axes into joystick state manager
+        while(fold) {
+            n = OI_CTZ(fold);
+            fold &= fold - 1;
+            joystick_setaxis(joy, conf, dev->index, n, value[n], OI_QUERY, TRUE);
         }
     }
+    // A short read means the kernel queue is empty
+    while(num == DLJS_READ_EVENTS);
 
-    // Do some debugging
-    debug("joystick_process: errorcode '%i'", errno);
+    // An empty queue is the normal way out, only report real errors
+    if((num < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+        debug("linuxjoy_process: errorcode '%i'", errno);
+    }
 }
 
 /* ******************************************************************** */
@@ -437,12 +526,73 @@ int linuxjoy_getfd(unsigned char num) {
     }
 
     // Make path and open it
-    sprintf(path, "/dev/input/js%u", num);
+    snprintf(path, sizeof(path), "%s/js%u", device_nodedir(), num);
     return open(path, O_RDONLY | O_NONBLOCK, 0);
 }
 
 /* ******************************************************************** */
 
+/**
+ * @ingroup DLinuxjoy
+ * @brief Find device of numbered joystick
+ *
+ * @param num joystick index (0-31)
+ * @returns device index, or 0 if joystick is not open
+ */
+unsigned char linuxjoy_find(unsigned char num) {
+    oi_device *dev;
+    unsigned int i;
+
+    for(i=0; device_live(i); i++) {
+        dev = device_get(device_live(i));
+        if((dev->process == linuxjoy_process) &&
+           (((linuxjoy_private*)dev->private)->id == num)) {
+            return dev->index;
+        }
+    }
+    return 0;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DLinuxjoy
+ * @brief Device node added or removed
+ *
+ * @param node name of device node
+ * @param added true (1) if node was added, false (0) if removed
+ * @returns see below
+ *
+ * This is a bootstrap function.
+ *
+ * When a new jsX node appears, remember it for the following
+ * create/init and return true, unless it is already open (udev
+ * changes the permissions right after creation, so the same node
+ * is usually reported twice). When a node is removed, return the
+ * index of the device to shut down.
+ */
+int linuxjoy_hotplug(char *node, char added) {
+    unsigned int num;
+    char c;
+
+    // Only jsX nodes
+    if((sscanf(node, "js%u%c", &num, &c) != 1) || (num >= DLJS_MAX_DEVS)) {
+        return 0;
+    }
+
+    if(!added) {
+        return linuxjoy_find(num);
+    }
+    if(linuxjoy_find(num)) {
+        return FALSE;
+    }
+
+    init_hot = num + 1;
+    return TRUE;
+}
+
+/* ******************************************************************** */
+
 /**
  * @ingroup DLinuxjoy
  * @brief Reset internal state
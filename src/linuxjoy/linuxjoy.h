@@ -29,6 +29,7 @@
 // Bootstrap entries
 int linuxjoy_avail();
 oi_device *linuxjoy_device();
+int linuxjoy_hotplug(char *node, char added);
 
 /* ******************************************************************** */
 
@@ -43,6 +44,7 @@ int linuxjoy_reset(oi_device *dev);
 
 // Misc local functions
 int linuxjoy_getfd(unsigned char num);
+unsigned char linuxjoy_find(unsigned char num);
 void linuxjoy_fallback(oi_device *dev, char *name, int fd);
 
 /* ******************************************************************** */
@@ -71,6 +73,7 @@ typedef struct linuxjoy_private {
  */
 #define DLJS_MAX_DEVS 32         /**< Max joystick devices */
 #define DLJS_NAME_SIZE 128       /**< Length of a joystick description (kernel) */
+#define DLJS_READ_EVENTS 64      /**< Max events fetched per read() */
 /** @} */
 
 /* ******************************************************************** */
@@ -0,0 +1,266 @@
+/*
+ * log.c : Leveled logging to an in-memory buffer
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "openinput.h"
+#include "internal.h"
+
+// Claim a slot, safe from several threads where we can
+#ifdef __GNUC__
+#define LOG_CLAIM() __sync_fetch_and_add(&log_head, 1)
+#define LOG_BARRIER() __sync_synchronize()
+#else
+#define LOG_CLAIM() (log_head++)
+#define LOG_BARRIER()
+#endif
+
+// Message buffer
+static struct {
+    volatile unsigned int seq;
+    unsigned char level;
+    char text[OI_LOG_LINE];
+} log_ring[OI_LOG_SIZE];
+static volatile unsigned int log_head = 0;
+static unsigned int log_tail = 0;
+
+// Current level, read by the log macros
+int log_level = OI_LOG_WARN;
+
+// Level names
+static char *log_names[] = {
+    "",
+    "error",
+    "warning",
+    "info",
+    "debug"
+};
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IMain
+ * @brief Store a log message
+ *
+ * @param level log level, see @ref PLog
+ * @param format string pointer with printf-formatting
+ * @param ... more arguments (varargs)
+ *
+ * Use the log_error, log_warn, log_info and debug macros instead,
+ * which skip this call when the level is not enabled, and drop
+ * it altogether when the level is not compiled in (only debug
+ * builds have debug messages).
+ *
+ * The message is formatted into the next slot of a ring buffer,
+ * without locks or I/O, and written out later by oi_log_flush.
+ * When the buffer wraps, the oldest messages are lost.
+ */
+void log_add(int level, char *format, ...) {
+    unsigned int n;
+    va_list args;
+
+    n = LOG_CLAIM();
+
+    // Invalidate, fill and publish the slot
+    log_ring[n & (OI_LOG_SIZE - 1)].seq = 0;
+    LOG_BARRIER();
+    log_ring[n & (OI_LOG_SIZE - 1)].level = (unsigned char)level;
+    va_start(args, format);
+    vsnprintf(log_ring[n & (OI_LOG_SIZE - 1)].text, OI_LOG_LINE, format, args);
+    va_end(args);
+    LOG_BARRIER();
+    log_ring[n & (OI_LOG_SIZE - 1)].seq = n + 1;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IMain
+ * @brief Read log level from environment
+ *
+ * @returns errorcode, see @ref PErrors
+ *
+ * Called on library initialization. The OI_LOG environment
+ * variable may hold a level name ("error", "warning", "info"
+ * or "debug") or number.
+ */
+int log_init() {
+    char *env;
+    int i;
+
+    env = getenv(OI_LOG_ENVIRONMENT);
+    if(!env || !*env) {
+        return OI_ERR_OK;
+    }
+
+    for(i=OI_LOG_ERROR; i<=OI_LOG_DEBUG; i++) {
+        if(strncmp(env, log_names[i], strlen(env)) == 0) {
+            oi_log_level(i);
+            return OI_ERR_OK;
+        }
+    }
+    oi_log_level(atoi(env));
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PMain
+ * @brief Set log level
+ *
+ * @param level new log level, see @ref PLog
+ * @returns previous log level
+ *
+ * Messages up to the given level are kept. Errors and warnings
+ * are kept by default. Debug messages only exist in libraries
+ * built with --enable-debug. The OI_LOG environment variable
+ * sets the level on oi_init.
+ */
+int oi_log_level(int level) {
+    int old;
+
+    old = log_level;
+    if(level < OI_LOG_NONE) {
+        level = OI_LOG_NONE;
+    }
+    if(level > OI_LOG_DEBUG) {
+        level = OI_LOG_DEBUG;
+    }
+    log_level = level;
+
+    return old;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PMain
+ * @brief Write out log messages
+ *
+ * @returns number of messages written
+ *
+ * Log messages are kept in memory, so logging does not slow
+ * down the event pipeline. Call this when convenient, ie. once
+ * per frame or from a logging thread (but from only one thread),
+ * to write them to standard error. Messages lost because the
+ * buffer wrapped are reported. The library flushes on oi_close,
+ * and debug builds also after each pump.
+ */
+int oi_log_flush() {
+    char text[OI_LOG_LINE];
+    unsigned int head;
+    unsigned int lost;
+    unsigned int seq;
+    int level;
+    int num;
+
+    head = log_head;
+    lost = 0;
+    num = 0;
+
+    // Skip what has been overwritten
+    if(head - log_tail > OI_LOG_SIZE) {
+        lost = head - log_tail - OI_LOG_SIZE;
+        log_tail = head - OI_LOG_SIZE;
+    }
+
+    while(log_tail != head) {
+        seq = log_ring[log_tail & (OI_LOG_SIZE - 1)].seq;
+
+        // Still being written, come back later
+        if(seq == 0) {
+            break;
+        }
+
+        // Copy, then check that it was not overwritten meanwhile
+        level = log_ring[log_tail & (OI_LOG_SIZE - 1)].level;
+        memcpy(text, log_ring[log_tail & (OI_LOG_SIZE - 1)].text, OI_LOG_LINE);
+        text[OI_LOG_LINE - 1] = '\0';
+        LOG_BARRIER();
+        if((seq != log_tail + 1) || (log_ring[log_tail & (OI_LOG_SIZE - 1)].seq != seq)) {
+            lost++;
+        }
+        else {
+            if(lost) {
+                fprintf(stderr, "openinput: %u messages lost\n", lost);
+                lost = 0;
+            }
+            fprintf(stderr, "openinput: %s: %s\n",
+                    log_names[(level > OI_LOG_DEBUG) ? 0 : level], text);
+            num++;
+        }
+        log_tail++;
+    }
+
+    if(lost) {
+        fprintf(stderr, "openinput: %u messages lost\n", lost);
+    }
+    return num;
+}
+
+/* ******************************************************************** */
+
+#if !(defined(__GNUC__) || (defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)) || \
+      (defined(_MSC_VER) && (_MSC_VER >= 1400)))
+
+/**
+ * @ingroup IMain
+ * @brief Log helpers for compilers without variadic macros
+ *
+ * @param format string pointer with printf-formatting
+ * @param ... more arguments (varargs)
+ *
+ * Same as the log macros, but always called.
+ */
+#define LOG_FUNCTION(name, level) \
+void name(char *format, ...) { \
+    va_list args; \
+    char text[OI_LOG_LINE]; \
+    if(level > log_level) { \
+        return; \
+    } \
+    va_start(args, format); \
+    vsnprintf(text, OI_LOG_LINE, format, args); \
+    va_end(args); \
+    log_add(level, "%s", text); \
+}
+
+LOG_FUNCTION(log_error, OI_LOG_ERROR)
+LOG_FUNCTION(log_warn, OI_LOG_WARN)
+#if OI_LOG_MAX >= OI_LOG_INFO
+LOG_FUNCTION(log_info, OI_LOG_INFO)
+#endif
+#if OI_LOG_MAX >= OI_LOG_DEBUG
+LOG_FUNCTION(debug, OI_LOG_DEBUG)
+#endif
+
+#endif
+
+/* ******************************************************************** */
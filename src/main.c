@@ -60,6 +60,7 @@ static char oi_running;
  * -# the application state manager is initialized
  * -# the mouse state manager is initialized
  * -# the keyboard state manager is initialized
+ * -# the joystick state manager is initialized
  * -# the action state manager is initialized
  * -# OpenInput enters "initialized mode"
  * -# you're good to go! ;-)
@@ -70,6 +71,10 @@ int oi_init(char *window_id, unsigned int flags) {
 
     // Initialize queue and device manager
     oi_running = FALSE;
+    log_init();
+    oi_stats_reset();
+    latency_init(flags);
+    trace_init();
     if((queue_init() != OI_ERR_OK) ||
        (device_init() != OI_ERR_OK)) {
         return OI_ERR_INTERNAL;
@@ -77,6 +82,7 @@ int oi_init(char *window_id, unsigned int flags) {
 
     // Bootstrap all devices
     device_bootstrap(window_id, flags);
+    hotplug_init(flags);
     debug("oi_init: device init finished");
 
     // Initialize non-critical manager
@@ -85,6 +91,7 @@ int oi_init(char *window_id, unsigned int flags) {
     // The rest _must_ succeed
     if((mouse_init() != OI_ERR_OK) ||
        (keyboard_init() != OI_ERR_OK) ||
+       (joystick_init() != OI_ERR_OK) ||
        (action_init() != OI_ERR_OK)) {
         return OI_ERR_INTERNAL;
     }
@@ -109,28 +116,27 @@ int oi_init(char *window_id, unsigned int flags) {
  * closes - it not, you may experience memory leaks and the like.
  */
 int oi_close() {
-    unsigned char i;
     int e;
 
     debug("oi_close");
     oi_running = FALSE;
 
-    // Parse all devices
-    e = 0;
-    i = 1;
-    while(device_get(i) != NULL) {
+    // Stop watching for new devices
+    hotplug_close();
 
-        // Destroy it
-        if(device_destroy(i) != OI_ERR_OK) {
-            e++;
-        }
+    // Destroy all devices, then unload the plugins with their code
+    e = device_close();
+    plugin_close();
 
-        i++;
-    }
+    // Finish the recording
+    record_close();
 
     // Some managers have shutdown functions
     joystick_close();
 
+    // Write out what is left in the log
+    oi_log_flush();
+
     // Done
     return e;
 }
@@ -186,3 +192,106 @@ unsigned int oi_getticks() {
 }
 
 /* ******************************************************************** */
+
+/**
+ * @ingroup IMain
+ * @brief Get high resolution timestamp
+ *
+ * @returns time in nanoseconds
+ *
+ * This function returns the current time in nanoseconds, preferably
+ * from the monotonic clock. It is used to stamp events that do not
+ * carry a timestamp from the driver, so drivers which deliver their
+ * own timestamps (like evdev) must use the same clock.
+ */
+oi_time oi_gettime() {
+    oi_time t;
+
+    t = 0;
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        t = (oi_time)now.tv_sec*1000000000 + now.tv_nsec;
+    }
+#elif defined(HAVE_GETTIMEOFDAY)
+    {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        t = (oi_time)now.tv_sec*1000000000 + (oi_time)now.tv_usec*1000;
+    }
+#elif defined(ENABLE_WIN32) || defined(ENABLE_DX9)
+    {
+        LARGE_INTEGER now;
+        LARGE_INTEGER freq;
+        QueryPerformanceCounter(&now);
+        QueryPerformanceFrequency(&freq);
+        t = (oi_time)(now.QuadPart / freq.QuadPart) * 1000000000 +
+            (oi_time)(now.QuadPart % freq.QuadPart) * 1000000000 / freq.QuadPart;
+    }
+#endif
+
+    return t;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IMain
+ * @brief Count trailing zero bits
+ *
+ * @param x bitmask, must be non-zero
+ * @returns index of the lowest set bit
+ *
+ * Portable fallback for the OI_CTZ macro, used on compilers
+ * without a count-trailing-zeros builtin. The state managers
+ * use this to walk "dirty" bitmasks without testing every bit.
+ */
+unsigned int oi_ctz(unsigned int x) {
+    unsigned int n;
+
+    n = 0;
+    while(!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IMain
+ * @brief Parse number in symbolic name
+ *
+ * @param str string with decimal digits only
+ * @param max highest allowed value
+ * @returns the number, or -1 if the string is not a number in range
+ *
+ * Used by the name parsers instead of atoi, which ignores trailing
+ * garbage and turns an empty string into zero. Leading zeros are
+ * refused, so each number has exactly one name.
+ */
+int oi_number(char *str, int max) {
+    int val;
+
+    if(!str || (*str < '0') || (*str > '9') || ((str[0] == '0') && (str[1] != '\0'))) {
+        return -1;
+    }
+
+    val = 0;
+    while(*str) {
+        if((*str < '0') || (*str > '9')) {
+            return -1;
+        }
+        val = val*10 + (*str - '0');
+        if(val > max) {
+            return -1;
+        }
+        str++;
+    }
+
+    return val;
+}
+
+/* ******************************************************************** */
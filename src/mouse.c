@@ -52,37 +52,37 @@ int mouse_init() {
 
 /**
  * @ingroup IMouse
- * @brief Allocate and prepare private managment data
+ * @brief Prepare private managment data
  *
- * @param mouse pointer to the address of the private mouse data
+ * @param mouse pointer to mouse data in the managment data arena
  * @param provide provide mask, see @ref PProvide
  *
  * @pre This function is called during "device_register" where
- * the base device->managment structure has been allocated and
- * initialized
+ * a slot (and thus room in the managment data arena) has been
+ * allocated for the device
  *
- * This function (possible) allocates and initializes the mouse
- * per-device private managment data, ie. absolute and relative
- * motion of the mouse and the button state
+ * This function initializes the mouse per-device private
+ * managment data, ie. absolute and relative motion of the mouse
+ * and the button state
  *
- * The structure might also not be created, depending on whether
- * the device provides a mice as determined by the provide-mask
+ * Nothing is done if the device does not provide a mouse, as
+ * determined by the provide-mask
  */
-void mouse_manage(oi_privmouse **mouse, unsigned int provide) {
+void mouse_manage(oi_privmouse *mouse, unsigned int provide) {
     // Only care about keyboard
     if(!(provide & OI_PRO_MOUSE)) {
         return;
     }
 
-    // Allocate
-    *mouse = (oi_privmouse*)malloc(sizeof(oi_privmouse));
-
     // Clear state
-    (*mouse)->button = OI_BUTTON_MASK(OIP_UNKNOWN);
-    (*mouse)->absx = 0;
-    (*mouse)->absy = 0;
-    (*mouse)->relx = 0;
-    (*mouse)->rely = 0;
+    mouse->button = OI_BUTTON_MASK(OIP_UNKNOWN);
+    mouse->absx = 0;
+    mouse->absy = 0;
+    mouse->relx = 0;
+    mouse->rely = 0;
+    mouse->wheely = 0;
+    mouse->wheelx = 0;
+    mouse->wheelrem = 0;
 
     debug("mouse_manage: manager data installed");
 }
@@ -118,6 +118,7 @@ void mouse_move(unsigned char index, int x, int y, char relative, char post) {
     if(!priv) {
         return;
     }
+    trace_add(OI_TRACE_MANAGER, index, OI_MOUSEMOVE);
 
     // Always make x,y absolute
     rx = x;
@@ -198,6 +199,7 @@ void mouse_button(unsigned char index, oi_mouse btn, char down, char post) {
     if(!priv) {
         return;
     }
+    trace_add(OI_TRACE_MANAGER, index, down ? OI_MOUSEBUTTONDOWN : OI_MOUSEBUTTONUP);
 
     newbutton = priv->button;
 
@@ -235,6 +237,64 @@ void mouse_button(unsigned char index, oi_mouse btn, char down, char post) {
 
 /* ******************************************************************** */
 
+/**
+ * @ingroup IMouse
+ * @brief Mouse wheel update
+ *
+ * @param index device index
+ * @param vert vertical wheel motion, positive is up (away from user)
+ * @param horiz horizontal wheel motion, positive is right
+ * @param post true (1) to send events, false (0) otherwise
+ *
+ * Inject high resolution wheel motion into the mouse state manager.
+ * Motion is in units of 1/OI_WHEEL_DETENT of a wheel click. Each
+ * time the vertical wheel has moved a full click, a wheel up/down
+ * button press and release is generated, so applications which
+ * only know about wheel buttons keep working.
+ *
+ * Drivers for wheels without high resolution should multiply
+ * the number of clicks by OI_WHEEL_DETENT, or simply inject
+ * OIP_WHEEL_UP/OIP_WHEEL_DOWN using mouse_button.
+ */
+void mouse_wheel(unsigned char index, int vert, int horiz, char post) {
+    oi_privmouse *priv;
+    oi_mouse btn;
+
+    // Get private per-device data
+    priv = (oi_privmouse*)device_priv(index, OI_PRO_MOUSE);
+    if(!priv) {
+        return;
+    }
+
+    // Accumulate for oi_mouse_wheel
+    priv->wheely += vert;
+    priv->wheelx += horiz;
+
+    // Start over when changing direction
+    if(((vert > 0) && (priv->wheelrem < 0)) ||
+       ((vert < 0) && (priv->wheelrem > 0))) {
+        priv->wheelrem = 0;
+    }
+    priv->wheelrem += vert;
+
+    // Click the wheel button for every full detent
+    while((priv->wheelrem >= OI_WHEEL_DETENT) ||
+          (priv->wheelrem <= -OI_WHEEL_DETENT)) {
+        if(priv->wheelrem > 0) {
+            btn = OIP_WHEEL_UP;
+            priv->wheelrem -= OI_WHEEL_DETENT;
+        }
+        else {
+            btn = OIP_WHEEL_DOWN;
+            priv->wheelrem += OI_WHEEL_DETENT;
+        }
+        mouse_button(index, btn, TRUE, post);
+        mouse_button(index, btn, FALSE, post);
+    }
+}
+
+/* ******************************************************************** */
+
 /**
  * @ingroup PMouse
  * @brief Get absolute position of mouse pointer
@@ -263,16 +323,7 @@ int oi_mouse_absolute(unsigned char index, int *x, int *y) {
     // Get device index
     i = index;
     if(i == 0) {
-        for(i=1; i<OI_MAX_DEVICES; i++) {
-            if(device_priv(i, OI_PRO_MOUSE)) {
-                break;
-            }
-        }
-
-        // End reached
-        if(i==OI_MAX_DEVICES) {
-            return OIP_UNKNOWN;
-        }
+        i = device_first(OI_PRO_MOUSE);
     }
 
     // Get device data
@@ -330,16 +381,7 @@ int oi_mouse_relative(unsigned char index, int *x, int *y) {
     // Get device index
     i = index;
     if(i == 0) {
-        for(i=1; i<OI_MAX_DEVICES; i++) {
-            if(device_priv(i, OI_PRO_MOUSE)) {
-                break;
-            }
-        }
-
-        // End reached
-        if(i==OI_MAX_DEVICES) {
-            return OIP_UNKNOWN;
-        }
+        i = device_first(OI_PRO_MOUSE);
     }
 
     // Get device data
@@ -366,6 +408,62 @@ int oi_mouse_relative(unsigned char index, int *x, int *y) {
 
 /* ******************************************************************** */
 
+/**
+ * @ingroup PMouse
+ * @brief Get mouse wheel motion
+ *
+ * @param index device index, 0 for default mouse
+ * @param vert pointer to vertical wheel motion (positive is up)
+ * @param horiz pointer to horizontal wheel motion (positive is right)
+ * @returns mouse button mask, see @ref PMouseMask
+ *
+ * Get the wheel motion since last call to this function (ie. it
+ * is cummulative), in units of 1/OI_WHEEL_DETENT of a wheel click.
+ * Drivers for high resolution wheels report motion smaller than
+ * a click, others report whole clicks.
+ */
+int oi_mouse_wheel(unsigned char index, int *vert, int *horiz) {
+    oi_privmouse *priv;
+    unsigned char i;
+
+    // Default motion
+    if(vert) {
+        *vert = 0;
+    }
+    if(horiz) {
+        *horiz = 0;
+    }
+
+    // Get device index
+    i = index;
+    if(i == 0) {
+        i = device_first(OI_PRO_MOUSE);
+    }
+
+    // Get device data
+    priv = (oi_privmouse*)device_priv(i, OI_PRO_MOUSE);
+    if(!priv) {
+        return OIP_UNKNOWN;
+    }
+
+    // Set data
+    if(vert) {
+        *vert = priv->wheely;
+    }
+    if(horiz) {
+        *horiz = priv->wheelx;
+    }
+
+    // Reset deltas
+    priv->wheely = 0;
+    priv->wheelx = 0;
+
+    // Return button state
+    return priv->button;
+}
+
+/* ******************************************************************** */
+
 /**
  * @ingroup PMouse
  * @brief Warp (move) mouse pointer
@@ -381,6 +479,7 @@ int oi_mouse_relative(unsigned char index, int *x, int *y) {
  */
 int oi_mouse_warp(unsigned char index, int x, int y) {
     oi_device *dev;
+    unsigned int n;
     unsigned char i;
     int e;
 
@@ -399,13 +498,8 @@ int oi_mouse_warp(unsigned char index, int x, int y) {
     }
     e = OI_ERR_NO_DEVICE;
 
-    // Parse all devices
-    for(i=1; i<OI_MAX_DEVICES; i++) {
-
-        // Only touch a single device?
-        if(index != 0) {
-            i = index;
-        }
+    // Parse all devices, or only touch a single device
+    for(n=0; (i = index ? index : device_live(n)); n++) {
 
         // Get device
         dev = device_get(i);
@@ -483,12 +577,15 @@ char *oi_mouse_getname(oi_mouse button) {
  * Translate symbolic string into mouse code.
  */
 oi_mouse oi_mouse_getcode(char *name) {
+    unsigned int len;
+
     // Dummies
     if(!name) {
         return OIP_UNKNOWN;
     }
-    if((strlen(name) < OI_MIN_KEYLENGTH) ||
-       (strlen(name) > OI_MAX_KEYLENGTH)) {
+    len = strlen(name);
+    if((len < OI_MIN_KEYLENGTH) ||
+       (len > OI_MAX_KEYLENGTH)) {
         return OIP_UNKNOWN;
     }
 
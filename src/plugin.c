@@ -0,0 +1,190 @@
+/*
+ * plugin.c : Loadable driver plugins
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ENABLE_PLUGINS
+#include <dirent.h>
+#include <dlfcn.h>
+#endif
+
+#include "openinput.h"
+#include "internal.h"
+
+// Globals
+#ifdef ENABLE_PLUGINS
+static void *handles[OI_MAX_PLUGINS];
+static oi_bootstrap *plugins[OI_MAX_PLUGINS];
+static unsigned int num_plugins = 0;
+#endif
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Get plugin directory
+ *
+ * @returns path of directory with driver plugins
+ *
+ * The directory is taken from the OI_PLUGINDIR environment
+ * variable, or the library directory chosen at build time.
+ */
+char *plugin_dir() {
+    char *dir;
+
+    dir = getenv(OI_PLUGIN_ENVIRONMENT);
+    if(dir && *dir) {
+        return dir;
+    }
+    return OI_PLUGIN_DIR;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Load driver plugins
+ *
+ * @returns number of plugins loaded
+ *
+ * Scan the plugin directory for shared objects, and load those
+ * which the device manager wants (see device_wanted). A plugin
+ * must be named after its driver, ie. "x11.so", and export
+ * the bootstrap structure as "x11_bootstrap" - the same
+ * symbol as when the driver is compiled into the library.
+ * Plugins from an earlier initialization are unloaded first.
+ */
+int plugin_load() {
+#ifdef ENABLE_PLUGINS
+    char path[OI_MAX_PATH];
+    char name[OI_MAX_PLUGNAME];
+    char sym[OI_MAX_PLUGNAME + 16];
+    struct dirent *ent;
+    oi_bootstrap *boot;
+    DIR *dir;
+    void *h;
+    int len;
+
+    plugin_close();
+
+    // No directory is fine, nothing to load
+    dir = opendir(plugin_dir());
+    if(!dir) {
+        return 0;
+    }
+
+    while(((ent = readdir(dir)) != NULL) && (num_plugins < OI_MAX_PLUGINS)) {
+
+        // Driver name is the file name without ".so"
+        len = (int)strlen(ent->d_name) - 3;
+        if((len < 1) || (len >= OI_MAX_PLUGNAME) ||
+           (strcmp(ent->d_name + len, ".so") != 0)) {
+            continue;
+        }
+        memcpy(name, ent->d_name, len);
+        name[len] = '\0';
+
+        // Unwanted drivers are not even loaded
+        if(!device_wanted(name)) {
+            debug("plugin_load: skipping '%s'", name);
+            continue;
+        }
+
+        if(snprintf(path, sizeof(path), "%s/%s", plugin_dir(), ent->d_name) >= (int)sizeof(path)) {
+            continue;
+        }
+        h = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+        if(!h) {
+            log_warn("plugin_load: %s", dlerror());
+            continue;
+        }
+
+        sprintf(sym, "%s_bootstrap", name);
+        boot = (oi_bootstrap*)dlsym(h, sym);
+        if(!boot) {
+            debug("plugin_load: '%s' has no %s", path, sym);
+            dlclose(h);
+            continue;
+        }
+
+        debug("plugin_load: loaded '%s'", path);
+        handles[num_plugins] = h;
+        plugins[num_plugins] = boot;
+        num_plugins++;
+    }
+    closedir(dir);
+
+    return num_plugins;
+#else
+    return 0;
+#endif
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Get loaded plugin
+ *
+ * @param n number of plugin, starting from zero
+ * @returns bootstrap structure of plugin, NULL when there are
+ * no more plugins
+ */
+oi_bootstrap *plugin_get(unsigned int n) {
+#ifdef ENABLE_PLUGINS
+    if(n < num_plugins) {
+        return plugins[n];
+    }
+#endif
+    return NULL;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IDevice
+ * @brief Unload driver plugins
+ *
+ * @returns errorcode, see @ref PErrors
+ *
+ * Called on library shutdown, after the devices have been
+ * destroyed.
+ */
+int plugin_close() {
+#ifdef ENABLE_PLUGINS
+    while(num_plugins > 0) {
+        num_plugins--;
+        dlclose(handles[num_plugins]);
+        handles[num_plugins] = NULL;
+        plugins[num_plugins] = NULL;
+    }
+#endif
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
@@ -27,6 +27,29 @@
 /* ******************************************************************** */
 
 
+/**
+ * @ingroup IPrivate
+ * @brief Joystick calibration kernel coefficients
+ *
+ * Calibration profile (see oi_joycalib) converted into per-axis
+ * floating point factors, laid out so that the calibration kernel
+ * can process four axes at a time.
+ */
+typedef struct oi_joykernel {
+    float min[OI_JOY_NUM_AXES];                        /**< Raw clip minimum */
+    float max[OI_JOY_NUM_AXES];                        /**< Raw clip maximum */
+    float center[OI_JOY_NUM_AXES];                     /**< Raw center */
+    float pos[OI_JOY_NUM_AXES];                        /**< Scale above center */
+    float neg[OI_JOY_NUM_AXES];                        /**< Scale below center */
+    float dead[OI_JOY_NUM_AXES];                       /**< Axial deadzone */
+    float deadscale[OI_JOY_NUM_AXES];                  /**< Rescale outside deadzone */
+    float radial[OI_JOY_NUM_AXES];                     /**< Radial deadzone */
+    float alpha[OI_JOY_NUM_AXES];                      /**< Smoothing filter weight */
+    float filter[OI_JOY_NUM_AXES];                     /**< Smoothing filter state */
+    char hasradial;                                    /**< Any radial deadzone set */
+} oi_joykernel;
+
+
 /**
  * @ingroup IPrivate
  * @brief Per-device joystick managment data
@@ -39,7 +62,13 @@ typedef struct oi_privjoy {
     int relaxes[OI_JOY_NUM_AXES];                      /**< Cummulative relative axes values */
     int absaxes[OI_JOY_NUM_AXES];                      /**< Absolute axes values */
     int insaxes[OI_JOY_NUM_AXES];                      /**< Instantaneous relative values */
-    char update[OI_JOY_NUM_AXES];                      /**< Post event update */
+    int rawaxes[OI_JOY_NUM_AXES];                      /**< Raw absolute values (calibrated only) */
+    unsigned int update;                               /**< Bitmask of axes pending post */
+    unsigned int calpend;                              /**< Bitmask of axes pending calibration */
+    unsigned int calpost;                              /**< Bitmask of calibrated axes to post if changed */
+    char calready;                                     /**< Kernel matches calibration profile */
+    oi_time stamp;                                     /**< Time of pending axis updates, 0 if unknown */
+    oi_joykernel kernel;                               /**< Calibration kernel */
 } oi_privjoy;
 
 
@@ -56,6 +85,9 @@ typedef struct oi_privmouse {
     int absy;                                          /**< Absolute vertical position */
     int relx;                                          /**< Relative horizontal movement */
     int rely;                                          /**< Relative vertical movement */
+    int wheely;                                        /**< Vertical wheel motion */
+    int wheelx;                                        /**< Horizontal wheel motion */
+    int wheelrem;                                      /**< Vertical motion since last detent */
 } oi_privmouse;
 
 
@@ -77,20 +109,49 @@ typedef struct oi_privkey {
 
 /**
  * @ingroup IPrivate
- * @brief Private per-device data for managers
+ * @brief Manager data arena
  *
  * The managers (keyboard/mouse/joystick) usually need some
  * per-device specific data, for example to store the
  * mouse cursor position or to perform joystick axis mapping.
- * This structure is a placeholder/entry, which is tied
- * into the device interface (device structure).
+ * The data of each manager is kept in an array of the per-device
+ * structures, with an entry for every possible slot, so the
+ * structures of all joysticks (or mice, or keyboards) follow each
+ * other in memory. The arrays are carved from a single allocation
+ * made for OI_MAX_DEVICES slots, which never moves.
  */
 typedef struct oi_private {
-    oi_privkey *key;                                    /**< Keyboard data */
-    oi_privmouse *mouse;                                /**< Mouse data */
-    oi_privjoy *joy;                                    /**< Joystick data */
+    char *block;                                        /**< Allocation holding the arrays */
+    oi_privkey *key;                                    /**< Keyboard data, per slot */
+    oi_privmouse *mouse;                                /**< Mouse data, per slot */
+    oi_privjoy *joy;                                    /**< Joystick data, per slot */
 } oi_private;
 
 /* ******************************************************************** */
 
+/**
+ * @ingroup IPrivate
+ * @brief Slot in the device table
+ *
+ * The device index is the number of the slot (plus one). Slots of
+ * removed devices are reused, and the generation counter is bumped
+ * every time a slot is released, so a handle (index and generation,
+ * see device_handle) can tell a device from a later occupant
+ * of the same slot. The name and description of a removed device
+ * are kept in the slot until the next device in it is removed, as
+ * the OI_DEVICELOST event points to them.
+ */
+typedef struct oi_devslot {
+    struct oi_device *dev;                              /**< Device interface, NULL if free */
+    unsigned int managers;                              /**< Provide-mask of installed manager data */
+    unsigned int gen;                                   /**< Generation of slot */
+    char run;                                           /**< Pump enabled */
+    unsigned char live;                                 /**< Position in list of live devices */
+    unsigned char next;                                 /**< Next free slot (index), 0 for none */
+    char *lostname;                                     /**< Name of removed device, or NULL */
+    char *lostdesc;                                     /**< Description of removed device, or NULL */
+} oi_devslot;
+
+/* ******************************************************************** */
+
 #endif
@@ -31,10 +31,20 @@
 // Globals
 static struct {
     oi_event events[OI_MAX_EVENTS];
+    oi_time stamps[OI_MAX_EVENTS];
     unsigned int head;
     unsigned int tail;
+    oi_time stamp;
+    oi_time last;
 } queue;
 
+// Event filters, called in order of installation
+static struct {
+    oi_filter fn;
+    void *data;
+} filters[OI_MAX_FILTERS];
+static unsigned int num_filters = 0;
+
 /* ******************************************************************** */
 
 /**
@@ -54,7 +64,13 @@ int queue_init() {
     // Clear event queue
     queue.head = 0;
     queue.tail = 0;
+    queue.stamp = 0;
+    queue.last = 0;
     memset(queue.events, 0, sizeof(queue.events));
+    memset(queue.stamps, 0, sizeof(queue.stamps));
+
+    // Filters belong to the previous session
+    num_filters = 0;
 
     //TODO: Mutexes and threads should gracefully be started here
 
@@ -99,18 +115,37 @@ int queue_unlock() {
  * @brief Add event to queue
  *
  * @param evt pointer to event
- * @returns true (1) if event added, false (0) otherwise
+ * @returns true (1) if event added or dropped by a filter,
+ * false (0) if the queue is full
  *
  * Add a single event to the event queue. This is the function
  * you want to use if you want to inject events into the
  * event queue yourself. Please note that you should use
  * the state managers if possible, as these will take
  * care of a lot of other nice stuff for you.
+ *
+ * The filters see the event first, so a dropped event never
+ * takes a queue slot nor generates action events.
  */
 int queue_add(oi_event *evt) {
+    oi_event copy;
     unsigned int tail;
+    unsigned int i;
 	int add;
 
+    // Run filters on a copy, the caller keeps its event
+    if(num_filters) {
+        copy = *evt;
+        for(i=0; i<num_filters; i++) {
+            if(!filters[i].fn(&copy, filters[i].data)) {
+                OI_PROBE2(queue__filter, OI_EVDEVICE(&copy), copy.type);
+                stats_filter(copy.type);
+                return 1;
+            }
+        }
+        evt = &copy;
+    }
+
     //FIXME Generate action events on keyboard/mouse
     if((evt->type == OI_KEYUP) ||
        (evt->type == OI_KEYDOWN) ||
@@ -127,12 +162,20 @@ int queue_add(oi_event *evt) {
 
     // Overflow, drop it
     if(tail == queue.head) {
+        trace_add(OI_TRACE_DROP, OI_EVDEVICE(evt), evt->type);
+        OI_PROBE2(queue__drop, OI_EVDEVICE(evt), evt->type);
+        stats_queue(evt, FALSE, OI_MAX_EVENTS - 1);
         add = 0;
     }
 
     // Insert it by COPYING!
     else {
         queue.events[queue.tail] = *evt;
+        queue.stamps[queue.tail] = queue.stamp ? queue.stamp : oi_gettime();
+        record_add(evt, queue.stamps[queue.tail]);
+        trace_add(OI_TRACE_QUEUE, OI_EVDEVICE(evt), evt->type);
+        OI_PROBE3(queue__add, OI_EVDEVICE(evt), evt->type, queue.stamps[queue.tail]);
+        stats_queue(evt, TRUE, (tail + OI_MAX_EVENTS - queue.head) % OI_MAX_EVENTS);
         add = 1;
         // SDL does some special windowmanager event handling here
 
@@ -179,10 +222,7 @@ int queue_cut(unsigned int where) {
         unsigned int here;
 
         // Wrap around negative tail
-        --queue.tail;
-        if(queue.tail < 0) {
-            queue.tail = OI_MAX_EVENTS-1;
-        }
+        queue.tail = (queue.tail+OI_MAX_EVENTS-1)%OI_MAX_EVENTS;
 
         // Shift everything backwards
         for(here=where; here!=queue.tail; here=next) {
@@ -190,6 +230,7 @@ int queue_cut(unsigned int where) {
 
             // We use COPYING here
             queue.events[here] = queue.events[next];
+            queue.stamps[here] = queue.stamps[next];
         }
 
         // Done
@@ -239,6 +280,10 @@ int queue_peep(oi_event *evts, unsigned int num, unsigned int mask, char remove)
 
             // With or without removal
             if(remove) {
+                trace_deliver(&(evts[copy-1]));
+                queue.last = queue.stamps[here];
+                latency_add(evts[copy-1].type, queue.last);
+                OI_PROBE3(queue__remove, OI_EVDEVICE(&(evts[copy-1])), evts[copy-1].type, queue.last);
                 here = queue_cut(here);
             }
             else {
@@ -256,3 +301,120 @@ int queue_peep(oi_event *evts, unsigned int num, unsigned int mask, char remove)
 }
 
 /* ******************************************************************** */
+
+/**
+ * @ingroup IQueue
+ * @brief Set timestamp for new events
+ *
+ * @param stamp timestamp in nanoseconds, 0 to use the current time
+ *
+ * Events added to the queue are stamped with this time, which
+ * lets drivers carry the device's own event time into the queue.
+ * The stamp is reset after each device has been pumped.
+ */
+void queue_stamp(oi_time stamp) {
+    queue.stamp = stamp;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IQueue
+ * @brief Get timestamp for new events
+ *
+ * @returns timestamp set by queue_stamp, 0 if none
+ *
+ * State managers which post events later, like the joystick
+ * pump, use this to keep the time of the driver's frame.
+ */
+oi_time queue_nextstamp() {
+    return queue.stamp;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IQueue
+ * @brief Get timestamp of last removed event
+ *
+ * @returns timestamp in nanoseconds
+ *
+ * Return the timestamp of the event most recently removed
+ * from the queue by queue_peep.
+ */
+oi_time queue_timestamp() {
+    return queue.last;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PEvents
+ * @brief Add event filter
+ *
+ * @param fn filter function
+ * @param data pointer passed to the filter
+ * @returns errorcode, see @ref PErrors
+ *
+ * The filter is called with every event as it is added to the
+ * queue, from within oi_events_pump or oi_events_add. It may
+ * change the event, or return false (0) to drop it before it
+ * takes up space in the queue. This is the place for handlers
+ * which must react at once, or to get rid of events the
+ * application never wants. Filters run in the order they were
+ * added and may add events themselves, but must not add or
+ * remove filters.
+ *
+ * Add filters after oi_init, which removes any left over
+ * from a previous session.
+ */
+int oi_events_addfilter(oi_filter fn, void *data) {
+    if(!fn) {
+        return OI_ERR_PARAM;
+    }
+    if(num_filters >= OI_MAX_FILTERS) {
+        return OI_ERR_INDEX;
+    }
+
+    filters[num_filters].fn = fn;
+    filters[num_filters].data = data;
+    num_filters++;
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PEvents
+ * @brief Remove event filter
+ *
+ * @param fn filter function
+ * @param data pointer given to oi_events_addfilter
+ * @returns errorcode, see @ref PErrors
+ *
+ * Remove the filter added with the same function and data
+ * pointer. The remaining filters keep their order.
+ */
+int oi_events_delfilter(oi_filter fn, void *data) {
+    unsigned int i;
+
+    for(i=0; i<num_filters; i++) {
+        if((filters[i].fn == fn) && (filters[i].data == data)) {
+            break;
+        }
+    }
+    if(i == num_filters) {
+        return OI_ERR_PARAM;
+    }
+
+    // Shift the rest down
+    num_filters--;
+    for(; i<num_filters; i++) {
+        filters[i] = filters[i+1];
+    }
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
@@ -0,0 +1,191 @@
+/*
+ * record.c : Event recorder
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include "openinput.h"
+#include "internal.h"
+
+// Globals
+static FILE *record_file = NULL;
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IQueue
+ * @brief Write a recording entry
+ *
+ * @param evt the event
+ * @param stamp event timestamp
+ * @returns errorcode, see @ref PErrors
+ *
+ * The event is written as is, except for the name and
+ * description of discovery events, which are appended
+ * to the entry as strings.
+ */
+static int record_write(oi_event *evt, oi_time stamp) {
+    static const char zero[OI_REC_ALIGN] = { 0 };
+    oi_recentry ent;
+    unsigned int nlen;
+    unsigned int dlen;
+
+    memset(&ent, 0, sizeof(ent));
+    ent.stamp = stamp;
+    ent.event = *evt;
+    ent.size = sizeof(ent);
+    nlen = 0;
+    dlen = 0;
+
+    // Device names can not be pointed to from a file
+    if((evt->type == OI_DISCOVERY) || (evt->type == OI_DEVICELOST)) {
+        nlen = evt->discover.name ? strlen(evt->discover.name) + 1 : 1;
+        dlen = evt->discover.description ? strlen(evt->discover.description) + 1 : 1;
+        ent.event.discover.name = NULL;
+        ent.event.discover.description = NULL;
+        ent.size = OI_ALIGN(sizeof(ent) + nlen + dlen, OI_REC_ALIGN);
+    }
+
+    if(fwrite(&ent, sizeof(ent), 1, record_file) != 1) {
+        return OI_ERR_INTERNAL;
+    }
+    if(nlen) {
+        fwrite(evt->discover.name ? evt->discover.name : "", 1, nlen, record_file);
+        fwrite(evt->discover.description ? evt->discover.description : "", 1, dlen, record_file);
+        fwrite(zero, 1, ent.size - sizeof(ent) - nlen - dlen, record_file);
+    }
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PEvents
+ * @brief Record events to file
+ *
+ * @param filename file to write, or NULL to stop recording
+ * @returns errorcode, see @ref PErrors
+ *
+ * Every event added to the queue from now on is appended to
+ * the file with its timestamp, see oi_events_timestamp. Events
+ * dropped by a full queue are not recorded. The devices already
+ * present are recorded first as discovery events, so a recording
+ * is self-contained.
+ *
+ * Recordings are played back with the replay driver.
+ */
+int oi_events_record(char *filename) {
+    oi_rechead head;
+    oi_device *dev;
+    oi_event ev;
+    oi_time now;
+    unsigned int n;
+    unsigned char index;
+
+    // Stop previous recording
+    record_close();
+    if(!filename) {
+        return OI_ERR_OK;
+    }
+
+    debug("oi_events_record: recording to '%s'", filename);
+    record_file = fopen(filename, "wb");
+    if(!record_file) {
+        return OI_ERR_PARAM;
+    }
+
+    // Header
+    now = oi_gettime();
+    memset(&head, 0, sizeof(head));
+    memcpy(head.magic, OI_REC_MAGIC, sizeof(head.magic));
+    head.version = OI_REC_VERSION;
+    head.order = OI_REC_ORDER;
+    head.evsize = sizeof(oi_event);
+    head.entsize = sizeof(oi_recentry);
+    head.start = now;
+    fwrite(&head, sizeof(head), 1, record_file);
+
+    // Devices we have
+    for(n=0; (index = device_live(n)) != 0; n++) {
+        dev = device_get(index);
+        ev.type = OI_DISCOVERY;
+        ev.discover.device = index;
+        ev.discover.name = dev->name;
+        ev.discover.description = dev->desc;
+        ev.discover.provides = dev->provides;
+        record_write(&ev, now);
+    }
+
+    if(ferror(record_file)) {
+        record_close();
+        return OI_ERR_INTERNAL;
+    }
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IQueue
+ * @brief Record event
+ *
+ * @param evt the event
+ * @param stamp event timestamp
+ * @returns errorcode, see @ref PErrors
+ *
+ * Called by the queue for every added event. Does nothing
+ * unless a recording is running.
+ */
+int record_add(oi_event *evt, oi_time stamp) {
+    if(!record_file) {
+        return OI_ERR_OK;
+    }
+    return record_write(evt, stamp);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IQueue
+ * @brief Stop recording
+ *
+ * @returns errorcode, see @ref PErrors
+ *
+ * Flush and close the recording, if any.
+ */
+int record_close() {
+    if(!record_file) {
+        return OI_ERR_OK;
+    }
+
+    debug("record_close");
+    fclose(record_file);
+    record_file = NULL;
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
@@ -0,0 +1,363 @@
+/*
+ * replay.c : Replay of event recordings
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include "openinput.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "internal.h"
+#include "bootstrap.h"
+#include "replay.h"
+
+/**
+ * @ingroup Drivers
+ * @defgroup DReplay Replay driver
+ * @brief Replay of event recordings
+ *
+ * Plays back a recording made with oi_events_record, so input
+ * can be reproduced exactly for bug reports and load tests. The
+ * driver is only available when the OI_REPLAY environment
+ * variable names a recording, ie. "OI_REPLAY=/tmp/bug.rec".
+ *
+ * Events are posted with the same spacing as they were recorded,
+ * and with matching timestamps, see oi_events_timestamp. The
+ * OI_REPLAY_SPEED variable scales the playback, ie. "2" plays
+ * twice as fast, and "0" posts events as fast as the queue
+ * takes them.
+ *
+ * The recording is memory mapped, and events are handed to the
+ * queue directly from the mapping. Events are posted as they
+ * were recorded (with the device indices of the recording), they
+ * do not go through the state managers.
+ */
+
+// Bootstrap global
+oi_bootstrap replay_bootstrap = {
+    "replay",
+    "Replay of event recordings",
+    OI_PRO_UNKNOWN,
+    replay_avail,
+    replay_device
+};
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DReplay
+ * @brief Check if a recording is given
+ *
+ * @param flags library initialization flags, see @ref PFlags
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a bootstrap function.
+ *
+ * Available when OI_REPLAY is set, the file itself is
+ * checked in replay_init.
+ */
+int replay_avail(unsigned int flags) {
+    char *env;
+
+    debug("replay_avail");
+
+    env = getenv(DREPLAY_ENVIRONMENT);
+    return env && *env;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DReplay
+ * @brief Create replay device driver interface
+ *
+ * @returns pointer to device interface, see @ref IDevstructs
+ *
+ * This is a bootstrap function.
+ *
+ * Create the device interface.
+ */
+oi_device *replay_device() {
+    oi_device *dev;
+    replay_private *priv;
+
+    debug("replay_device");
+
+    // Alloc device data
+    dev = (oi_device*)malloc(sizeof(oi_device));
+    priv = (replay_private*)malloc(sizeof(replay_private));
+    if((dev == NULL) || (priv == NULL)) {
+        debug("replay_device: device creation failed");
+        if(dev) {
+            free(dev);
+        }
+        if(priv) {
+            free(priv);
+        }
+        return NULL;
+    }
+
+    // Clear structures
+    memset(dev, 0, sizeof(oi_device));
+    memset(priv, 0, sizeof(replay_private));
+
+    // Set members
+    dev->init = replay_init;
+    dev->destroy = replay_destroy;
+    dev->process = replay_process;
+    dev->grab = NULL;
+    dev->hide = NULL;
+    dev->warp = NULL;
+    dev->winsize = NULL;
+    dev->reset = replay_reset;
+    dev->private = priv;
+
+    // Done
+    return dev;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DReplay
+ * @brief Initialize the replay driver
+ *
+ * @param dev pointer to created device interface
+ * @param window_id window hook parameters, see @ref PWindow
+ * @param flags initialization flags, see @ref PFlags
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Map the recording and check that it was made by a library
+ * with the same event layout.
+ */
+int replay_init(oi_device *dev, char *window_id, unsigned int flags) {
+    replay_private *priv;
+    struct stat st;
+    char *speed;
+    int fd;
+
+    priv = (replay_private*)dev->private;
+    debug("replay_init");
+
+    fd = open(getenv(DREPLAY_ENVIRONMENT), O_RDONLY, 0);
+    if(fd == -1) {
+        log_error("replay_init: can not open recording");
+        return OI_ERR_NO_DEVICE;
+    }
+
+    if((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(oi_rechead))) {
+        close(fd);
+        return OI_ERR_NO_DEVICE;
+    }
+
+    // The mapping stays valid after close
+    priv->len = st.st_size;
+    priv->map = mmap(NULL, priv->len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(priv->map == MAP_FAILED) {
+        priv->map = NULL;
+        return OI_ERR_NO_DEVICE;
+    }
+
+    priv->first = replay_check((oi_rechead*)priv->map, priv->len);
+    if(!priv->first) {
+        log_error("replay_init: not a recording, or a different version");
+        munmap(priv->map, priv->len);
+        priv->map = NULL;
+        return OI_ERR_NO_DEVICE;
+    }
+    priv->end = (char*)priv->map + priv->len;
+
+    // Playback speed
+    priv->speed = 1.0;
+    speed = getenv(DREPLAY_SPEED_ENVIRONMENT);
+    if(speed && *speed) {
+        priv->speed = strtod(speed, NULL);
+        if(priv->speed < 0) {
+            priv->speed = 1.0;
+        }
+    }
+
+    replay_reset(dev);
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DReplay
+ * @brief Destroy the replay driver
+ *
+ * @param dev pointer to device interface
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Unmap the recording and free the device structure.
+ */
+int replay_destroy(oi_device *dev) {
+    replay_private *priv;
+
+    debug("replay_destroy");
+
+    if(dev) {
+        priv = (replay_private*)dev->private;
+        if(priv) {
+            if(priv->map) {
+                munmap(priv->map, priv->len);
+            }
+            free(priv);
+        }
+        free(dev);
+    }
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DReplay
+ * @brief Process events
+ *
+ * @param dev pointer to device interface
+ *
+ * This is a device interface function.
+ *
+ * Post the entries which are due. Entries are used in place,
+ * only discovery events are copied to point their names into
+ * the mapping. If the queue is full, the rest is posted at the
+ * next pump.
+ */
+void replay_process(oi_device *dev) {
+    replay_private *priv;
+    oi_recentry *ent;
+    oi_event ev;
+    oi_time now;
+    oi_time due;
+    char *name;
+    size_t len;
+
+    priv = (replay_private*)dev->private;
+    now = oi_gettime();
+
+    while((char*)priv->next + sizeof(oi_recentry) <= priv->end) {
+        ent = priv->next;
+
+        // Broken entry, stop the replay
+        if((ent->size < sizeof(oi_recentry)) || (ent->size % OI_REC_ALIGN) ||
+           ((char*)ent + ent->size > priv->end)) {
+            log_error("replay_process: broken entry");
+            priv->next = (oi_recentry*)priv->end;
+            break;
+        }
+
+        // Not yet, entries stamped before the first are due at once
+        due = now;
+        if((priv->speed > 0) && (ent->stamp > priv->first->stamp)) {
+            due = priv->start + (oi_time)((ent->stamp - priv->first->stamp) / priv->speed);
+            if(due > now) {
+                break;
+            }
+        }
+        queue_stamp(due);
+
+        // Device names follow the entry
+        if((ent->event.type == OI_DISCOVERY) || (ent->event.type == OI_DEVICELOST)) {
+            ev = ent->event;
+            name = (char*)(ent + 1);
+            len = ent->size - sizeof(oi_recentry);
+            ev.discover.name = memchr(name, 0, len) ? name : "";
+            ev.discover.description = "";
+            if(*ev.discover.name &&
+               memchr(name + strlen(name) + 1, 0, len - strlen(name) - 1)) {
+                ev.discover.description = name + strlen(name) + 1;
+            }
+            if(!queue_add(&ev)) {
+                break;
+            }
+        }
+        else if(!queue_add(&(ent->event))) {
+            break;
+        }
+
+        priv->next = (oi_recentry*)((char*)ent + ent->size);
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DReplay
+ * @brief Reset internal state
+ *
+ * @param dev pointer to device interface
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Restart the replay from the beginning.
+ */
+int replay_reset(oi_device *dev) {
+    replay_private *priv;
+
+    debug("replay_reset");
+
+    priv = (replay_private*)dev->private;
+    priv->next = priv->first;
+    priv->start = oi_gettime();
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DReplay
+ * @brief Check recording header
+ *
+ * @param head start of recording
+ * @param len length of recording
+ * @returns first entry, or NULL if this is not a usable recording
+ */
+oi_recentry *replay_check(oi_rechead *head, size_t len) {
+    if((len < sizeof(oi_rechead)) ||
+       (memcmp(head->magic, OI_REC_MAGIC, sizeof(head->magic)) != 0) ||
+       (head->version != OI_REC_VERSION) ||
+       (head->order != OI_REC_ORDER) ||
+       (head->evsize != sizeof(oi_event)) ||
+       (head->entsize != sizeof(oi_recentry))) {
+        return NULL;
+    }
+    return (oi_recentry*)(head + 1);
+}
+
+/* ******************************************************************** */
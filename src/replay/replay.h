@@ -0,0 +1,74 @@
+/*
+ * replay.h : Replay of event recordings
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+#ifndef _OPENINPUT_REPLAY_H_
+#define _OPENINPUT_REPLAY_H_
+
+/* ******************************************************************** */
+
+// Bootstrap
+int replay_avail(unsigned int flags);
+oi_device *replay_device();
+
+// Device
+int replay_init(oi_device *dev, char *window_id, unsigned int flags);
+int replay_destroy(oi_device *dev);
+void replay_process(oi_device *dev);
+int replay_reset(oi_device *dev);
+
+// Misc
+oi_recentry *replay_check(oi_rechead *head, size_t len);
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DReplay
+ * @brief Replay driver private instance data
+ *
+ * The recording is mapped read-only, and entries are handed to
+ * the queue straight from the mapping.
+ */
+typedef struct replay_private {
+    void *map;                 /**< Mapped recording */
+    size_t len;                /**< Length of mapping */
+    oi_recentry *first;        /**< First entry */
+    oi_recentry *next;         /**< Next entry to post */
+    char *end;                 /**< End of the mapping */
+    double speed;              /**< Speed factor, zero for no delays */
+    oi_time start;             /**< Time replay started */
+} replay_private;
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DReplay
+ * @{
+ */
+#define DREPLAY_ENVIRONMENT "OI_REPLAY"             /**< Environment variable naming the recording */
+#define DREPLAY_SPEED_ENVIRONMENT "OI_REPLAY_SPEED" /**< Environment variable setting the speed */
+/** @} */
+
+/* ******************************************************************** */
+
+#endif
@@ -0,0 +1,289 @@
+/*
+ * stats.c : Runtime statistics and counters
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include "openinput.h"
+#include "internal.h"
+
+// Queue counters, written for every event
+static union {
+    struct {
+        oi_count enqueued[OI_STATS_TYPES];
+        oi_count dropped[OI_STATS_TYPES];
+        oi_count merged[OI_STATS_TYPES];
+        oi_count filtered[OI_STATS_TYPES];
+        unsigned int highwater;
+    } c;
+    char pad[OI_ALIGN(sizeof(oi_count) * OI_STATS_TYPES * 4 + sizeof(unsigned int), OI_ARENA_ALIGN)];
+} OI_CACHEALIGN counts_queue;
+
+// Pump and action counters
+static union {
+    struct {
+        oi_count pumps;
+        oi_count pumptime[OI_STATS_BUCKETS];
+        oi_count actions;
+        oi_count dispatched;
+        oi_time start;
+    } c;
+    char pad[OI_ALIGN(sizeof(oi_count) * (OI_STATS_BUCKETS + 4), OI_ARENA_ALIGN)];
+} OI_CACHEALIGN counts_pump;
+
+// Device counters, one cache line each
+static union {
+    struct {
+        oi_count events;
+        oi_count reads;
+        oi_time start;
+    } c;
+    char pad[OI_ARENA_ALIGN];
+} OI_CACHEALIGN counts_dev[OI_MAX_DEVICES];
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IStats
+ * @brief Count event offered to the queue
+ *
+ * @param evt the event
+ * @param added true (1) if queued, false (0) if dropped
+ * @param depth events in queue, including this one
+ *
+ * Called by queue_add. Events with a device index are also
+ * counted for the device.
+ */
+void stats_queue(oi_event *evt, char added, unsigned int depth) {
+    unsigned char type;
+
+    type = evt->type % OI_STATS_TYPES;
+    if(!added) {
+        counts_queue.c.dropped[type]++;
+        return;
+    }
+
+    counts_queue.c.enqueued[type]++;
+    if(depth > counts_queue.c.highwater) {
+        counts_queue.c.highwater = depth;
+    }
+
+    if(OI_EVDEVICE(evt) > 0) {
+        counts_dev[OI_EVDEVICE(evt) - 1].c.events++;
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IStats
+ * @brief Count merged updates
+ *
+ * @param type event type, see oi_type
+ * @param num number of updates merged
+ *
+ * Called when updates are folded into an event which is
+ * already pending, instead of making new events.
+ */
+void stats_merge(unsigned char type, unsigned int num) {
+    counts_queue.c.merged[type % OI_STATS_TYPES] += num;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IStats
+ * @brief Count filtered event
+ *
+ * @param type event type, see oi_type
+ *
+ * Called by queue_add when a filter dropped the event.
+ */
+void stats_filter(unsigned char type) {
+    counts_queue.c.filtered[type % OI_STATS_TYPES]++;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IStats
+ * @brief Count device pump
+ *
+ * @param duration time spent pumping in nanoseconds
+ */
+void stats_pump(oi_time duration) {
+    unsigned int us;
+    unsigned int b;
+
+    us = (unsigned int)(duration / 1000);
+    for(b=0; us && (b < OI_STATS_BUCKETS-1); b++) {
+        us >>= 1;
+    }
+
+    counts_pump.c.pumps++;
+    counts_pump.c.pumptime[b]++;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IStats
+ * @brief Count action mapper work
+ *
+ * @param posted true (1) if an action event was posted, false (0)
+ *   for an event looked up in the action map
+ */
+void stats_action(char posted) {
+    if(posted) {
+        counts_pump.c.dispatched++;
+    }
+    else {
+        counts_pump.c.actions++;
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IStats
+ * @brief Count read system call
+ *
+ * @param index device index
+ *
+ * Drivers call this for each read from their device node.
+ */
+void stats_read(unsigned char index) {
+    if(index > 0) {
+        counts_dev[index - 1].c.reads++;
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup IStats
+ * @brief Start counting for a device
+ *
+ * @param index device index
+ *
+ * Called when a device is registered, as indices are reused.
+ */
+void stats_device(unsigned char index) {
+    if(index > 0) {
+        memset(&counts_dev[index - 1], 0, sizeof(counts_dev[0]));
+        counts_dev[index - 1].c.start = oi_gettime();
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PStats
+ * @brief Get library statistics
+ *
+ * @param stats pointer to where to store the counters
+ * @returns errorcode, see @ref PErrors
+ *
+ * Copy the counters of the event queue, the device pump and the
+ * action mapper. This is cheap enough to be called every frame,
+ * but the counters are meant to be scraped now and then by
+ * monitoring code.
+ */
+int oi_stats_get(oi_stats *stats) {
+    if(!stats) {
+        return OI_ERR_PARAM;
+    }
+
+    memcpy(stats->enqueued, counts_queue.c.enqueued, sizeof(stats->enqueued));
+    memcpy(stats->dropped, counts_queue.c.dropped, sizeof(stats->dropped));
+    memcpy(stats->merged, counts_queue.c.merged, sizeof(stats->merged));
+    memcpy(stats->filtered, counts_queue.c.filtered, sizeof(stats->filtered));
+    stats->highwater = counts_queue.c.highwater;
+    stats->pumps = counts_pump.c.pumps;
+    memcpy(stats->pumptime, counts_pump.c.pumptime, sizeof(stats->pumptime));
+    stats->actions = counts_pump.c.actions;
+    stats->dispatched = counts_pump.c.dispatched;
+    stats->elapsed = oi_gettime() - counts_pump.c.start;
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PStats
+ * @brief Get device statistics
+ *
+ * @param index device index
+ * @param stats pointer to where to store the counters
+ * @returns errorcode, see @ref PErrors
+ *
+ * Copy the counters of a device, and work out its
+ * average event rate.
+ */
+int oi_stats_device(unsigned char index, oi_devstats *stats) {
+    if(!stats) {
+        return OI_ERR_PARAM;
+    }
+    if(!device_get(index)) {
+        return OI_ERR_INDEX;
+    }
+
+    stats->events = counts_dev[index - 1].c.events;
+    stats->reads = counts_dev[index - 1].c.reads;
+    stats->elapsed = oi_gettime() - counts_dev[index - 1].c.start;
+    stats->rate = 0;
+    if(stats->elapsed) {
+        stats->rate = (unsigned int)((double)stats->events * 1e9 / (double)stats->elapsed);
+    }
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PStats
+ * @brief Clear all counters
+ *
+ * Start counting from zero, for the library and all devices.
+ * Counters are also cleared by oi_init.
+ */
+void oi_stats_reset() {
+    oi_time now;
+    unsigned int i;
+
+    now = oi_gettime();
+    memset(&counts_queue, 0, sizeof(counts_queue));
+    memset(&counts_pump, 0, sizeof(counts_pump));
+    memset(counts_dev, 0, sizeof(counts_dev));
+    counts_pump.c.start = now;
+    for(i=0; i<OI_MAX_DEVICES; i++) {
+        counts_dev[i].c.start = now;
+    }
+}
+
+/* ******************************************************************** */
@@ -0,0 +1,514 @@
+/*
+ * synth.c : Synthetic load generator driver
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include "openinput.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "internal.h"
+#include "bootstrap.h"
+#include "synth.h"
+
+/**
+ * @ingroup Drivers
+ * @defgroup DSynth Synthetic load driver
+ * @brief Configurable load generator
+ *
+ * Virtual keyboards, mice and joysticks which generate events at
+ * configurable rates, so the device pump and the state managers
+ * can be loaded without any hardware or display. The driver is
+ * only available when the OI_SYNTH environment variable is set
+ * (applications can use setenv before oi_init). It holds a list
+ * of options separated by commas or spaces, eg.
+ * "keyboards=2,joysticks=4,axes=100000,burst=16,seed=42":
+ *
+ * - keyboards, mice, joysticks: number of virtual devices
+ * - keys: key presses and releases per second per keyboard
+ * - motion, clicks: mouse motion and button events per second per mouse
+ * - axes, buttons: axis and button events per second per joystick
+ * - burst: events which come at once, the gaps grow to match
+ * - seed: seed of the random generator
+ *
+ * Rates above DSYNTH_MAX_RATE (10 million events per second) are
+ * lowered to it.
+ *
+ * Given the same options, every device generates the same
+ * sequence of keys, buttons and values. Gaps between bursts are
+ * drawn at random from half to one and a half times the mean.
+ * Events are stamped with the time they were due, see
+ * oi_events_timestamp.
+ */
+
+// Bootstrap global
+oi_bootstrap synth_bootstrap = {
+    "synth",
+    "Synthetic load generator",
+    OI_PRO_UNKNOWN,
+    synth_avail,
+    synth_device
+};
+
+// Configuration and device counters
+static synth_config config;
+static unsigned int synth_made = 0;
+static unsigned int synth_live = 0;
+
+// Option names
+static synth_option synth_options[] = {
+    { "keyboards", &config.keyboards },
+    { "mice", &config.mice },
+    { "joysticks", &config.joysticks },
+    { "keys", &config.keys },
+    { "motion", &config.motion },
+    { "clicks", &config.clicks },
+    { "axes", &config.axes },
+    { "buttons", &config.buttons },
+    { "burst", &config.burst },
+    { "seed", &config.seed },
+    { NULL, NULL }
+};
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DSynth
+ * @brief Check if virtual devices are wanted
+ *
+ * @param flags library initialization flags, see @ref PFlags
+ * @returns true (1) if another device is available, false (0) otherwise
+ *
+ * This is a bootstrap function.
+ *
+ * Available when OI_SYNTH is set. The configuration is read when
+ * no virtual devices are alive, and the driver then asks to be
+ * registered once for each virtual device.
+ */
+int synth_avail(unsigned int flags) {
+    unsigned int total;
+    char *env;
+
+    debug("synth_avail");
+
+    env = getenv(DSYNTH_ENVIRONMENT);
+    if(!env) {
+        return FALSE;
+    }
+
+    // New bootstrap, read configuration
+    total = config.keyboards + config.mice + config.joysticks;
+    if((synth_made >= total) && (synth_live == 0)) {
+        synth_parse(env);
+        synth_made = 0;
+        total = config.keyboards + config.mice + config.joysticks;
+    }
+
+    if(synth_made >= total) {
+        return FALSE;
+    }
+    device_moreavail(synth_made + 1 < total);
+    return TRUE;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DSynth
+ * @brief Create synthetic device driver interface
+ *
+ * @returns pointer to device interface, see @ref IDevstructs
+ *
+ * This is a bootstrap function.
+ *
+ * Create the next virtual device. Keyboards come first, then
+ * mice and joysticks.
+ */
+oi_device *synth_device() {
+    oi_device *dev;
+    synth_private *priv;
+    unsigned int n;
+    int i;
+
+    debug("synth_device");
+
+    // Counted even on failure, so bootstrap ends
+    n = synth_made++;
+
+    // Alloc device data
+    dev = (oi_device*)malloc(sizeof(oi_device));
+    priv = (synth_private*)malloc(sizeof(synth_private));
+    if((dev == NULL) || (priv == NULL)) {
+        debug("synth_device: device creation failed");
+        if(dev) {
+            free(dev);
+        }
+        if(priv) {
+            free(priv);
+        }
+        return NULL;
+    }
+
+    // Clear structures
+    memset(dev, 0, sizeof(oi_device));
+    memset(priv, 0, sizeof(synth_private));
+
+    // Set members
+    dev->init = synth_init;
+    dev->destroy = synth_destroy;
+    dev->process = synth_process;
+    dev->grab = NULL;
+    dev->hide = NULL;
+    dev->warp = NULL;
+    dev->winsize = NULL;
+    dev->reset = synth_reset;
+    dev->private = priv;
+
+    // Kind of device, and its own random sequence
+    if(n < config.keyboards) {
+        priv->kind = OI_PRO_KEYBOARD;
+        dev->desc = "Synthetic keyboard";
+    }
+    else if(n < config.keyboards + config.mice) {
+        priv->kind = OI_PRO_MOUSE;
+        dev->desc = "Synthetic mouse";
+    }
+    else {
+        priv->kind = OI_PRO_JOYSTICK;
+        dev->desc = "Synthetic joystick";
+        priv->joyconfig.name = "synth";
+        priv->joyconfig.buttons = DSYNTH_JOY_BUTTONS;
+        for(i=0; i<DSYNTH_JOY_AXES; i++) {
+            priv->joyconfig.kind[i] = OIJ_STICK;
+        }
+        dev->joyconfig = &(priv->joyconfig);
+    }
+    dev->provides = priv->kind;
+    priv->seed = config.seed + n * 0x9e3779b9;
+
+    synth_live++;
+    return dev;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DSynth
+ * @brief Initialize the synthetic driver
+ *
+ * @param dev pointer to created device interface
+ * @param window_id window hook parameters, see @ref PWindow
+ * @param flags initialization flags, see @ref PFlags
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Setup the event streams of the device.
+ */
+int synth_init(oi_device *dev, char *window_id, unsigned int flags) {
+    synth_private *priv;
+
+    priv = (synth_private*)dev->private;
+    debug("synth_init");
+
+    switch(priv->kind) {
+    case OI_PRO_KEYBOARD:
+        priv->stream[0].rate = config.keys;
+        priv->stream[1].rate = 0;
+        break;
+
+    case OI_PRO_MOUSE:
+        priv->stream[0].rate = config.motion;
+        priv->stream[1].rate = config.clicks;
+        break;
+
+    default:
+        priv->stream[0].rate = config.axes;
+        priv->stream[1].rate = config.buttons;
+        break;
+    }
+
+    synth_reset(dev);
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DSynth
+ * @brief Destroy the synthetic driver
+ *
+ * @param dev pointer to device interface
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Free the device structure.
+ */
+int synth_destroy(oi_device *dev) {
+    debug("synth_destroy");
+
+    if(dev) {
+        if(dev->private) {
+            free(dev->private);
+        }
+        free(dev);
+        synth_live--;
+    }
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DSynth
+ * @brief Process events
+ *
+ * @param dev pointer to device interface
+ *
+ * This is a device interface function.
+ *
+ * Post the events which are due since the last pump. When the
+ * application falls more than 100 ms behind, the backlog is
+ * dropped instead of being posted in one go.
+ */
+void synth_process(oi_device *dev) {
+    synth_private *priv;
+    synth_stream *st;
+    oi_time now;
+    oi_time gap;
+    unsigned int i;
+
+    priv = (synth_private*)dev->private;
+    now = oi_gettime();
+
+    for(i=0; i<2; i++) {
+        st = &(priv->stream[i]);
+        if(!st->rate) {
+            continue;
+        }
+
+        if(st->next + DSYNTH_MAX_LAG < now) {
+            st->next = now;
+        }
+
+        while(st->next <= now) {
+            queue_stamp(st->next);
+            synth_post(dev, i);
+
+            // Burst done, mean gap is one period per event, time
+            // must always move on or the loop never ends
+            if(--st->left == 0) {
+                st->left = config.burst;
+                gap = (oi_time)1000000000 * config.burst / st->rate;
+                gap = gap / 2 + ((gap * (synth_random(&priv->seed) >> 16)) >> 16);
+                st->next += gap ? gap : 1;
+            }
+        }
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DSynth
+ * @brief Reset internal state
+ *
+ * @param dev pointer to device interface
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Release everything and start the streams from now.
+ */
+int synth_reset(oi_device *dev) {
+    synth_private *priv;
+    oi_time now;
+
+    priv = (synth_private*)dev->private;
+    debug("synth_reset");
+
+    now = oi_gettime();
+    priv->held = 0;
+    priv->stream[0].next = now;
+    priv->stream[0].left = config.burst;
+    priv->stream[1].next = now;
+    priv->stream[1].left = config.burst;
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DSynth
+ * @brief Post one event
+ *
+ * @param dev pointer to device interface
+ * @param stream stream number
+ *
+ * Feed a random key, motion, axis or button change into the
+ * state manager of the device. Keys and buttons alternate
+ * between press and release.
+ */
+void synth_post(oi_device *dev, unsigned int stream) {
+    synth_private *priv;
+    oi_keysym keysym;
+    unsigned int r;
+    unsigned int bit;
+    int x;
+    int y;
+
+    priv = (synth_private*)dev->private;
+    r = synth_random(&priv->seed);
+
+    switch(priv->kind) {
+    case OI_PRO_KEYBOARD:
+        bit = r % DSYNTH_KEYS;
+        priv->held ^= 1 << bit;
+        keysym.scancode = bit;
+        keysym.sym = (oi_key)(OIK_A + bit);
+        keysym.mod = OIM_NONE;
+        keyboard_update(dev->index, &keysym, (priv->held >> bit) & 1, TRUE);
+        break;
+
+    case OI_PRO_MOUSE:
+        if(stream == 0) {
+            x = (int)(r % (2 * DSYNTH_MOUSE_STEP + 1)) - DSYNTH_MOUSE_STEP;
+            y = (int)((r >> 16) % (2 * DSYNTH_MOUSE_STEP + 1)) - DSYNTH_MOUSE_STEP;
+            mouse_move(dev->index, x, y, TRUE, TRUE);
+        }
+        else {
+            bit = OIP_BUTTON_LEFT + r % 3;
+            priv->held ^= 1 << bit;
+            mouse_button(dev->index, (oi_mouse)bit, (priv->held >> bit) & 1, TRUE);
+        }
+        break;
+
+    default:
+        if(stream == 0) {
+            x = (int)(r % 65535) - 32767;
+            joystick_axis(dev->index, (unsigned char)((r >> 24) % DSYNTH_JOY_AXES), x, FALSE, TRUE);
+        }
+        else {
+            bit = (r >> 8) % DSYNTH_JOY_BUTTONS;
+            priv->held ^= 1 << bit;
+            joystick_button(dev->index, (unsigned char)bit, (priv->held >> bit) & 1, TRUE);
+        }
+        break;
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DSynth
+ * @brief Parse configuration
+ *
+ * @param spec option list, see @ref DSynth
+ * @returns number of options set
+ *
+ * Options not given get their defaults: one device of each
+ * kind, 100 key, 1000 motion, 10 click, 1000 axis and 10 button
+ * events per second, no bursts and seed 1. Rates are limited to
+ * DSYNTH_MAX_RATE.
+ */
+int synth_parse(char *spec) {
+    static unsigned int *rates[] = { &config.keys, &config.motion, &config.clicks,
+                                     &config.axes, &config.buttons };
+    unsigned int len;
+    unsigned int n;
+    unsigned int i;
+    int num;
+
+    config.keyboards = 1;
+    config.mice = 1;
+    config.joysticks = 1;
+    config.keys = 100;
+    config.motion = 1000;
+    config.clicks = 10;
+    config.axes = 1000;
+    config.buttons = 10;
+    config.burst = 1;
+    config.seed = 1;
+
+    num = 0;
+    while(spec && *spec) {
+        spec += strspn(spec, ", ");
+        n = strcspn(spec, ", ");
+        len = strcspn(spec, "=");
+        for(i=0; (len < n) && synth_options[i].name; i++) {
+            if((strlen(synth_options[i].name) == len) &&
+               (strncmp(spec, synth_options[i].name, len) == 0)) {
+                *(synth_options[i].value) = (unsigned int)strtoul(spec + len + 1, NULL, 10);
+                num++;
+                break;
+            }
+        }
+        if(n && ((len >= n) || !synth_options[i].name)) {
+            log_warn("synth_parse: unknown option '%.*s'", (int)n, spec);
+        }
+        spec += n;
+    }
+
+    if(config.burst == 0) {
+        config.burst = 1;
+    }
+    for(i=0; i<sizeof(rates)/sizeof(rates[0]); i++) {
+        if(*(rates[i]) > DSYNTH_MAX_RATE) {
+            log_warn("synth_parse: rate %u too high, using %u", *(rates[i]), DSYNTH_MAX_RATE);
+            *(rates[i]) = DSYNTH_MAX_RATE;
+        }
+    }
+
+    debug("synth_parse: %u keyboards, %u mice, %u joysticks, burst %u, seed %u",
+          config.keyboards, config.mice, config.joysticks, config.burst, config.seed);
+    return num;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DSynth
+ * @brief Random number generator
+ *
+ * @param seed pointer to generator state
+ * @returns next random number
+ *
+ * A xorshift generator, so sequences are the same on all
+ * platforms (unlike rand).
+ */
+unsigned int synth_random(unsigned int *seed) {
+    unsigned int x;
+
+    x = *seed ? *seed : 1;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+    return x;
+}
+
+/* ******************************************************************** */
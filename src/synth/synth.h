@@ -0,0 +1,121 @@
+/*
+ * synth.h : Synthetic load generator driver
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+#ifndef _OPENINPUT_SYNTH_H_
+#define _OPENINPUT_SYNTH_H_
+
+/* ******************************************************************** */
+
+// Bootstrap
+int synth_avail(unsigned int flags);
+oi_device *synth_device();
+
+// Device
+int synth_init(oi_device *dev, char *window_id, unsigned int flags);
+int synth_destroy(oi_device *dev);
+void synth_process(oi_device *dev);
+int synth_reset(oi_device *dev);
+
+// Misc
+void synth_post(oi_device *dev, unsigned int stream);
+int synth_parse(char *spec);
+unsigned int synth_random(unsigned int *seed);
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DSynth
+ * @brief Synthetic event stream
+ *
+ * Events of a stream come in bursts, and the gap between bursts
+ * is drawn at random around the mean, so the average rate holds.
+ */
+typedef struct synth_stream {
+    unsigned int rate;         /**< Events per second, zero for none */
+    unsigned int left;         /**< Events left of current burst */
+    oi_time next;              /**< Time of next burst */
+} synth_stream;
+
+/**
+ * @ingroup DSynth
+ * @brief Synthetic driver private instance data
+ *
+ * Each instance is a single virtual keyboard, mouse or joystick
+ * with two event streams, ie. key presses for keyboards, motion
+ * and buttons for mice, and axes and buttons for joysticks.
+ */
+typedef struct synth_private {
+    unsigned int kind;         /**< Provided interface, see @ref PProvide */
+    unsigned int seed;         /**< Random generator state */
+    unsigned int held;         /**< Bitmask of pressed keys/buttons */
+    synth_stream stream[2];    /**< Event streams */
+    oi_joyconfig joyconfig;    /**< Joystick configuration */
+} synth_private;
+
+/**
+ * @ingroup DSynth
+ * @brief Synthetic driver configuration
+ *
+ * Parsed from the OI_SYNTH environment variable, see synth_parse.
+ */
+typedef struct synth_config {
+    unsigned int keyboards;    /**< Number of keyboards */
+    unsigned int mice;         /**< Number of mice */
+    unsigned int joysticks;    /**< Number of joysticks */
+    unsigned int keys;         /**< Key presses and releases per second */
+    unsigned int motion;       /**< Mouse motion events per second */
+    unsigned int clicks;       /**< Mouse button events per second */
+    unsigned int axes;         /**< Joystick axis updates per second */
+    unsigned int buttons;      /**< Joystick button events per second */
+    unsigned int burst;        /**< Events per burst */
+    unsigned int seed;         /**< Random seed */
+} synth_config;
+
+/**
+ * @ingroup DSynth
+ * @brief Configuration option name
+ */
+typedef struct synth_option {
+    char *name;                /**< Option name */
+    unsigned int *value;       /**< Configuration member */
+} synth_option;
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DSynth
+ * @{
+ */
+#define DSYNTH_ENVIRONMENT "OI_SYNTH"     /**< Environment variable with the configuration */
+#define DSYNTH_MAX_LAG 100000000          /**< Backlog dropped when more than 100 ms behind */
+#define DSYNTH_MAX_RATE 10000000         /**< Highest rate of a stream, events per second */
+#define DSYNTH_KEYS 26                    /**< Keys pressed, "a" to "z" */
+#define DSYNTH_MOUSE_STEP 8               /**< Largest relative motion step */
+#define DSYNTH_JOY_AXES 4                 /**< Axes per joystick */
+#define DSYNTH_JOY_BUTTONS 8              /**< Buttons per joystick */
+/** @} */
+
+/* ******************************************************************** */
+
+#endif
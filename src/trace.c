@@ -0,0 +1,195 @@
+/*
+ * trace.c : Trace ring of the input pipeline
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "openinput.h"
+#include "internal.h"
+
+// Ring of the calling thread
+static OI_THREADLOCAL struct {
+    oi_trace entries[OI_TRACE_SIZE];
+    unsigned int next;
+} trace_ring;
+
+// Dump file for OI_QUIT
+static char *trace_file = NULL;
+
+// Stage names
+static char *trace_names[] = {
+    "driver",
+    "manager",
+    "queue",
+    "drop",
+    "deliver",
+    "pump"
+};
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup ITrace
+ * @brief Setup the trace ring
+ *
+ * @returns errorcode, see @ref PErrors
+ *
+ * Called on library initialization. The ring keeps running
+ * across oi_close/oi_init, but the OI_TRACE environment variable
+ * (naming a file to dump the ring to when OI_QUIT is delivered)
+ * is read again.
+ */
+int trace_init() {
+    char *env;
+
+    if(trace_file) {
+        free(trace_file);
+        trace_file = NULL;
+    }
+
+    env = getenv(OI_TRACE_ENVIRONMENT);
+    if(env && *env) {
+        trace_file = strdup(env);
+    }
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup ITrace
+ * @brief Record a pipeline hop
+ *
+ * @param stage pipeline stage, see @ref ITraceStages
+ * @param device device index
+ * @param type event type, or native event code for drivers
+ *
+ * Write an entry to the ring of the calling thread, overwriting
+ * the oldest. This is a clock read and a store, so it can be
+ * called for every event.
+ */
+void trace_add(unsigned char stage, unsigned char device, unsigned int type) {
+    oi_trace *t;
+
+    t = &(trace_ring.entries[trace_ring.next++ & (OI_TRACE_SIZE - 1)]);
+    t->stamp = oi_gettime();
+    t->stage = stage;
+    t->device = device;
+    t->type = type;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup ITrace
+ * @brief Event delivered to the application
+ *
+ * @param evt the event
+ *
+ * Called by queue_peep for removed events. When OI_QUIT goes out
+ * and OI_TRACE is set, the ring is dumped, so the last moments
+ * of the session can be inspected.
+ */
+void trace_deliver(oi_event *evt) {
+    trace_add(OI_TRACE_DELIVER, OI_EVDEVICE(evt), evt->type);
+
+    if((evt->type == OI_QUIT) && trace_file) {
+        oi_trace_dump(trace_file);
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup PTrace
+ * @brief Dump the trace ring
+ *
+ * @param filename file to write
+ * @returns errorcode, see @ref PErrors
+ *
+ * Write the trace ring of the calling thread (the thread which
+ * pumps and polls events) as JSON in the Chrome trace event
+ * format, which can be loaded into chrome://tracing or Perfetto.
+ * Each pipeline hop is an instant event named after the stage,
+ * with the device index and event type as arguments. Pumps are
+ * shown as slices.
+ *
+ * The ring holds the last OI_TRACE_SIZE hops. Tracing is always
+ * on, see also the OI_TRACE environment variable.
+ */
+int oi_trace_dump(char *filename) {
+    FILE *f;
+    oi_trace *t;
+    unsigned int first;
+    unsigned int i;
+    char *sep;
+
+    if(!filename) {
+        return OI_ERR_PARAM;
+    }
+
+    f = fopen(filename, "w");
+    if(!f) {
+        return OI_ERR_NO_DEVICE;
+    }
+
+    first = 0;
+    if(trace_ring.next > OI_TRACE_SIZE) {
+        first = trace_ring.next - OI_TRACE_SIZE;
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    sep = "\n";
+    for(i=first; i!=trace_ring.next; i++) {
+        t = &(trace_ring.entries[i & (OI_TRACE_SIZE - 1)]);
+        if(t->stage > OI_TRACE_PUMP) {
+            continue;
+        }
+
+        // Pumps have a beginning and an end, the rest are instants
+        if(t->stage == OI_TRACE_PUMP) {
+            fprintf(f, "%s{\"name\":\"pump\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":1}",
+                    sep, t->type ? "B" : "E", (double)t->stamp / 1000.0);
+        }
+        else {
+            fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":1,"
+                    "\"args\":{\"device\":%u,\"type\":%u}}",
+                    sep, trace_names[t->stage], (double)t->stamp / 1000.0,
+                    t->device, t->type);
+        }
+        sep = ",\n";
+    }
+    fprintf(f, "\n]}\n");
+
+    if(fclose(f) != 0) {
+        return OI_ERR_INTERNAL;
+    }
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
@@ -19,6 +19,7 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+
 /* ******************************************************************** */
 
 // Includes
@@ -28,6 +29,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
+#include <errno.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_PIPE
+#include <fcntl.h>
+#endif
 #include "internal.h"
 #include "bootstrap.h"
 #include "unixsignal.h"
@@ -40,9 +48,19 @@
  * POSIX systems use "signals" to notify applications
  * of operating systems events such as suspend,
  * interrupt and hang-up, segmentation faults etc.
- * This driver listens for some of the most basic
- * signals and generates a OpenInput quit-event
- * if one of these is received.
+ * This driver listens for a set of signals and generates
+ * an OpenInput quit-event for interrupt and terminate,
+ * and a signal-event for the rest.
+ *
+ * The set of signals is read from the OI_SIGNALS environment
+ * variable, ie. "INT,TERM,HUP,USR1". The default is interrupt
+ * and terminate.
+ *
+ * The signal handler only does async-signal-safe things: It sets
+ * a flag and writes the signal number to a pipe. The event pump
+ * looks at the flag, so it costs nothing while no signals arrive,
+ * and oi_events_wait watches the pipe, so a signal wakes a
+ * blocked waiter at once.
  */
 
 // Bootstrap global
@@ -54,8 +72,46 @@ oi_bootstrap unixsignal_bootstrap = {
     unixsignal_device
 };
 
+// Names of signals that can be selected, see unixsignal_parse
+static unixsignal_name unixsignal_names[] = {
+    { "INT", SIGINT },
+    { "TERM", SIGTERM },
+    { "SEGV", SIGSEGV },
+#ifdef SIGQUIT
+    { "QUIT", SIGQUIT },
+#endif
+#ifdef SIGHUP
+    { "HUP", SIGHUP },
+#endif
+#ifdef SIGUSR1
+    { "USR1", SIGUSR1 },
+#endif
+#ifdef SIGUSR2
+    { "USR2", SIGUSR2 },
+#endif
+#ifdef SIGPIPE
+    { "PIPE", SIGPIPE },
+#endif
+#ifdef SIGALRM
+    { "ALRM", SIGALRM },
+#endif
+#ifdef SIGCHLD
+    { "CHLD", SIGCHLD },
+#endif
+#ifdef SIGWINCH
+    { "WINCH", SIGWINCH },
+#endif
+    { NULL, 0 }
+};
+
 // Private data is global here (it makes no sense with a private struct)
-static char pendingsignal;
+static volatile sig_atomic_t pendingsignal;
+static int signals[DUNIX_MAX_SIGNALS];
+static unsigned int num_signals;
+static int wakeup[2] = { -1, -1 };
+#ifdef HAVE_SIGACTION
+static struct sigaction oldaction[DUNIX_MAX_SIGNALS];
+#endif
 
 /* ******************************************************************** */
 
@@ -131,18 +187,53 @@ oi_device *unixsignal_device() {
  *
  * This is a device interface function.
  *
- * Setup the signal handlers for interrupt, terminate and segfault.
+ * Create the wakeup pipe and install the signal handlers
+ * for the selected signals.
  */
 int unixsignal_init(oi_device *dev, char *window_id, unsigned int flags) {
+    unsigned int i;
+
     debug("unixsignal_init");
 
     // Just to be sure, no signal is pending
     pendingsignal = FALSE;
-
-    // Install handler for various shutdown-signals
-    signal(SIGINT, unixsignal_handler);  // Interrupt (ctrl+c)
-    signal(SIGTERM, unixsignal_handler); // Terminate (kill)
-    signal(SIGSEGV, unixsignal_handler); // Segfault
+    unixsignal_parse(getenv(DUNIX_ENVIRONMENT));
+
+    // Non-blocking pipe, the handler must never block
+#ifdef HAVE_PIPE
+    if(pipe(wakeup) == 0) {
+        for(i=0; i<2; i++) {
+            fcntl(wakeup[i], F_SETFL, fcntl(wakeup[i], F_GETFL) | O_NONBLOCK);
+            fcntl(wakeup[i], F_SETFD, FD_CLOEXEC);
+        }
+        events_watch(wakeup[0], TRUE);
+    }
+    else {
+        debug("unixsignal_init: no wakeup pipe");
+        wakeup[0] = -1;
+        wakeup[1] = -1;
+    }
+#endif
+
+    // Install handlers
+    for(i=0; i<num_signals; i++) {
+#ifdef HAVE_SIGACTION
+        struct sigaction sa;
+
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = unixsignal_handler;
+        sigfillset(&sa.sa_mask);
+        sa.sa_flags = SA_RESTART;
+
+        // Returning would fault again, so let the next one through
+        if(signals[i] == SIGSEGV) {
+            sa.sa_flags |= SA_RESETHAND;
+        }
+        sigaction(signals[i], &sa, &(oldaction[i]));
+#else
+        signal(signals[i], unixsignal_handler);
+#endif
+    }
 
     return OI_ERR_OK;
 }
@@ -158,16 +249,34 @@ int unixsignal_init(oi_device *dev, char *window_id, unsigned int flags) {
  *
  * This is a device interface function.
  *
- * Free device structure and reset signal handlers to
- * the system default.
+ * Free device structure, restore the previous signal handlers
+ * and close the wakeup pipe.
  */
 int unixsignal_destroy(oi_device *dev) {
+    unsigned int i;
+
     debug("unixsignal_destroy");
 
-    // Set default handlers
-    signal(SIGINT, SIG_DFL);
-    signal(SIGTERM, SIG_DFL);
-    signal(SIGSEGV, SIG_DFL);
+    // Restore handlers
+    for(i=0; i<num_signals; i++) {
+#ifdef HAVE_SIGACTION
+        sigaction(signals[i], &(oldaction[i]), NULL);
+#else
+        signal(signals[i], SIG_DFL);
+#endif
+    }
+    num_signals = 0;
+
+    // Close pipe
+#ifdef HAVE_PIPE
+    if(wakeup[0] != -1) {
+        events_watch(wakeup[0], FALSE);
+        close(wakeup[0]);
+        close(wakeup[1]);
+        wakeup[0] = -1;
+        wakeup[1] = -1;
+    }
+#endif
 
     // Free device
     if(dev) {
@@ -188,11 +297,16 @@ int unixsignal_destroy(oi_device *dev) {
  *
  * This is a device interface function.
  *
- * Pump an OI_QUIT event into the queue if a
- * signal is pending.
+ * If a signal is pending, post an OI_QUIT event for
+ * quit-signals, and an OI_SIGNAL event for the others.
  */
 void unixsignal_process(oi_device *dev) {
-    static oi_event ev;
+    oi_event ev;
+#ifdef HAVE_PIPE
+    unsigned char buf[DUNIX_MAX_SIGNALS];
+    int n;
+    int i;
+#endif
 
     if(!oi_runstate()) {
         debug("unixsignal_process: oi_running false");
@@ -204,12 +318,32 @@ void unixsignal_process(oi_device *dev) {
         return;
     }
 
-    // Don't forget to clear the flag
+    // Don't forget to clear the flag, before reading
     pendingsignal = FALSE;
 
-    // A signal, send quit event
-    ev.type = OI_QUIT;
-    queue_add(&ev);
+    // Without the pipe, we only know that something came
+    if(wakeup[0] == -1) {
+        ev.type = OI_QUIT;
+        queue_add(&ev);
+        return;
+    }
+
+#ifdef HAVE_PIPE
+    while((n = read(wakeup[0], buf, sizeof(buf))) > 0) {
+        stats_read(dev->index);
+        for(i=0; i<n; i++) {
+            debug("unixsignal_process: signal %d received", buf[i]);
+            if(unixsignal_quit(buf[i])) {
+                ev.type = OI_QUIT;
+            }
+            else {
+                ev.type = OI_SIGNAL;
+                ev.signal.signum = buf[i];
+            }
+            queue_add(&ev);
+        }
+    }
+#endif
 }
 
 /* ******************************************************************** */
@@ -223,33 +357,130 @@ void unixsignal_process(oi_device *dev) {
  *
  * This is a device interface function.
  *
- * Reset pending flag.
+ * Reset pending flag and drop unprocessed signals.
  */
 int unixsignal_reset(oi_device *dev) {
+#ifdef HAVE_PIPE
+    unsigned char buf[DUNIX_MAX_SIGNALS];
+#endif
+
     debug("unixsignal_reset");
 
     pendingsignal = FALSE;
+#ifdef HAVE_PIPE
+    if(wakeup[0] != -1) {
+        while(read(wakeup[0], buf, sizeof(buf)) > 0) {
+            ;
+        }
+    }
+#endif
 
     return OI_ERR_OK;
 }
 
 /* ******************************************************************** */
 
+/**
+ * @ingroup DUnix
+ * @brief Select the signals to catch
+ *
+ * @param list comma or space separated signal names, or NULL
+ *
+ * Names are given without the "SIG" prefix, see the table at
+ * the top of this file. Unknown names are ignored, and an empty
+ * or missing list selects interrupt and terminate.
+ */
+void unixsignal_parse(char *list) {
+    unsigned int n;
+    unsigned int i;
+
+    num_signals = 0;
+    while(list && *list && (num_signals < DUNIX_MAX_SIGNALS)) {
+        list += strspn(list, ", ");
+        n = strcspn(list, ", ");
+
+        // Optional prefix
+        if((n > 3) && (strncmp(list, "SIG", 3) == 0)) {
+            list += 3;
+            n -= 3;
+        }
+
+        for(i=0; unixsignal_names[i].name; i++) {
+            if((strlen(unixsignal_names[i].name) == n) &&
+               (strncmp(list, unixsignal_names[i].name, n) == 0)) {
+                signals[num_signals++] = unixsignal_names[i].signum;
+                break;
+            }
+        }
+        list += n;
+    }
+
+    // Defaults
+    if(num_signals == 0) {
+        signals[num_signals++] = SIGINT;
+        signals[num_signals++] = SIGTERM;
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DUnix
+ * @brief Check for quit-signals
+ *
+ * @param signum signal code
+ * @returns true (1) if the signal asks us to quit, false (0) otherwise
+ */
+char unixsignal_quit(int signum) {
+    switch(signum) {
+    case SIGINT:
+    case SIGTERM:
+    case SIGSEGV:
+#ifdef SIGQUIT
+    case SIGQUIT:
+#endif
+        return TRUE;
+
+    default:
+        return FALSE;
+    }
+}
+
+/* ******************************************************************** */
+
 /**
  * @ingroup DUnix
  * @brief The POSIX signal handler
  *
  * @param signum signal code
  *
- * This is the POSIX signal handler function. We simply
- * set the pending-flag, so that the next call to the
- * event pump will inject the quit event.
+ * This is the POSIX signal handler function. We write the
+ * signal number to the wakeup pipe and set the pending-flag,
+ * so that the next call to the event pump will inject the
+ * event. Nothing else is async-signal-safe.
  */
 void unixsignal_handler(int signum) {
+#ifdef HAVE_PIPE
+    unsigned char sig;
+    int olderrno;
+
+    // A full pipe drops the signal, the flag is still set
+    if(wakeup[1] != -1) {
+        olderrno = errno;
+        sig = (unsigned char)signum;
+        if(write(wakeup[1], &sig, 1) < 0) {
+            ;
+        }
+        errno = olderrno;
+    }
+#endif
 
-    if(!pendingsignal) {
-        debug("unixsignal_handler: signal %d received", signum);
+#ifndef HAVE_SIGACTION
+    // Old-style handlers are reset on delivery
+    if(signum != SIGSEGV) {
+        signal(signum, unixsignal_handler);
     }
+#endif
 
     // Ok, we've fetched a signal
     pendingsignal = TRUE;
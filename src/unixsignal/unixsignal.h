@@ -39,6 +39,31 @@ int unixsignal_reset(oi_device *dev);
 
 // Handler
 void unixsignal_handler(int signum);
+void unixsignal_parse(char *list);
+char unixsignal_quit(int signum);
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DUnix
+ * @brief Signal name
+ *
+ * Entry of the table of signals that can be selected.
+ */
+typedef struct unixsignal_name {
+    char *name;                /**< Name without "SIG" prefix */
+    int signum;                /**< Signal number */
+} unixsignal_name;
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DUnix
+ * @{
+ */
+#define DUNIX_MAX_SIGNALS 16           /**< Max number of caught signals */
+#define DUNIX_ENVIRONMENT "OI_SIGNALS" /**< Environment variable selecting signals */
+/** @} */
 
 /* ******************************************************************** */
 
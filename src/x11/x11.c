@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <X11/Xlib.h>
+#include <X11/XKBlib.h>
 #include "internal.h"
 #include "bootstrap.h"
 #include "x11.h"
@@ -66,12 +67,12 @@ oi_bootstrap x11_bootstrap = {
  *
  * This is a bootstrap function.
  *
- * We try to open a dummy-connection to the X-server. That
- * tells us of the X11 system can be used.
+ * The driver hooks into the display connection and window of the
+ * application (see x11_init), so there is no need to open a
+ * connection of our own here. That used to cost a full roundtrip
+ * to the X-server on every oi_init.
  */
 int x11_avail(unsigned int flags) {
-    Display *disp;
-
     debug("x11_avail");
 
     // Check flags
@@ -79,16 +80,8 @@ int x11_avail(unsigned int flags) {
         return FALSE;
     }
 
-    // Check for X11 existence
-    disp = XOpenDisplay(NULL);
-    if(disp != NULL) {
-        // Got it, close display again
-        XCloseDisplay(disp);
-        return TRUE;
-    }
-    else {
-        return FALSE;
-    }
+    // The connection is checked by init
+    return TRUE;
 }
 
 /* ******************************************************************** */
@@ -162,9 +155,16 @@ oi_device *x11_device() {
  *
  * The X11 keymap is also read, and a full reset is performed
  * in order to sync states between X11 and OpenInput.
+ *
+ * XKB detectable autorepeat is switched on, so the server
+ * sends repeated presses without the fake releases in between.
+ * Note that this is a per-connection setting, so it also applies
+ * to the application which owns the display connection. The old
+ * setting is restored by x11_destroy.
  */
 int x11_init(oi_device *dev, char *window_id, unsigned int flags) {
     x11_private *priv;
+    Bool supported;
 
     priv = (x11_private*)dev->private;
     debug("x11_init");
@@ -173,6 +173,7 @@ int x11_init(oi_device *dev, char *window_id, unsigned int flags) {
     priv->disp = (Display*)device_windowid(window_id, OI_I_CONN);
     priv->screen = (Screen*)device_windowid(window_id, OI_I_SCRN);
     priv->win = (Window)device_windowid(window_id, OI_I_WINID);
+    priv->compress = (flags & OI_FLAG_COMPRESS) ? TRUE : FALSE;
 
     // We require conn and winid parameters
     if(!(priv->disp) || !(priv->win)) {
@@ -187,8 +188,16 @@ int x11_init(oi_device *dev, char *window_id, unsigned int flags) {
     // Initialize blank-cursor, keymapper table, modifier mask and key state
     priv->cursor = x11_mkcursor(priv->disp, priv->win);
     priv->relative = 0;
+    x11_rawinit(dev);
     x11_initkeymap();
+    x11_keymap(dev, priv->disp);
     x11_modmasks(priv->disp, dev);
+
+    // Repeated keys without fake releases, see x11_keyrepeat
+    supported = False;
+    priv->wasdetectable = (XkbGetDetectableAutoRepeat(priv->disp, &supported) == True);
+    XkbSetDetectableAutoRepeat(priv->disp, True, &supported);
+    priv->detectable = (supported == True);
     x11_keystate(dev, priv->disp, NULL);
 
     // Start receiving events
@@ -200,8 +209,9 @@ int x11_init(oi_device *dev, char *window_id, unsigned int flags) {
     // Get "close window" window manager protocol atom
     priv->wm_delete_window = XInternAtom(priv->disp, "WM_DELETE_WINDOW", False);
     XSetWMProtocols(priv->disp, priv->win, &(priv->wm_delete_window), 1);
+    XFlush(priv->disp);
 
-    debug("x11_init: initialized");
+    debug("x11_init: initialized (detectable autorepeat:%i)", priv->detectable);
 
     return OI_ERR_OK;
 }
@@ -218,7 +228,8 @@ int x11_init(oi_device *dev, char *window_id, unsigned int flags) {
  * This is a device interface function.
  *
  * Shutdown the X11 driver by releasing all
- * allocated memory and the hidden cursor.
+ * allocated memory and the hidden cursor, and restore
+ * the detectable autorepeat setting of the connection.
  */
 int x11_destroy(oi_device *dev) {
     x11_private *priv;
@@ -230,6 +241,15 @@ int x11_destroy(oi_device *dev) {
 
         // Private members
         if(priv) {
+            // Stop raw motion
+            priv->relative = 0;
+            x11_rawselect(dev);
+
+            // Give the application its autorepeat setting back
+            if(priv->detectable && !priv->wasdetectable) {
+                XkbSetDetectableAutoRepeat(priv->disp, False, NULL);
+            }
+
             if(priv->cursor) {
                 XFreeCursor(priv->disp, priv->cursor);
             }
@@ -257,14 +277,21 @@ int x11_destroy(oi_device *dev) {
  * Process pending X11 events, and pump these
  * into the OpenInput queue. The real functionality
  * is handled in the dispatcher.
+ *
+ * The connection is read once (without blocking), and the
+ * batch is then dispatched from the local Xlib queue. We do
+ * not flush here - functions sending requests flush themselves.
  */
 void x11_process(oi_device *dev) {
     x11_private *priv;
 
     priv = (x11_private*)dev->private;
 
-    // Process all pending events
-    while(oi_runstate() && x11_pending(priv->disp)) {
+    // Single non-blocking read
+    XEventsQueued(priv->disp, QueuedAfterReading);
+
+    // Dispatch what we got, the dispatcher may eat events itself
+    while(oi_runstate() && XEventsQueued(priv->disp, QueuedAlready)) {
         x11_dispatch(dev, priv->disp);
     }
 }
@@ -324,6 +351,10 @@ int x11_grab(oi_device *dev, int on) {
         priv->relative &= ~DX11_GRAB;
     }
 
+    // Relative mode may have changed
+    x11_rawselect(dev);
+    XFlush(priv->disp);
+
     return OI_ERR_OK;
 }
 
@@ -362,6 +393,10 @@ int x11_hidecursor(oi_device *dev, int on) {
         priv->relative &= ~DX11_HIDE;
     }
 
+    // Relative mode may have changed
+    x11_rawselect(dev);
+    XFlush(priv->disp);
+
     return OI_ERR_OK;
 }
 
@@ -458,7 +493,8 @@ int x11_reset(oi_device *dev) {
     x11_grab(dev, FALSE);
     x11_hidecursor(dev, FALSE);
 
-    // Query for modifiers
+    // Rebuild keycode table and query for modifiers
+    x11_keymap(dev, priv->disp);
     x11_modmasks(priv->disp, dev);
 
     // Sync keyboard state
@@ -487,7 +523,7 @@ int x11_reset(oi_device *dev) {
  * OpenInput is compiled in debug-mode.
  */
 int x11_error(Display *d, XErrorEvent *e) {
-    debug("x11_error: code %u", e->error_code);
+    log_warn("x11_error: code %u", e->error_code);
 
     return 0;
 }
@@ -506,7 +542,7 @@ int x11_error(Display *d, XErrorEvent *e) {
  * should terminate.
  */
 int x11_fatal(Display *d) {
-    debug("x11_fatal: fatal I/O error");
+    log_error("x11_fatal: fatal I/O error");
 
     //FIXME: Send a quit-event?
     return OI_ERR_OK;
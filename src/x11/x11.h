@@ -48,15 +48,18 @@ int x11_reset(oi_device *dev);
 Cursor x11_mkcursor(Display *d, Window w);
 int x11_error(Display *d, XErrorEvent *e);
 int x11_fatal(Display *d);
-int x11_pending(Display *d);
 void x11_dispatch(oi_device *dev, Display *d);
-oi_keysym *x11_translate(Display *d, XKeyEvent *xkey,
-                                KeyCode kc, oi_keysym *keysym);
+oi_key x11_translate(KeySym xsym, KeyCode kc);
 void x11_initkeymap();
+void x11_keymap(oi_device *dev, Display *d);
 void x11_keystate(oi_device *dev, Display *d, char *keyvector);
 void x11_modmasks(Display *d, oi_device *dev);
 void x11_relative_mouse(oi_device *dev, XEvent *xev);
-char x11_keyrepeat(Display *d, XEvent *evt);
+void x11_compress(oi_device *dev, XEvent *xev);
+char x11_keyrepeat(oi_device *dev, XEvent *evt);
+int x11_rawinit(oi_device *dev);
+void x11_rawselect(oi_device *dev);
+void x11_rawmotion(oi_device *dev, XEvent *xev);
 
 /* ******************************************************************** */
 
@@ -84,6 +87,18 @@ typedef struct x11_private {
     int lasty;                 /**< Last mouse y position */
     int width;                 /**< Window width */
     int height;                /**< Window height */
+    char detectable;           /**< XKB detectable autorepeat is on */
+    char wasdetectable;        /**< Detectable autorepeat setting before x11_init */
+    unsigned char keydown[32]; /**< Pressed keycodes, X keymap bit vector */
+    KeySym keysyms[256];       /**< Unshifted keysym of each keycode */
+    oi_key keymap[256];        /**< OpenInput key of each keycode */
+    int xi_opcode;             /**< XInput2 opcode, zero if unavailable */
+    unsigned char raw;         /**< Raw motion selected on root window */
+    double remx;               /**< Raw x motion not yet posted */
+    double remy;               /**< Raw y motion not yet posted */
+    char compress;             /**< Collapse queued motion, see x11_compress */
+    char rawheld;              /**< Raw motion held back by compression */
+    Time rawtime;              /**< Time of first held raw motion */
 } x11_private;
 
 /* ******************************************************************** */
@@ -96,6 +111,9 @@ typedef struct x11_private {
 #define DX11_HIDE 2            /**< Hidden state flag */
 #define DX11_FUDGE 8           /**< Mouse fudge factor */
 #define DX11_REP_THRESHOLD 2   /**< Key repeat threshold */
+#define DX11_XI_MAJOR 2        /**< Required XInput major version */
+#define DX11_XI_MINOR 0        /**< Required XInput minor version */
+#define DX11_COMPRESS_SPAN 8   /**< Max time span of collapsed motion (ms) */
 /** @} */
 
 /* ******************************************************************** */
@@ -28,12 +28,47 @@
 #include <string.h>
 #include <stdlib.h>
 #include <X11/Xlib.h>
-#include <sys/select.h>
 #include "internal.h"
 #include "x11.h"
 
 /* ******************************************************************** */
 
+/**
+ * @ingroup DX11
+ * @brief Collapse queued mouse motion
+ *
+ * @param dev pointer to device interface
+ * @param xev X mouse motion event, replaced by the last collapsed one
+ *
+ * With the OI_FLAG_COMPRESS flag, a motion event followed by
+ * more motion in the local queue is replaced by the last of
+ * them, so only one mouse_move is posted. As positions are
+ * absolute, the deltas still add up. Only motion within
+ * DX11_COMPRESS_SPAN milliseconds of the first event is collapsed,
+ * so slow pumping does not hide the path of the pointer.
+ */
+void x11_compress(oi_device *dev, XEvent *xev) {
+    x11_private *priv;
+    XEvent pev;
+    Time first;
+
+    priv = (x11_private*)dev->private;
+    first = xev->xmotion.time;
+
+    while(XEventsQueued(priv->disp, QueuedAlready)) {
+        XPeekEvent(priv->disp, &pev);
+        if((pev.type != MotionNotify) ||
+           (pev.xmotion.window != xev->xmotion.window) ||
+           ((pev.xmotion.time - first) >= DX11_COMPRESS_SPAN)) {
+            break;
+        }
+        XNextEvent(priv->disp, xev);
+        stats_merge(OI_MOUSEMOVE, 1);
+    }
+}
+
+/* ******************************************************************** */
+
 /**
  * @ingroup DX11
  * @brief Handle relative mouse movement
@@ -48,7 +83,8 @@
  *
  * The trick is to make the cursor stay in the middle of
  * the window (using warp) and eating the extra X motion
- * events.
+ * events. This is only used when XInput2 raw motion is
+ * not available, see x11_rawmotion.
  */
 void x11_relative_mouse(oi_device *dev, XEvent *xev) {
     x11_private *priv;
@@ -106,69 +142,47 @@ void x11_relative_mouse(oi_device *dev, XEvent *xev) {
 
 /* ******************************************************************** */
 
-/**
- * @ingroup DX11
- * @brief Check for pending X events
- *
- * @param d display handle
- * @returns true (1) if events are pending, false (0) otherwise
- *
- * Use this function to check for pending events from the
- * X server without going into a long-time blocking call.
- * The block is avoided using a "select attack" on the
- * X-server - this technique was borrowed from SDL. Thanks!
- */
-int x11_pending(Display *d) {
-    // Flush to pump the X pipeline
-    XFlush(d);
-
-    // Standard X non-blocking check
-    if(XEventsQueued(d, QueuedAlready)) {
-        return TRUE;
-    }
-
-    // Bruteforce-attack the X server to make it talk (thanks SDL!)
-    {
-        static struct timeval time;
-        int fd;
-        fd_set set;
-
-        fd = ConnectionNumber(d);
-        FD_ZERO(&set);
-        FD_SET(fd, &set);
-
-        // Charge!
-        if(select(fd+1, &set, NULL, NULL, &time) == 1) {
-            // Ok, perform the blocking X call
-            return XPending(d);
-        }
-    }
-
-    // Nothing is pending
-    return FALSE;
-}
-
-/* ******************************************************************** */
-
 /**
  * @ingroup DX11
  * @brief Cancel repeated key events
  *
- * @param d display handle
- * @param evt X event
+ * @param dev pointer to device interface
+ * @param evt X key event
+ * @returns true (1) if the event is a repeat, false (0) otherwise
  *
  * Make sure that the repeated key-down events from
  * the X server is thrown away. OpenInput has it's internal
  * keyrepeat system if you want repeat-events.
+ *
+ * With XKB detectable autorepeat, a repeat is simply a press
+ * of a key which is already down. Otherwise the server fakes a
+ * release followed by a press with the same timestamp, so a
+ * release is checked against the next event - if it is already
+ * in the local queue, that is, we never read or block here.
  */
-char x11_keyrepeat(Display *d, XEvent *evt) {
+char x11_keyrepeat(oi_device *dev, XEvent *evt) {
+    x11_private *priv;
     XEvent pev;
-    char rep;
+    unsigned char bit;
+    unsigned int byte;
 
-    rep = FALSE;
+    priv = (x11_private*)dev->private;
+    byte = (evt->xkey.keycode >> 3) & 31;
+    bit = 1 << (evt->xkey.keycode & 7);
+
+    // Key down
+    if(evt->type == KeyPress) {
+        if(priv->keydown[byte] & bit) {
+            debug("x11_keyrepeat: repeating key detected");
+            return TRUE;
+        }
+        priv->keydown[byte] |= bit;
+        return FALSE;
+    }
 
-    if(XPending(d)) {
-        XPeekEvent(d, &pev);
+    // Key up, possibly followed by a fake press of the same key
+    if(!priv->detectable && XEventsQueued(priv->disp, QueuedAlready)) {
+        XPeekEvent(priv->disp, &pev);
 
         // Same key down within threshold
         if((pev.type == KeyPress) &&
@@ -176,12 +190,13 @@ char x11_keyrepeat(Display *d, XEvent *evt) {
            ((pev.xkey.time - evt->xkey.time) < DX11_REP_THRESHOLD)) {
 
             debug("x11_keyrepeat: repeating key detected");
-            rep = 1;
-            XNextEvent(d, &pev);
+            XNextEvent(priv->disp, &pev);
+            return TRUE;
         }
     }
 
-    return(rep);
+    priv->keydown[byte] &= ~bit;
+    return FALSE;
 }
 
 /* ******************************************************************** */
@@ -209,6 +224,7 @@ void x11_dispatch(oi_device *dev, Display *d) {
 
     // Fetch the event
     XNextEvent(d, &xev);
+    trace_add(OI_TRACE_DRIVER, dev->index, xev.type);
 
     // Handle
     switch(xev.type) {
@@ -250,15 +266,36 @@ void x11_dispatch(oi_device *dev, Display *d) {
         // Generated on EnterWindow and FocusIn
     case KeymapNotify:
         debug("x11_dispatch: keymap_notify");
-        // Do a full reset of keystate/modstates
+        // Sync changed keys and modifiers
         x11_keystate(dev, d, xev.xkeymap.key_vector);
         break;
 
+
+        // Keyboard layout changed
+    case MappingNotify:
+        debug("x11_dispatch: mapping_notify");
+        XRefreshKeyboardMapping(&xev.xmapping);
+        if(xev.xmapping.request != MappingPointer) {
+            x11_keymap(dev, d);
+            x11_modmasks(d, dev);
+        }
+        break;
+
+
         // Mouse motion
     case MotionNotify:
         debug("x11_dispatch: motion_notify");
+        if(((x11_private*)dev->private)->compress) {
+            x11_compress(dev, &xev);
+        }
+
         // Mouse grabbed and hidden, using relative motion
-        if(((x11_private*)dev->private)->relative == (DX11_GRAB | DX11_HIDE)) {
+        if(((x11_private*)dev->private)->raw) {
+            // Raw events do the work, just track the position
+            ((x11_private*)dev->private)->lastx = xev.xmotion.x;
+            ((x11_private*)dev->private)->lasty = xev.xmotion.y;
+        }
+        else if(((x11_private*)dev->private)->relative == (DX11_GRAB | DX11_HIDE)) {
             x11_relative_mouse(dev, &xev);
         }
         else {
@@ -285,18 +322,14 @@ void x11_dispatch(oi_device *dev, Display *d) {
         debug("x11_dispatch: key_press/release (in/down:%i)", xev.type == KeyPress);
         {
             oi_keysym keysym;
-            x11_private *priv;
-
-            priv = (x11_private*)dev->private;
 
             // Do not post repeated keys
-            if(!x11_keyrepeat(priv->disp, &xev)) {
+            if(!x11_keyrepeat(dev, &xev)) {
 
                 // Decode key and send it to the state manager
-                x11_translate(priv->disp,
-                              &xev.xkey,
-                              xev.xkey.keycode,
-                              &keysym);
+                keysym.scancode = xev.xkey.keycode;
+                keysym.sym = ((x11_private*)dev->private)->keymap[xev.xkey.keycode & 0xFF];
+                keysym.mod = OIM_NONE;
                 keyboard_update(dev->index,
                                 &keysym,
                                 xev.type == KeyPress,
@@ -358,6 +391,12 @@ void x11_dispatch(oi_device *dev, Display *d) {
         break;
 
 
+        // Extension events, ie. XInput2 raw motion
+    case GenericEvent:
+        x11_rawmotion(dev, &xev);
+        break;
+
+
         // Unhandled event
     default:
         debug("x11_dispatch: unhandled event type %i", xev.type);
@@ -155,7 +155,49 @@ void x11_initkeymap() {
 
 /**
  * @ingroup DX11
- * @brief Perform a full keyboard state update
+ * @brief Build the keycode table
+ *
+ * @param dev pointer to device interface
+ * @param d display handle
+ *
+ * The unshifted keysym of each keycode is fetched in a single
+ * request and translated once per keyboard mapping, so that
+ * translating a key event is a single table lookup. Must be
+ * redone when the server sends a MappingNotify.
+ */
+void x11_keymap(oi_device *dev, Display *d) {
+    x11_private *priv;
+    KeySym *syms;
+    int first;
+    int last;
+    int per;
+    int kc;
+
+    debug("x11_keymap");
+    priv = (x11_private*)dev->private;
+
+    // Fetch all keysyms of the keyboard
+    XDisplayKeycodes(d, &first, &last);
+    syms = XGetKeyboardMapping(d, first, last - first + 1, &per);
+
+    memset(priv->keysyms, 0, sizeof(priv->keysyms));
+    for(kc=0; kc<TABLESIZE(priv->keymap); kc++) {
+        if(syms && (kc >= first) && (kc <= last)) {
+            priv->keysyms[kc] = syms[(kc - first) * per];
+        }
+        priv->keymap[kc] = x11_translate(priv->keysyms[kc], kc);
+    }
+
+    if(syms) {
+        XFree(syms);
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DX11
+ * @brief Perform a keyboard state update
  *
  * @param dev pointer to device interface
  * @param d display handle
@@ -166,19 +208,23 @@ void x11_initkeymap() {
  * other applications may have altered things.
  * Because of this, we have to sync the OpenInput state
  * with the X server. It's cumbersome, but required!
+ *
+ * The new X key vector is compared with the keys we last
+ * saw, and only the keys that differ are updated.
  */
 void x11_keystate(oi_device *dev, Display *d, char *keyvec) {
     char keyret[32];
-    KeyCode xcode[OIK_LAST];
+    x11_private *priv;
     Window w;
     int i;
     int j;
     unsigned int mod;
     unsigned int mask;
-    char newstate[OIK_LAST];
+    unsigned char diff;
     char *curstate;
 
     debug("x11_keystate");
+    priv = (x11_private*)dev->private;
 
     // Fetch pressed keys from X if not supplied
     if(!keyvec) {
@@ -190,8 +236,6 @@ void x11_keystate(oi_device *dev, Display *d, char *keyvec) {
     mod = OIM_NONE;
     if(XQueryPointer(d, DefaultRootWindow(d), &w, &w,
                      &i, &j, &i, &j, &mask)) {
-        x11_private *priv;
-        priv = (x11_private*)dev->private;
 
         // Capslock
         if(mask & LockMask) {
@@ -205,42 +249,26 @@ void x11_keystate(oi_device *dev, Display *d, char *keyvec) {
         }
     }
 
-    // Prepare new and current keystates
-    memset(newstate, 0, sizeof(newstate));
+    // Released keys first, in case two keycodes share a key
     curstate = oi_key_keystate(dev->index, NULL);
-
-    // Check each bit in the 32 bytes of the X keystate
     for(i=0; i<32; i++) {
-        // No bits set
-        if(!keyvec[i]) {
-            continue;
-        }
-
-        // Scan bits
-        for(j=0; j<8; j++) {
-            if(keyvec[i] & (1<<j)) {
-                // Find out what that key is
-                oi_keysym sks;
-                KeyCode kc;
-
-                kc = i << 3 | j;
-                x11_translate(d, NULL, kc, &sks);
-
-                newstate[sks.sym] = TRUE;
-                xcode[sks.sym] = kc;
+        diff = priv->keydown[i] & ~keyvec[i];
+        for(j=0; diff && (j<8); j++) {
+            if(diff & (1<<j)) {
+                curstate[priv->keymap[i << 3 | j]] = FALSE;
             }
         }
     }
 
-    // Set state and fetch modifiers
-    for(i=OIK_FIRST+1; i<OIK_LAST; i++) {
-        if(newstate[i]) {
-
-            // Store new state of key
-            curstate[i] = newstate[i];
+    // Pressed keys, and the normal modifiers they hold
+    for(i=0; i<32; i++) {
+        for(j=0; keyvec[i] && (j<8); j++) {
+            if(!(keyvec[i] & (1<<j))) {
+                continue;
+            }
+            curstate[priv->keymap[i << 3 | j]] = TRUE;
 
-            // Fetch normal modifiers
-            switch(i) {
+            switch(priv->keymap[i << 3 | j]) {
             case OIK_LSHIFT:
                 mod |= OIM_LSHIFT;
                 break;
@@ -279,7 +307,11 @@ void x11_keystate(oi_device *dev, Display *d, char *keyvec) {
         }
     }
 
+    // Remember raw key state for repeat detection
+    memcpy(priv->keydown, keyvec, sizeof(priv->keydown));
+
     // Correct for locking modifiers
+    curstate[OIK_UNKNOWN] = FALSE;
     if(mod & OIM_CAPSLOCK) {
         curstate[OIK_CAPSLOCK] = TRUE;
     }
@@ -301,12 +333,10 @@ void x11_keystate(oi_device *dev, Display *d, char *keyvec) {
 
 /**
  * @ingroup DX11
- * @brief Translate X11 keysym to OpenInput keysym
+ * @brief Translate X11 keysym to OpenInput key
  *
- * @param d display handle
- * @param xkey X keyboard event
+ * @param xsym X keysym
  * @param kc X keycode
- * @param keysym OpenInput symbolic key
  * @returns OpenInput symbolic key
  *
  * Here's where the X key is translate to the corresponding
@@ -314,76 +344,67 @@ void x11_keystate(oi_device *dev, Display *d, char *keyvec) {
  * actually quite fast (and easy), though it requires some
  * deep knowledge of how X keycodes and X keysyms are
  * composed (eg. that X has a different keymaps).
+ *
+ * This is only used to build the keycode table, see x11_keymap.
  */
-oi_keysym *x11_translate(Display *d, XKeyEvent *xkey,
-                                KeyCode kc, oi_keysym *keysym) {
-    KeySym xsym;
-
-    // Basic OI keysym
-    keysym->scancode = kc;
-    keysym->sym = OIK_UNKNOWN;
-    keysym->mod = OIM_NONE;
-
-    // Handle X keysym
-    xsym = XKeycodeToKeysym(d, kc, 0);
-    if(xsym) {
-        // Keymap information is in the high byte
-        switch(xsym >> 8) {
-
-        case 0x00: // Latin 1
-        case 0x01: // Latin 2
-        case 0x02: // Latin 3
-        case 0x03: // Latin 4
-        case 0x04: // Katakana
-        case 0x05: // Arabic
-        case 0x06: // Cyrillic
-        case 0x07: // Greek
-        case 0x08: // Technical
-        case 0x0A: // Publishing
-        case 0x0C: // Hebrew
-        case 0x0D: // Thai
-            // Normal ASCII keymap
-            keysym->sym = (oi_key)(xsym & 0xFF);
-
-            // Fix lowercase
-            if((keysym->sym >= 'A') && (keysym->sym <= 'Z')) {
-                keysym->sym += 'a'-'A';
-            }
-            break;
+oi_key x11_translate(KeySym xsym, KeyCode kc) {
+    oi_key sym;
 
-        case 0xFE: // Odd
-            keysym->sym = x11_oddmap[xsym & 0xFF];
-            break;
-
-        case 0xFF: // Misc
-            keysym->sym = x11_miscmap[xsym & 0xFF];
-            break;
-
-        default: // Unhandled
-            debug("x11_translate: unhandled map 0x%04x", (unsigned int)xsym);
-            break;
-        }
-    }
+    sym = OIK_UNKNOWN;
 
     // Handle special scancodes
-    else {
+    if(!xsym) {
         switch(kc) {
         case 115:
-            keysym->sym = OIK_LWINDOWS;
-            break;
+            return OIK_LWINDOWS;
 
         case 116:
-            keysym->sym = OIK_RWINDOWS;
-            break;
+            return OIK_RWINDOWS;
 
         case 117:
-            keysym->sym = OIK_MENU;
-            break;
+            return OIK_MENU;
         }
+        return OIK_UNKNOWN;
+    }
+
+    // Keymap information is in the high byte
+    switch(xsym >> 8) {
+
+    case 0x00: // Latin 1
+    case 0x01: // Latin 2
+    case 0x02: // Latin 3
+    case 0x03: // Latin 4
+    case 0x04: // Katakana
+    case 0x05: // Arabic
+    case 0x06: // Cyrillic
+    case 0x07: // Greek
+    case 0x08: // Technical
+    case 0x0A: // Publishing
+    case 0x0C: // Hebrew
+    case 0x0D: // Thai
+        // Normal ASCII keymap
+        sym = (oi_key)(xsym & 0xFF);
+
+        // Fix lowercase
+        if((sym >= 'A') && (sym <= 'Z')) {
+            sym += 'a'-'A';
+        }
+        break;
+
+    case 0xFE: // Odd
+        sym = x11_oddmap[xsym & 0xFF];
+        break;
+
+    case 0xFF: // Misc
+        sym = x11_miscmap[xsym & 0xFF];
+        break;
+
+    default: // Unhandled
+        debug("x11_translate: unhandled map 0x%04x", (unsigned int)xsym);
+        break;
     }
 
-    // Done
-    return keysym;
+    return sym;
 }
 
 /* ******************************************************************** */
@@ -397,7 +418,7 @@ oi_keysym *x11_translate(Display *d, XKeyEvent *xkey,
  *
  * Apparantly, the bitmasks of certain modifier keys (shift, meta, etc.)
  * are variable. Because of this, we have to find out which modifier
- * corresponds to which bit.
+ * corresponds to which bit. The keycode table must be built first.
  */
 void x11_modmasks(Display *d, oi_device *dev) {
     XModifierKeymap *xmods;
@@ -418,11 +439,10 @@ void x11_modmasks(Display *d, oi_device *dev) {
         for(j = 0; j < n; j++) {
 
             KeyCode kc = xmods->modifiermap[i * n + j];
-            KeySym ks = XKeycodeToKeysym(d, kc, 0);
 
             mask = 1 << i;
 
-            switch(ks) {
+            switch(priv->keysyms[kc]) {
             case XK_Num_Lock:
                 priv->mask_num = mask;
                 break;
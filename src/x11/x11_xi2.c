@@ -0,0 +1,225 @@
+/*
+ * x11_xi2.c : X11 raw mouse motion using XInput2
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include "openinput.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <X11/Xlib.h>
+#ifdef HAVE_XI2
+#include <X11/extensions/XInput2.h>
+#endif
+#include "internal.h"
+#include "x11.h"
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DX11
+ * @brief Probe for XInput2 raw motion
+ *
+ * @param dev pointer to device interface
+ * @returns true (1) if raw motion is available, false (0) otherwise
+ *
+ * Look up the XInput extension and check that the server
+ * speaks version 2. If not, or if the library was built
+ * without XInput2, relative mouse mode falls back to
+ * warping the pointer (see x11_relative_mouse).
+ */
+int x11_rawinit(oi_device *dev) {
+    x11_private *priv;
+
+    priv = (x11_private*)dev->private;
+    priv->xi_opcode = 0;
+    priv->raw = FALSE;
+
+#ifdef HAVE_XI2
+    {
+        int opcode;
+        int event;
+        int error;
+        int major;
+        int minor;
+
+        if(!XQueryExtension(priv->disp, "XInputExtension", &opcode, &event, &error)) {
+            debug("x11_rawinit: no XInput extension");
+            return FALSE;
+        }
+
+        major = DX11_XI_MAJOR;
+        minor = DX11_XI_MINOR;
+        if(XIQueryVersion(priv->disp, &major, &minor) != Success) {
+            debug("x11_rawinit: XInput %i.%i not supported", major, minor);
+            return FALSE;
+        }
+
+        debug("x11_rawinit: XInput %i.%i, opcode %i", major, minor, opcode);
+        priv->xi_opcode = opcode;
+    }
+#endif
+
+    return priv->xi_opcode != 0;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DX11
+ * @brief Select raw motion events
+ *
+ * @param dev pointer to device interface
+ *
+ * Call this whenever the grab or hide state changes. Raw motion
+ * is selected on the root window while the mouse is both grabbed
+ * and hidden, ie. when we're in relative mouse motion mode,
+ * and deselected otherwise.
+ */
+void x11_rawselect(oi_device *dev) {
+#ifdef HAVE_XI2
+    x11_private *priv;
+    XIEventMask evmask;
+    unsigned char mask[XIMaskLen(XI_RawMotion)];
+    unsigned char on;
+
+    priv = (x11_private*)dev->private;
+    if(!priv->xi_opcode) {
+        return;
+    }
+
+    // Nothing changed
+    on = (priv->relative == (DX11_GRAB | DX11_HIDE));
+    if(on == priv->raw) {
+        return;
+    }
+
+    memset(mask, 0, sizeof(mask));
+    if(on) {
+        XISetMask(mask, XI_RawMotion);
+    }
+    evmask.deviceid = XIAllMasterDevices;
+    evmask.mask_len = sizeof(mask);
+    evmask.mask = mask;
+    XISelectEvents(priv->disp, DefaultRootWindow(priv->disp), &evmask, 1);
+    XFlush(priv->disp);
+
+    debug("x11_rawselect: state:%i", on);
+    priv->raw = on;
+    priv->remx = 0;
+    priv->remy = 0;
+    priv->rawheld = FALSE;
+#endif
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DX11
+ * @brief Handle raw mouse motion
+ *
+ * @param dev pointer to device interface
+ * @param xev X generic event
+ *
+ * Raw events carry the unaccelerated device motion, and keep
+ * coming when the (confined) pointer hits the window border, so
+ * no warping is needed. Valuators 0 and 1 are the x and y axes.
+ * Fractions are kept until they add up to a whole pixel, so
+ * slow motion is not lost.
+ *
+ * With motion compression, see x11_compress, the motion is held
+ * back while more raw motion follows in the local queue.
+ */
+void x11_rawmotion(oi_device *dev, XEvent *xev) {
+#ifdef HAVE_XI2
+    x11_private *priv;
+    XGenericEventCookie *cookie;
+    XIRawEvent *raw;
+    XEvent pev;
+    double *value;
+    double delta[2];
+    int deltax;
+    int deltay;
+    int i;
+
+    priv = (x11_private*)dev->private;
+    cookie = &(xev->xcookie);
+
+    // Not ours
+    if(!priv->xi_opcode || (cookie->extension != priv->xi_opcode) ||
+       !XGetEventData(priv->disp, cookie)) {
+        return;
+    }
+
+    if((cookie->evtype == XI_RawMotion) && priv->raw) {
+        raw = (XIRawEvent*)cookie->data;
+
+        // Values are packed, only set valuators are present
+        value = raw->raw_values;
+        delta[0] = 0;
+        delta[1] = 0;
+        for(i=0; (i < 2) && (i < raw->valuators.mask_len * 8); i++) {
+            if(XIMaskIsSet(raw->valuators.mask, i)) {
+                delta[i] = *value;
+                value++;
+            }
+        }
+
+        priv->remx += delta[0];
+        priv->remy += delta[1];
+
+        // Hold back while more raw motion is queued
+        if(priv->compress) {
+            if(!priv->rawheld) {
+                priv->rawheld = TRUE;
+                priv->rawtime = raw->time;
+            }
+            if(((raw->time - priv->rawtime) < DX11_COMPRESS_SPAN) &&
+               XEventsQueued(priv->disp, QueuedAlready)) {
+                XPeekEvent(priv->disp, &pev);
+                if((pev.type == GenericEvent) &&
+                   (pev.xcookie.extension == priv->xi_opcode) &&
+                   (pev.xcookie.evtype == XI_RawMotion)) {
+                    XFreeEventData(priv->disp, cookie);
+                    return;
+                }
+            }
+            priv->rawheld = FALSE;
+        }
+
+        // Post whole pixels, keep the rest
+        deltax = (int)priv->remx;
+        deltay = (int)priv->remy;
+        priv->remx -= deltax;
+        priv->remy -= deltay;
+
+        if(deltax || deltay) {
+            mouse_move(dev->index, deltax, deltay, TRUE, TRUE);
+        }
+    }
+
+    XFreeEventData(priv->disp, cookie);
+#endif
+}
+
+/* ******************************************************************** */
@@ -0,0 +1,770 @@
+/*
+ * xcbdrv.c : XCB bootstrap and device interface
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include "openinput.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <xcb/xcb.h>
+#include <xcb/xcbext.h>
+#ifdef HAVE_XCB_XKB
+#include <xcb/xkb.h>
+#endif
+#include "internal.h"
+#include "bootstrap.h"
+#include "xcbdrv.h"
+
+/**
+ * @ingroup Drivers
+ * @defgroup DXCB XCB device driver
+ * @brief X11 window system driver using XCB
+ *
+ * The XCB driver handles mice and keyboards under X11, like
+ * the X11 driver, but talks to the server through an XCB
+ * connection shared with the application. Requests are sent
+ * without waiting, and replies are collected on later pumps,
+ * so pumping never waits for a roundtrip to the server.
+ *
+ * The connection is passed with the "x" window hook parameter
+ * (see @ref PWindow) instead of the Xlib display "c".
+ */
+
+// Bootstrap global
+oi_bootstrap xcb_bootstrap = {
+    "xcb",
+    "X11 Window system (XCB)",
+    OI_PRO_KEYBOARD | OI_PRO_MOUSE | OI_PRO_WINDOW,
+    xcbdrv_avail,
+    xcbdrv_device,
+};
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Check for window system
+ *
+ * @param flags library initialization flags, see @ref PFlags
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a bootstrap function.
+ *
+ * The connection belongs to the application and is checked
+ * by init.
+ */
+int xcbdrv_avail(unsigned int flags) {
+    debug("xcbdrv_avail");
+
+    // Check flags
+    if(flags & OI_FLAG_NOWINDOW) {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Create XCB device driver interface
+ *
+ * @returns pointer to device interface, see @ref IDevstructs
+ *
+ * This is a bootstrap function.
+ *
+ * Create the internal data structure and the device interface.
+ */
+oi_device *xcbdrv_device() {
+    oi_device *dev;
+    xcbdrv_private *priv;
+
+    debug("xcbdrv_device");
+
+    // Alloc
+    dev = (oi_device*)malloc(sizeof(oi_device));
+    priv = (xcbdrv_private*)malloc(sizeof(xcbdrv_private));
+    if((dev == NULL) || (priv == NULL)) {
+        debug("xcbdrv_device: device creation failed");
+        if(dev) {
+            free(dev);
+        }
+        if(priv) {
+            free(priv);
+        }
+        return NULL;
+    }
+
+    // Clear structures
+    memset(dev, 0, sizeof(oi_device));
+    memset(priv, 0, sizeof(xcbdrv_private));
+
+    // Set members
+    dev->private = priv;
+    dev->init = xcbdrv_init;
+    dev->destroy = xcbdrv_destroy;
+    dev->process = xcbdrv_process;
+    dev->grab = xcbdrv_grab;
+    dev->hide = xcbdrv_hidecursor;
+    dev->warp = xcbdrv_warp;
+    dev->winsize = xcbdrv_winsize;
+    dev->reset = xcbdrv_reset;
+
+    // Done
+    return dev;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Initialize the XCB driver
+ *
+ * @param dev pointer to created device interface
+ * @param window_id window hook parameters, see @ref PWindow
+ * @param flags initialization flags, see @ref PFlags
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Hooks into the window of the application. All requests needed
+ * (atoms, window attributes and geometry, keyboard and modifier
+ * mappings and the keyboard state) are sent at once, so
+ * initialization costs a single roundtrip (plus one for XKB).
+ *
+ * Our events are added to the event mask already selected on
+ * the window, and WM_DELETE_WINDOW is appended to the window
+ * manager protocols, so the application keeps its own.
+ */
+int xcbdrv_init(oi_device *dev, char *window_id, unsigned int flags) {
+    xcbdrv_private *priv;
+    xcb_intern_atom_cookie_t protoc;
+    xcb_intern_atom_cookie_t wmdeletec;
+    xcb_get_window_attributes_cookie_t attrc;
+    xcb_get_geometry_cookie_t geoc;
+    xcb_query_keymap_cookie_t keysc;
+    xcb_query_pointer_cookie_t ptrc;
+    xcb_intern_atom_reply_t *proto;
+    xcb_intern_atom_reply_t *wmdelete;
+    xcb_get_window_attributes_reply_t *attr;
+    xcb_get_geometry_reply_t *geo;
+    xcb_query_keymap_reply_t *keys;
+    xcb_query_pointer_reply_t *ptr;
+    xcb_pixmap_t pixmap;
+    uint32_t mask;
+
+    priv = (xcbdrv_private*)dev->private;
+    debug("xcbdrv_init");
+
+    // Parse the window_id flags
+    priv->conn = (xcb_connection_t*)device_windowid(window_id, OI_I_XCB);
+    priv->win = (xcb_window_t)device_windowid(window_id, OI_I_WINID);
+
+    // We require xcb and winid parameters
+    if(!(priv->conn) || !(priv->win) || xcb_connection_has_error(priv->conn)) {
+        debug("xcbdrv_init: xcb (x) and winid (w) parameters required");
+        return OI_ERR_NO_DEVICE;
+    }
+
+    // Send everything first
+#ifdef HAVE_XCB_XKB
+    xcb_prefetch_extension_data(priv->conn, &xcb_xkb_id);
+#endif
+    protoc = xcb_intern_atom(priv->conn, FALSE, 12, "WM_PROTOCOLS");
+    wmdeletec = xcb_intern_atom(priv->conn, FALSE, 16, "WM_DELETE_WINDOW");
+    attrc = xcb_get_window_attributes(priv->conn, priv->win);
+    geoc = xcb_get_geometry(priv->conn, priv->win);
+    keysc = xcb_query_keymap(priv->conn);
+    ptrc = xcb_query_pointer(priv->conn, priv->win);
+    xcbdrv_mapping(dev);
+
+    // Make the invisible cursor
+    pixmap = xcb_generate_id(priv->conn);
+    priv->cursor = xcb_generate_id(priv->conn);
+    xcb_create_pixmap(priv->conn, 1, pixmap, priv->win, 1, 1);
+    xcb_create_cursor(priv->conn, priv->cursor, pixmap, pixmap,
+                      0, 0, 0, 0, 0, 0, 0, 0);
+    xcb_free_pixmap(priv->conn, pixmap);
+
+    // Then collect the replies
+    proto = xcb_intern_atom_reply(priv->conn, protoc, NULL);
+    wmdelete = xcb_intern_atom_reply(priv->conn, wmdeletec, NULL);
+    attr = xcb_get_window_attributes_reply(priv->conn, attrc, NULL);
+    geo = xcb_get_geometry_reply(priv->conn, geoc, NULL);
+    keys = xcb_query_keymap_reply(priv->conn, keysc, NULL);
+    ptr = xcb_query_pointer_reply(priv->conn, ptrc, NULL);
+    xcbdrv_replies(dev, TRUE);
+
+    if(attr && geo) {
+        // Start receiving events
+        mask = attr->your_event_mask | XCB_EVENT_MASK_FOCUS_CHANGE |
+            XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE |
+            XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_STRUCTURE_NOTIFY |
+            XCB_EVENT_MASK_KEYMAP_STATE | XCB_EVENT_MASK_BUTTON_PRESS |
+            XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_POINTER_MOTION |
+            XCB_EVENT_MASK_ENTER_WINDOW | XCB_EVENT_MASK_LEAVE_WINDOW;
+        xcb_change_window_attributes(priv->conn, priv->win, XCB_CW_EVENT_MASK, &mask);
+
+        priv->width = geo->width;
+        priv->height = geo->height;
+    }
+
+    // Get "close window" window manager protocol atom
+    if(proto && wmdelete) {
+        priv->wm_delete_window = wmdelete->atom;
+        xcb_change_property(priv->conn, XCB_PROP_MODE_APPEND, priv->win,
+                            proto->atom, XCB_ATOM_ATOM, 32, 1,
+                            &(priv->wm_delete_window));
+    }
+
+    // Sync keyboard state
+    if(keys) {
+        xcbdrv_keystate(dev, keys->keys, ptr ? ptr->mask : 0);
+    }
+
+    if(proto) {
+        free(proto);
+    }
+    if(wmdelete) {
+        free(wmdelete);
+    }
+    if(keys) {
+        free(keys);
+    }
+    if(ptr) {
+        free(ptr);
+    }
+    if(attr) {
+        free(attr);
+    }
+    if(!geo) {
+        debug("xcbdrv_init: no such window");
+        xcb_free_cursor(priv->conn, priv->cursor);
+        priv->cursor = 0;
+        return OI_ERR_NO_DEVICE;
+    }
+    free(geo);
+
+    xcbdrv_autorepeat(dev);
+    xcb_flush(priv->conn);
+
+    debug("xcbdrv_init: initialized (detectable autorepeat:%i)", priv->detectable);
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Destroy the XCB device driver
+ *
+ * @param dev pointer to device interface
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Shutdown the XCB driver by releasing all
+ * allocated memory and the hidden cursor, and restore
+ * the detectable autorepeat setting of the connection.
+ */
+int xcbdrv_destroy(oi_device *dev) {
+    xcbdrv_private *priv;
+
+    debug("xcbdrv_destroy");
+
+    if(dev) {
+        priv = (xcbdrv_private*)dev->private;
+
+        // Private members
+        if(priv) {
+            // Do not leave replies behind in the connection
+            xcbdrv_replies(dev, TRUE);
+
+            if(priv->cursor) {
+                xcb_free_cursor(priv->conn, priv->cursor);
+            }
+
+#ifdef HAVE_XCB_XKB
+            // Give the application its autorepeat setting back
+            if(priv->detectable && !priv->wasdetectable) {
+                xcb_discard_reply(priv->conn,
+                                  xcb_xkb_per_client_flags(priv->conn, XCB_XKB_ID_USE_CORE_KBD,
+                                                           XCB_XKB_PER_CLIENT_FLAG_DETECTABLE_AUTO_REPEAT,
+                                                           0, 0, 0, 0).sequence);
+            }
+#endif
+            if(priv->conn) {
+                xcb_flush(priv->conn);
+            }
+            free(priv);
+        }
+
+        // Device struct
+        free(dev);
+        dev = NULL;
+    }
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Process events
+ *
+ * @param dev pointer to device interface
+ *
+ * This is a device interface function.
+ *
+ * Collect replies that have arrived, then read the connection
+ * once (without blocking) and dispatch the whole batch from
+ * the XCB event queue.
+ */
+void xcbdrv_process(oi_device *dev) {
+    xcbdrv_private *priv;
+    xcb_generic_event_t *ev;
+
+    priv = (xcbdrv_private*)dev->private;
+
+    // Replies to earlier requests
+    if(priv->pending) {
+        xcbdrv_replies(dev, FALSE);
+    }
+
+    // One read, then the queued events
+    ev = xcb_poll_for_event(priv->conn);
+    while(ev) {
+        xcbdrv_dispatch(dev, ev);
+        free(ev);
+
+        if(!oi_runstate()) {
+            break;
+        }
+        ev = xcb_poll_for_queued_event(priv->conn);
+    }
+
+    // A release ending the batch was not a repeat
+    if(priv->held) {
+        xcbdrv_release(dev);
+    }
+
+    // Requests made by the dispatcher
+    xcb_flush(priv->conn);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Grab/release mouse and keyboard
+ *
+ * @param dev pointer to device interface.
+ * @param on true (1) turns on grab, false (0) releases grab
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Grab or release input (keyboard) and pointer (mouse) inside
+ * the hook-window. Both grabs are sent before waiting for the
+ * replies.
+ */
+int xcbdrv_grab(oi_device *dev, int on) {
+    xcbdrv_private *priv;
+    xcb_grab_keyboard_cookie_t keyc;
+    xcb_grab_pointer_cookie_t ptrc;
+    xcb_grab_keyboard_reply_t *keyr;
+    xcb_grab_pointer_reply_t *ptrr;
+    uint32_t value;
+    int ok;
+
+    priv = (xcbdrv_private*)dev->private;
+    debug("xcbdrv_grab: state:%i", on);
+
+    if(on) {
+        // Raise window and focus it
+        value = XCB_STACK_MODE_ABOVE;
+        xcb_configure_window(priv->conn, priv->win, XCB_CONFIG_WINDOW_STACK_MODE, &value);
+        xcb_set_input_focus(priv->conn, XCB_INPUT_FOCUS_PARENT, priv->win, XCB_CURRENT_TIME);
+
+        // Grab input
+        keyc = xcb_grab_keyboard(priv->conn, TRUE, priv->win, XCB_CURRENT_TIME,
+                                 XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC);
+
+        // Wait for succesfull grabbing of mouse
+        while(1) {
+            ptrc = xcb_grab_pointer(priv->conn, TRUE, priv->win,
+                                    XCB_EVENT_MASK_BUTTON_PRESS |
+                                    XCB_EVENT_MASK_BUTTON_RELEASE |
+                                    XCB_EVENT_MASK_POINTER_MOTION,
+                                    XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC,
+                                    priv->win, XCB_NONE, XCB_CURRENT_TIME);
+            ptrr = xcb_grab_pointer_reply(priv->conn, ptrc, NULL);
+            ok = !ptrr || (ptrr->status == XCB_GRAB_STATUS_SUCCESS);
+            if(ptrr) {
+                free(ptrr);
+            }
+            if(ok) {
+                break;
+            }
+            usleep(OI_SLEEP);
+        }
+
+        keyr = xcb_grab_keyboard_reply(priv->conn, keyc, NULL);
+        if(keyr) {
+            free(keyr);
+        }
+
+        // Set flag for possible relative mouse
+        priv->relative |= DXCB_GRAB;
+    }
+    else {
+        // Simply ungrab both
+        xcb_ungrab_keyboard(priv->conn, XCB_CURRENT_TIME);
+        xcb_ungrab_pointer(priv->conn, XCB_CURRENT_TIME);
+        xcb_flush(priv->conn);
+
+        // Fix relative mouse motion
+        priv->relative &= ~DXCB_GRAB;
+    }
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Show/hide mouse pointer
+ *
+ * @param dev pointer to device interface.
+ * @param on true (1) hides cursor, false (0) shows cursor
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Switch between the invisible cursor and the default one.
+ */
+int xcbdrv_hidecursor(oi_device *dev, int on) {
+    xcbdrv_private *priv;
+    uint32_t cursor;
+
+    debug("xcbdrv_hidecursor: state:%i", on);
+    priv = (xcbdrv_private*)dev->private;
+
+    if(on) {
+        cursor = priv->cursor;
+        priv->relative |= DXCB_HIDE;
+    }
+    else {
+        cursor = XCB_NONE;
+        priv->relative &= ~DXCB_HIDE;
+    }
+
+    xcb_change_window_attributes(priv->conn, priv->win, XCB_CW_CURSOR, &cursor);
+    xcb_flush(priv->conn);
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Warp mouse pointer
+ *
+ * @param dev pointer to device interface.
+ * @param x pointer to horizontal position
+ * @param y pointer to vertical position
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Warp (move) the mouse pointer to the given absolute coordinate
+ * within the hook-window. We do not wait for the warp, instead
+ * the sequence number of the request tells which motion events
+ * were generated before and after it, see xcbdrv_motion.
+ */
+int xcbdrv_warp(oi_device *dev, int x, int y) {
+    xcbdrv_private *priv;
+    xcb_void_cookie_t cookie;
+
+    priv = (xcbdrv_private*)dev->private;
+
+    cookie = xcb_warp_pointer(priv->conn, XCB_NONE, priv->win,
+                              0, 0, 0, 0, x, y);
+    xcb_flush(priv->conn);
+
+    priv->warp_seq = cookie.sequence;
+    priv->warpx = x;
+    priv->warpy = y;
+    priv->warping = TRUE;
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Get window size
+ *
+ * @param dev pointer to device interface.
+ * @param w pointer to horizontal size
+ * @param h pointer to vertical size
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * The size is tracked from configure-notify events, so
+ * the server is not asked.
+ */
+int xcbdrv_winsize(oi_device *dev, int *w, int *h) {
+    xcbdrv_private *priv;
+
+    priv = (xcbdrv_private*)dev->private;
+
+    if(w) {
+        *w = priv->width;
+    }
+    if(h) {
+        *h = priv->height;
+    }
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Reset internal state
+ *
+ * @param dev pointer to device interface
+ * @returns errorcode, see @ref PErrors
+ *
+ * This is a device interface function.
+ *
+ * Show cursor, release grab, reread the keymap and center
+ * the mouse cursor.
+ */
+int xcbdrv_reset(oi_device *dev) {
+    xcbdrv_private *priv;
+
+    priv = (xcbdrv_private*)dev->private;
+    debug("xcbdrv_reset");
+
+    xcbdrv_grab(dev, FALSE);
+    xcbdrv_hidecursor(dev, FALSE);
+    xcbdrv_mapping(dev);
+    xcbdrv_warp(dev, priv->width/2, priv->height/2);
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Fetch a reply
+ *
+ * @param dev pointer to device interface
+ * @param seq sequence number of request
+ * @param wait true (1) to wait for the reply, false (0) otherwise
+ * @param reply where to store the reply, NULL on error
+ * @returns true (1) if the request is done, false (0) if the
+ * reply has not arrived yet
+ *
+ * The caller must free the reply.
+ */
+int xcbdrv_reply(oi_device *dev, unsigned int seq, char wait, void **reply) {
+    xcbdrv_private *priv;
+    xcb_generic_error_t *error;
+
+    priv = (xcbdrv_private*)dev->private;
+    error = NULL;
+    *reply = NULL;
+
+    if(wait) {
+        *reply = xcb_wait_for_reply(priv->conn, seq, &error);
+    }
+    else if(!xcb_poll_for_reply(priv->conn, seq, reply, &error)) {
+        return FALSE;
+    }
+
+    if(error) {
+        log_warn("xcbdrv_reply: request %u failed, code %u", seq, error->error_code);
+        free(error);
+    }
+
+    return TRUE;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Handle pending replies
+ *
+ * @param dev pointer to device interface
+ * @param wait true (1) to wait for the replies, false (0) to
+ * handle only those which have arrived
+ *
+ * The keyboard mapping is handled before the modifier mapping,
+ * since the latter needs the keysyms.
+ */
+void xcbdrv_replies(oi_device *dev, char wait) {
+    xcbdrv_private *priv;
+    void *reply;
+
+    priv = (xcbdrv_private*)dev->private;
+
+    if((priv->pending & DXCB_P_KEYMAP) &&
+       xcbdrv_reply(dev, priv->keymap_seq, wait, &reply)) {
+        priv->pending &= ~DXCB_P_KEYMAP;
+        if(reply) {
+            xcbdrv_keymap(dev, (xcb_get_keyboard_mapping_reply_t*)reply);
+            free(reply);
+        }
+    }
+
+    if(!(priv->pending & DXCB_P_KEYMAP) && (priv->pending & DXCB_P_MODMAP) &&
+       xcbdrv_reply(dev, priv->modmap_seq, wait, &reply)) {
+        priv->pending &= ~DXCB_P_MODMAP;
+        if(reply) {
+            xcbdrv_modmasks(dev, (xcb_get_modifier_mapping_reply_t*)reply);
+            free(reply);
+        }
+    }
+
+    if((priv->pending & DXCB_P_POINTER) &&
+       xcbdrv_reply(dev, priv->pointer_seq, wait, &reply)) {
+        priv->pending &= ~DXCB_P_POINTER;
+        if(reply) {
+            xcbdrv_keystate(dev, priv->keyvec,
+                            ((xcb_query_pointer_reply_t*)reply)->mask);
+            free(reply);
+        }
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Request keyboard and modifier mappings
+ *
+ * @param dev pointer to device interface
+ *
+ * The replies are handled by xcbdrv_replies.
+ */
+void xcbdrv_mapping(oi_device *dev) {
+    xcbdrv_private *priv;
+    const xcb_setup_t *setup;
+
+    priv = (xcbdrv_private*)dev->private;
+    setup = xcb_get_setup(priv->conn);
+
+    priv->keymap_seq = xcb_get_keyboard_mapping(priv->conn, setup->min_keycode,
+                                                setup->max_keycode - setup->min_keycode + 1).sequence;
+    priv->modmap_seq = xcb_get_modifier_mapping(priv->conn).sequence;
+    priv->pending |= DXCB_P_KEYMAP | DXCB_P_MODMAP;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Turn on detectable autorepeat
+ *
+ * @param dev pointer to device interface
+ *
+ * With XKB detectable autorepeat, the server sends repeated presses
+ * without fake releases in between. Note that this is a per-client
+ * setting, so it also applies to the application sharing the
+ * connection. The old setting is kept, so xcbdrv_destroy can restore
+ * it. Without XKB, repeats are detected from the timestamps of
+ * release/press pairs instead, see xcbdrv_release.
+ */
+void xcbdrv_autorepeat(oi_device *dev) {
+    xcbdrv_private *priv;
+
+    priv = (xcbdrv_private*)dev->private;
+    priv->detectable = FALSE;
+    priv->wasdetectable = FALSE;
+
+#ifdef HAVE_XCB_XKB
+    {
+        const xcb_query_extension_reply_t *ext;
+        xcb_xkb_use_extension_cookie_t usec;
+        xcb_xkb_per_client_flags_cookie_t oldc;
+        xcb_xkb_per_client_flags_cookie_t flagc;
+        xcb_xkb_use_extension_reply_t *use;
+        xcb_xkb_per_client_flags_reply_t *old;
+        xcb_xkb_per_client_flags_reply_t *flag;
+
+        ext = xcb_get_extension_data(priv->conn, &xcb_xkb_id);
+        if(!ext || !ext->present) {
+            debug("xcbdrv_autorepeat: no XKB extension");
+            return;
+        }
+
+        usec = xcb_xkb_use_extension(priv->conn, XCB_XKB_MAJOR_VERSION,
+                                     XCB_XKB_MINOR_VERSION);
+        oldc = xcb_xkb_per_client_flags(priv->conn, XCB_XKB_ID_USE_CORE_KBD,
+                                        0, 0, 0, 0, 0);
+        flagc = xcb_xkb_per_client_flags(priv->conn, XCB_XKB_ID_USE_CORE_KBD,
+                                         XCB_XKB_PER_CLIENT_FLAG_DETECTABLE_AUTO_REPEAT,
+                                         XCB_XKB_PER_CLIENT_FLAG_DETECTABLE_AUTO_REPEAT,
+                                         0, 0, 0);
+        use = xcb_xkb_use_extension_reply(priv->conn, usec, NULL);
+        old = xcb_xkb_per_client_flags_reply(priv->conn, oldc, NULL);
+        flag = xcb_xkb_per_client_flags_reply(priv->conn, flagc, NULL);
+
+        if(old && (old->value & XCB_XKB_PER_CLIENT_FLAG_DETECTABLE_AUTO_REPEAT)) {
+            priv->wasdetectable = TRUE;
+        }
+
+        if(use && use->supported && flag &&
+           (flag->value & XCB_XKB_PER_CLIENT_FLAG_DETECTABLE_AUTO_REPEAT)) {
+            priv->detectable = TRUE;
+        }
+
+        if(use) {
+            free(use);
+        }
+        if(old) {
+            free(old);
+        }
+        if(flag) {
+            free(flag);
+        }
+    }
+#endif
+}
+
+/* ******************************************************************** */
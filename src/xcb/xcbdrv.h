@@ -0,0 +1,121 @@
+/*
+ * xcbdrv.h : XCB utility functions (bootstrapping, etc.)
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+#ifndef _OPENINPUT_XCBDRV_H_
+#define _OPENINPUT_XCBDRV_H_
+
+/* ******************************************************************** */
+
+// Bootstrap entries
+int xcbdrv_avail(unsigned int flags);
+oi_device *xcbdrv_device();
+
+/* ******************************************************************** */
+
+// Device entries
+int xcbdrv_init(oi_device *dev, char *window_id, unsigned int flags);
+int xcbdrv_destroy(oi_device *dev);
+void xcbdrv_process(oi_device *dev);
+int xcbdrv_grab(oi_device *dev, int on);
+int xcbdrv_hidecursor(oi_device *dev, int on);
+int xcbdrv_warp(oi_device *dev, int x, int y);
+int xcbdrv_winsize(oi_device *dev, int *w, int *h);
+int xcbdrv_reset(oi_device *dev);
+
+/* ******************************************************************** */
+
+// Misc local functions
+int xcbdrv_reply(oi_device *dev, unsigned int seq, char wait, void **reply);
+void xcbdrv_replies(oi_device *dev, char wait);
+void xcbdrv_mapping(oi_device *dev);
+void xcbdrv_autorepeat(oi_device *dev);
+void xcbdrv_dispatch(oi_device *dev, xcb_generic_event_t *ev);
+void xcbdrv_motion(oi_device *dev, xcb_motion_notify_event_t *mev);
+void xcbdrv_key(oi_device *dev, xcb_keycode_t kc, char down);
+void xcbdrv_release(oi_device *dev);
+void xcbdrv_initkeymap();
+oi_key xcbdrv_translate(xcb_keysym_t xsym, xcb_keycode_t kc);
+void xcbdrv_keymap(oi_device *dev, xcb_get_keyboard_mapping_reply_t *map);
+void xcbdrv_modmasks(oi_device *dev, xcb_get_modifier_mapping_reply_t *mods);
+void xcbdrv_keystate(oi_device *dev, unsigned char *keyvec, unsigned int mask);
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief XCB driver private instance data
+ *
+ * Private data for the XCB driver. Besides the connection and
+ * window handles, this holds the keycode translation table and
+ * the sequence numbers of requests whose replies are collected
+ * later on, so the driver never has to wait for the X server
+ * while pumping.
+ */
+typedef struct xcbdrv_private {
+    xcb_connection_t *conn;    /**< Connection handle */
+    xcb_window_t win;          /**< Window handle */
+    xcb_cursor_t cursor;       /**< The invisible cursor */
+    xcb_atom_t wm_delete_window; /**< Close-window protocol atom */
+    unsigned int mask_num;     /**< Variable mask for key */
+    unsigned int mask_altgr;   /**< Variable mask for key */
+    unsigned char relative;    /**< Relative mouse motion bitmask */
+    int lastx;                 /**< Last mouse x positon */
+    int lasty;                 /**< Last mouse y position */
+    int width;                 /**< Window width */
+    int height;                /**< Window height */
+    char warping;              /**< Warp not yet seen in motion events */
+    unsigned int warp_seq;     /**< Sequence number of last warp */
+    int warpx;                 /**< Warp x position */
+    int warpy;                 /**< Warp y position */
+    char detectable;           /**< XKB detectable autorepeat is on */
+    char wasdetectable;        /**< Detectable autorepeat setting before xcbdrv_init */
+    char held;                 /**< Key release held back, see xcbdrv_release */
+    xcb_key_release_event_t release; /**< The held key release */
+    unsigned char keydown[32]; /**< Pressed keycodes, X keymap bit vector */
+    unsigned char keyvec[32];  /**< Key vector waiting for modifier state */
+    xcb_keysym_t keysyms[256]; /**< Unshifted keysym of each keycode */
+    oi_key keymap[256];        /**< OpenInput key of each keycode */
+    unsigned char pending;     /**< Outstanding requests, see @ref DXCB */
+    unsigned int keymap_seq;   /**< Keyboard mapping request */
+    unsigned int modmap_seq;   /**< Modifier mapping request */
+    unsigned int pointer_seq;  /**< Pointer query for modifier state */
+} xcbdrv_private;
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @{
+ */
+#define DXCB_GRAB 1            /**< Grabbed state flag */
+#define DXCB_HIDE 2            /**< Hidden state flag */
+#define DXCB_FUDGE 8           /**< Mouse fudge factor */
+#define DXCB_REP_THRESHOLD 2   /**< Key repeat threshold */
+#define DXCB_P_KEYMAP 1        /**< Keyboard mapping reply pending */
+#define DXCB_P_MODMAP 2        /**< Modifier mapping reply pending */
+#define DXCB_P_POINTER 4       /**< Pointer query reply pending */
+/** @} */
+
+/* ******************************************************************** */
+
+#endif
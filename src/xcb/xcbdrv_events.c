@@ -0,0 +1,359 @@
+/*
+ * xcbdrv_events.c : XCB event handling
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include "openinput.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <xcb/xcb.h>
+#include "internal.h"
+#include "xcbdrv.h"
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Handle mouse motion
+ *
+ * @param dev pointer to device interface
+ * @param mev motion event
+ *
+ * When the mouse is grabbed and the cursor is hidden we
+ * are in "relative mouse motion mode", where the cursor is
+ * warped back to the middle of the window when it gets near
+ * the border.
+ *
+ * Unlike the X11 driver, we never wait for the warp. Each event
+ * carries the sequence number of the last request the server had
+ * handled when the event was generated, so events from before
+ * the warp are measured from the previous position, and events
+ * from after it from the warp position.
+ */
+void xcbdrv_motion(oi_device *dev, xcb_motion_notify_event_t *mev) {
+    xcbdrv_private *priv;
+    int deltax;
+    int deltay;
+
+    priv = (xcbdrv_private*)dev->private;
+
+    // Warp has taken effect, (16 bit sequence, with wrap-around)
+    if(priv->warping &&
+       ((uint16_t)(mev->sequence - (uint16_t)priv->warp_seq) < 0x8000)) {
+        priv->warping = FALSE;
+        priv->lastx = priv->warpx;
+        priv->lasty = priv->warpy;
+    }
+
+    // Calculate motion and store current positon
+    deltax = mev->event_x - priv->lastx;
+    deltay = mev->event_y - priv->lasty;
+    priv->lastx = mev->event_x;
+    priv->lasty = mev->event_y;
+
+    // Absolute mode
+    if(priv->relative != (DXCB_GRAB | DXCB_HIDE)) {
+        mouse_move(dev->index, mev->event_x, mev->event_y, FALSE, TRUE);
+        return;
+    }
+
+    // Relative mode, the warp itself does not count
+    if(deltax || deltay) {
+        mouse_move(dev->index, deltax, deltay, TRUE, TRUE);
+    }
+
+    // Center (warp) mouse if we're near the edge of the window
+    if(!priv->warping &&
+       ((mev->event_x < DXCB_FUDGE) ||
+        (mev->event_x > (priv->width - DXCB_FUDGE)) ||
+        (mev->event_y < DXCB_FUDGE) ||
+        (mev->event_y > (priv->height - DXCB_FUDGE)))) {
+        xcbdrv_warp(dev, priv->width / 2, priv->height / 2);
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Post key event
+ *
+ * @param dev pointer to device interface
+ * @param kc X keycode
+ * @param down true (1) if pressed, false (0) if released
+ *
+ * Translation is a lookup in the keycode table. Presses of keys
+ * which are already down are repeats, and are thrown away as
+ * OpenInput has it's internal keyrepeat system.
+ */
+void xcbdrv_key(oi_device *dev, xcb_keycode_t kc, char down) {
+    xcbdrv_private *priv;
+    oi_keysym keysym;
+    unsigned char bit;
+
+    priv = (xcbdrv_private*)dev->private;
+    bit = 1 << (kc & 7);
+
+    if(down) {
+        if(priv->keydown[kc >> 3] & bit) {
+            debug("xcbdrv_key: repeating key detected");
+            return;
+        }
+        priv->keydown[kc >> 3] |= bit;
+    }
+    else {
+        priv->keydown[kc >> 3] &= ~bit;
+    }
+
+    keysym.scancode = kc;
+    keysym.sym = priv->keymap[kc];
+    keysym.mod = OIM_NONE;
+    keyboard_update(dev->index, &keysym, down, TRUE);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Post held key release
+ *
+ * @param dev pointer to device interface
+ *
+ * Without detectable autorepeat, the server repeats a key by
+ * sending a release and a press with the same timestamp. As
+ * XCB can't peek at the next event, the release is held back
+ * until the next event (or the end of the batch) shows whether
+ * it was real.
+ */
+void xcbdrv_release(oi_device *dev) {
+    xcbdrv_private *priv;
+
+    priv = (xcbdrv_private*)dev->private;
+    priv->held = FALSE;
+    xcbdrv_key(dev, priv->release.detail, FALSE);
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief XCB event dispatcher
+ *
+ * @param dev pointer to device interface
+ * @param ev the XCB event
+ *
+ * Convert the XCB event to the corresponding OpenInput event.
+ * For the most part, this is handled in the state managers
+ * (ie. keyboard, mouse, appstate, etc.)
+ */
+void xcbdrv_dispatch(oi_device *dev, xcb_generic_event_t *ev) {
+    xcbdrv_private *priv;
+    unsigned char type;
+
+    priv = (xcbdrv_private*)dev->private;
+
+    // Strip the "sent by SendEvent" flag
+    type = ev->response_type & ~0x80;
+    trace_add(OI_TRACE_DRIVER, dev->index, type);
+
+    // Held release followed by a press of the same key is a repeat
+    if(priv->held) {
+        if((type == XCB_KEY_PRESS) &&
+           (((xcb_key_press_event_t*)ev)->detail == priv->release.detail) &&
+           ((((xcb_key_press_event_t*)ev)->time - priv->release.time) < DXCB_REP_THRESHOLD)) {
+            debug("xcbdrv_dispatch: repeating key detected");
+            priv->held = FALSE;
+            return;
+        }
+        xcbdrv_release(dev);
+    }
+
+    switch(type) {
+
+        // Mouse enters/leaves window
+    case XCB_ENTER_NOTIFY:
+    case XCB_LEAVE_NOTIFY:
+        debug("xcbdrv_dispatch: enter/leave_notify (in/down:%i)", type == XCB_ENTER_NOTIFY);
+        {
+            xcb_enter_notify_event_t *cev;
+            cev = (xcb_enter_notify_event_t*)ev;
+
+            // We're not interested in grab mode events
+            if((cev->mode != XCB_NOTIFY_MODE_GRAB) &&
+               (cev->mode != XCB_NOTIFY_MODE_UNGRAB)) {
+
+                // Move if grabbed, otherwise change focus
+                if(oi_app_grab(OI_QUERY) == OI_ENABLE) {
+                    mouse_move(dev->index, cev->event_x, cev->event_y, FALSE, TRUE);
+                }
+                else {
+                    appstate_focus(dev->index,
+                                   type == XCB_ENTER_NOTIFY,
+                                   OI_FOCUS_MOUSE,
+                                   TRUE);
+                }
+            }
+        }
+        break;
+
+
+        // Input focus gained/lost
+    case XCB_FOCUS_IN:
+    case XCB_FOCUS_OUT:
+        debug("xcbdrv_dispatch: focus_in/out (in/down:%i)", type == XCB_FOCUS_IN);
+        appstate_focus(dev->index,
+                       type == XCB_FOCUS_IN,
+                       OI_FOCUS_INPUT,
+                       TRUE);
+        break;
+
+
+        // Generated on EnterWindow and FocusIn
+    case XCB_KEYMAP_NOTIFY:
+        debug("xcbdrv_dispatch: keymap_notify");
+        // Keys of the event start at byte 1, the locks come later
+        priv->keyvec[0] = 0;
+        memcpy(priv->keyvec + 1, ((xcb_keymap_notify_event_t*)ev)->keys, 31);
+        priv->pointer_seq = xcb_query_pointer(priv->conn, priv->win).sequence;
+        priv->pending |= DXCB_P_POINTER;
+        break;
+
+
+        // Keyboard layout changed
+    case XCB_MAPPING_NOTIFY:
+        debug("xcbdrv_dispatch: mapping_notify");
+        if(((xcb_mapping_notify_event_t*)ev)->request != XCB_MAPPING_POINTER) {
+            xcbdrv_mapping(dev);
+        }
+        break;
+
+
+        // Mouse motion
+    case XCB_MOTION_NOTIFY:
+        debug("xcbdrv_dispatch: motion_notify");
+        xcbdrv_motion(dev, (xcb_motion_notify_event_t*)ev);
+        break;
+
+
+        // Mouse button pressed
+    case XCB_BUTTON_PRESS:
+    case XCB_BUTTON_RELEASE:
+        debug("xcbdrv_dispatch: button_press/release (in/down:%i)", type == XCB_BUTTON_PRESS);
+        mouse_button(dev->index,
+                     ((xcb_button_press_event_t*)ev)->detail,
+                     type == XCB_BUTTON_PRESS,
+                     TRUE);
+        break;
+
+
+        // Keyboard pressed
+    case XCB_KEY_PRESS:
+        debug("xcbdrv_dispatch: key_press");
+        xcbdrv_key(dev, ((xcb_key_press_event_t*)ev)->detail, TRUE);
+        break;
+
+
+        // Keyboard released, maybe hold it back
+    case XCB_KEY_RELEASE:
+        debug("xcbdrv_dispatch: key_release");
+        if(priv->detectable) {
+            xcbdrv_key(dev, ((xcb_key_release_event_t*)ev)->detail, FALSE);
+        }
+        else {
+            memcpy(&(priv->release), ev, sizeof(xcb_key_release_event_t));
+            priv->held = TRUE;
+        }
+        break;
+
+
+        // Window gets iconified
+    case XCB_UNMAP_NOTIFY:
+        debug("xcbdrv_dispatch: unmap_notify");
+        appstate_focus(dev->index, FALSE, OI_FOCUS_INPUT | OI_FOCUS_VISIBLE, TRUE);
+        break;
+
+
+        // Window gets restored (uniconified)
+    case XCB_MAP_NOTIFY:
+        debug("xcbdrv_dispatch: map_notify");
+        appstate_focus(dev->index, TRUE, OI_FOCUS_VISIBLE, TRUE);
+        break;
+
+
+        // Window was resized or moved
+    case XCB_CONFIGURE_NOTIFY:
+        debug("xcbdrv_dispatch: configure_notify");
+        {
+            xcb_configure_notify_event_t *cev;
+            cev = (xcb_configure_notify_event_t*)ev;
+
+            // Only post update if anything changed
+            if((cev->window == priv->win) &&
+               ((priv->width != cev->width) || (priv->height != cev->height))) {
+                priv->width = cev->width;
+                priv->height = cev->height;
+                appstate_resize(dev->index, cev->width, cev->height, TRUE);
+            }
+        }
+        break;
+
+
+        // We should quit -- or other messages
+    case XCB_CLIENT_MESSAGE:
+        debug("xcbdrv_dispatch: client_message");
+        // Window manager close window
+        if((((xcb_client_message_event_t*)ev)->format == 32) &&
+           (((xcb_client_message_event_t*)ev)->data.data32[0] == priv->wm_delete_window)) {
+            oi_event oev;
+            oev.type = OI_QUIT;
+            queue_add(&oev);
+        }
+        break;
+
+
+        // Redraw required
+    case XCB_EXPOSE:
+        debug("xcbdrv_dispatch: expose");
+        {
+            oi_event oev;
+            oev.type = OI_EXPOSE;
+            queue_add(&oev);
+        }
+        break;
+
+
+        // Errors of requests without replies
+    case 0:
+        log_warn("xcbdrv_dispatch: error code %u", ((xcb_generic_error_t*)ev)->error_code);
+        break;
+
+
+        // Unhandled event
+    default:
+        debug("xcbdrv_dispatch: unhandled event type %i", type);
+        break;
+    }
+}
+
+/* ******************************************************************** */
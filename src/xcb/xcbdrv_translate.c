@@ -0,0 +1,406 @@
+/*
+ * xcbdrv_translate.c : XCB keyboard translators
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+// Includes
+#include "config.h"
+#include "openinput.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <xcb/xcb.h>
+#include <X11/keysym.h>
+#include "internal.h"
+#include "xcbdrv.h"
+
+// Globals
+static oi_key xcbdrv_oddmap[256];
+static oi_key xcbdrv_miscmap[256];
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Initialize the X11 to OpenInput keymap table
+ *
+ * To be able to do constant-time translations from X
+ * keyboard button names to OpenInput symbolic keys,
+ * we prepare two lookup-tables in this function.
+ */
+void xcbdrv_initkeymap() {
+    int i;
+
+    // Clear odd and misc keymaps
+    for(i=0; i<TABLESIZE(xcbdrv_oddmap); i++) {
+        xcbdrv_oddmap[i] = OIK_UNKNOWN;
+        xcbdrv_miscmap[i] = OIK_UNKNOWN;
+    }
+
+    // Odd keymap (highbyte 0xFE)
+#ifdef XK_dead_circumflex
+    xcbdrv_oddmap[XK_dead_circumflex & 0xFF] = OIK_CARET;
+#endif
+#ifdef XK_ISO_Level3_Shift
+    xcbdrv_oddmap[XK_ISO_Level3_Shift & 0xFF] = OIK_ALTGR;
+#endif
+
+    // Misc keymap (highbyte 0xFF)
+    xcbdrv_miscmap[XK_BackSpace & 0xFF]    = OIK_BACKSPACE;
+    xcbdrv_miscmap[XK_Tab & 0xFF]          = OIK_TAB;
+    xcbdrv_miscmap[XK_Clear & 0xFF]        = OIK_CLEAR;
+    xcbdrv_miscmap[XK_Return & 0xFF]       = OIK_RETURN;
+    xcbdrv_miscmap[XK_Pause & 0xFF]        = OIK_PAUSE;
+    xcbdrv_miscmap[XK_Escape & 0xFF]       = OIK_ESC;
+    xcbdrv_miscmap[XK_Delete & 0xFF]       = OIK_DELETE;
+
+    xcbdrv_miscmap[XK_KP_0 & 0xFF]         = OIK_N_0;
+    xcbdrv_miscmap[XK_KP_1 & 0xFF]         = OIK_N_1;
+    xcbdrv_miscmap[XK_KP_2 & 0xFF]         = OIK_N_2;
+    xcbdrv_miscmap[XK_KP_3 & 0xFF]         = OIK_N_3;
+    xcbdrv_miscmap[XK_KP_4 & 0xFF]         = OIK_N_4;
+    xcbdrv_miscmap[XK_KP_5 & 0xFF]         = OIK_N_5;
+    xcbdrv_miscmap[XK_KP_6 & 0xFF]         = OIK_N_6;
+    xcbdrv_miscmap[XK_KP_7 & 0xFF]         = OIK_N_7;
+    xcbdrv_miscmap[XK_KP_8 & 0xFF]         = OIK_N_8;
+    xcbdrv_miscmap[XK_KP_9 & 0xFF]         = OIK_N_9;
+    xcbdrv_miscmap[XK_KP_Insert & 0xFF]    = OIK_N_0;
+    xcbdrv_miscmap[XK_KP_End & 0xFF]       = OIK_N_1;
+    xcbdrv_miscmap[XK_KP_Down & 0xFF]      = OIK_N_2;
+    xcbdrv_miscmap[XK_KP_Page_Down & 0xFF] = OIK_N_3;
+    xcbdrv_miscmap[XK_KP_Left & 0xFF]      = OIK_N_4;
+    xcbdrv_miscmap[XK_KP_Begin & 0xFF]     = OIK_N_5;
+    xcbdrv_miscmap[XK_KP_Right & 0xFF]     = OIK_N_6;
+    xcbdrv_miscmap[XK_KP_Home & 0xFF]      = OIK_N_7;
+    xcbdrv_miscmap[XK_KP_Up & 0xFF]        = OIK_N_8;
+    xcbdrv_miscmap[XK_KP_Page_Up & 0xFF]   = OIK_N_9;
+    xcbdrv_miscmap[XK_KP_Delete & 0xFF]    = OIK_N_PERIOD;
+    xcbdrv_miscmap[XK_KP_Decimal & 0xFF]   = OIK_N_PERIOD;
+    xcbdrv_miscmap[XK_KP_Divide & 0xFF]    = OIK_N_DIVIDE;
+    xcbdrv_miscmap[XK_KP_Multiply & 0xFF]  = OIK_N_MULTIPLY;
+    xcbdrv_miscmap[XK_KP_Subtract & 0xFF]  = OIK_N_MINUS;
+    xcbdrv_miscmap[XK_KP_Add & 0xFF]       = OIK_N_PLUS;
+    xcbdrv_miscmap[XK_KP_Enter & 0xFF]     = OIK_N_ENTER;
+    xcbdrv_miscmap[XK_KP_Equal & 0xFF]     = OIK_N_EQUALS;
+
+    xcbdrv_miscmap[XK_Up & 0xFF]           = OIK_UP;
+    xcbdrv_miscmap[XK_Down & 0xFF]         = OIK_DOWN;
+    xcbdrv_miscmap[XK_Right & 0xFF]        = OIK_RIGHT;
+    xcbdrv_miscmap[XK_Left & 0xFF]         = OIK_LEFT;
+    xcbdrv_miscmap[XK_Insert & 0xFF]       = OIK_INSERT;
+    xcbdrv_miscmap[XK_Home & 0xFF]         = OIK_HOME;
+    xcbdrv_miscmap[XK_End & 0xFF]          = OIK_END;
+    xcbdrv_miscmap[XK_Page_Up & 0xFF]      = OIK_PAGEUP;
+    xcbdrv_miscmap[XK_Page_Down & 0xFF]    = OIK_PAGEDOWN;
+
+    xcbdrv_miscmap[XK_F1 & 0xFF]           = OIK_F1;
+    xcbdrv_miscmap[XK_F2 & 0xFF]           = OIK_F2;
+    xcbdrv_miscmap[XK_F3 & 0xFF]           = OIK_F3;
+    xcbdrv_miscmap[XK_F4 & 0xFF]           = OIK_F4;
+    xcbdrv_miscmap[XK_F5 & 0xFF]           = OIK_F5;
+    xcbdrv_miscmap[XK_F6 & 0xFF]           = OIK_F6;
+    xcbdrv_miscmap[XK_F7 & 0xFF]           = OIK_F7;
+    xcbdrv_miscmap[XK_F8 & 0xFF]           = OIK_F8;
+    xcbdrv_miscmap[XK_F9 & 0xFF]           = OIK_F9;
+    xcbdrv_miscmap[XK_F10 & 0xFF]          = OIK_F10;
+    xcbdrv_miscmap[XK_F11 & 0xFF]          = OIK_F11;
+    xcbdrv_miscmap[XK_F12 & 0xFF]          = OIK_F12;
+    xcbdrv_miscmap[XK_F13 & 0xFF]          = OIK_F13;
+    xcbdrv_miscmap[XK_F14 & 0xFF]          = OIK_F14;
+    xcbdrv_miscmap[XK_F15 & 0xFF]          = OIK_F15;
+
+    xcbdrv_miscmap[XK_Num_Lock & 0xFF]     = OIK_NUMLOCK;
+    xcbdrv_miscmap[XK_Caps_Lock & 0xFF]    = OIK_CAPSLOCK;
+    xcbdrv_miscmap[XK_Scroll_Lock & 0xFF]  = OIK_SCROLLOCK;
+    xcbdrv_miscmap[XK_Shift_R & 0xFF]      = OIK_RSHIFT;
+    xcbdrv_miscmap[XK_Shift_L & 0xFF]      = OIK_LSHIFT;
+    xcbdrv_miscmap[XK_Control_R & 0xFF]    = OIK_RCTRL;
+    xcbdrv_miscmap[XK_Control_L & 0xFF]    = OIK_LCTRL;
+    xcbdrv_miscmap[XK_Alt_R & 0xFF]        = OIK_RALT;
+    xcbdrv_miscmap[XK_Alt_L & 0xFF]        = OIK_LALT;
+    xcbdrv_miscmap[XK_Meta_R & 0xFF]       = OIK_RMETA;
+    xcbdrv_miscmap[XK_Meta_L & 0xFF]       = OIK_LMETA;
+    xcbdrv_miscmap[XK_Super_L & 0xFF]      = OIK_LWINDOWS;
+    xcbdrv_miscmap[XK_Super_R & 0xFF]      = OIK_RWINDOWS;
+    xcbdrv_miscmap[XK_Mode_switch & 0xFF]  = OIK_ALTGR;
+    xcbdrv_miscmap[XK_Multi_key & 0xFF]    = OIK_COMPOSE;
+
+    xcbdrv_miscmap[XK_Help & 0xFF]         = OIK_HELP;
+    xcbdrv_miscmap[XK_Print & 0xFF]        = OIK_PRINT;
+    xcbdrv_miscmap[XK_Sys_Req & 0xFF]      = OIK_SYSREQ;
+    xcbdrv_miscmap[XK_Break & 0xFF]        = OIK_BREAK;
+    xcbdrv_miscmap[XK_Menu & 0xFF]         = OIK_MENU;
+    xcbdrv_miscmap[XK_Hyper_R & 0xFF]      = OIK_MENU;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Translate X keysym to OpenInput key
+ *
+ * @param xsym unshifted X keysym
+ * @param kc X keycode
+ * @returns OpenInput symbolic key
+ *
+ * Same translation as the X11 driver. It is only used when
+ * the keycode table is built, see xcbdrv_keymap.
+ */
+oi_key xcbdrv_translate(xcb_keysym_t xsym, xcb_keycode_t kc) {
+    oi_key sym;
+
+    sym = OIK_UNKNOWN;
+
+    // Handle special scancodes
+    if(!xsym) {
+        switch(kc) {
+        case 115:
+            return OIK_LWINDOWS;
+
+        case 116:
+            return OIK_RWINDOWS;
+
+        case 117:
+            return OIK_MENU;
+        }
+        return OIK_UNKNOWN;
+    }
+
+    // Keymap information is in the high byte
+    switch(xsym >> 8) {
+
+    case 0x00: // Latin 1
+    case 0x01: // Latin 2
+    case 0x02: // Latin 3
+    case 0x03: // Latin 4
+    case 0x04: // Katakana
+    case 0x05: // Arabic
+    case 0x06: // Cyrillic
+    case 0x07: // Greek
+    case 0x08: // Technical
+    case 0x0A: // Publishing
+    case 0x0C: // Hebrew
+    case 0x0D: // Thai
+        // Normal ASCII keymap
+        sym = (oi_key)(xsym & 0xFF);
+
+        // Fix lowercase
+        if((sym >= 'A') && (sym <= 'Z')) {
+            sym += 'a'-'A';
+        }
+        break;
+
+    case 0xFE: // Odd
+        sym = xcbdrv_oddmap[xsym & 0xFF];
+        break;
+
+    case 0xFF: // Misc
+        sym = xcbdrv_miscmap[xsym & 0xFF];
+        break;
+
+    default: // Unhandled
+        debug("xcbdrv_translate: unhandled map 0x%04x", (unsigned int)xsym);
+        break;
+    }
+
+    return sym;
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Build the keycode table
+ *
+ * @param dev pointer to device interface
+ * @param map keyboard mapping reply
+ *
+ * The unshifted keysym of each keycode is translated once per
+ * keyboard mapping, so translating a key event is a single
+ * table lookup.
+ */
+void xcbdrv_keymap(oi_device *dev, xcb_get_keyboard_mapping_reply_t *map) {
+    xcbdrv_private *priv;
+    xcb_keysym_t *syms;
+    unsigned int first;
+    unsigned int len;
+    unsigned int kc;
+
+    priv = (xcbdrv_private*)dev->private;
+    syms = xcb_get_keyboard_mapping_keysyms(map);
+    len = xcb_get_keyboard_mapping_keysyms_length(map);
+    first = xcb_get_setup(priv->conn)->min_keycode;
+
+    xcbdrv_initkeymap();
+    memset(priv->keysyms, 0, sizeof(priv->keysyms));
+    for(kc=0; kc<TABLESIZE(priv->keymap); kc++) {
+        if((kc >= first) && map->keysyms_per_keycode &&
+           ((kc - first) * map->keysyms_per_keycode < len)) {
+            priv->keysyms[kc] = syms[(kc - first) * map->keysyms_per_keycode];
+        }
+        priv->keymap[kc] = xcbdrv_translate(priv->keysyms[kc], kc);
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Decode the variable modifier masks
+ *
+ * @param dev pointer to device interface
+ * @param mods modifier mapping reply
+ *
+ * Find out which modifier bits hold num-lock and alt-gr.
+ * The keyboard mapping must be known.
+ */
+void xcbdrv_modmasks(oi_device *dev, xcb_get_modifier_mapping_reply_t *mods) {
+    xcbdrv_private *priv;
+    xcb_keycode_t *codes;
+    unsigned int n;
+    int i;
+    int j;
+
+    priv = (xcbdrv_private*)dev->private;
+    codes = xcb_get_modifier_mapping_keycodes(mods);
+    n = mods->keycodes_per_modifier;
+
+    priv->mask_num = 0;
+    priv->mask_altgr = 0;
+    for(i = 3; i < 8; i++) {
+        for(j = 0; j < n; j++) {
+            switch(priv->keysyms[codes[i * n + j]]) {
+            case XK_Num_Lock:
+                priv->mask_num = 1 << i;
+                break;
+
+            case XK_Mode_switch:
+                priv->mask_altgr = 1 << i;
+                break;
+            }
+        }
+    }
+}
+
+/* ******************************************************************** */
+
+/**
+ * @ingroup DXCB
+ * @brief Perform a full keyboard state update
+ *
+ * @param dev pointer to device interface
+ * @param keyvec X keyboard vector
+ * @param mask X modifier mask
+ *
+ * When OpenInput starts, and when the hook-window receives
+ * focus, the keyboard state is unknown since other applications
+ * may have altered things, so we sync with the X server.
+ */
+void xcbdrv_keystate(oi_device *dev, unsigned char *keyvec, unsigned int mask) {
+    xcbdrv_private *priv;
+    char newstate[OIK_LAST];
+    char *curstate;
+    unsigned int mod;
+    int i;
+    int j;
+
+    debug("xcbdrv_keystate");
+    priv = (xcbdrv_private*)dev->private;
+
+    // Remember raw key state for repeat detection
+    memcpy(priv->keydown, keyvec, sizeof(priv->keydown));
+
+    // Locking modifiers
+    mod = OIM_NONE;
+    if(mask & XCB_MOD_MASK_LOCK) {
+        mod |= OIM_CAPSLOCK;
+    }
+    if(mask & priv->mask_altgr) {
+        mod |= OIM_ALTGR;
+    }
+    if(mask & priv->mask_num) {
+        mod |= OIM_NUMLOCK;
+    }
+
+    // Pressed keys
+    memset(newstate, 0, sizeof(newstate));
+    for(i=0; i<32; i++) {
+        for(j=0; keyvec[i] && (j<8); j++) {
+            if(keyvec[i] & (1<<j)) {
+                newstate[priv->keymap[i << 3 | j]] = TRUE;
+            }
+        }
+    }
+
+    // Set state and fetch modifiers
+    curstate = oi_key_keystate(dev->index, NULL);
+    for(i=OIK_FIRST+1; i<OIK_LAST; i++) {
+        curstate[i] = newstate[i];
+        if(!newstate[i]) {
+            continue;
+        }
+
+        switch(i) {
+        case OIK_LSHIFT:
+            mod |= OIM_LSHIFT;
+            break;
+
+        case OIK_RSHIFT:
+            mod |= OIM_RSHIFT;
+            break;
+
+        case OIK_LCTRL:
+            mod |= OIM_LCTRL;
+            break;
+
+        case OIK_RCTRL:
+            mod |= OIM_RCTRL;
+            break;
+
+        case OIK_LALT:
+            mod |= OIM_LALT;
+            break;
+
+        case OIK_RALT:
+            mod |= OIM_RALT;
+            break;
+
+        case OIK_LMETA:
+            mod |= OIM_LMETA;
+            break;
+
+        case OIK_RMETA:
+            mod |= OIM_RMETA;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // Correct for locking modifiers
+    curstate[OIK_CAPSLOCK] = (mod & OIM_CAPSLOCK) ? TRUE : FALSE;
+    curstate[OIK_NUMLOCK] = (mod & OIM_NUMLOCK) ? TRUE : FALSE;
+
+    keyboard_setmodifier(dev->index, mod);
+}
+
+/* ******************************************************************** */
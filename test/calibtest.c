@@ -0,0 +1,367 @@
+/*
+ * calibtest.c : Test of joystick calibration
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+/* ******************************************************************** */
+
+/* The calibration kernel is run on random raw values with the SSE2
+ * and the scalar code, which must agree exactly, also when rounding
+ * halves. A dummy joystick is then calibrated through the public
+ * interface to check deadzone, saturation and smoothing, and the
+ * profile is saved, loaded back, and loaded from broken files which
+ * must leave the installed profile alone.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "openinput.h"
+#include "internal.h"
+#include "private.h"
+#include "testlib.h"
+
+// Parameters
+#define NUM_AXES 4
+#define ROUNDS 20000
+#define PROFILE "calibtest.txt"
+
+// Globals
+static unsigned char joy;
+
+// Bootstrap for the dummy joystick
+oi_bootstrap joy_bootstrap = {
+    "calibjoy",
+    "Calibration test joystick",
+    OI_PRO_JOYSTICK,
+    NULL,
+    dummy_joystick
+};
+
+/* ******************************************************************** */
+
+// Run kernel on all axes with either code path, returns changed mask
+unsigned int kernel(oi_privjoy *priv, oi_joyconfig *conf, char simd) {
+    unsigned int changed;
+
+    joystick_simd(simd);
+    priv->calpend = (1u << NUM_AXES) - 1;
+    changed = joystick_calibrate(priv, conf);
+    joystick_simd(TRUE);
+    return changed;
+}
+
+/* ******************************************************************** */
+
+// Profile with center offset, deadzones, a paired stick and smoothing
+void profile(oi_joycalib *c) {
+    int j;
+
+    memset(c, 0, sizeof(oi_joycalib));
+    for(j=0; j<OI_JOY_NUM_AXES; j++) {
+        c->min[j] = OI_JOY_AXIS_MIN;
+        c->max[j] = OI_JOY_AXIS_MAX;
+    }
+    c->min[0] = -900;
+    c->center[0] = 37;
+    c->max[0] = 1100;
+    c->deadzone[0] = 1500;
+    c->radial[0] = 4000;
+    c->min[1] = -1000;
+    c->max[1] = 1000;
+    c->radial[1] = 4000;
+    c->deadzone[2] = 333;
+    c->smooth[2] = 200;
+    c->min[3] = 10;
+    c->center[3] = 500;
+    c->max[3] = 65000;
+    c->smooth[3] = 17;
+}
+
+/* ******************************************************************** */
+
+// Compare the two kernels on random input
+void compare() {
+    oi_privjoy a;
+    oi_privjoy b;
+    oi_joyconfig conf;
+    unsigned int ca;
+    unsigned int cb;
+    int diff;
+    int same;
+    int r;
+    int j;
+
+    dummy_joyconfig(&conf, "calibjoy", 0, NUM_AXES);
+    conf.pair[0] = 1;
+    conf.pair[1] = 0;
+    profile(&(conf.calib));
+    conf.calibrated = TRUE;
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+
+    same = TRUE;
+    srand(1);
+    for(r=0; r<ROUNDS; r++) {
+        for(j=0; j<NUM_AXES; j++) {
+            a.rawaxes[j] = (rand() % 70000) - 35000;
+            b.rawaxes[j] = a.rawaxes[j];
+        }
+        ca = kernel(&a, &conf, TRUE);
+        cb = kernel(&b, &conf, FALSE);
+        diff = (ca != cb) || (a.calpend != b.calpend) ||
+            memcmp(a.absaxes, b.absaxes, sizeof(a.absaxes)) ||
+            memcmp(a.relaxes, b.relaxes, sizeof(a.relaxes)) ||
+            memcmp(a.insaxes, b.insaxes, sizeof(a.insaxes));
+
+        // The filter state may differ in the sign of zero only
+        for(j=0; j<NUM_AXES; j++) {
+            diff |= (a.kernel.filter[j] != b.kernel.filter[j]);
+        }
+        if(diff) {
+            printf("round %i: %i %i %i %i against %i %i %i %i\n", r,
+                   a.absaxes[0], a.absaxes[1], a.absaxes[2], a.absaxes[3],
+                   b.absaxes[0], b.absaxes[1], b.absaxes[2], b.absaxes[3]);
+            same = FALSE;
+            break;
+        }
+    }
+    check(same, "SSE2 and scalar kernels agree");
+}
+
+/* ******************************************************************** */
+
+// Halves are rounded away from zero by both kernels
+void halves() {
+    oi_privjoy p;
+    oi_joyconfig conf;
+    int simd;
+
+    // Scale by exactly one half on both sides
+    dummy_joyconfig(&conf, "calibjoy", 0, NUM_AXES);
+    memset(&(conf.calib), 0, sizeof(oi_joycalib));
+    conf.calib.min[0] = -65536;
+    conf.calib.max[0] = 65534;
+    conf.calib.min[1] = -65536;
+    conf.calib.max[1] = 65534;
+    conf.calib.min[2] = -65536;
+    conf.calib.max[2] = 65534;
+    conf.calib.min[3] = -65536;
+    conf.calib.max[3] = 65534;
+    conf.calibrated = TRUE;
+
+    for(simd=TRUE; simd>=FALSE; simd--) {
+        memset(&p, 0, sizeof(p));
+        p.rawaxes[0] = 1;
+        p.rawaxes[1] = 5;
+        p.rawaxes[2] = -1;
+        p.rawaxes[3] = -5;
+        kernel(&p, &conf, (char)simd);
+        printf("%s: 0.5 %i, 2.5 %i, -0.5 %i, -2.5 %i\n", simd ? "sse2" : "scalar",
+               p.absaxes[0], p.absaxes[1], p.absaxes[2], p.absaxes[3]);
+        check((p.absaxes[0] == 1) && (p.absaxes[1] == 3) &&
+              (p.absaxes[2] == -1) && (p.absaxes[3] == -3),
+              simd ? "sse2 rounds halves away from zero" : "scalar rounds halves away from zero");
+    }
+}
+
+/* ******************************************************************** */
+
+// Set raw axis value, pump and return the absolute value
+int move(unsigned char axis, int raw) {
+    int v;
+
+    joystick_axis(joy, axis, raw, FALSE, TRUE);
+    joystick_pump();
+    oi_joy_absolute(joy, axis, &v, NULL);
+    return v;
+}
+
+/* ******************************************************************** */
+
+// Poll everything, return number of axis events
+int axis_events() {
+    oi_event ev;
+    int n;
+
+    n = 0;
+    while(oi_events_poll(&ev)) {
+        if(ev.type == OI_JOYAXIS) {
+            n++;
+        }
+    }
+    return n;
+}
+
+/* ******************************************************************** */
+
+// Deadzone, saturation and smoothing through the public interface
+void manager() {
+    oi_joycalib c;
+    oi_event ev;
+    int last;
+    int v;
+    int i;
+
+    check(oi_joy_getcalib(joy, &c) == OI_ERR_OK, "get identity profile");
+    check((c.min[0] == OI_JOY_AXIS_MIN) && (c.max[0] == OI_JOY_AXIS_MAX) &&
+          !c.deadzone[0] && !c.smooth[0], "identity profile");
+    check(oi_joy_setcalib(joy + 1, &c) == OI_ERR_NO_DEVICE, "no such joystick");
+
+    profile(&c);
+    c.min[0] = -1000;
+    c.center[0] = 0;
+    c.max[0] = 1000;
+    c.deadzone[0] = 100;
+    c.radial[0] = 0;
+    c.radial[1] = 0;
+    c.smooth[1] = 128;
+    check(oi_joy_setcalib(joy, &c) == OI_ERR_OK, "set profile");
+
+    // Deadzone and rescaling outside it
+    v = move(0, 3);
+    check(v == 0, "inside deadzone");
+    v = move(0, 550);
+    printf("raw 550: %i\n", v);
+    check((v >= 17976) && (v <= 17977), "scaled outside deadzone");
+    check(move(0, 1000) == OI_JOY_AXIS_MAX, "end of range");
+    check(move(0, 5000) == OI_JOY_AXIS_MAX, "saturated above");
+    check(move(0, -5000) == OI_JOY_AXIS_MIN, "saturated below");
+
+    // Posted only when asked to, and only when the output changes
+    axis_events();
+    joystick_axis(joy, 0, 550, FALSE, FALSE);
+    joystick_pump();
+    oi_joy_absolute(joy, 0, &v, NULL);
+    check((v >= 17976) && (axis_events() == 0), "no event unless posted");
+    check((move(0, 3) == 0) && (axis_events() == 1), "event when output changes");
+    check((move(0, -3) == 0) && (axis_events() == 0), "no event inside deadzone");
+
+    // Smoothing approaches the target over several pumps
+    last = move(1, 0);
+    v = move(1, 1000);
+    printf("smoothed step: %i\n", v);
+    check((v > 0) && (v < OI_JOY_AXIS_MAX), "step smoothed");
+    for(i=0; (i<64) && (v < OI_JOY_AXIS_MAX) && (v > last); i++) {
+        last = v;
+        joystick_pump();
+        oi_joy_absolute(joy, 1, &v, NULL);
+    }
+    printf("target after %i more pumps\n", i);
+    check(v == OI_JOY_AXIS_MAX, "smoothing reaches target");
+
+    while(oi_events_poll(&ev));
+}
+
+/* ******************************************************************** */
+
+// Write text file
+void write_file(char *text) {
+    FILE *f;
+
+    f = fopen(PROFILE, "w");
+    if(f) {
+        fputs(text, f);
+        fclose(f);
+    }
+}
+
+/* ******************************************************************** */
+
+// Profile files
+void files() {
+    oi_joycalib c;
+    oi_joycalib d;
+    oi_joycalib id;
+    int j;
+
+    profile(&c);
+    check(oi_joy_setcalib(joy, &c) == OI_ERR_OK, "set profile");
+    check(oi_joy_saveprofile(joy, PROFILE) == OI_ERR_OK, "save profile");
+
+    // Round trip through the identity profile
+    oi_joy_setcalib(joy, NULL);
+    oi_joy_getcalib(joy, &id);
+    check(oi_joy_loadprofile(joy, PROFILE) == OI_ERR_OK, "load profile");
+    oi_joy_getcalib(joy, &d);
+    for(j=NUM_AXES; j<OI_JOY_NUM_AXES; j++) {
+        c.min[j] = id.min[j];
+        c.max[j] = id.max[j];
+    }
+    check(!memcmp(&c, &d, sizeof(c)), "profile read back");
+
+    // Broken files keep the installed profile
+    write_file("axis 0 min 1 center 2 max 3 deadzone 4 radial 5 smooth 6\n"
+               "axis 1 min 1 center 2\n");
+    check(oi_joy_loadprofile(joy, PROFILE) == OI_ERR_PARAM, "bad line refused");
+    oi_joy_getcalib(joy, &d);
+    check(!memcmp(&c, &d, sizeof(c)), "bad line keeps profile");
+
+    write_file("axis 99 min 1 center 2 max 3 deadzone 4 radial 5 smooth 6\n");
+    check(oi_joy_loadprofile(joy, PROFILE) == OI_ERR_PARAM, "bad axis refused");
+    oi_joy_getcalib(joy, &d);
+    check(!memcmp(&c, &d, sizeof(c)), "bad axis keeps profile");
+
+    unlink(PROFILE);
+    check(oi_joy_loadprofile(joy, PROFILE) == OI_ERR_PARAM, "missing file refused");
+    oi_joy_getcalib(joy, &d);
+    check(!memcmp(&c, &d, sizeof(c)), "missing file keeps profile");
+
+    // Comments and blank lines, missing axes get the identity
+    write_file("# comment\n\naxis 2 min -5 center 0 max 5 deadzone 1 radial 0 smooth 0\n");
+    check(oi_joy_loadprofile(joy, PROFILE) == OI_ERR_OK, "load partial profile");
+    oi_joy_getcalib(joy, &d);
+    check((d.max[2] == 5) && (d.min[0] == OI_JOY_AXIS_MIN) && !d.smooth[3],
+          "partial profile");
+    unlink(PROFILE);
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    int i;
+
+    printf("*** calibtest start\n");
+    printf("sse2 kernel: %s\n", joystick_simd(TRUE) ? "yes" : "no");
+
+    compare();
+    halves();
+
+    setenv("OI_DRIVERS", "none", 1);
+    i = oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", i);
+
+    dummy_joyconfig(&dummy_joy, "calibjoy", 2, NUM_AXES);
+    check(device_register(&joy_bootstrap, NULL, 0) == OI_ERR_OK, "register joystick");
+    joy = device_live(0);
+
+    manager();
+    files();
+
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+
+    printf("*** calibtest ended, %i failed\n", failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * devicetest.c : Test of the device table
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+/* Dummy keyboard devices are registered and removed directly through
+ * the internal device interface, and the slot reuse, handles, live
+ * device iteration and default device lookup are checked.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "openinput.h"
+#include "internal.h"
+#include "private.h"
+#include "testlib.h"
+
+// Globals
+static int pumped[OI_MAX_DEVICES+1];
+
+// Bootstrap for the dummy device
+oi_bootstrap dummy_bootstrap = {
+    "dummy",
+    "Device table test device",
+    OI_PRO_KEYBOARD,
+    NULL,
+    dummy_device
+};
+
+/* ******************************************************************** */
+
+// Count pumps per device
+void count_pump(oi_device *dev) {
+    pumped[dev->index]++;
+}
+
+/* ******************************************************************** */
+
+// Register a dummy device and return its index
+unsigned char add() {
+    unsigned int i;
+
+    if(device_register(&dummy_bootstrap, NULL, 0) != OI_ERR_OK) {
+        return 0;
+    }
+
+    // Newest device is last
+    for(i=0; device_live(i+1); i++);
+    return device_live(i);
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    oi_actionmap map[1];
+    oi_event ev;
+    unsigned int handle;
+    unsigned char a;
+    unsigned char b;
+    unsigned char c;
+    unsigned char d;
+    unsigned int i;
+    char *keys;
+    char *state;
+    int num;
+
+    printf("*** devicetest start\n");
+
+    i = oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", i);
+    dummy_pump = count_pump;
+
+    // Three devices, live in registration order
+    a = add();
+    b = add();
+    c = add();
+    check(a && b && c && (a != b) && (b != c), "register devices");
+    for(i=0; device_live(i) && (device_live(i) != a); i++);
+    check((device_live(i+1) == b) && (device_live(i+2) == c), "live order");
+
+    // Removed device is skipped by the pump, and its handle goes stale
+    handle = device_handle(b);
+    check(device_lookup(handle) == device_get(b), "handle lookup");
+    device_remove(b);
+    check(device_lookup(handle) == NULL, "handle of removed device");
+    memset(pumped, 0, sizeof(pumped));
+    oi_events_pump();
+    check(pumped[a] && pumped[c] && !pumped[b], "pump live devices");
+
+    // Next device takes the free slot, the old handle stays stale
+    d = add();
+    check(d == b, "slot reused");
+    check(device_lookup(handle) == NULL, "stale handle after reuse");
+    check(device_lookup(device_handle(d)) == device_get(d), "handle of new device");
+
+    // Oldest free slot is reused first
+    device_remove(c);
+    device_remove(a);
+    check((add() == c) && (add() == a), "free slots reused in order");
+
+    // Actions bound to a device do not pass to the next one in its slot
+    map[0].actionid = 1;
+    map[0].device = a;
+    map[0].name = oi_key_getname(OIK_A);
+    check(oi_action_install(map, 1) == OI_ERR_OK, "install device action");
+    memset(&ev, 0, sizeof(ev));
+    ev.type = OI_KEYDOWN;
+    ev.key.device = a;
+    ev.key.keysym.sym = OIK_A;
+    oi_events_add(&ev, 1);
+    state = oi_action_actionstate(&num);
+    check(state && state[1], "action of bound device");
+    ev.type = OI_KEYUP;
+    oi_events_add(&ev, 1);
+    device_remove(a);
+    check(add() == a, "slot of bound device reused");
+    ev.type = OI_KEYDOWN;
+    oi_events_add(&ev, 1);
+    state = oi_action_actionstate(&num);
+    check(state && !state[1], "no action for later device");
+    while(oi_events_poll(&ev));
+
+    // Default keyboard
+    keyboard_setmodifier(device_first(OI_PRO_KEYBOARD), OIM_LSHIFT);
+    check(oi_key_modstate(0) == OIM_LSHIFT, "default keyboard");
+
+    // Manager data starts on a cache line
+    check(((size_t)device_priv(device_live(0), OI_PRO_KEYBOARD) -
+           (device_live(0)-1) * sizeof(oi_privkey)) % OI_ARENA_ALIGN == 0, "arena alignment");
+
+    // Fill the table, manager data must not move as it grows
+    keys = oi_key_keystate(0, &num);
+    keys[OIK_A] = 1;
+    for(num=0; add(); num++);
+    check(device_live(OI_MAX_DEVICES-1) && !device_live(OI_MAX_DEVICES), "table full");
+    check((oi_key_keystate(0, &num) == keys) && keys[OIK_A], "keystate pointer kept");
+    check(device_register(&dummy_bootstrap, NULL, 0) == OI_ERR_INDEX, "full table refused");
+
+    // Room again after removal
+    device_remove(a);
+    check(add() == a, "register after full");
+
+    // Done
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+    check(device_live(0) == 0, "all devices closed");
+    printf("*** devicetest ended, %i failed\n", failed);
+
+    return failed != 0;
+}
+
+/* ******************************************************************** */
@@ -0,0 +1,304 @@
+/*
+ * evdevtest.c : Test of the GNU/Linux event device driver
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+/* The evdev driver is pointed (through OI_EVDEV) at a recorded file
+ * and at one end of a socketpair. The file checks frame handling,
+ * timestamps and high resolution wheels, the socket checks that
+ * nothing is injected before the frame is complete. Then a second
+ * file, with a plain wheel only, must give a click per detent.
+ * Last, a node is hotplugged and removed, and the removal event
+ * must still carry the name and description.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <linux/input.h>
+#include "openinput.h"
+#include "testlib.h"
+
+#ifndef REL_WHEEL_HI_RES
+#define REL_WHEEL_HI_RES 0x0b
+#endif
+
+/* ******************************************************************** */
+
+// Write single kernel event, time in microseconds
+void put(int fd, int usec, int type, int code, int value) {
+    struct input_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.time.tv_sec = usec / 1000000;
+    ev.time.tv_usec = usec % 1000000;
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    if(write(fd, &ev, sizeof(ev)) != sizeof(ev)) {
+        printf("write failed\n");
+        exit(1);
+    }
+}
+
+/* ******************************************************************** */
+
+// Poll events from device for about 20 ms, returns number of events
+int collect(unsigned char index, oi_event *evs, oi_time *stamps, int max) {
+    struct timespec ts;
+    oi_event ev;
+    int num;
+    int i;
+
+    ts.tv_sec = 0;
+    ts.tv_nsec = 2000000;
+    num = 0;
+    for(i=0; i<10; i++) {
+        while(oi_events_poll(&ev)) {
+            if((ev.type == OI_DISCOVERY) || (ev.key.device != index) ||
+               (num == max)) {
+                continue;
+            }
+            stamps[num] = oi_events_timestamp();
+            evs[num++] = ev;
+        }
+        nanosleep(&ts, NULL);
+    }
+    return num;
+}
+
+/* ******************************************************************** */
+
+// Poll for about 20 ms and return first event of given type
+int wait_for(unsigned char type, oi_event *ev) {
+    struct timespec ts;
+    int i;
+
+    ts.tv_sec = 0;
+    ts.tv_nsec = 2000000;
+    for(i=0; i<10; i++) {
+        while(oi_events_poll(ev)) {
+            if(ev->type == type) {
+                return 1;
+            }
+        }
+        nanosleep(&ts, NULL);
+    }
+    return 0;
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    char path[] = "/tmp/evdevtestXXXXXX";
+    char wpath[] = "/tmp/evdevwheelXXXXXX";
+    char dir[] = "/tmp/evdevdirXXXXXX";
+    char node[64];
+    char env[128];
+    unsigned char file;
+    unsigned char wheel;
+    unsigned char sock;
+    oi_event evs[16];
+    oi_time stamps[16];
+    struct input_event ev;
+    int sv[2];
+    int num;
+    int fd;
+    int i;
+    int v;
+    char *name;
+    char *desc;
+
+    printf("*** evdevtest start\n");
+
+    // Recorded file
+    fd = mkstemp(path);
+    if(fd == -1) {
+        printf("mkstemp failed\n");
+        return 1;
+    }
+    put(fd, 1000001, EV_KEY, KEY_A, 1);
+    put(fd, 1000001, EV_SYN, SYN_REPORT, 0);
+    put(fd, 1002000, EV_REL, REL_X, 5);
+    put(fd, 1002000, EV_REL, REL_Y, -3);
+    put(fd, 1002000, EV_REL, REL_X, 2);
+    put(fd, 1002000, EV_SYN, SYN_REPORT, 0);
+    put(fd, 1003000, EV_REL, REL_WHEEL, 1);
+    put(fd, 1003000, EV_REL, REL_WHEEL_HI_RES, 120);
+    put(fd, 1003000, EV_SYN, SYN_REPORT, 0);
+    put(fd, 1004000, EV_REL, REL_WHEEL_HI_RES, 60);
+    put(fd, 1004000, EV_SYN, SYN_REPORT, 0);
+    put(fd, 1005000, EV_REL, REL_WHEEL, 1);
+    put(fd, 1005000, EV_REL, REL_WHEEL_HI_RES, 60);
+    put(fd, 1005000, EV_SYN, SYN_REPORT, 0);
+    put(fd, 1006000, EV_KEY, KEY_A, 2);
+    put(fd, 1006000, EV_KEY, KEY_A, 0);
+    put(fd, 1006000, EV_SYN, SYN_REPORT, 0);
+    put(fd, 1007000, EV_REL, REL_X, 100);
+    close(fd);
+
+    // Recorded file with a low resolution wheel only
+    fd = mkstemp(wpath);
+    if(fd == -1) {
+        printf("mkstemp failed\n");
+        return 1;
+    }
+    put(fd, 1000000, EV_REL, REL_WHEEL, 1);
+    put(fd, 1000000, EV_SYN, SYN_REPORT, 0);
+    put(fd, 1001000, EV_REL, REL_WHEEL, 1);
+    put(fd, 1001000, EV_SYN, SYN_REPORT, 0);
+    close(fd);
+
+    // Live stream
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        printf("socketpair failed\n");
+        return 1;
+    }
+
+    // Point driver at them and start
+    sprintf(env, "%s:fd=%i", path, sv[0]);
+    setenv("OI_EVDEV", env, 1);
+    i = oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW);
+    printf("oi_init: code %i\n", i);
+    unlink(path);
+
+    // Find the devices
+    file = 0;
+    sock = 0;
+    for(i=1; oi_device_info(i, &name, &desc, NULL) == OI_ERR_OK; i++) {
+        if(strcmp(name, "evdev") == 0) {
+            printf("device %i: %s\n", i, desc);
+            if(!file) {
+                file = i;
+            }
+            else if(!sock) {
+                sock = i;
+            }
+        }
+    }
+    check(file && sock, "two evdev devices");
+    if(!file || !sock) {
+        return 1;
+    }
+
+    // Recorded file, whole frames only
+    num = collect(file, evs, stamps, 16);
+    printf("file: %i events\n", num);
+    check(num == 7, "event count");
+    if(num == 7) {
+        check((evs[0].type == OI_KEYDOWN) && (evs[0].key.keysym.sym == OIK_A), "key down");
+        check(stamps[0] == 1000001000ULL, "key down timestamp");
+        check((evs[1].type == OI_MOUSEMOVE) && (evs[1].move.relx == 7) &&
+              (evs[1].move.rely == -3), "motion folded per frame");
+        check(stamps[1] == 1002000000ULL, "motion timestamp");
+        check((evs[2].type == OI_MOUSEBUTTONDOWN) && (evs[2].button.button == OIP_WHEEL_UP) &&
+              (evs[3].type == OI_MOUSEBUTTONUP), "wheel click");
+        check(stamps[2] == 1003000000ULL, "wheel timestamp");
+        check((evs[4].type == OI_MOUSEBUTTONDOWN) && (stamps[4] == 1005000000ULL),
+              "wheel click after two half detents");
+        check((evs[6].type == OI_KEYUP) && (stamps[6] == 1006000000ULL), "key up, no repeat");
+    }
+    oi_mouse_wheel(file, &v, NULL);
+    check(v == 2*OI_WHEEL_DETENT, "high resolution wheel motion");
+
+    // Socket, split record and incomplete frame
+    memset(&ev, 0, sizeof(ev));
+    ev.time.tv_sec = 2;
+    ev.type = EV_KEY;
+    ev.code = BTN_JOYSTICK;
+    ev.value = 1;
+    write(sv[1], &ev, 10);
+    num = collect(sock, evs, stamps, 16);
+    check(num == 0, "nothing from half record");
+    write(sv[1], (char*)&ev + 10, sizeof(ev) - 10);
+    put(sv[1], 2000000, EV_ABS, ABS_X, 1000);
+    num = collect(sock, evs, stamps, 16);
+    check(num == 0, "nothing from incomplete frame");
+    put(sv[1], 2000000, EV_SYN, SYN_REPORT, 0);
+    num = collect(sock, evs, stamps, 16);
+    check((num == 2) && (evs[0].type == OI_JOYBUTTONDOWN) &&
+          (stamps[0] == 2000000000ULL), "joystick button");
+    check((num == 2) && (evs[1].type == OI_JOYAXIS), "joystick axis");
+    check((num == 2) && (stamps[1] == 2000000000ULL), "joystick axis timestamp");
+    oi_joy_absolute(sock, 0, &v, NULL);
+    check(v == 1000, "joystick axis position");
+
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+
+    // Plain wheel, every detent is a click
+    setenv("OI_EVDEV", wpath, 1);
+    i = oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW);
+    printf("oi_init: code %i\n", i);
+    unlink(wpath);
+    for(wheel=1; (oi_device_info(wheel, &name, NULL, NULL) == OI_ERR_OK) &&
+            strcmp(name, "evdev"); wheel++);
+    num = collect(wheel, evs, stamps, 16);
+    printf("wheel: %i events\n", num);
+    check((num == 4) && (evs[0].type == OI_MOUSEBUTTONDOWN) &&
+          (evs[0].button.button == OIP_WHEEL_UP) && (evs[2].type == OI_MOUSEBUTTONDOWN),
+          "low resolution wheel clicks");
+    oi_mouse_wheel(wheel, &v, NULL);
+    check(v == 2*OI_WHEEL_DETENT, "low resolution wheel motion");
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+
+    // Hotplugged node, the driver frees its strings on removal
+    if(!mkdtemp(dir)) {
+        printf("mkdtemp failed\n");
+        return 1;
+    }
+    unsetenv("OI_EVDEV");
+    setenv("OI_INPUTDIR", dir, 1);
+    setenv("OI_DRIVERS", "evdev", 1);
+    i = oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW);
+    printf("oi_init: code %i\n", i);
+    sprintf(node, "%s/event3", dir);
+    mkfifo(node, 0600);
+    env[0] = '\0';
+    file = 0;
+    if(wait_for(OI_DISCOVERY, &evs[0])) {
+        file = evs[0].discover.device;
+        strncat(env, evs[0].discover.description, sizeof(env) - 1);
+    }
+    check(file && env[0], "hotplugged device");
+    unlink(node);
+    check(wait_for(OI_DEVICELOST, &evs[0]) && (evs[0].discover.device == file) &&
+          (strcmp(evs[0].discover.name, "evdev") == 0) &&
+          (strcmp(evs[0].discover.description, env) == 0), "removed device description");
+    rmdir(dir);
+
+    // Done
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+    printf("*** evdevtest ended, %i failed\n", failed);
+
+    return failed != 0;
+}
+
+/* ******************************************************************** */
@@ -0,0 +1,231 @@
+/*
+ * filtertest.c : Test of event filters
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+/* ******************************************************************** */
+
+/* Without drivers, events are injected with filters installed that
+ * drop, rewrite and observe them. Dropped events must not use queue
+ * space or generate actions, filters must run in order, and a
+ * filter must be able to add events of its own.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "openinput.h"
+#include "internal.h"
+#include "testlib.h"
+
+// Globals
+static char order[16];
+
+/* ******************************************************************** */
+
+// Drop key releases
+int drop_keyup(oi_event *evt, void *data) {
+    return evt->type != OI_KEYUP;
+}
+
+/* ******************************************************************** */
+
+// Drop everything
+int drop_all(oi_event *evt, void *data) {
+    return FALSE;
+}
+
+/* ******************************************************************** */
+
+// Turn caps lock into escape
+int caps_to_esc(oi_event *evt, void *data) {
+    if(((evt->type == OI_KEYDOWN) || (evt->type == OI_KEYUP)) &&
+       (evt->key.keysym.sym == OIK_CAPSLOCK)) {
+        evt->key.keysym.sym = OIK_ESC;
+    }
+    return TRUE;
+}
+
+/* ******************************************************************** */
+
+// Count escape presses and ask to quit, the way a menu would open
+int watch_esc(oi_event *evt, void *data) {
+    oi_event quit;
+
+    if((evt->type == OI_KEYDOWN) && (evt->key.keysym.sym == OIK_ESC)) {
+        (*(int*)data)++;
+        memset(&quit, 0, sizeof(quit));
+        quit.type = OI_QUIT;
+        oi_events_add(&quit, 1);
+    }
+    return TRUE;
+}
+
+/* ******************************************************************** */
+
+// Append the letter given as data to the order string
+int mark(oi_event *evt, void *data) {
+    if(strlen(order) < sizeof(order) - 1) {
+        strncat(order, (char*)data, 1);
+    }
+    return TRUE;
+}
+
+/* ******************************************************************** */
+
+// Poll everything, return number of events and the last one
+int drain(oi_event *last) {
+    oi_event ev;
+    int n;
+
+    n = 0;
+    while(oi_events_poll(&ev)) {
+        *last = ev;
+        n++;
+    }
+    return n;
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    oi_actionmap map[1];
+    oi_event ev[6];
+    oi_event last;
+    oi_stats st;
+    char *state;
+    int escs;
+    int num;
+    int i;
+
+    printf("*** filtertest start\n");
+
+    setenv("OI_DRIVERS", "none", 1);
+    i = oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", i);
+    drain(&last);
+    oi_stats_reset();
+
+    // Bad parameters
+    check(oi_events_addfilter(NULL, NULL) == OI_ERR_PARAM, "no filter function");
+    check(oi_events_delfilter(drop_keyup, NULL) == OI_ERR_PARAM, "remove unknown filter");
+
+    memset(ev, 0, sizeof(ev));
+    for(i=0; i<6; i++) {
+        ev[i].type = (i % 2) ? OI_KEYUP : OI_KEYDOWN;
+        ev[i].key.keysym.sym = OIK_B;
+    }
+
+    // Reinitialization forgets filters
+    oi_events_addfilter(drop_all, NULL);
+    oi_close();
+    oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    drain(&last);
+    oi_events_add(&ev[0], 1);
+    check(drain(&last) == 1, "filters removed by reinit");
+
+    // Dropped events are counted, but never queued
+    oi_stats_reset();
+    check(oi_events_addfilter(drop_keyup, NULL) == OI_ERR_OK, "add drop filter");
+    check(oi_events_add(ev, 6) == 6, "dropped events count as added");
+    num = drain(&last);
+    oi_stats_get(&st);
+    printf("keys: %i polled, %llu enqueued, %llu filtered\n",
+           num, st.enqueued[OI_KEYUP] + st.enqueued[OI_KEYDOWN], st.filtered[OI_KEYUP]);
+    check(num == 3, "key releases dropped");
+    check(last.type == OI_KEYDOWN, "key presses kept");
+    check((st.filtered[OI_KEYUP] == 3) && (st.enqueued[OI_KEYUP] == 0), "dropped events counted");
+    check(oi_events_delfilter(drop_keyup, NULL) == OI_ERR_OK, "remove drop filter");
+
+    // A full queue of dropped events takes no space
+    check(oi_events_addfilter(drop_all, NULL) == OI_ERR_OK, "add drop-all filter");
+    for(i=0; i<OI_MAX_EVENTS * 2; i++) {
+        oi_events_add(&ev[0], 1);
+    }
+    check(drain(&last) == 0, "nothing queued");
+    oi_events_delfilter(drop_all, NULL);
+    oi_stats_get(&st);
+    check(st.dropped[OI_KEYDOWN] == 0, "queue never full");
+
+    // Dropped keys do not fire actions
+    map[0].actionid = 1;
+    map[0].device = 0;
+    map[0].name = oi_key_getname(OIK_A);
+    check(oi_action_install(map, 1) == OI_ERR_OK, "install action map");
+    ev[0].type = OI_KEYDOWN;
+    ev[0].key.keysym.sym = OIK_A;
+    oi_events_addfilter(drop_all, NULL);
+    oi_events_add(&ev[0], 1);
+    state = oi_action_actionstate(&num);
+    check(state && !state[1], "no action for dropped key");
+    oi_events_delfilter(drop_all, NULL);
+    oi_events_add(&ev[0], 1);
+    state = oi_action_actionstate(&num);
+    check(state && state[1], "action for kept key");
+    drain(&last);
+
+    // Rewrite, then observe the rewritten event at once
+    escs = 0;
+    check(oi_events_addfilter(caps_to_esc, NULL) == OI_ERR_OK, "add rewrite filter");
+    check(oi_events_addfilter(watch_esc, &escs) == OI_ERR_OK, "add watch filter");
+    ev[0].type = OI_KEYDOWN;
+    ev[0].key.keysym.sym = OIK_CAPSLOCK;
+    oi_events_add(&ev[0], 1);
+    check(escs == 1, "handler ran before poll");
+    check(ev[0].key.keysym.sym == OIK_CAPSLOCK, "caller's event untouched");
+    check(oi_events_poll(&last) && (last.type == OI_QUIT), "filter added event first");
+    check(oi_events_poll(&last) && (last.key.keysym.sym == OIK_ESC), "key rewritten");
+    drain(&last);
+    oi_events_delfilter(caps_to_esc, NULL);
+    oi_events_delfilter(watch_esc, &escs);
+
+    // Order of installation, same function with other data
+    order[0] = '\0';
+    oi_events_addfilter(mark, "a");
+    oi_events_addfilter(mark, "b");
+    oi_events_addfilter(mark, "c");
+    oi_events_add(&ev[0], 1);
+    printf("order: %s\n", order);
+    check(!strcmp(order, "abc"), "filters run in order");
+    check(oi_events_delfilter(mark, "b") == OI_ERR_OK, "remove middle filter");
+    oi_events_add(&ev[0], 1);
+    check(!strcmp(order, "abcac"), "order kept after removal");
+    oi_events_delfilter(mark, "a");
+    oi_events_delfilter(mark, "c");
+    drain(&last);
+
+    // Table full
+    for(i=0; i<OI_MAX_FILTERS; i++) {
+        oi_events_addfilter(mark, NULL);
+    }
+    check(oi_events_addfilter(mark, NULL) == OI_ERR_INDEX, "filter table full");
+    for(i=0; i<OI_MAX_FILTERS; i++) {
+        oi_events_delfilter(mark, NULL);
+    }
+
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+
+    printf("*** filtertest ended, %i failed\n", failed);
+    return failed ? 1 : 0;
+}
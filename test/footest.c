@@ -19,41 +19,116 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+
 /* ******************************************************************** */
 
+/* The foo driver queues a key press on every pump. The events are
+ * polled as fast as possible, then the driver pretends to be a slow
+ * device with OI_FOO_DELAY, and the percentiles must follow the
+ * delay. Wall clock budgets depend on the machine, so they are only
+ * checked when FOOTEST_BUDGET_US is set, eg. to 2000.
+ */
+
 // Includes
 #include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include "openinput.h"
+#include "testlib.h"
+
+// Parameters
+#define RUN_MS 200
+#define BUDGET_ENV "FOOTEST_BUDGET_US"
+#define DELAY_US "3000"
+#define DELAY_NS 3000000
+
+/* ******************************************************************** */
+
+// Poll events for a while, returns number of events
+int run(int ms) {
+    oi_event ev;
+    int num;
+    int i;
+
+    num = 0;
+    for(i=0; i<ms*10; i++) {
+        while(oi_events_poll(&ev)) {
+            num++;
+        }
+        usleep(100);
+    }
+    return num;
+}
+
+/* ******************************************************************** */
+
+// Print latency of key presses
+void show(oi_latency *lat) {
+    oi_latency_get(OI_KEYDOWN, lat);
+    printf("%llu events, p50 %llu ns, p99 %llu ns, p999 %llu ns, max %llu ns\n",
+           (unsigned long long)lat->count, (unsigned long long)lat->p50,
+           (unsigned long long)lat->p99, (unsigned long long)lat->p999,
+           (unsigned long long)lat->max);
+}
 
 /* ******************************************************************** */
 
 // Main function
 int main(int argc, char *argv[]) {
-  int e;
-  oi_event ev;
-
-  // Startup
-  printf("*** footest start ***\n\n");
-  
-  // Init OI
-  e = oi_init("c:1 s:2 w:3", 0);
-  printf("--- oi_init, code %i\n\n", e);
-
-  // Try to fetch an event
-  e = oi_events_poll(&ev);
-  printf("--- oi_events_poll, code %i\n", e);
-  if(e > 0) {
-    printf("--- event type %i\n", ev.type);
-  }
-  printf("\n");
-
-  // Close OI
-  e = oi_close();
-  printf("--- oi_close, code %i\n\n", e);
-
-  // Done
-  printf("*** footest stop ***\n");
-  return 0;
+    oi_latency lat;
+    oi_latency all;
+    oi_time budget;
+    int e;
+
+    printf("*** footest start\n");
+    budget = getenv(BUDGET_ENV) ? (oi_time)atoi(getenv(BUDGET_ENV)) * 1000 : 0;
+    setenv("OI_DRIVERS", "foo", 1);
+
+    // Without the flag nothing is measured
+    e = oi_init("c:1 s:2 w:3", OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", e);
+    check(run(20) > 0, "events from foo");
+    show(&lat);
+    check(lat.count == 0, "latency off by default");
+    oi_close();
+
+    // Fast device
+    e = oi_init("c:1 s:2 w:3", OI_FLAG_NOHOTPLUG | OI_FLAG_LATENCY);
+    printf("oi_init: code %i\n", e);
+    e = run(RUN_MS);
+    show(&lat);
+    check((lat.p50 <= lat.p99) && (lat.p99 <= lat.p999) && (lat.p999 <= lat.max),
+          "percentiles in order");
+    if(budget) {
+        check(lat.p99 < budget, "p99 within budget");
+    }
+
+    check(oi_latency_get(0, &all) == OI_ERR_OK, "all types");
+    check(all.count == (oi_count)e, "every event measured");
+    check((lat.count > 0) && (lat.count <= all.count), "key presses measured");
+    check(oi_latency_get(OI_STATS_TYPES, &all) == OI_ERR_PARAM, "bad type");
+
+    oi_latency_reset();
+    show(&lat);
+    check((lat.count == 0) && (lat.max == 0), "reset");
+    oi_close();
+
+    // Slow device
+    setenv("OI_FOO_DELAY", DELAY_US, 1);
+    e = oi_init("c:1 s:2 w:3", OI_FLAG_NOHOTPLUG | OI_FLAG_LATENCY);
+    printf("oi_init: code %i\n", e);
+    run(RUN_MS / 2);
+    show(&lat);
+    check(lat.p50 >= DELAY_NS, "p50 above delay");
+    check((lat.p50 <= lat.p99) && (lat.p99 <= lat.p999) && (lat.p999 <= lat.max),
+          "percentiles in order");
+    if(budget) {
+        check(lat.p99 < DELAY_NS + budget, "p99 within delay and budget");
+    }
+    oi_close();
+
+    printf("*** footest ended, %i failed\n", failed);
+    return failed != 0;
 }
 
 /* ******************************************************************** */
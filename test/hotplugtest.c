@@ -0,0 +1,183 @@
+/*
+ * hotplugtest.c : Test of joystick hotplugging
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+/* The device node directory is pointed (through OI_INPUTDIR) at a
+ * temporary directory, where FIFOs named like joysticks are created
+ * and removed while the library is running.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <linux/joystick.h>
+#include "openinput.h"
+#include "testlib.h"
+
+// Parameters
+#define CHURN 300
+
+// Globals
+static char dir[] = "/tmp/hotplugXXXXXX";
+
+/* ******************************************************************** */
+
+// Make path of node in the temporary directory
+char *node(char *name) {
+    static char path[128];
+
+    sprintf(path, "%s/%s", dir, name);
+    return path;
+}
+
+/* ******************************************************************** */
+
+// Poll for about 20 ms and return first event of given type
+int wait_for(unsigned char type, oi_event *ev) {
+    struct timespec ts;
+    int found;
+    int i;
+
+    ts.tv_sec = 0;
+    ts.tv_nsec = 2000000;
+    found = 0;
+    for(i=0; i<10; i++) {
+        while(oi_events_poll(ev)) {
+            if(ev->type == type) {
+                found = 1;
+                break;
+            }
+        }
+        if(found) {
+            break;
+        }
+        nanosleep(&ts, NULL);
+    }
+    return found;
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    struct js_event jse;
+    oi_event ev;
+    unsigned char first;
+    unsigned char hot;
+    int fd;
+    int bad;
+    int i;
+    int v;
+    char *name;
+
+    printf("*** hotplugtest start\n");
+
+    // Directory with a joystick present at startup
+    if(!mkdtemp(dir) || (mkfifo(node("js0"), 0600) != 0)) {
+        printf("cannot create nodes\n");
+        return 1;
+    }
+    setenv("OI_INPUTDIR", dir, 1);
+
+    i = oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW);
+    printf("oi_init: code %i\n", i);
+
+    // Bootstrap uses the directory too
+    first = 0;
+    while(oi_events_poll(&ev)) {
+        if((ev.type == OI_DISCOVERY) && (strcmp(ev.discover.name, "linuxjoy") == 0)) {
+            first = ev.discover.device;
+        }
+    }
+    check(first != 0, "joystick present at startup");
+
+    // Plug in a joystick, and something unrelated
+    mkfifo(node("js5"), 0600);
+    mkfifo(node("mouse0"), 0600);
+    hot = 0;
+    if(wait_for(OI_DISCOVERY, &ev) && (strcmp(ev.discover.name, "linuxjoy") == 0)) {
+        hot = ev.discover.device;
+    }
+    check(hot && (hot != first), "discovery of hotplugged joystick");
+    check(!wait_for(OI_DISCOVERY, &ev), "unrelated node ignored");
+
+    // Permission change must not add it twice
+    chmod(node("js5"), 0644);
+    check(!wait_for(OI_DISCOVERY, &ev), "no duplicate on attribute change");
+
+    // Feed it
+    fd = open(node("js5"), O_WRONLY | O_NONBLOCK);
+    check(fd != -1, "device is open");
+    memset(&jse, 0, sizeof(jse));
+    jse.type = JS_EVENT_AXIS;
+    jse.number = 0;
+    jse.value = 1234;
+    write(fd, &jse, sizeof(jse));
+    check(wait_for(OI_JOYAXIS, &ev) && (ev.joyaxis.device == hot), "axis event from new device");
+    oi_joy_absolute(hot, 0, &v, NULL);
+    check(v == 1234, "axis position");
+    close(fd);
+
+    // Unplug it
+    unlink(node("js5"));
+    check(wait_for(OI_DEVICELOST, &ev) && (ev.discover.device == hot), "removal event");
+    check(oi_device_info(hot, &name, NULL, NULL) != OI_ERR_OK, "removed device is gone");
+    check(oi_device_info(first, &name, NULL, NULL) == OI_ERR_OK, "other device still there");
+
+    // And back again, reuses the free slot
+    mkfifo(node("js5"), 0600);
+    check(wait_for(OI_DISCOVERY, &ev) && (ev.discover.device == hot), "replugged joystick");
+
+    // Churn, indices must not run out
+    bad = 0;
+    for(i=0; i<CHURN; i++) {
+        unlink(node("js5"));
+        if(!wait_for(OI_DEVICELOST, &ev)) {
+            bad++;
+        }
+        mkfifo(node("js5"), 0600);
+        if(!wait_for(OI_DISCOVERY, &ev) || (ev.discover.device != hot)) {
+            bad++;
+        }
+    }
+    check(bad == 0, "plug/unplug churn");
+    check(oi_device_info(first, &name, NULL, NULL) == OI_ERR_OK, "first device survived churn");
+
+    // Done
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+    unlink(node("js5"));
+    unlink(node("js0"));
+    unlink(node("mouse0"));
+    rmdir(dir);
+    printf("*** hotplugtest ended, %i failed\n", failed);
+
+    return failed != 0;
+}
+
+/* ******************************************************************** */
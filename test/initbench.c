@@ -0,0 +1,171 @@
+/*
+ * initbench.c : Benchmark of library startup
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+/* Time oi_init with different sets of devices. The device node
+ * directory is pointed (through OI_INPUTDIR) at a temporary
+ * directory with 0, 4 or 32 FIFOs posing as joysticks, and the
+ * library is started with and without hotplugging and lazy
+ * joystick drivers.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "openinput.h"
+
+// Parameters
+#define ROUNDS 101
+#define MAX_NODES 32
+
+// Globals
+static char dir[] = "/tmp/initbenchXXXXXX";
+static int nodes = 0;
+
+/* ******************************************************************** */
+
+// Monotonic time in microseconds
+double now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+/* ******************************************************************** */
+
+// Create or remove joystick nodes so that "num" exist
+void set_nodes(int num) {
+    char path[128];
+
+    while(nodes < num) {
+        sprintf(path, "%s/js%i", dir, nodes++);
+        mkfifo(path, 0600);
+    }
+    while(nodes > num) {
+        sprintf(path, "%s/js%i", dir, --nodes);
+        unlink(path);
+    }
+}
+
+/* ******************************************************************** */
+
+// Number of registered devices with given name
+int count(char *which) {
+    char *name;
+    int num;
+    int i;
+
+    num = 0;
+    for(i=1; i<=64; i++) {
+        if((oi_device_info(i, &name, NULL, NULL) == OI_ERR_OK) &&
+           (strcmp(name, which) == 0)) {
+            num++;
+        }
+    }
+    return num;
+}
+
+/* ******************************************************************** */
+
+// Compare doubles for qsort
+int cmp(const void *a, const void *b) {
+    double d;
+    d = *(const double*)a - *(const double*)b;
+    return (d > 0) - (d < 0);
+}
+
+/* ******************************************************************** */
+
+// Time oi_init for a scenario, returns number of errors
+int run(char *what, int num, unsigned int flags, int expect) {
+    double t[ROUNDS];
+    int found;
+    int bad;
+    int i;
+
+    set_nodes(num);
+    bad = 0;
+    for(i=0; i<ROUNDS; i++) {
+        t[i] = now_us();
+        oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW | flags);
+        t[i] = now_us() - t[i];
+
+        found = count("linuxjoy");
+        if(found != expect) {
+            bad++;
+        }
+        oi_close();
+    }
+
+    qsort(t, ROUNDS, sizeof(double), cmp);
+    printf("%-32s median %8.1f us  min %8.1f us  (%i joysticks)\n",
+           what, t[ROUNDS/2], t[0], found);
+    if(bad) {
+        printf("  expected %i joysticks, mismatch in %i rounds\n", expect, bad);
+    }
+    return bad;
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    int bad;
+
+    printf("*** initbench start\n");
+
+    if(!mkdtemp(dir)) {
+        printf("mkdtemp failed\n");
+        return 1;
+    }
+    setenv("OI_INPUTDIR", dir, 1);
+
+    bad = 0;
+    bad += run("no joysticks", 0, OI_FLAG_NOHOTPLUG, 0);
+    bad += run("4 joysticks", 4, OI_FLAG_NOHOTPLUG, 4);
+    bad += run("32 joysticks", 32, OI_FLAG_NOHOTPLUG, 32);
+    bad += run("32 joysticks, hotplug watcher", 32, 0, 32);
+    bad += run("32 joysticks, lazy", 32, OI_FLAG_NOHOTPLUG | OI_FLAG_LAZY, 0);
+
+    // Lazy drivers appear on first use of the joystick interface
+    oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG | OI_FLAG_LAZY);
+    oi_joy_absolute(0, 0, NULL, NULL);
+    if(count("linuxjoy") != 32) {
+        printf("lazy: %i joysticks after first use\n", count("linuxjoy"));
+        bad++;
+    }
+    oi_close();
+
+    // Cleanup
+    set_nodes(0);
+    rmdir(dir);
+    printf("*** initbench ended\n");
+
+    return bad != 0;
+}
+
+/* ******************************************************************** */
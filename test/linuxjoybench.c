@@ -0,0 +1,311 @@
+/*
+ * linuxjoybench.c : Benchmark of the GNU/Linux joystick driver
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+/* The linuxjoy driver is fed from a pipe instead of /dev/input/jsX.
+ * First, large bursts of js_event records are written and the time
+ * spent in the driver and joystick pump is measured. Secondly, a
+ * child process writes records at 8 kHz (like a high-rate gamepad)
+ * while we run a 1 kHz polling loop, and the CPU usage is measured.
+ * Finally, the axis state is checked against what was written.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <linux/joystick.h>
+#include "openinput.h"
+#include "internal.h"
+#include "linuxjoy.h"
+#include "testlib.h"
+
+// Parameters
+#define BURST_RECORDS 4096
+#define BURST_ROUNDS 32
+#define RATE_HZ 8000
+#define RATE_SECONDS 1
+#define NUM_AXES 4
+
+// Pipe feeding the driver
+static int pipefd[2];
+
+// Fake device init, use the pipe instead of a real joystick
+int bench_init(oi_device *dev, char *window_id, unsigned int flags);
+oi_device *bench_device();
+
+// Bootstrap for the pipe-driven device
+oi_bootstrap bench_bootstrap = {
+    "benchjoy",
+    "Pipe-driven linuxjoy benchmark device",
+    OI_PRO_JOYSTICK,
+    NULL,
+    bench_device
+};
+
+/* ******************************************************************** */
+
+// Create a linuxjoy device with our own init
+oi_device *bench_device() {
+    oi_device *dev;
+
+    dev = linuxjoy_device();
+    if(dev) {
+        dev->init = bench_init;
+    }
+    return dev;
+}
+
+/* ******************************************************************** */
+
+// Setup pipe and a plain four-axis, four-button joystick
+int bench_init(oi_device *dev, char *window_id, unsigned int flags) {
+    linuxjoy_private *priv;
+
+    priv = (linuxjoy_private*)dev->private;
+    priv->fd = pipefd[0];
+    priv->id = 0;
+
+    dummy_joyconfig(dev->joyconfig, "benchjoy", 4, NUM_AXES);
+
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+// Monotonic time in nanoseconds
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* ******************************************************************** */
+
+// Consumed user+system CPU time in nanoseconds
+double cpu_ns() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ((double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e9 +
+            (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1e3);
+}
+
+/* ******************************************************************** */
+
+// Generate record number n, returns final axis values in "last"
+void make_record(struct js_event *jse, int n, int *last) {
+    jse->time = n;
+
+    // Every 256th record is a button toggle, rest is axis motion
+    if((n % 256) == 255) {
+        jse->type = JS_EVENT_BUTTON;
+        jse->number = (n / 256) % 4;
+        jse->value = (n / 1024) & 1;
+    }
+    else {
+        jse->type = JS_EVENT_AXIS;
+        jse->number = n % NUM_AXES;
+        jse->value = (short)(((n * 97) % 65535) - 32767);
+        last[jse->number] = jse->value;
+    }
+}
+
+/* ******************************************************************** */
+
+// Drain the event queue, returns number of events
+int drain() {
+    oi_event ev;
+    int n;
+
+    n = 0;
+    while(oi_events_poll(&ev)) {
+        n++;
+    }
+    return n;
+}
+
+/* ******************************************************************** */
+
+// Check that the joystick state matches the last written values
+int verify(unsigned char index, int *last) {
+    int i;
+    int v;
+    int bad;
+
+    bad = 0;
+    for(i=0; i<NUM_AXES; i++) {
+        oi_joy_absolute(index, i, &v, NULL);
+        if(v != last[i]) {
+            printf("axis %i: got %i, expected %i\n", i, v, last[i]);
+            bad++;
+        }
+    }
+    return bad;
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    static struct js_event buf[BURST_RECORDS];
+    struct timespec ts;
+    oi_device *dev;
+    unsigned char index;
+    int last[NUM_AXES];
+    double t;
+    double best;
+    double cpu;
+    int events;
+    int polls;
+    int bad;
+    int i;
+    int r;
+    int status;
+    char *name;
+    pid_t child;
+
+    printf("*** linuxjoybench start\n");
+
+    // Pipe with non-blocking read end, like the joystick device
+    if(pipe(pipefd) != 0) {
+        printf("pipe failed\n");
+        return 1;
+    }
+    fcntl(pipefd[0], F_SETFL, fcntl(pipefd[0], F_GETFL) | O_NONBLOCK);
+
+    // Init library and register pipe device
+    i = oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW);
+    printf("oi_init: code %i\n", i);
+    i = device_register(&bench_bootstrap, NULL, 0);
+    printf("device_register: code %i\n", i);
+    if(i != OI_ERR_OK) {
+        return 1;
+    }
+
+    // Find our device
+    index = 0;
+    for(i=1; i<OI_MAX_DEVICES; i++) {
+        if((oi_device_info(i, &name, NULL, NULL) == OI_ERR_OK) &&
+           (strcmp(name, "benchjoy") == 0)) {
+            index = i;
+            break;
+        }
+    }
+    dev = device_get(index);
+    if(!dev) {
+        printf("benchjoy device not found\n");
+        return 1;
+    }
+    drain();
+    memset(last, 0, sizeof(last));
+
+    // Burst: time driver and pump for a full pipe of records
+    best = 1e30;
+    t = 0;
+    for(r=0; r<BURST_ROUNDS; r++) {
+        for(i=0; i<BURST_RECORDS; i++) {
+            make_record(&buf[i], r*BURST_RECORDS + i, last);
+        }
+        if(write(pipefd[1], buf, sizeof(buf)) != sizeof(buf)) {
+            printf("short write\n");
+            return 1;
+        }
+
+        t = now_ns();
+        dev->process(dev);
+        joystick_pump();
+        t = now_ns() - t;
+        if(t < best) {
+            best = t;
+        }
+        drain();
+    }
+    printf("burst: %i records, best %.0f ns (%.1f ns/record)\n",
+           BURST_RECORDS, best, best / BURST_RECORDS);
+    bad = verify(index, last);
+
+    // Rate: child writes at 8 kHz, we poll at about 1 kHz
+    child = fork();
+    if(child == 0) {
+        struct js_event jse;
+        struct timespec next;
+
+        clock_gettime(CLOCK_MONOTONIC, &next);
+        for(i=0; i<RATE_HZ*RATE_SECONDS; i++) {
+            make_record(&jse, i, last);
+            if(write(pipefd[1], &jse, sizeof(jse)) != sizeof(jse)) {
+                _exit(1);
+            }
+            next.tv_nsec += 1000000000 / RATE_HZ;
+            if(next.tv_nsec >= 1000000000) {
+                next.tv_nsec -= 1000000000;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+        _exit(0);
+    }
+
+    // Replay the child's records locally to know the final state
+    for(i=0; i<RATE_HZ*RATE_SECONDS; i++) {
+        make_record(&buf[0], i, last);
+    }
+
+    events = 0;
+    polls = 0;
+    cpu = cpu_ns();
+    t = now_ns();
+    ts.tv_sec = 0;
+    ts.tv_nsec = 1000000;
+    while(waitpid(child, &status, WNOHANG) == 0) {
+        events += drain();
+        polls++;
+        nanosleep(&ts, NULL);
+    }
+
+    // Pick up the tail end
+    nanosleep(&ts, NULL);
+    events += drain();
+    t = now_ns() - t;
+    cpu = cpu_ns() - cpu;
+
+    printf("rate: %i Hz for %.2f s, %i polls, %i events, cpu %.2f%%\n",
+           RATE_HZ, t / 1e9, polls, events, 100.0 * cpu / t);
+    bad += verify(index, last);
+
+    // Done
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+    printf("*** linuxjoybench ended\n");
+
+    return (bad != 0) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0);
+}
+
+/* ******************************************************************** */
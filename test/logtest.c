@@ -0,0 +1,168 @@
+/*
+ * logtest.c : Test of leveled logging
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+/* ******************************************************************** */
+
+/* Standard error is sent to a file, and messages at various levels
+ * are logged and flushed. Disabled levels must not be stored, and a
+ * wrapped buffer must report the lost messages. Finally the cost of
+ * a disabled log call is timed.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "openinput.h"
+#include "internal.h"
+#include "testlib.h"
+
+// Parameters
+#define OUTPUT "logtest.txt"
+#define CALLS 10000000
+#define MAX_NS 5
+#define MAX_SIZE (64*1024)
+
+// Globals
+static char buf[MAX_SIZE];
+
+/* ******************************************************************** */
+
+// Read file into buffer and truncate it, returns length
+int slurp(char *filename) {
+    FILE *f;
+    int n;
+
+    fflush(stderr);
+    buf[0] = '\0';
+    f = fopen(filename, "r");
+    if(!f) {
+        return 0;
+    }
+    n = fread(buf, 1, MAX_SIZE - 1, f);
+    buf[n] = '\0';
+    fclose(f);
+    freopen(filename, "w", stderr);
+    return n;
+}
+
+/* ******************************************************************** */
+
+// Monotonic time in nanoseconds
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    double s;
+    double ns;
+    int i;
+
+    printf("*** logtest start\n");
+
+    setenv("OI_DRIVERS", "none", 1);
+    setenv("OI_LOG", "info", 1);
+    i = oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", i);
+    check(oi_log_level(OI_LOG_WARN) == OI_LOG_INFO, "level from environment");
+
+    if(!freopen(OUTPUT, "w", stderr)) {
+        printf("cannot redirect stderr\n");
+        return 1;
+    }
+    oi_log_flush();
+    slurp(OUTPUT);
+
+    // Enabled and disabled levels
+    log_error("first %i", 1);
+    log_warn("second %s", "two");
+    log_info("never");
+    debug("never");
+    check(oi_log_flush() == 2, "two messages flushed");
+    slurp(OUTPUT);
+    check(strcmp(buf, "openinput: error: first 1\nopeninput: warning: second two\n") == 0,
+          "message format");
+    check(oi_log_flush() == 0, "nothing left");
+
+    // Debug messages only exist in debug builds
+    oi_log_level(OI_LOG_DEBUG);
+    log_info("third");
+    debug("fourth");
+    i = oi_log_flush();
+    slurp(OUTPUT);
+#if OI_LOG_MAX >= OI_LOG_DEBUG
+    check(i == 2, "debug message kept");
+#else
+    check(i == 1, "debug message compiled out");
+#endif
+    check(strncmp(buf, "openinput: info: third\n", 23) == 0, "info message");
+
+    // Silence
+    oi_log_level(OI_LOG_NONE);
+    log_error("never");
+    check(oi_log_flush() == 0, "silent");
+
+    // Wrap the buffer
+    oi_log_level(OI_LOG_WARN);
+    for(i=0; i<OI_LOG_SIZE+10; i++) {
+        log_warn("message %i", i);
+    }
+    check(oi_log_flush() == OI_LOG_SIZE, "buffer wrapped");
+    slurp(OUTPUT);
+    check(strncmp(buf, "openinput: 10 messages lost\nopeninput: warning: message 10\n", 59) == 0,
+          "lost messages reported");
+
+    // Long messages are cut
+    memset(buf, 'x', 2 * OI_LOG_LINE);
+    buf[2 * OI_LOG_LINE] = '\0';
+    log_warn("%s", buf);
+    check(oi_log_flush() == 1, "long message");
+    i = slurp(OUTPUT);
+    check(i == (int)strlen("openinput: warning: \n") + OI_LOG_LINE - 1, "long message cut");
+
+    // Cost of a disabled call
+    s = now_ns();
+    for(i=0; i<CALLS; i++) {
+        log_info("disabled %i", i);
+    }
+    ns = (now_ns() - s) / CALLS;
+    printf("disabled log call: %.2f ns\n", ns);
+    check(ns < MAX_NS, "disabled call is cheap");
+    check(oi_log_flush() == 0, "disabled calls stored nothing");
+
+    i = oi_close();
+    unlink(OUTPUT);
+    printf("oi_close: code %i\n", i);
+    printf("*** logtest ended, %i failed\n", failed);
+
+    return failed != 0;
+}
+
+/* ******************************************************************** */
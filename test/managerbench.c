@@ -0,0 +1,236 @@
+/*
+ * managerbench.c : Benchmark of the state managers with many devices
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+/* 32 dummy joysticks, a keyboard and a mouse are registered through
+ * the internal device interface. Each round, every joystick gets
+ * axis and button updates which are then pumped into events, and all
+ * joysticks are queried through the public interface. Rounds are
+ * timed both with warm caches, and after the caches have been
+ * flushed by touching a large buffer (as happens when the
+ * application does real work between event pumps).
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "openinput.h"
+#include "internal.h"
+#include "testlib.h"
+
+// Parameters
+#define NUM_JOYS 32
+#define NUM_AXES 6
+#define NUM_BUTTONS 12
+#define ROUNDS 2001
+#define FLUSH_SIZE (16*1024*1024)
+
+// Globals
+static unsigned char joys[NUM_JOYS];
+static char *flush;
+static void *fill[NUM_JOYS];
+static volatile unsigned int sink;
+
+// Bootstraps for the dummy devices
+oi_bootstrap joy_bootstrap = {
+    "benchjoy",
+    "Manager benchmark joystick",
+    OI_PRO_JOYSTICK,
+    NULL,
+    dummy_joystick
+};
+oi_bootstrap kbdmouse_bootstrap = {
+    "benchkbd",
+    "Manager benchmark keyboard and mouse",
+    OI_PRO_KEYBOARD | OI_PRO_MOUSE,
+    NULL,
+    dummy_device
+};
+
+/* ******************************************************************** */
+
+// Monotonic time in nanoseconds
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* ******************************************************************** */
+
+// Compare doubles for qsort
+int cmp(const void *a, const void *b) {
+    double d;
+    d = *(const double*)a - *(const double*)b;
+    return (d > 0) - (d < 0);
+}
+
+/* ******************************************************************** */
+
+// Evict library state from the caches
+void flush_caches() {
+    int i;
+
+    for(i=0; i<FLUSH_SIZE; i+=64) {
+        flush[i]++;
+    }
+}
+
+/* ******************************************************************** */
+
+// Remove all pending events
+void drain() {
+    oi_event evs[64];
+
+    while(queue_peep(evs, 64, OI_MASK_ALL, TRUE) > 0);
+}
+
+/* ******************************************************************** */
+
+// Inject updates into all joysticks and pump them
+void update(int round) {
+    int i;
+    int j;
+
+    for(i=0; i<NUM_JOYS; i++) {
+        for(j=0; j<2; j++) {
+            joystick_axis(joys[i], (unsigned char)j, (round * 7 + i + j) & 0x7fff, FALSE, TRUE);
+        }
+        joystick_button(joys[i], (unsigned char)(round % NUM_BUTTONS), round & 1, TRUE);
+    }
+    joystick_pump();
+}
+
+/* ******************************************************************** */
+
+// Query all joysticks and the keyboard/mouse, returns checksum
+int query() {
+    int sum;
+    int x;
+    int y;
+    int i;
+    int j;
+
+    sum = 0;
+    for(i=0; i<NUM_JOYS; i++) {
+        for(j=0; j<NUM_AXES; j+=2) {
+            sum += oi_joy_absolute(joys[i], j, &x, &y);
+            sum += x + y;
+        }
+    }
+    sum += oi_key_modstate(0);
+    sum += oi_mouse_absolute(0, &x, &y);
+    return sum + x + y;
+}
+
+/* ******************************************************************** */
+
+// Time a workload, returns median in nanoseconds
+double run(char *what, int work, int cold) {
+    double t[ROUNDS];
+    double s;
+    int i;
+
+    for(i=0; i<ROUNDS; i++) {
+        if(cold) {
+            flush_caches();
+        }
+
+        s = now_ns();
+        if(work) {
+            sink += query();
+        }
+        else {
+            update(i);
+        }
+        t[i] = now_ns() - s;
+
+        drain();
+    }
+
+    qsort(t, ROUNDS, sizeof(double), cmp);
+    printf("%-30s median %8.0f ns  min %8.0f ns  (%5.1f ns/joystick)\n",
+           what, t[ROUNDS/2], t[0], t[ROUNDS/2] / NUM_JOYS);
+    return t[ROUNDS/2];
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    int x;
+    int i;
+
+    printf("*** managerbench start\n");
+
+    flush = (char*)malloc(FLUSH_SIZE);
+    if(!flush) {
+        return 1;
+    }
+    memset(flush, 0, FLUSH_SIZE);
+
+    i = oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", i);
+
+    dummy_joyconfig(&dummy_joy, "benchjoy", NUM_BUTTONS, NUM_AXES);
+
+    // Devices are interleaved with other allocations like in a real program
+    for(i=0; i<NUM_JOYS; i++) {
+        if(i == NUM_JOYS/2) {
+            device_register(&kbdmouse_bootstrap, NULL, 0);
+        }
+        if(device_register(&joy_bootstrap, NULL, 0) != OI_ERR_OK) {
+            printf("cannot register joystick %i\n", i);
+            return 1;
+        }
+        for(x=0; device_live(x+1); x++);
+        joys[i] = device_live(x);
+        fill[i] = malloc(100 + i * 40);
+    }
+    drain();
+
+    run("update+pump, warm", 0, 0);
+    run("update+pump, cold", 0, 1);
+    run("query, warm", 1, 0);
+    run("query, cold", 1, 1);
+
+    // Sanity check of state
+    update(12345);
+    oi_joy_absolute(joys[NUM_JOYS-1], 0, &x, NULL);
+    i = (x != ((12345 * 7 + NUM_JOYS-1) & 0x7fff));
+    if(i) {
+        printf("wrong axis state %i\n", x);
+    }
+
+    oi_close();
+    for(x=0; x<NUM_JOYS; x++) {
+        free(fill[x]);
+    }
+    free(flush);
+    printf("*** managerbench ended\n");
+
+    return i;
+}
+
+/* ******************************************************************** */
@@ -0,0 +1,126 @@
+/*
+ * plugintest.c : Test of driver plugins
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+/* The plugin directory is pointed (through OI_PLUGINDIR) at the
+ * libtool output directory, where the "testdrv" plugin is built.
+ * The library is started with different driver selections (through
+ * OI_DRIVERS), and we check which devices show up and whether the
+ * plugin is loaded at all.
+ */
+
+// Includes
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include "openinput.h"
+#include "testlib.h"
+
+// Parameters
+#define PLUGIN_DIR "./.libs"
+#define PLUGIN_FILE PLUGIN_DIR "/testdrv.so"
+
+/* ******************************************************************** */
+
+// Is the plugin in memory
+int loaded() {
+    void *h;
+
+    h = dlopen(PLUGIN_FILE, RTLD_NOW | RTLD_NOLOAD);
+    if(h) {
+        dlclose(h);
+        return 1;
+    }
+    return 0;
+}
+
+/* ******************************************************************** */
+
+// Start library with driver selection, returns mask of devices found
+int start(char *drivers) {
+    oi_event ev;
+    int found;
+
+    if(drivers) {
+        setenv("OI_DRIVERS", drivers, 1);
+    }
+    else {
+        unsetenv("OI_DRIVERS");
+    }
+
+    found = 0;
+    oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    while(oi_events_poll(&ev)) {
+        if(ev.type != OI_DISCOVERY) {
+            continue;
+        }
+        if(strcmp(ev.discover.name, "testdrv") == 0) {
+            found |= 1;
+        }
+        else {
+            found |= 2;
+        }
+    }
+    return found;
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    int found;
+
+    printf("*** plugintest start\n");
+    setenv("OI_PLUGINDIR", PLUGIN_DIR, 1);
+
+    // All drivers
+    found = start(NULL);
+    check(found == 3, "plugin and compiled-in drivers");
+    check(loaded(), "plugin loaded");
+    oi_close();
+    check(!loaded(), "plugin unloaded on close");
+
+    // Only the plugin
+    found = start("testdrv");
+    check(found == 1, "select plugin only");
+    oi_close();
+
+    // Plugin not selected is not loaded either
+    found = start("unixsignal, foo");
+    check(found == 2, "select compiled-in driver only");
+    check(!loaded(), "unselected plugin not loaded");
+    oi_close();
+
+    // No plugin directory
+    setenv("OI_PLUGINDIR", "/nonexistent", 1);
+    found = start(NULL);
+    check(found == 2, "missing plugin directory");
+    oi_close();
+
+    printf("*** plugintest ended, %i failed\n", failed);
+
+    return failed != 0;
+}
+
+/* ******************************************************************** */
@@ -0,0 +1,204 @@
+/*
+ * replaytest.c : Test of event recording and replay
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+/* Events are injected while recording, and the recording is then
+ * played back through the replay driver: first as fast as possible,
+ * where the events must come out the same, then at normal speed,
+ * where they must keep their spacing. Last, an entry stamped before
+ * the start of the recording must not hold up the replay.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "openinput.h"
+#include "internal.h"
+#include "testlib.h"
+
+// Parameters
+#define GAP_MS 30
+#define SLACK_MS 10
+#define WAIT_MS 200
+#define RECORDING "replaytest.rec"
+
+/* ******************************************************************** */
+
+// Next event, pumping for a while
+int next(oi_event *ev) {
+    int ms;
+
+    for(ms=0; ms<WAIT_MS; ms++) {
+        if(oi_events_poll(ev)) {
+            return 1;
+        }
+        usleep(1000);
+    }
+    return 0;
+}
+
+/* ******************************************************************** */
+
+// Change the stamp of the first entry of the given type
+int restamp(int type, oi_time stamp) {
+    oi_recentry ent;
+    long pos;
+    FILE *f;
+
+    f = fopen(RECORDING, "r+b");
+    if(!f) {
+        return 0;
+    }
+    pos = sizeof(oi_rechead);
+    while((fseek(f, pos, SEEK_SET) == 0) && (fread(&ent, sizeof(ent), 1, f) == 1)) {
+        if(ent.event.type == type) {
+            ent.stamp = stamp;
+            fseek(f, pos, SEEK_SET);
+            fwrite(&ent, sizeof(ent), 1, f);
+            fclose(f);
+            return 1;
+        }
+        pos += ent.size;
+    }
+    fclose(f);
+    return 0;
+}
+
+/* ******************************************************************** */
+
+// Play the recording, returns time between key down and key up
+double play(char *speed) {
+    oi_event ev;
+    oi_time down;
+    oi_time up;
+    int found;
+    int i;
+
+    setenv("OI_REPLAY_SPEED", speed, 1);
+    i = oi_init(NULL, OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    printf("oi_init (speed %s): code %i\n", speed, i);
+
+    // Own device, then the recorded one
+    found = 0;
+    down = 0;
+    up = 0;
+    while(next(&ev)) {
+        switch(ev.type) {
+        case OI_DISCOVERY:
+            if(strcmp(ev.discover.name, "unixsignal") == 0) {
+                found = 1;
+            }
+            break;
+
+        case OI_KEYDOWN:
+            check((ev.key.keysym.sym == OIK_A) && (ev.key.device == 3), "key down");
+            down = oi_events_timestamp();
+            break;
+
+        case OI_KEYUP:
+            check(ev.key.keysym.sym == OIK_A, "key up");
+            up = oi_events_timestamp();
+            break;
+
+        case OI_MOUSEMOVE:
+            check((ev.move.x == 10) && (ev.move.y == 20) && (ev.move.relx == -5), "mouse move");
+            break;
+
+        case OI_QUIT:
+            check(up != 0, "quit comes last");
+            break;
+
+        default:
+            break;
+        }
+    }
+    check(found, "recorded device discovered");
+    check(down && up, "keys replayed");
+
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+
+    return (double)(up - down) / 1e6;
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    oi_event ev[3];
+    double gap;
+    int i;
+
+    printf("*** replaytest start\n");
+
+    // Record
+    setenv("OI_DRIVERS", "unixsignal", 1);
+    i = oi_init(NULL, OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", i);
+    while(next(&ev[0]));
+
+    check(oi_events_record(RECORDING) == OI_ERR_OK, "start recording");
+    memset(ev, 0, sizeof(ev));
+    ev[0].type = OI_KEYDOWN;
+    ev[0].key.device = 3;
+    ev[0].key.keysym.sym = OIK_A;
+    ev[1].type = OI_MOUSEMOVE;
+    ev[1].move.x = 10;
+    ev[1].move.y = 20;
+    ev[1].move.relx = -5;
+    oi_events_add(ev, 2);
+    usleep(GAP_MS * 1000);
+    ev[0].type = OI_KEYUP;
+    ev[1].type = OI_QUIT;
+    oi_events_add(ev, 2);
+    while(next(&ev[0]));
+    oi_events_record(NULL);
+
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+
+    // Replay
+    setenv("OI_DRIVERS", "replay", 1);
+    setenv("OI_REPLAY", RECORDING, 1);
+    gap = play("0");
+    printf("fast replay: key held %.2f ms\n", gap);
+    check(gap < GAP_MS, "fast replay has no delay");
+
+    gap = play("1");
+    printf("normal replay: key held %.2f ms, recorded %i ms\n", gap, GAP_MS);
+    check((gap >= GAP_MS) && (gap < GAP_MS + SLACK_MS), "normal replay keeps spacing");
+
+    // Key release stamped before anything else is due at once
+    check(restamp(OI_KEYUP, 1), "restamp key up");
+    gap = play("1");
+    printf("early stamp: key held %.2f ms\n", gap);
+    check(gap < GAP_MS, "early entry replayed at once");
+
+    unlink(RECORDING);
+    printf("*** replaytest ended, %i failed\n", failed);
+    return failed != 0;
+}
+
+/* ******************************************************************** */
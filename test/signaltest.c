@@ -0,0 +1,137 @@
+/*
+ * signaltest.c : Test of the UNIX signal driver
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+/* The unixsignal driver is set up (through OI_SIGNALS) to catch
+ * interrupt, hang-up and user signal 1. Signals raised by ourselves
+ * must come out as quit and signal events, and a signal sent by a
+ * child process must wake up oi_events_wait right away.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "openinput.h"
+#include "testlib.h"
+
+// Parameters
+#define DELAY_MS 50
+#define MAX_LATE_MS 20
+#define WAIT_MS 100
+
+/* ******************************************************************** */
+
+// Next event, pumping for a while
+int next(oi_event *ev) {
+    int ms;
+
+    for(ms=0; ms<WAIT_MS; ms++) {
+        if(oi_events_poll(ev)) {
+            return 1;
+        }
+        usleep(1000);
+    }
+    return 0;
+}
+
+/* ******************************************************************** */
+
+// Monotonic time in milliseconds
+double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    oi_event ev;
+    struct timespec ts;
+    double start;
+    double late;
+    pid_t child;
+    int i;
+
+    printf("*** signaltest start\n");
+
+    setenv("OI_SIGNALS", "INT,SIGHUP,USR1", 1);
+    setenv("OI_DRIVERS", "unixsignal", 1);
+    i = oi_init(NULL, OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", i);
+    while(next(&ev));
+
+    // Nothing pending
+    check(!next(&ev), "idle");
+
+    // Own signals
+    raise(SIGUSR1);
+    check(next(&ev) && (ev.type == OI_SIGNAL) &&
+          (ev.signal.signum == SIGUSR1), "SIGUSR1 is a signal event");
+
+    raise(SIGINT);
+    check(next(&ev) && (ev.type == OI_QUIT), "SIGINT is a quit event");
+
+    raise(SIGHUP);
+    raise(SIGUSR1);
+    check(next(&ev) && (ev.type == OI_SIGNAL) &&
+          (ev.signal.signum == SIGHUP), "SIGHUP in order");
+    check(next(&ev) && (ev.type == OI_SIGNAL) &&
+          (ev.signal.signum == SIGUSR1), "SIGUSR1 in order");
+    check(!next(&ev), "nothing more");
+
+    // Signal from another process wakes the waiter
+    start = now_ms();
+    child = fork();
+    if(child == 0) {
+        ts.tv_sec = 0;
+        ts.tv_nsec = DELAY_MS * 1000000;
+        nanosleep(&ts, NULL);
+        kill(getppid(), SIGHUP);
+        _exit(0);
+    }
+    oi_events_wait(&ev);
+    late = now_ms() - start - DELAY_MS;
+    waitpid(child, NULL, 0);
+    printf("wakeup %.2f ms after the signal was sent\n", late);
+    check((ev.type == OI_SIGNAL) && (ev.signal.signum == SIGHUP), "wait woken by SIGHUP");
+    check(late < MAX_LATE_MS, "wait woken quickly");
+
+    // Handlers are restored
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+    signal(SIGUSR1, SIG_IGN);
+    raise(SIGUSR1);
+
+    printf("*** signaltest ended, %i failed\n", failed);
+    return failed != 0;
+}
+
+/* ******************************************************************** */
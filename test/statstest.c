@@ -0,0 +1,174 @@
+/*
+ * statstest.c : Test of the runtime statistics
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+/* Without drivers, events are injected and a dummy joystick is fed
+ * through the internal interface, and the library and device
+ * counters are checked: queued, dropped and merged events, the
+ * queue high-water mark, action dispatches, read calls and pumps.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "openinput.h"
+#include "internal.h"
+#include "testlib.h"
+
+// Parameters
+#define PUMP_MS 20
+
+// Bootstrap for the dummy joystick
+oi_bootstrap joy_bootstrap = {
+    "statsjoy",
+    "Statistics test joystick",
+    OI_PRO_JOYSTICK,
+    NULL,
+    dummy_joystick
+};
+
+/* ******************************************************************** */
+
+// Remove all pending events
+void drain() {
+    oi_event evs[64];
+
+    while(queue_peep(evs, 64, OI_MASK_ALL, TRUE) > 0);
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    oi_actionmap map[2];
+    oi_stats st;
+    oi_devstats ds;
+    oi_event ev[3];
+    oi_count sum;
+    unsigned char joy;
+    int i;
+
+    printf("*** statstest start\n");
+
+    setenv("OI_DRIVERS", "none", 1);
+    i = oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", i);
+
+    dummy_joyconfig(&dummy_joy, "statsjoy", 2, 2);
+    check(device_register(&joy_bootstrap, NULL, 0) == OI_ERR_OK, "register joystick");
+    joy = device_live(0);
+    drain();
+    oi_stats_reset();
+
+    // Queued events
+    memset(ev, 0, sizeof(ev));
+    for(i=0; i<3; i++) {
+        ev[i].type = OI_KEYDOWN;
+        ev[i].key.keysym.sym = OIK_B;
+    }
+    oi_events_add(ev, 3);
+    oi_stats_get(&st);
+    check(st.enqueued[OI_KEYDOWN] == 3, "keys enqueued");
+    check(st.highwater == 3, "high-water mark");
+    check(st.actions == 0, "no action map, no lookups");
+
+    // Overflow
+    ev[0].type = OI_EXPOSE;
+    for(i=0; i<OI_MAX_EVENTS; i++) {
+        queue_add(&ev[0]);
+    }
+    oi_stats_get(&st);
+    printf("expose: %llu enqueued, %llu dropped\n",
+           st.enqueued[OI_EXPOSE], st.dropped[OI_EXPOSE]);
+    check(st.enqueued[OI_EXPOSE] == OI_MAX_EVENTS - 4, "queue filled");
+    check(st.dropped[OI_EXPOSE] == 4, "overflow dropped");
+    check(st.highwater == OI_MAX_EVENTS - 1, "queue full");
+    drain();
+
+    // Joystick axis updated twice between pumps
+    joystick_axis(joy, 0, 100, FALSE, TRUE);
+    joystick_axis(joy, 0, 200, FALSE, TRUE);
+    joystick_axis(joy, 1, 300, FALSE, TRUE);
+    joystick_pump();
+    stats_read(joy);
+    stats_read(joy);
+    oi_stats_get(&st);
+    check(st.merged[OI_JOYAXIS] == 1, "axis update merged");
+    check(st.enqueued[OI_JOYAXIS] == 2, "axes enqueued");
+    drain();
+
+    check(oi_stats_device(joy, &ds) == OI_ERR_OK, "device statistics");
+    printf("device %i: %llu events, %llu reads, %u events/s\n",
+           joy, ds.events, ds.reads, ds.rate);
+    check((ds.events == 2) && (ds.reads == 2) && (ds.rate > 0), "device counters");
+    check(oi_stats_device(joy + 1, &ds) == OI_ERR_INDEX, "unknown device");
+
+    // Actions, highest id on a key never pressed
+    map[0].actionid = 1;
+    map[0].device = 0;
+    map[0].name = oi_key_getname(OIK_A);
+    map[1].actionid = 2;
+    map[1].device = 0;
+    map[1].name = oi_key_getname(OIK_Z);
+    check(oi_action_install(map, 2) == OI_ERR_OK, "install action map");
+    ev[0].type = OI_KEYDOWN;
+    ev[0].key.keysym.sym = OIK_A;
+    ev[1].type = OI_KEYDOWN;
+    ev[1].key.keysym.sym = OIK_B;
+    oi_events_add(ev, 2);
+    oi_stats_get(&st);
+    check((st.actions == 2) && (st.dispatched == 1) && (st.enqueued[OI_ACTION] == 1),
+          "action dispatch");
+    drain();
+
+    // Pumps
+    for(i=0; i<PUMP_MS; i++) {
+        oi_events_pump();
+        usleep(1000);
+    }
+    oi_stats_get(&st);
+    sum = 0;
+    for(i=0; i<OI_STATS_BUCKETS; i++) {
+        sum += st.pumptime[i];
+    }
+    printf("pumps: %llu, fastest bucket %llu, elapsed %.1f ms\n",
+           st.pumps, st.pumptime[0], (double)st.elapsed / 1e6);
+    check((st.pumps > PUMP_MS / 2) && (sum == st.pumps), "pump histogram");
+
+    // Reset
+    oi_stats_reset();
+    oi_stats_get(&st);
+    oi_stats_device(joy, &ds);
+    check((st.enqueued[OI_KEYDOWN] == 0) && (st.pumps == 0) && (st.highwater == 0) &&
+          (ds.events == 0) && (ds.reads == 0), "reset");
+
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+    printf("*** statstest ended, %i failed\n", failed);
+
+    return failed != 0;
+}
+
+/* ******************************************************************** */
@@ -0,0 +1,166 @@
+/*
+ * synthtest.c : Test of the synthetic load driver
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+/* Virtual devices of the synth driver are configured through
+ * OI_SYNTH and run for a while. We check that the devices are
+ * there, that events come at the configured rates, and that the
+ * same seed gives the same keys, while another seed does not.
+ * Finally, a rate too high to keep time with must not hang the pump.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "openinput.h"
+#include "testlib.h"
+
+// Parameters
+#define RUN_MS 200
+#define NUM_KEYS 200
+#define KEY_RATE 20000
+#define CONFIG "keyboards=2 mice=1 joysticks=2 keys=20000 motion=10000 " \
+               "clicks=500 axes=20000 buttons=500 burst=4 seed="
+
+/* ******************************************************************** */
+
+// Run the synth driver, keys of first keyboard are stored in keys
+void run(char *seed, oi_key *keys, int show) {
+    char config[200];
+    oi_event ev;
+    oi_time end;
+    char *name;
+    char *desc;
+    unsigned int provides;
+    unsigned char first;
+    unsigned char joy;
+    int counts[32];
+    int devices;
+    int nkeys;
+    int x;
+    int i;
+
+    sprintf(config, "%s%s", CONFIG, seed);
+    setenv("OI_SYNTH", config, 1);
+    i = oi_init(NULL, OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    printf("oi_init (seed %s): code %i\n", seed, i);
+
+    memset(counts, 0, sizeof(counts));
+    devices = 0;
+    first = 0;
+    joy = 0;
+    nkeys = 0;
+    end = 0;
+    while(!end || (oi_events_timestamp() < end)) {
+        if(!oi_events_poll(&ev)) {
+            usleep(100);
+            continue;
+        }
+        if(!end) {
+            end = oi_events_timestamp() + (oi_time)RUN_MS * 1000000;
+        }
+        counts[ev.type]++;
+
+        switch(ev.type) {
+        case OI_DISCOVERY:
+            oi_device_info(ev.discover.device, &name, &desc, &provides);
+            devices++;
+            if((provides == OI_PRO_KEYBOARD) && !first) {
+                first = ev.discover.device;
+            }
+            if(provides == OI_PRO_JOYSTICK) {
+                joy = ev.discover.device;
+            }
+            break;
+
+        case OI_KEYDOWN:
+            if((ev.key.device == first) && (nkeys < NUM_KEYS)) {
+                keys[nkeys++] = ev.key.keysym.sym;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if(show) {
+        check(devices == 5, "five devices discovered");
+        printf("events in %i ms: %i keys, %i motion, %i clicks, %i axes, %i buttons\n",
+               RUN_MS, counts[OI_KEYDOWN] + counts[OI_KEYUP], counts[OI_MOUSEMOVE],
+               counts[OI_MOUSEBUTTONDOWN] + counts[OI_MOUSEBUTTONUP],
+               counts[OI_JOYAXIS], counts[OI_JOYBUTTONDOWN] + counts[OI_JOYBUTTONUP]);
+
+        // Two keyboards at KEY_RATE
+        i = counts[OI_KEYDOWN] + counts[OI_KEYUP];
+        x = 2 * KEY_RATE / 1000 * RUN_MS;
+        check((i > x * 3 / 4) && (i < x * 5 / 4), "key rate");
+        check(counts[OI_MOUSEMOVE] > 0, "mouse motion");
+        check(counts[OI_JOYAXIS] > 0, "joystick axes");
+        check(counts[OI_JOYBUTTONDOWN] > 0, "joystick buttons");
+        oi_joy_absolute(joy, 0, &x, &i);
+        check(joy && (x || i), "joystick state");
+    }
+    check(nkeys == NUM_KEYS, "keys collected");
+
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    oi_key first[NUM_KEYS];
+    oi_key again[NUM_KEYS];
+    oi_key other[NUM_KEYS];
+    oi_event ev;
+    int i;
+
+    printf("*** synthtest start\n");
+
+    setenv("OI_DRIVERS", "synth", 1);
+    run("42", first, 1);
+    run("42", again, 0);
+    run("7", other, 0);
+
+    check(memcmp(first, again, sizeof(first)) == 0, "same seed, same keys");
+    check(memcmp(first, other, sizeof(first)) != 0, "other seed, other keys");
+
+    // Absurd rate is limited, so the pump returns
+    setenv("OI_SYNTH", "keyboards=1 mice=0 joysticks=0 keys=2000000000", 1);
+    oi_init(NULL, OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    for(i=0; i<10; i++) {
+        oi_events_pump();
+        usleep(1000);
+    }
+    check(oi_events_poll(&ev), "highest rate pumped");
+    oi_close();
+
+    printf("*** synthtest ended, %i failed\n", failed);
+    return failed != 0;
+}
+
+/* ******************************************************************** */
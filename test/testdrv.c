@@ -0,0 +1,48 @@
+/*
+ * testdrv.c : Driver plugin used by plugintest
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+// Includes
+#include "openinput.h"
+#include "internal.h"
+#include "testlib.h"
+
+// Driver functions
+int testdrv_avail(unsigned int flags);
+
+// Bootstrap, found by the plugin loader through the file name
+oi_bootstrap testdrv_bootstrap = {
+    "testdrv",
+    "Plugin test driver",
+    OI_PRO_UNKNOWN,
+    testdrv_avail,
+    dummy_device
+};
+
+/* ******************************************************************** */
+
+// Always there
+int testdrv_avail(unsigned int flags) {
+    return TRUE;
+}
+
+/* ******************************************************************** */
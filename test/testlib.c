@@ -0,0 +1,131 @@
+/*
+ * testlib.c : Helpers shared by the test programs
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+/* Check reporting, and a dummy driver without input of its own.
+ * Tests register the dummy devices through the internal device
+ * interface and feed them by hand, or from dummy_pump.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "openinput.h"
+#include "internal.h"
+#include "testlib.h"
+
+// Globals
+int failed = 0;
+oi_joyconfig dummy_joy;
+void (*dummy_pump)(oi_device *dev) = NULL;
+
+// Dummy device functions
+int dummy_init(oi_device *dev, char *window_id, unsigned int flags);
+int dummy_destroy(oi_device *dev);
+void dummy_process(oi_device *dev);
+
+/* ******************************************************************** */
+
+// Check condition and report
+void check(int ok, char *what) {
+    printf("%s: %s\n", ok ? "ok" : "FAILED", what);
+    if(!ok) {
+        failed++;
+    }
+}
+
+/* ******************************************************************** */
+
+// Create a dummy device
+oi_device *dummy_device() {
+    oi_device *dev;
+
+    dev = (oi_device*)malloc(sizeof(oi_device));
+    if(dev) {
+        memset(dev, 0, sizeof(oi_device));
+        dev->init = dummy_init;
+        dev->destroy = dummy_destroy;
+        dev->process = dummy_process;
+    }
+    return dev;
+}
+
+/* ******************************************************************** */
+
+// Create a dummy joystick with a copy of dummy_joy
+oi_device *dummy_joystick() {
+    oi_device *dev;
+    oi_joyconfig *conf;
+
+    dev = dummy_device();
+    conf = (oi_joyconfig*)malloc(sizeof(oi_joyconfig));
+    if(!dev || !conf) {
+        free(dev);
+        free(conf);
+        return NULL;
+    }
+    *conf = dummy_joy;
+    dev->joyconfig = conf;
+    return dev;
+}
+
+/* ******************************************************************** */
+
+// Fill joystick configuration with plain sticks
+void dummy_joyconfig(oi_joyconfig *conf, char *name, int buttons, int axes) {
+    int i;
+
+    memset(conf, 0, sizeof(oi_joyconfig));
+    conf->name = name;
+    conf->buttons = buttons;
+    for(i=0; (i<axes) && (i<OI_JOY_NUM_AXES); i++) {
+        conf->kind[i] = OIJ_STICK;
+    }
+}
+
+/* ******************************************************************** */
+
+// Nothing to setup
+int dummy_init(oi_device *dev, char *window_id, unsigned int flags) {
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+// Free device
+int dummy_destroy(oi_device *dev) {
+    free(dev->joyconfig);
+    free(dev);
+    return OI_ERR_OK;
+}
+
+/* ******************************************************************** */
+
+// Input comes from the test
+void dummy_process(oi_device *dev) {
+    if(dummy_pump) {
+        dummy_pump(dev);
+    }
+}
+
+/* ******************************************************************** */
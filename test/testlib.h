@@ -1,5 +1,5 @@
 /*
- * debug.c : Debugging helpers
+ * testlib.h : Helpers shared by the test programs
  *
  * This file is a part of the OpenInput library.
  * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
@@ -21,58 +21,38 @@
 
 /* ******************************************************************** */
 
-// Includes
-#include "config.h"
-#include <stdio.h>
-#include <stdarg.h>
-#include "openinput.h"
-#include "internal.h"
+#ifndef _OPENINPUT_TESTLIB_H_
+#define _OPENINPUT_TESTLIB_H_
 
 /* ******************************************************************** */
 
-#ifdef DEBUG
+// Number of failed checks
+extern int failed;
 
-/**
- * @ingroup IMain
- * @brief Debug printf-helper
- *
- * @param format string pointer with printf-formatting
- * @param ... more arguments (varargs)
- *
- * Print debug information to standard-error. You should use this
- * function instead of regular printf's, as this function is only
- * used on debug-enabled builds.
- */
-void debug(char* format, ...) {
-    va_list args;
+// Check condition and report
+void check(int ok, char *what);
 
-    fprintf(stderr, "openinput: ");
+/* ******************************************************************** */
 
-    va_start(args, format);
-    vfprintf(stderr, format, args);
-    va_end(args);
+// Dummy driver, for tests built against the internal interface
+#ifdef _OPENINPUT_INTERNAL_H_
 
-    fprintf(stderr, "\n");
-}
-#endif
+// Joystick configuration given to devices from dummy_joystick
+extern oi_joyconfig dummy_joy;
 
-/* ******************************************************************** */
+// Called when a dummy device is pumped, NULL for no input
+extern void (*dummy_pump)(oi_device *dev);
 
-#if !defined(DEBUG) && !defined(__GNUC__)
+// Dummy devices, for bootstraps registered with device_register
+oi_device *dummy_device();
+oi_device *dummy_joystick();
 
-/**
- * @ingroup IMain
- * @brief Debug printf-helper, dummy version
- *
- * @param format string pointer with printf-formatting
- * @param ... more arguments (varargs)
- *
- * Empty function. We need this since MSVC does not allow for
- * vararg-style preprocessor macros. MSVC is broken!
- */
-void debug(char* format, ...) {
-}
+// Fill joystick configuration with plain sticks
+void dummy_joyconfig(oi_joyconfig *conf, char *name,
+                     int buttons, int axes);
 
 #endif
 
 /* ******************************************************************** */
+
+#endif
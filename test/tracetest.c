@@ -0,0 +1,146 @@
+/*
+ * tracetest.c : Test of the trace ring
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/* ******************************************************************** */
+
+/* Events are injected, dropped and polled without drivers, and the
+ * trace ring is dumped and checked for the pipeline stages. Then
+ * the cost of a trace record is timed, and finally OI_QUIT must
+ * dump the ring to the file named by OI_TRACE.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "openinput.h"
+#include "internal.h"
+#include "testlib.h"
+
+// Parameters
+#define DUMP "tracetest.json"
+#define QUITDUMP "tracetest-quit.json"
+#define RECORDS 1000000
+#define MAX_NS 100
+#define MAX_SIZE (1024*1024)
+
+// Globals
+static char buf[MAX_SIZE];
+
+/* ******************************************************************** */
+
+// Read file into buffer, returns length
+int slurp(char *filename) {
+    FILE *f;
+    int n;
+
+    buf[0] = '\0';
+    f = fopen(filename, "r");
+    if(!f) {
+        return 0;
+    }
+    n = fread(buf, 1, MAX_SIZE - 1, f);
+    buf[n] = '\0';
+    fclose(f);
+    return n;
+}
+
+/* ******************************************************************** */
+
+// Monotonic time in nanoseconds
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    oi_event ev;
+    double s;
+    double ns;
+    int i;
+
+    printf("*** tracetest start\n");
+
+    setenv("OI_DRIVERS", "none", 1);
+    setenv("OI_TRACE", QUITDUMP, 1);
+    unlink(QUITDUMP);
+    i = oi_init("c:0 s:0 w:0", OI_FLAG_NOWINDOW | OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", i);
+
+    // Key through the queue, and a full queue
+    memset(&ev, 0, sizeof(ev));
+    ev.type = OI_KEYDOWN;
+    ev.key.device = 7;
+    ev.key.keysym.sym = OIK_A;
+    oi_events_add(&ev, 1);
+    ev.type = OI_EXPOSE;
+    for(i=0; i<OI_MAX_EVENTS; i++) {
+        oi_events_add(&ev, 1);
+    }
+    for(i=0; i<5; i++) {
+        while(oi_events_poll(&ev));
+        usleep(1000);
+    }
+
+    check(oi_trace_dump(DUMP) == OI_ERR_OK, "dump");
+    i = slurp(DUMP);
+    printf("dump is %i bytes\n", i);
+    check(strncmp(buf, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 39) == 0, "trace header");
+    check(strstr(buf, "\"name\":\"queue\",\"ph\":\"i\",\"s\":\"t\",\"ts\":") != NULL, "queue hop");
+    check(strstr(buf, "\"args\":{\"device\":7,\"type\":2}") != NULL, "device and type");
+    check(strstr(buf, "\"name\":\"drop\"") != NULL, "drop hop");
+    check(strstr(buf, "\"name\":\"deliver\"") != NULL, "deliver hop");
+    check(strstr(buf, "\"name\":\"pump\",\"ph\":\"B\"") && strstr(buf, "\"name\":\"pump\",\"ph\":\"E\""),
+          "pump slices");
+    check((i > 4) && (strcmp(buf + i - 4, "\n]}\n") == 0), "trace footer");
+    unlink(DUMP);
+
+    // Cost of a record
+    s = now_ns();
+    for(i=0; i<RECORDS; i++) {
+        trace_add(OI_TRACE_MANAGER, 1, OI_MOUSEMOVE);
+    }
+    ns = (now_ns() - s) / RECORDS;
+    printf("trace record: %.1f ns\n", ns);
+    check(ns < MAX_NS, "record is cheap");
+
+    // Dump on quit
+    ev.type = OI_QUIT;
+    oi_events_add(&ev, 1);
+    while(oi_events_poll(&ev));
+    check(slurp(QUITDUMP) > 0, "dumped on quit");
+    unlink(QUITDUMP);
+
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+    printf("*** tracetest ended, %i failed\n", failed);
+
+    return failed != 0;
+}
+
+/* ******************************************************************** */
@@ -0,0 +1,296 @@
+/*
+ * x11bench.c : Benchmark of X11 event draining
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+/* A second display connection injects batches of key presses,
+ * key releases and pointer motion with XTest, and the batch is then
+ * pumped through the library. The I/O system calls made by Xlib and
+ * the library are counted by wrapping them in this program, and are
+ * reported per X event along with the time spent. A held key which
+ * the server repeats must come out as a single key down. Finally,
+ * with OI_FLAG_COMPRESS a burst of motion must collapse into fewer
+ * moves that end at the last position.
+ * Run it under Xvfb, ie. "xvfb-run ./x11bench". Without a display
+ * the benchmark is skipped.
+ */
+
+// Includes
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <X11/Xlib.h>
+#include <X11/keysym.h>
+#include <X11/extensions/XTest.h>
+#include "openinput.h"
+
+// Parameters
+#define ROUNDS 101
+#define KEYS 50
+#define MOTIONS 100
+#define EVENTS (KEYS * 2 + MOTIONS)
+#define MAX_EMPTY 1000
+
+// Globals
+static int counting = 0;
+static unsigned int syscalls = 0;
+
+/* ******************************************************************** */
+
+// Count an I/O system call and find the real one
+void *real(char *name) {
+    if(counting) {
+        syscalls++;
+    }
+    return dlsym(RTLD_NEXT, name);
+}
+
+ssize_t read(int fd, void *buf, size_t n) {
+    return ((ssize_t(*)(int, void*, size_t))real("read"))(fd, buf, n);
+}
+
+ssize_t recv(int fd, void *buf, size_t n, int flags) {
+    return ((ssize_t(*)(int, void*, size_t, int))real("recv"))(fd, buf, n, flags);
+}
+
+ssize_t recvmsg(int fd, struct msghdr *msg, int flags) {
+    return ((ssize_t(*)(int, struct msghdr*, int))real("recvmsg"))(fd, msg, flags);
+}
+
+ssize_t writev(int fd, const struct iovec *iov, int n) {
+    return ((ssize_t(*)(int, const struct iovec*, int))real("writev"))(fd, iov, n);
+}
+
+ssize_t sendmsg(int fd, const struct msghdr *msg, int flags) {
+    return ((ssize_t(*)(int, const struct msghdr*, int))real("sendmsg"))(fd, msg, flags);
+}
+
+int poll(struct pollfd *fds, nfds_t n, int timeout) {
+    return ((int(*)(struct pollfd*, nfds_t, int))real("poll"))(fds, n, timeout);
+}
+
+int select(int n, fd_set *r, fd_set *w, fd_set *e, struct timeval *t) {
+    return ((int(*)(int, fd_set*, fd_set*, fd_set*, struct timeval*))real("select"))(n, r, w, e, t);
+}
+
+/* ******************************************************************** */
+
+// Monotonic time in nanoseconds
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* ******************************************************************** */
+
+// Compare doubles for qsort
+int cmp(const void *a, const void *b) {
+    double d;
+    d = *(const double*)a - *(const double*)b;
+    return (d > 0) - (d < 0);
+}
+
+/* ******************************************************************** */
+
+// Pump until the wanted number of events arrived, returns events seen
+int collect(int wanted, int *downs) {
+    oi_event ev;
+    int got;
+    int empty;
+
+    got = 0;
+    empty = 0;
+    while((got < wanted) && (empty < MAX_EMPTY)) {
+        if(!oi_events_poll(&ev)) {
+            empty++;
+            continue;
+        }
+        if((ev.type == OI_KEYDOWN) || (ev.type == OI_KEYUP) ||
+           (ev.type == OI_MOUSEMOVE)) {
+            got++;
+        }
+        if(downs && (ev.type == OI_KEYDOWN)) {
+            (*downs)++;
+        }
+    }
+    return got;
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char* argv[]) {
+    Display *disp;
+    Display *inject;
+    Window win;
+    Window child;
+    XEvent evt;
+    oi_event ev;
+    unsigned int scrn;
+    unsigned int kc;
+    char csw[100];
+    double sys[ROUNDS];
+    double t[ROUNDS];
+    double s;
+    int downs;
+    int moves;
+    int failed;
+    int lastx;
+    int lasty;
+    int got;
+    int x;
+    int y;
+    int r;
+    int i;
+
+    printf("*** x11bench start\n");
+
+    // Skip without a display
+    disp = XOpenDisplay(NULL);
+    inject = XOpenDisplay(NULL);
+    if(!disp || !inject) {
+        printf("x11bench: no display, skipped\n");
+        return 77;
+    }
+
+    scrn = DefaultScreen(disp);
+    win = XCreateSimpleWindow(disp, DefaultRootWindow(disp),
+                              50, 50, 200, 200, 0,
+                              BlackPixel(disp, scrn),
+                              WhitePixel(disp, scrn));
+    XSelectInput(disp, win, StructureNotifyMask);
+    XMapWindow(disp, win);
+    do {
+        XNextEvent(disp, &evt);
+    } while(evt.type != MapNotify);
+    XSetInputFocus(disp, win, RevertToParent, CurrentTime);
+    XTranslateCoordinates(disp, win, DefaultRootWindow(disp), 0, 0, &x, &y, &child);
+
+    sprintf(csw, "c:%lu s:%u w:%u", (ulong)disp, (uint)scrn, (uint)win);
+    i = oi_init(csw, OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", i);
+    while(oi_events_poll(&ev));
+
+    kc = XKeysymToKeycode(inject, XK_a);
+    for(r=0; r<ROUNDS; r++) {
+
+        // Queue a batch at the server, without reading it
+        for(i=0; i<MOTIONS; i++) {
+            XTestFakeMotionEvent(inject, -1, x + 10 + (i & 1) * 20 + (r & 7),
+                                 y + 10 + i, CurrentTime);
+            if(i < KEYS) {
+                XTestFakeKeyEvent(inject, kc, True, CurrentTime);
+                XTestFakeKeyEvent(inject, kc, False, CurrentTime);
+            }
+        }
+        XSync(inject, False);
+        usleep(2000);
+
+        syscalls = 0;
+        counting = 1;
+        s = now_ns();
+        got = collect(EVENTS, NULL);
+        t[r] = now_ns() - s;
+        counting = 0;
+        sys[r] = (double)syscalls / EVENTS;
+
+        if(got != EVENTS) {
+            printf("round %i: got %i of %i events\n", r, got, EVENTS);
+        }
+    }
+
+    qsort(t, ROUNDS, sizeof(double), cmp);
+    qsort(sys, ROUNDS, sizeof(double), cmp);
+    printf("%-30s median %8.0f ns  (%6.1f ns/event)\n", "drain batch",
+           t[ROUNDS/2], t[ROUNDS/2] / EVENTS);
+    printf("%-30s median %8.3f  min %8.3f\n", "syscalls/event",
+           sys[ROUNDS/2], sys[0]);
+
+    // Held key, the server repeats presses
+    downs = 0;
+    XTestFakeKeyEvent(inject, kc, True, CurrentTime);
+    for(i=0; i<10; i++) {
+        XTestFakeKeyEvent(inject, kc, True, CurrentTime);
+    }
+    XTestFakeKeyEvent(inject, kc, False, CurrentTime);
+    XSync(inject, False);
+    usleep(2000);
+    collect(2, &downs);
+    while(oi_events_poll(&ev)) {
+        if(ev.type == OI_KEYDOWN) {
+            downs++;
+        }
+    }
+    printf("repeated presses: %i key down events, expected 1\n", downs);
+
+    // Motion compression
+    i = oi_close();
+    i = oi_init(csw, OI_FLAG_NOHOTPLUG | OI_FLAG_COMPRESS);
+    printf("oi_init compressed: code %i\n", i);
+    while(oi_events_poll(&ev));
+
+    for(i=0; i<MOTIONS; i++) {
+        XTestFakeMotionEvent(inject, -1, x + 10 + i / 2, y + 10 + i, CurrentTime);
+    }
+    XSync(inject, False);
+    usleep(2000);
+
+    failed = 0;
+    moves = 0;
+    lastx = -1;
+    lasty = -1;
+    for(i=0; i<MAX_EMPTY; i++) {
+        while(oi_events_poll(&ev)) {
+            if(ev.type == OI_MOUSEMOVE) {
+                moves++;
+                lastx = ev.move.x;
+                lasty = ev.move.y;
+            }
+        }
+    }
+    printf("compressed motion: %i move events for %i motions, end (%i,%i)\n",
+           moves, MOTIONS, lastx, lasty);
+    if((moves < 1) || (moves >= MOTIONS) ||
+       (lastx != 10 + (MOTIONS - 1) / 2) || (lasty != 10 + MOTIONS - 1)) {
+        failed = 1;
+    }
+
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+    XDestroyWindow(disp, win);
+    XCloseDisplay(inject);
+    XCloseDisplay(disp);
+    printf("*** x11bench ended\n");
+
+    return (downs != 1) || failed;
+}
+
+/* ******************************************************************** */
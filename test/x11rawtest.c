@@ -0,0 +1,125 @@
+/*
+ * x11rawtest.c : X11 relative mouse motion with XInput2
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+/* The mouse is grabbed and hidden, and XTest fakes relative motion
+ * far beyond the window border, like xdotool does. All of it must come
+ * out as relative OI_MOUSEMOVE events, without anything lost at the
+ * border. Run it under Xvfb, ie. "xvfb-run ./x11rawtest". Without a
+ * display the test is skipped.
+ */
+
+// Includes
+#include "openinput.h"
+#include <X11/Xlib.h>
+#include <X11/extensions/XTest.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// Parameters
+#define STEPS 40
+#define STEP_X 25
+#define STEP_Y -15
+#define WAIT_MS 2000
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char* argv[]) {
+    Display *disp;
+    Window win;
+    XEvent evt;
+    oi_event ev;
+    unsigned int scrn;
+    char csw[100];
+    int sumx;
+    int sumy;
+    int ms;
+    int i;
+
+    printf("*** x11rawtest start\n");
+
+    // Skip without a display
+    disp = XOpenDisplay(NULL);
+    if(!disp) {
+        printf("x11rawtest: no display, skipped\n");
+        return 77;
+    }
+
+    // Small window, so the motion crosses the border many times
+    scrn = DefaultScreen(disp);
+    win = XCreateSimpleWindow(disp, DefaultRootWindow(disp),
+                              50, 50, 200, 200, 0,
+                              BlackPixel(disp, scrn),
+                              WhitePixel(disp, scrn));
+    XSelectInput(disp, win, StructureNotifyMask);
+    XMapWindow(disp, win);
+    do {
+        XNextEvent(disp, &evt);
+    } while(evt.type != MapNotify);
+
+    sprintf(csw, "c:%lu s:%u w:%u", (ulong)disp, (uint)scrn, (uint)win);
+    i = oi_init(csw, OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", i);
+
+    // Relative mouse mode
+    oi_app_grab(OI_ENABLE);
+    oi_app_cursor(OI_DISABLE);
+    while(oi_events_poll(&ev));
+
+    // Fake the motion
+    for(i=0; i<STEPS; i++) {
+        XTestFakeRelativeMotionEvent(disp, STEP_X, STEP_Y, CurrentTime);
+    }
+    XSync(disp, False);
+
+    // Collect it
+    sumx = 0;
+    sumy = 0;
+    for(ms=0; ms<WAIT_MS; ms++) {
+        while(oi_events_poll(&ev)) {
+            if(ev.type == OI_MOUSEMOVE) {
+                sumx += ev.move.relx;
+                sumy += ev.move.rely;
+            }
+        }
+        if((sumx == STEPS * STEP_X) && (sumy == STEPS * STEP_Y)) {
+            break;
+        }
+        usleep(1000);
+    }
+    printf("motion: %i,%i expected %i,%i\n", sumx, sumy,
+           STEPS * STEP_X, STEPS * STEP_Y);
+
+    oi_app_cursor(OI_ENABLE);
+    oi_app_grab(OI_DISABLE);
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+
+    XDestroyWindow(disp, win);
+    XCloseDisplay(disp);
+    printf("*** x11rawtest ended\n");
+
+    return (sumx != STEPS * STEP_X) || (sumy != STEPS * STEP_Y);
+}
+
+/* ******************************************************************** */
@@ -0,0 +1,212 @@
+/*
+ * xcbtest.c : Test of the XCB driver
+ *
+ * This file is a part of the OpenInput library.
+ * Copyright (C) 2005  Jakob Kjaer <makob@makob.dk>.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* ******************************************************************** */
+
+/* The library is hooked into a window on our XCB connection, and
+ * events are sent to the window with SendEvent (so no input
+ * extension is needed). We check that they come out of the library
+ * as the right OpenInput events. Run it under Xvfb, ie.
+ * "xvfb-run ./xcbtest". Without a display the test is skipped.
+ */
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <xcb/xcb.h>
+#include "openinput.h"
+#include "testlib.h"
+
+// Parameters
+#define WAIT_MS 1000
+
+// Globals
+static xcb_connection_t *conn;
+static xcb_window_t win;
+
+/* ******************************************************************** */
+
+// Send event to our window
+void send(void *ev) {
+    xcb_send_event(conn, 0, win, XCB_EVENT_MASK_NO_EVENT, (char*)ev);
+    xcb_flush(conn);
+}
+
+/* ******************************************************************** */
+
+// Wait for an event of the given type
+int wait_for(oi_type type, oi_event *ev) {
+    int ms;
+
+    for(ms=0; ms<WAIT_MS; ms++) {
+        while(oi_events_poll(ev)) {
+            if(ev->type == type) {
+                return 1;
+            }
+        }
+        usleep(1000);
+    }
+    return 0;
+}
+
+/* ******************************************************************** */
+
+// Send a key event
+void key(unsigned char type, xcb_keycode_t kc) {
+    xcb_key_press_event_t kev;
+
+    memset(&kev, 0, sizeof(kev));
+    kev.response_type = type;
+    kev.detail = kc;
+    kev.event = win;
+    kev.time = 1000;
+    send(&kev);
+}
+
+/* ******************************************************************** */
+
+// Main function
+int main(int argc, char *argv[]) {
+    const xcb_setup_t *setup;
+    xcb_screen_t *screen;
+    xcb_get_keyboard_mapping_reply_t *map;
+    xcb_keysym_t *syms;
+    xcb_generic_event_t *xev;
+    xcb_button_press_event_t bev;
+    xcb_motion_notify_event_t mev;
+    xcb_configure_notify_event_t cev;
+    xcb_keycode_t kc;
+    oi_event ev;
+    uint32_t mask;
+    char csw[100];
+    int scrn;
+    int found;
+    int i;
+
+    printf("*** xcbtest start\n");
+
+    // Skip without a display
+    conn = xcb_connect(NULL, &scrn);
+    if(xcb_connection_has_error(conn)) {
+        printf("xcbtest: no display, skipped\n");
+        return 77;
+    }
+
+    // Open and map window
+    setup = xcb_get_setup(conn);
+    screen = xcb_setup_roots_iterator(setup).data;
+    win = xcb_generate_id(conn);
+    mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+    xcb_create_window(conn, XCB_COPY_FROM_PARENT, win, screen->root,
+                      50, 50, 200, 200, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      screen->root_visual, XCB_CW_EVENT_MASK, &mask);
+    xcb_map_window(conn, win);
+    xcb_flush(conn);
+    while((xev = xcb_wait_for_event(conn)) != NULL) {
+        i = (xev->response_type & ~0x80) == XCB_MAP_NOTIFY;
+        free(xev);
+        if(i) {
+            break;
+        }
+    }
+
+    // Keycode of "a"
+    kc = 0;
+    map = xcb_get_keyboard_mapping_reply(conn,
+                                         xcb_get_keyboard_mapping(conn, setup->min_keycode,
+                                                                  setup->max_keycode - setup->min_keycode + 1),
+                                         NULL);
+    if(map) {
+        syms = xcb_get_keyboard_mapping_keysyms(map);
+        for(i=0; i<xcb_get_keyboard_mapping_keysyms_length(map); i++) {
+            if(syms[i] == 'a') {
+                kc = setup->min_keycode + i / map->keysyms_per_keycode;
+                break;
+            }
+        }
+        free(map);
+    }
+
+    // Init OI on the connection
+    sprintf(csw, "x:%lu s:%i w:%u", (unsigned long)conn, scrn, (unsigned int)win);
+    i = oi_init(csw, OI_FLAG_NOHOTPLUG);
+    printf("oi_init: code %i\n", i);
+    found = 0;
+    while(oi_events_poll(&ev)) {
+        if((ev.type == OI_DISCOVERY) && (strcmp(ev.discover.name, "xcb") == 0)) {
+            found = 1;
+        }
+    }
+    check(found, "xcb device discovered");
+
+    // Keys, a repeated press is eaten
+    key(XCB_KEY_PRESS, kc);
+    key(XCB_KEY_PRESS, kc);
+    key(XCB_KEY_RELEASE, kc);
+    check(kc && wait_for(OI_KEYDOWN, &ev) && (ev.key.keysym.sym == OIK_A), "key down");
+    check(wait_for(OI_KEYUP, &ev) && (ev.key.keysym.sym == OIK_A), "repeat eaten, key up");
+
+    // Mouse
+    memset(&mev, 0, sizeof(mev));
+    mev.response_type = XCB_MOTION_NOTIFY;
+    mev.event = win;
+    mev.event_x = 30;
+    mev.event_y = 40;
+    send(&mev);
+    check(wait_for(OI_MOUSEMOVE, &ev) && (ev.move.x == 30) && (ev.move.y == 40), "mouse motion");
+
+    memset(&bev, 0, sizeof(bev));
+    bev.response_type = XCB_BUTTON_PRESS;
+    bev.event = win;
+    bev.detail = 1;
+    send(&bev);
+    check(wait_for(OI_MOUSEBUTTONDOWN, &ev), "mouse button");
+
+    // Window size
+    memset(&cev, 0, sizeof(cev));
+    cev.response_type = XCB_CONFIGURE_NOTIFY;
+    cev.event = win;
+    cev.window = win;
+    cev.width = 320;
+    cev.height = 240;
+    send(&cev);
+    check(wait_for(OI_RESIZE, &ev) && (ev.resize.width == 320) && (ev.resize.height == 240), "resize");
+
+    // Grab and hide round trip
+    oi_app_grab(OI_ENABLE);
+    oi_app_cursor(OI_DISABLE);
+    oi_app_cursor(OI_ENABLE);
+    oi_app_grab(OI_DISABLE);
+    check(!xcb_connection_has_error(conn), "grab and hide");
+
+    // Done
+    i = oi_close();
+    printf("oi_close: code %i\n", i);
+    xcb_destroy_window(conn, win);
+    xcb_disconnect(conn);
+    printf("*** xcbtest ended, %i failed\n", failed);
+
+    return failed != 0;
+}
+
+/* ******************************************************************** */